@@ -24,9 +24,12 @@
 #pragma warning(disable : 4503)
 #endif
 
+#include <cstdlib>
 #include <iostream>
+#include <new>
 
 #include <orea/app/oreapp.hpp>
+#include <ored/utilities/profiler.hpp>
 
 #ifdef BOOST_MSVC
 #include <orea/auto_link.hpp>
@@ -54,6 +57,31 @@ using namespace std;
 using namespace ore::data;
 using namespace ore::analytics;
 
+#ifndef BOOST_MSVC
+// Replacement of the global allocation functions, so that the profiler can count the allocations of a run. The
+// allocations are counted only while the profiler is on, see the setup parameter "profile". Not done for MSVC,
+// where the replacement would not be seen by the ORE libraries built as DLLs.
+void* operator new(std::size_t size) {
+    Profiler::allocation(size);
+    if (size == 0)
+        size = 1;
+    while (true) {
+        if (void* p = std::malloc(size))
+            return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete[](void* p) noexcept { std::free(p); }
+#endif
+
 int main(int argc, char** argv) {
 
     if (argc == 2 && (string(argv[1]) == "-v" || string(argv[1]) == "--version")) {
@@ -0,0 +1,346 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <benchmark/generators.hpp>
+#include <benchmark/oreabenchmark.hpp>
+#include <orea/aggregation/postprocess.hpp>
+#include <orea/cube/cubewriter.hpp>
+#include <orea/cube/inmemorycube.hpp>
+#include <orea/engine/sensitivityanalysis.hpp>
+#include <orea/engine/valuationcalculator.hpp>
+#include <orea/engine/valuationengine.hpp>
+#include <orea/scenario/crossassetmodelscenariogenerator.hpp>
+#include <orea/scenario/deltascenario.hpp>
+#include <orea/scenario/scenariosimmarket.hpp>
+#include <orea/scenario/simplescenariofactory.hpp>
+#include <ored/configuration/curveconfigurations.hpp>
+#include <ored/marketdata/csvloader.hpp>
+#include <ored/marketdata/todaysmarket.hpp>
+#include <ored/marketdata/todaysmarketparameters.hpp>
+#include <ored/model/crossassetmodelbuilder.hpp>
+#include <ored/portfolio/enginefactory.hpp>
+#include <ored/portfolio/nettingsetmanager.hpp>
+#include <ored/utilities/to_string.hpp>
+#include <ql/settings.hpp>
+#include <qle/methods/multipathgeneratorbase.hpp>
+#include <test/testmarket.hpp>
+
+#include <boost/make_shared.hpp>
+
+using namespace QuantLib;
+using namespace ore::data;
+using namespace ore::analytics;
+
+using std::map;
+using std::string;
+using std::vector;
+using testsuite::TestConfigurationObjects;
+
+namespace orea_benchmark {
+
+namespace {
+
+// exposes the scenario application of the simulation market, which is otherwise only reached through update()
+class BenchmarkSimMarket : public ScenarioSimMarket {
+public:
+    using ScenarioSimMarket::ScenarioSimMarket;
+    using ScenarioSimMarket::applyScenario;
+};
+
+// The simulation setup of the swap exposure performance test: test market, five currency cross asset model and
+// scenario simulation market
+struct Simulation {
+    Simulation(const Date& today, Size dates, Size seed = 5) : today(today) {
+        Settings::instance().evaluationDate() = today;
+        initMarket = boost::make_shared<testsuite::TestMarket>(today);
+        parameters = TestConfigurationObjects::setupExposureSimMarketData5();
+        grid = quarterlyGrid(dates);
+        CrossAssetModelBuilder modelBuilder(initMarket, TestConfigurationObjects::setupCrossAssetModelData5());
+        boost::shared_ptr<QuantExt::CrossAssetModel> model = *modelBuilder.model();
+        boost::shared_ptr<QuantExt::MultiPathGeneratorBase> pathGenerator =
+            boost::make_shared<QuantExt::MultiPathGeneratorMersenneTwister>(model->stateProcess(), grid->timeGrid(),
+                                                                            seed, false);
+        scenarioGenerator = boost::make_shared<CrossAssetModelScenarioGenerator>(
+            model, pathGenerator, boost::make_shared<SimpleScenarioFactory>(), parameters, today, grid, initMarket);
+        simMarket = boost::make_shared<BenchmarkSimMarket>(initMarket, parameters, *TestConfigurationObjects::conv());
+        simMarket->scenarioGenerator() = scenarioGenerator;
+    }
+    Date today;
+    boost::shared_ptr<Market> initMarket;
+    boost::shared_ptr<ScenarioSimMarketParameters> parameters;
+    boost::shared_ptr<DateGrid> grid;
+    boost::shared_ptr<ScenarioGenerator> scenarioGenerator;
+    boost::shared_ptr<BenchmarkSimMarket> simMarket;
+};
+
+const Date today(14, April, 2016);
+
+// Pricing of a swap portfolio on cross asset model scenarios, as in the swap exposure performance test
+void cubeBuild(BenchmarkState& state) {
+    Size trades = state.parameter("trades", 100);
+    Size dates = state.parameter("dates", 40);
+    Size samples = state.parameter("samples", 100);
+
+    Simulation sim(today, dates);
+    boost::shared_ptr<EngineFactory> factory = boost::make_shared<EngineFactory>(engineData(), sim.simMarket);
+    boost::shared_ptr<Portfolio> portfolio = swapPortfolio(trades);
+    portfolio->build(factory);
+    QL_REQUIRE(portfolio->size() == trades, "built " << portfolio->size() << " trades, expected " << trades);
+
+    ValuationEngine engine(today, sim.grid, sim.simMarket);
+    vector<boost::shared_ptr<ValuationCalculator>> calculators(1, boost::make_shared<NPVCalculator>("EUR"));
+    boost::shared_ptr<NPVCube> cube;
+    state.run("npv",
+              [&]() {
+                  engine.buildCube(portfolio, cube, calculators);
+                  return trades * sim.grid->size() * samples;
+              },
+              [&]() {
+                  cube = boost::make_shared<DoublePrecisionInMemoryCube>(today, portfolio->ids(), sim.grid->dates(),
+                                                                         samples);
+              });
+}
+
+// Setting all quotes of the simulation market from full cross asset model scenarios
+void applyScenario(BenchmarkState& state) {
+    Size dates = state.parameter("dates", 40);
+    Size samples = state.parameter("samples", 25);
+
+    Simulation sim(today, dates);
+    vector<boost::shared_ptr<Scenario>> scenarios;
+    for (Size k = 0; k < samples; ++k) {
+        for (const auto& d : sim.grid->dates())
+            scenarios.push_back(sim.scenarioGenerator->next(d));
+        sim.scenarioGenerator->reset();
+    }
+
+    state.run("scenario", [&]() {
+        for (const auto& s : scenarios)
+            sim.simMarket->applyScenario(s);
+        return scenarios.size();
+    });
+}
+
+// Patching single quotes of the sensitivity market, as done for each sensitivity scenario
+void applyDeltaScenario(BenchmarkState& state) {
+    Size maxScenarios = state.parameter("scenarios", 500);
+
+    Settings::instance().evaluationDate() = today;
+    boost::shared_ptr<Market> initMarket = boost::make_shared<testsuite::TestMarket>(today);
+    BenchmarkSimMarket simMarket(initMarket, TestConfigurationObjects::setupSimMarketData5(),
+                                 *TestConfigurationObjects::conv());
+    boost::shared_ptr<Scenario> base = simMarket.baseScenario();
+
+    vector<boost::shared_ptr<Scenario>> scenarios;
+    for (const auto& key : base->keys()) {
+        if (scenarios.size() == maxScenarios)
+            break;
+        boost::shared_ptr<Scenario> delta = boost::make_shared<DeltaScenario>(base, to_string(key));
+        delta->add(key, base->get(key) * 1.0001 + 0.0001);
+        scenarios.push_back(delta);
+    }
+
+    state.run("scenario", [&]() {
+        for (const auto& s : scenarios)
+            simMarket.applyScenario(s);
+        return scenarios.size();
+    });
+}
+
+// Building today's market of the examples from the example market data
+void curveBootstrap(BenchmarkState& state) {
+    Date asof(5, February, 2016);
+    Settings::instance().evaluationDate() = asof;
+    string input = state.inputPath() + "/";
+
+    Conventions conventions;
+    conventions.fromFile(input + "conventions.xml");
+    CurveConfigurations curveConfigs;
+    curveConfigs.fromFile(input + "curveconfig.xml");
+    TodaysMarketParameters marketParameters;
+    marketParameters.fromFile(input + "todaysmarket.xml");
+    CSVLoader loader(input + "market_20160205.txt", input + "fixings_20160205.txt", false);
+
+    // fixings are not loaded, they would change the global index histories for the following benchmarks
+    state.run("market", [&]() {
+        TodaysMarket market(asof, marketParameters, loader, curveConfigs, conventions, true, false);
+        return Size(1);
+    });
+}
+
+// Parsing market data and fixing files
+void csvLoader(BenchmarkState& state) {
+    Size dates = state.parameter("dates", 10);
+    Size quotes = state.parameter("quotes", 10000);
+    Size fixings = state.parameter("fixings", 2000);
+
+    Date asof(5, February, 2016);
+    Settings::instance().evaluationDate() = asof;
+    string marketFile = state.workPath() + "/benchmark_market.txt";
+    string fixingsFile = state.workPath() + "/benchmark_fixings.txt";
+    writeMarketDataFile(marketFile, asof, dates, quotes);
+    writeFixingsFile(fixingsFile, asof, fixings);
+
+    state.run("quote", [&]() {
+        CSVLoader loader(marketFile, fixingsFile, false);
+        return dates * quotes + 5 * fixings;
+    });
+}
+
+// Sensitivity analysis of a swap and swaption portfolio, as in the sensitivity performance test
+void sensitivity(BenchmarkState& state) {
+    Size trades = state.parameter("trades", 20);
+
+    Settings::instance().evaluationDate() = today;
+    boost::shared_ptr<Market> initMarket = boost::make_shared<testsuite::TestMarket>(today);
+    boost::shared_ptr<ScenarioSimMarketParameters> parameters = TestConfigurationObjects::setupSimMarketData5();
+    boost::shared_ptr<SensitivityScenarioData> sensiData = TestConfigurationObjects::setupSensitivityScenarioData5();
+    boost::shared_ptr<EngineData> data = engineData();
+    boost::shared_ptr<Conventions> convs = TestConfigurationObjects::conv();
+
+    // the analysis includes building the simulation market and the portfolio, as in the application
+    boost::shared_ptr<Portfolio> portfolio;
+    state.run("npv",
+              [&]() {
+                  SensitivityAnalysis sa(portfolio, initMarket, Market::defaultConfiguration, data, parameters,
+                                         sensiData, *convs, false);
+                  sa.generateSensitivities();
+                  return sa.scenarioGenerator()->samples() * portfolio->size();
+              },
+              [&]() { portfolio = swapSwaptionPortfolio(trades); });
+}
+
+// The inputs of the post processor: a built swap portfolio and a random cube and scenario data
+struct Aggregation {
+    Aggregation(BenchmarkState& state, Size depth) {
+        trades = state.parameter("trades", 100);
+        dates = state.parameter("dates", 40);
+        samples = state.parameter("samples", 1000);
+
+        Settings::instance().evaluationDate() = today;
+        market = boost::make_shared<testsuite::TestMarket>(today);
+        portfolio = swapPortfolio(trades);
+        portfolio->build(boost::make_shared<EngineFactory>(engineData(), market));
+        QL_REQUIRE(portfolio->size() == trades, "built " << portfolio->size() << " trades, expected " << trades);
+        cube = randomCube(today, portfolio->ids(), quarterlyGrid(dates)->dates(), samples, depth);
+        scenarioData = randomScenarioData(dates, samples);
+        nettingSetManager = boost::make_shared<NettingSetManager>();
+        nettingSetManager->add(boost::make_shared<NettingSetDefinition>(nettingSet, counterparty));
+    }
+
+    Size trades, dates, samples;
+    boost::shared_ptr<Market> market;
+    boost::shared_ptr<Portfolio> portfolio;
+    boost::shared_ptr<NPVCube> cube;
+    boost::shared_ptr<AggregationScenarioData> scenarioData;
+    boost::shared_ptr<NettingSetManager> nettingSetManager;
+};
+
+map<string, bool> postProcessAnalytics(bool dim) {
+    return {{"exerciseNextBreak", false}, {"exposureProfiles", true}, {"cva", true},
+            {"dva", false},               {"fva", false},             {"colva", false},
+            {"collateralFloor", false},   {"kva", false},             {"mva", false},
+            {"dim", dim},                 {"flipViewXVA", false}};
+}
+
+// Exposure profiles, CVA and allocation from a cube
+void postProcessExposure(BenchmarkState& state) {
+    Aggregation a(state, 1);
+    map<string, bool> analytics = postProcessAnalytics(false);
+    state.run("npv", [&]() {
+        PostProcess postProcess(a.portfolio, a.nettingSetManager, a.market, Market::defaultConfiguration, a.cube,
+                                a.scenarioData, analytics, "EUR", "Marginal", 1.0);
+        return a.trades * a.dates * a.samples;
+    });
+}
+
+// Dynamic initial margin by regression from a cube with cash flows
+void postProcessDim(BenchmarkState& state) {
+    Aggregation a(state, 2);
+    Size order = state.parameter("order", 2);
+    map<string, bool> analytics = postProcessAnalytics(true);
+    state.run("npv", [&]() {
+        PostProcess postProcess(a.portfolio, a.nettingSetManager, a.market, Market::defaultConfiguration, a.cube,
+                                a.scenarioData, analytics, "EUR", "None", 1.0, 0.95, "Symmetric", "", "", "", 0.99, 14,
+                                order);
+        return a.trades * a.dates * a.samples;
+    });
+}
+
+vector<string> tradeIds(Size trades) {
+    vector<string> ids;
+    for (Size i = 0; i < trades; ++i)
+        ids.push_back("Trade_" + std::to_string(i + 1));
+    return ids;
+}
+
+// Writing a cube as a csv file
+void cubeWriter(BenchmarkState& state) {
+    Size trades = state.parameter("trades", 100);
+    Size dates = state.parameter("dates", 40);
+    Size samples = state.parameter("samples", 100);
+
+    Settings::instance().evaluationDate() = today;
+    vector<string> ids = tradeIds(trades);
+    boost::shared_ptr<NPVCube> cube = randomCube(today, ids, quarterlyGrid(dates)->dates(), samples, 1);
+    map<string, string> nettingSetMap;
+    for (const auto& id : ids)
+        nettingSetMap[id] = nettingSet;
+
+    CubeWriter writer(state.workPath() + "/benchmark_cube.csv");
+    state.run("npv", [&]() {
+        writer.write(cube, nettingSetMap);
+        return trades * dates * samples;
+    });
+}
+
+// Saving and loading a cube in the binary archive format
+void cubeSerialization(BenchmarkState& state) {
+    Size trades = state.parameter("trades", 100);
+    Size dates = state.parameter("dates", 40);
+    Size samples = state.parameter("samples", 100);
+
+    Settings::instance().evaluationDate() = today;
+    boost::shared_ptr<NPVCube> cube = randomCube(today, tradeIds(trades), quarterlyGrid(dates)->dates(), samples, 1);
+    string fileName = state.workPath() + "/benchmark_cube.dat";
+
+    state.run("npv", [&]() {
+        cube->save(fileName);
+        DoublePrecisionInMemoryCube loaded;
+        loaded.load(fileName);
+        return trades * dates * samples;
+    });
+}
+
+} // namespace
+
+vector<Benchmark> benchmarks() {
+    return {{"CubeBuild", "swap portfolio priced on cross asset model scenarios", cubeBuild},
+            {"ApplyScenario", "cross asset model scenarios applied to the simulation market", applyScenario},
+            {"ApplyDeltaScenario", "single quote sensitivity scenarios applied to the simulation market",
+             applyDeltaScenario},
+            {"CurveBootstrap", "today's market of the examples", curveBootstrap},
+            {"CSVLoader", "market data and fixings files parsed", csvLoader},
+            {"Sensitivity", "sensitivity analysis of swaps and swaptions", sensitivity},
+            {"PostProcessExposure", "exposure profiles, CVA and allocation from a cube", postProcessExposure},
+            {"PostProcessDIM", "dynamic initial margin by regression from a cube", postProcessDim},
+            {"CubeWriter", "cube written as csv file", cubeWriter},
+            {"CubeSerialization", "cube saved and loaded as binary archive", cubeSerialization}};
+}
+
+} // namespace orea_benchmark
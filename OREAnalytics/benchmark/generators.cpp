@@ -0,0 +1,239 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <benchmark/generators.hpp>
+#include <orea/cube/inmemorycube.hpp>
+#include <ored/portfolio/swap.hpp>
+#include <ored/utilities/to_string.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+#include <ql/settings.hpp>
+#include <ql/time/calendars/target.hpp>
+#include <test/testportfolio.hpp>
+
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+using namespace QuantLib;
+using namespace ore::data;
+using namespace ore::analytics;
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace orea_benchmark {
+
+const string counterparty = "dc";
+const string nettingSet = "CPTY_A";
+
+namespace {
+
+// Returns an int in the interval [min, max]. Inclusive.
+unsigned long randInt(MersenneTwisterUniformRng& rng, Size min, Size max) {
+    return min + (rng.nextInt32() % (max + 1 - min));
+}
+
+const string& randString(MersenneTwisterUniformRng& rng, const vector<string>& strs) {
+    return strs[randInt(rng, 0, strs.size() - 1)];
+}
+
+bool randBoolean(MersenneTwisterUniformRng& rng) { return randInt(rng, 0, 1) == 1; }
+
+const vector<string> currencies = {"EUR", "USD", "GBP", "JPY", "CHF"};
+
+const map<string, string> indices = {{"EUR", "EUR-EURIBOR-6M"},
+                                     {"USD", "USD-LIBOR-3M"},
+                                     {"GBP", "GBP-LIBOR-6M"},
+                                     {"CHF", "CHF-LIBOR-6M"},
+                                     {"JPY", "JPY-LIBOR-6M"}};
+
+const vector<string> fixedTenors = {"6M", "1Y"};
+
+string tradeId(Size i) { return "Trade_" + std::to_string(i + 1); }
+
+} // namespace
+
+boost::shared_ptr<Portfolio> swapPortfolio(Size size, Size seed) {
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+
+    MersenneTwisterUniformRng rng(seed);
+    Date today = Settings::instance().evaluationDate();
+    Calendar cal = TARGET();
+    vector<Real> notional(1, 1000000.0);
+    vector<Real> spread(1, 0.0);
+
+    for (Size i = 0; i < size; ++i) {
+        Size term = randInt(rng, 2, 30);
+        // start today +/- 1 year
+        Date startDate = cal.adjust(today - 365 + randInt(rng, 0, 730));
+        Date endDate = cal.adjust(startDate + term * Years);
+        string start = to_string(startDate);
+        string end = to_string(endDate);
+
+        string ccy = randString(rng, currencies);
+        string index = indices.at(ccy);
+        string floatFreq = index.substr(index.find('-', 4) + 1);
+        Real fixedRate = randInt(rng, 10, 400) / 10000.0;
+        string fixFreq = randString(rng, fixedTenors);
+        bool isPayer = randBoolean(rng);
+
+        ScheduleData floatSchedule(ScheduleRules(start, end, floatFreq, "TARGET", "MF", "MF", "Forward"));
+        ScheduleData fixedSchedule(ScheduleRules(start, end, fixFreq, "TARGET", "MF", "MF", "Forward"));
+        LegData fixedLeg(boost::make_shared<FixedLegData>(vector<Real>(1, fixedRate)), isPayer, ccy, fixedSchedule,
+                         "30/360", notional);
+        LegData floatingLeg(boost::make_shared<FloatingLegData>(index, 2, false, spread), !isPayer, ccy, floatSchedule,
+                            "ACT/365", notional);
+
+        boost::shared_ptr<Trade> swap =
+            boost::make_shared<ore::data::Swap>(Envelope(counterparty, nettingSet), floatingLeg, fixedLeg);
+        swap->id() = tradeId(i);
+        portfolio->add(swap);
+    }
+
+    return portfolio;
+}
+
+boost::shared_ptr<Portfolio> swapSwaptionPortfolio(Size size, Size seed) {
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+
+    MersenneTwisterUniformRng rng(seed);
+    for (Size i = 0; i < size; ++i) {
+        string ccy = randString(rng, currencies);
+        string index = indices.at(ccy);
+        string floatFreq = index.substr(index.find('-', 4) + 1);
+        Real fixedRate = randInt(rng, 10, 400) / 10000.0;
+        string fixFreq = randString(rng, fixedTenors);
+        bool isPayer = randBoolean(rng);
+
+        if (i % 2 == 0) {
+            int start = randInt(rng, 1, 10);
+            Size term = randInt(rng, 2, 30);
+            string longShort = randBoolean(rng) ? "Long" : "Short";
+            portfolio->add(testsuite::buildEuropeanSwaption(tradeId(i), longShort, ccy, isPayer, 1000000.0, start, term,
+                                                            fixedRate, 0.0, fixFreq, "30/360", floatFreq, "ACT/365",
+                                                            index));
+        } else {
+            int start = randInt(rng, 0, 5);
+            Size term = randInt(rng, 2, 30);
+            portfolio->add(testsuite::buildSwap(tradeId(i), ccy, isPayer, 1000000.0, start, term, fixedRate, 0.0,
+                                                fixFreq, "30/360", floatFreq, "ACT/365", index));
+        }
+    }
+
+    return portfolio;
+}
+
+boost::shared_ptr<EngineData> engineData() {
+    boost::shared_ptr<EngineData> data = boost::make_shared<EngineData>();
+    data->model("Swap") = "DiscountedCashflows";
+    data->engine("Swap") = "DiscountingSwapEngine";
+    data->model("EuropeanSwaption") = "BlackBachelier";
+    data->engine("EuropeanSwaption") = "BlackBachelierSwaptionEngine";
+    return data;
+}
+
+boost::shared_ptr<DateGrid> quarterlyGrid(Size dates) {
+    return boost::make_shared<DateGrid>(std::to_string(dates) + ",3M");
+}
+
+boost::shared_ptr<NPVCube> randomCube(const Date& today, const vector<string>& ids, const vector<Date>& dates,
+                                      Size samples, Size depth, Size seed) {
+    boost::shared_ptr<NPVCube> cube;
+    if (depth == 1)
+        cube = boost::make_shared<DoublePrecisionInMemoryCube>(today, ids, dates, samples);
+    else
+        cube = boost::make_shared<DoublePrecisionInMemoryCubeN>(today, ids, dates, samples, depth);
+
+    MersenneTwisterUniformRng rng(seed);
+    for (Size i = 0; i < ids.size(); ++i) {
+        Real t0 = 20000.0 * (rng.nextReal() - 0.5);
+        cube->setT0(t0, i);
+        for (Size j = 0; j < dates.size(); ++j) {
+            Real scale = 100000.0 * std::sqrt((dates[j] - today) / 365.0);
+            for (Size k = 0; k < samples; ++k) {
+                cube->set(t0 + scale * (rng.nextReal() - 0.5), i, j, k);
+                if (depth > 1)
+                    cube->set(1000.0 * (rng.nextReal() - 0.5), i, j, k, 1);
+            }
+        }
+    }
+    return cube;
+}
+
+boost::shared_ptr<AggregationScenarioData> randomScenarioData(Size dates, Size samples, Size seed) {
+    boost::shared_ptr<AggregationScenarioData> data =
+        boost::make_shared<InMemoryAggregationScenarioData>(dates, samples);
+    MersenneTwisterUniformRng rng(seed);
+    for (Size j = 0; j < dates; ++j) {
+        for (Size k = 0; k < samples; ++k)
+            data->set(j, k, 0.9 + 0.2 * rng.nextReal(), AggregationScenarioDataType::Numeraire);
+    }
+    return data;
+}
+
+void writeMarketDataFile(const string& fileName, const Date& asof, Size dates, Size quotesPerDate) {
+    std::ofstream file(fileName.c_str());
+    QL_REQUIRE(file.is_open(), "writeMarketDataFile: could not open " << fileName);
+
+    // the quotes cycle through the currencies and money market, swap and swaption volatility quotes with
+    // increasing tenors, so that all keys are distinct and valid
+    vector<string> keys(quotesPerDate);
+    for (Size q = 0; q < quotesPerDate; ++q) {
+        const string& ccy = currencies[q % currencies.size()];
+        string tenor = std::to_string(q / (3 * currencies.size()) + 1) + "M";
+        switch ((q / currencies.size()) % 3) {
+        case 0:
+            keys[q] = "MM/RATE/" + ccy + "/2D/" + tenor;
+            break;
+        case 1:
+            keys[q] = "IR_SWAP/RATE/" + ccy + "/2D/" + indices.at(ccy).substr(indices.at(ccy).find('-', 4) + 1) + "/" +
+                      tenor;
+            break;
+        default:
+            keys[q] = "SWAPTION/RATE_LNVOL/" + ccy + "/" + tenor + "/10Y/ATM";
+        }
+    }
+
+    MersenneTwisterUniformRng rng(42);
+    Date d = asof - (dates - 1);
+    for (Size i = 0; i < dates; ++i, ++d) {
+        string date = to_string(d);
+        date.erase(std::remove(date.begin(), date.end(), '-'), date.end());
+        for (const auto& key : keys)
+            file << date << " " << key << " " << 0.05 * rng.nextReal() << "\n";
+    }
+}
+
+void writeFixingsFile(const string& fileName, const Date& asof, Size fixingsPerIndex) {
+    std::ofstream file(fileName.c_str());
+    QL_REQUIRE(file.is_open(), "writeFixingsFile: could not open " << fileName);
+
+    MersenneTwisterUniformRng rng(42);
+    Date d = asof - fixingsPerIndex;
+    for (Size i = 0; i < fixingsPerIndex; ++i, ++d) {
+        string date = to_string(d);
+        date.erase(std::remove(date.begin(), date.end(), '-'), date.end());
+        for (const auto& index : indices)
+            file << date << " " << index.second << " " << 0.05 * rng.nextReal() << "\n";
+    }
+}
+
+} // namespace orea_benchmark
@@ -0,0 +1,73 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file benchmark/generators.hpp
+    \brief Synthetic portfolios, cubes and data files for the benchmark suite
+*/
+
+#pragma once
+
+#include <orea/scenario/aggregationscenariodata.hpp>
+#include <orea/cube/npvcube.hpp>
+#include <ored/portfolio/enginedata.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/utilities/dategrid.hpp>
+
+#include <string>
+
+namespace orea_benchmark {
+
+using QuantLib::Date;
+using QuantLib::Size;
+
+//! Counterparty and netting set of the generated trades, the counterparty has a default curve in the test market
+extern const std::string counterparty;
+extern const std::string nettingSet;
+
+/*! Random vanilla swaps in EUR, USD, GBP, CHF and JPY starting within one year around today with terms between 2
+    and 30 years. The portfolio is not built. */
+boost::shared_ptr<ore::data::Portfolio> swapPortfolio(Size size, Size seed = 5);
+
+//! Random mix of vanilla swaps and European swaptions, the portfolio is not built
+boost::shared_ptr<ore::data::Portfolio> swapSwaptionPortfolio(Size size, Size seed = 5);
+
+//! Engine data for swaps and European swaptions
+boost::shared_ptr<ore::data::EngineData> engineData();
+
+//! A date grid of the given number of quarterly dates
+boost::shared_ptr<ore::data::DateGrid> quarterlyGrid(Size dates);
+
+/*! A cube of depth 1 (NPV) or 2 (NPV and cash flow) for the trades of the portfolio, filled with random NPVs of a
+    size typical for swaps of notional one million, that grow with the square root of time */
+boost::shared_ptr<ore::analytics::NPVCube> randomCube(const Date& today, const std::vector<std::string>& ids,
+                                                       const std::vector<Date>& dates, Size samples, Size depth,
+                                                       Size seed = 42);
+
+//! Aggregation scenario data holding random numeraires around one
+boost::shared_ptr<ore::analytics::AggregationScenarioData> randomScenarioData(Size dates, Size samples,
+                                                                              Size seed = 42);
+
+/*! Writes a market data file with the given number of quotes per date for the given number of dates ending at
+    asof, in the format read by the CSVLoader. The quotes are money market, swap and swaption volatility
+    quotes. */
+void writeMarketDataFile(const std::string& fileName, const Date& asof, Size dates, Size quotesPerDate);
+
+//! Writes a fixings file with the given number of daily fixings of each of five ibor indices before asof
+void writeFixingsFile(const std::string& fileName, const Date& asof, Size fixingsPerIndex);
+
+} // namespace orea_benchmark
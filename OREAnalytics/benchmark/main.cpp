@@ -0,0 +1,189 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#ifdef BOOST_MSVC
+// disable warning C4503: '__LINE__Var': decorated name length exceeded, name was truncated
+#pragma warning(disable : 4503)
+#endif
+
+#include <benchmark/oreabenchmark.hpp>
+#include <ored/utilities/osutils.hpp>
+#include <ored/utilities/parsers.hpp>
+#include <qle/version.hpp>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/regex.hpp>
+
+#include <fstream>
+#include <iostream>
+
+#ifdef BOOST_MSVC
+#include <orea/auto_link.hpp>
+#include <ored/auto_link.hpp>
+#include <ql/auto_link.hpp>
+#include <qle/auto_link.hpp>
+// Find the name of the correct boost library with which to link.
+#define BOOST_LIB_NAME boost_regex
+#include <boost/config/auto_link.hpp>
+#define BOOST_LIB_NAME boost_serialization
+#include <boost/config/auto_link.hpp>
+#define BOOST_LIB_NAME boost_date_time
+#include <boost/config/auto_link.hpp>
+#define BOOST_LIB_NAME boost_filesystem
+#include <boost/config/auto_link.hpp>
+#define BOOST_LIB_NAME boost_system
+#include <boost/config/auto_link.hpp>
+#define BOOST_LIB_NAME boost_timer
+#include <boost/config/auto_link.hpp>
+#define BOOST_LIB_NAME boost_chrono
+#include <boost/config/auto_link.hpp>
+#endif
+
+using namespace std;
+using namespace ore::data;
+using namespace orea_benchmark;
+
+namespace {
+
+void usage() {
+    cout << endl
+         << "usage: orea-benchmark [options]" << endl
+         << endl
+         << "  --list                  list the benchmarks and exit" << endl
+         << "  --filter <regex>        run the benchmarks whose name matches the regular expression" << endl
+         << "  --repetitions <n>       timed repetitions of each benchmark, default 3" << endl
+         << "  --warmup <n>            untimed repetitions before the timed ones, default 0" << endl
+         << "  --param <name>=<value>  override a size parameter of the benchmarks, e.g. trades=1000" << endl
+         << "  --quick                 small sizes and a single repetition, e.g. for a smoke test" << endl
+         << "  --input <path>          directory with the example input files, default Examples/Input" << endl
+         << "  --work <path>           directory for temporary files, default the system temp directory" << endl
+         << "  --output <file>         JSON results file, default benchmark.json" << endl
+         << endl;
+}
+
+// sizes used by --quick, parameters given on the command line take precedence
+const map<string, Size> quickParameters = {{"trades", 5},  {"dates", 4},   {"samples", 10},
+                                           {"quotes", 100}, {"fixings", 50}, {"scenarios", 20}};
+
+} // namespace
+
+int main(int argc, char** argv) {
+
+    Size repetitions = 3, warmup = 0;
+    bool list = false, quick = false, repetitionsGiven = false;
+    string filter = ".*", inputPath = "Examples/Input", outputFile = "benchmark.json";
+    string workPath = boost::filesystem::temp_directory_path().string();
+    map<string, Size> overrides;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            string arg(argv[i]);
+            if (arg == "--list") {
+                list = true;
+            } else if (arg == "--quick") {
+                quick = true;
+            } else if (arg == "-h" || arg == "--help") {
+                usage();
+                return 0;
+            } else if (arg == "-v" || arg == "--version") {
+                cout << "ORE version " << OPEN_SOURCE_RISK_VERSION << endl;
+                return 0;
+            } else if (i + 1 < argc) {
+                string value(argv[++i]);
+                if (arg == "--filter") {
+                    filter = value;
+                } else if (arg == "--repetitions") {
+                    repetitions = parseInteger(value);
+                    repetitionsGiven = true;
+                } else if (arg == "--warmup") {
+                    warmup = parseInteger(value);
+                } else if (arg == "--param") {
+                    string::size_type pos = value.find('=');
+                    QL_REQUIRE(pos != string::npos, "expected name=value, got " << value);
+                    overrides[value.substr(0, pos)] = parseInteger(value.substr(pos + 1));
+                } else if (arg == "--input") {
+                    inputPath = value;
+                } else if (arg == "--work") {
+                    workPath = value;
+                } else if (arg == "--output") {
+                    outputFile = value;
+                } else {
+                    QL_FAIL("unknown option " << arg);
+                }
+            } else {
+                QL_FAIL("unknown option or missing value " << arg);
+            }
+        }
+    } catch (const exception& e) {
+        cout << endl << "an error occured: " << e.what() << endl;
+        usage();
+        return -1;
+    }
+
+    if (quick) {
+        overrides.insert(quickParameters.begin(), quickParameters.end());
+        if (!repetitionsGiven)
+            repetitions = 1;
+    }
+
+    vector<Benchmark> selected;
+    boost::regex pattern(filter);
+    for (const auto& b : benchmarks()) {
+        if (boost::regex_match(b.name, pattern))
+            selected.push_back(b);
+    }
+
+    if (list) {
+        for (const auto& b : selected)
+            cout << b.name << " - " << b.description << endl;
+        return 0;
+    }
+
+    vector<BenchmarkResult> results;
+    bool failed = false;
+    for (const auto& b : selected) {
+        cout << "Running " << b.name << "..." << flush;
+        results.push_back(runBenchmark(b, overrides, repetitions, warmup, inputPath, workPath));
+        failed = failed || !results.back().error.empty();
+        cout << (results.back().error.empty() ? " done" : " failed") << endl;
+    }
+    cout << endl;
+    writeSummary(cout, results);
+
+    map<string, string> context;
+    context["version"] = OPEN_SOURCE_RISK_VERSION;
+    context["timestamp"] = boost::posix_time::to_iso_extended_string(boost::posix_time::second_clock::local_time());
+    context["os"] = os::getOsName();
+    context["cpu"] = os::getCpuName();
+    context["cores"] = std::to_string(os::getNumberCores());
+    context["memory"] = os::getMemoryRAM();
+    context["host"] = os::getHostname();
+    context["repetitions"] = std::to_string(repetitions);
+    context["warmup"] = std::to_string(warmup);
+
+    ofstream out(outputFile.c_str());
+    if (!out.is_open()) {
+        cout << endl << "an error occured: could not open " << outputFile << endl;
+        return -1;
+    }
+    writeJson(out, context, results);
+    cout << endl << "Results written to " << outputFile << endl;
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,193 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <benchmark/oreabenchmark.hpp>
+#include <ored/utilities/osutils.hpp>
+#include <ql/errors.hpp>
+#include <ql/settings.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace orea_benchmark {
+
+namespace {
+
+double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+string jsonString(const string& s) {
+    std::ostringstream o;
+    o << '"';
+    for (char c : s) {
+        switch (c) {
+        case '"':
+            o << "\\\"";
+            break;
+        case '\\':
+            o << "\\\\";
+            break;
+        case '\n':
+            o << "\\n";
+            break;
+        case '\r':
+            o << "\\r";
+            break;
+        case '\t':
+            o << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+                o << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+            else
+                o << c;
+        }
+    }
+    o << '"';
+    return o.str();
+}
+
+struct Statistics {
+    Statistics(const vector<double>& times) : min(0.0), median(0.0), mean(0.0), max(0.0) {
+        if (times.empty())
+            return;
+        vector<double> t(times);
+        std::sort(t.begin(), t.end());
+        min = t.front();
+        max = t.back();
+        median = t.size() % 2 == 1 ? t[t.size() / 2] : 0.5 * (t[t.size() / 2 - 1] + t[t.size() / 2]);
+        mean = std::accumulate(t.begin(), t.end(), 0.0) / t.size();
+    }
+    double min, median, mean, max;
+};
+
+} // namespace
+
+BenchmarkState::BenchmarkState(const map<string, Size>& overrides, Size repetitions, Size warmup,
+                               const string& inputPath, const string& workPath, BenchmarkResult& result)
+    : overrides_(overrides), repetitions_(repetitions), warmup_(warmup), inputPath_(inputPath),
+      workPath_(workPath), result_(result), start_(now()) {
+    QL_REQUIRE(repetitions_ > 0, "BenchmarkState: at least one repetition required");
+}
+
+Size BenchmarkState::parameter(const string& name, Size defaultValue) {
+    auto it = overrides_.find(name);
+    Size value = it == overrides_.end() ? defaultValue : it->second;
+    result_.parameters[name] = value;
+    return value;
+}
+
+void BenchmarkState::run(const string& unit, const std::function<Size()>& f, const std::function<void()>& setup) {
+    if (result_.times.empty())
+        result_.setupTime = now() - start_;
+    result_.unit = unit;
+    for (Size i = 0; i < warmup_ + repetitions_; ++i) {
+        if (setup)
+            setup();
+        double t = now();
+        Size items = f();
+        t = now() - t;
+        if (i >= warmup_) {
+            result_.items = items;
+            result_.times.push_back(t);
+        }
+    }
+}
+
+BenchmarkResult runBenchmark(const Benchmark& benchmark, const map<string, Size>& overrides, Size repetitions,
+                             Size warmup, const string& inputPath, const string& workPath) {
+    BenchmarkResult result;
+    result.name = benchmark.name;
+    result.description = benchmark.description;
+    // each benchmark starts from the same global state
+    QuantLib::SavedSettings backup;
+    try {
+        BenchmarkState state(overrides, repetitions, warmup, inputPath, workPath, result);
+        benchmark.function(state);
+        QL_REQUIRE(!result.times.empty(), "benchmark " << benchmark.name << " did not run anything");
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    result.peakMemory = ore::data::os::getPeakMemoryUsageBytes();
+    return result;
+}
+
+void writeJson(std::ostream& out, const map<string, string>& context, const vector<BenchmarkResult>& results) {
+    out << std::setprecision(9) << "{\n";
+    for (const auto& c : context)
+        out << "  " << jsonString(c.first) << ": " << jsonString(c.second) << ",\n";
+    out << "  \"benchmarks\": [";
+    for (Size i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        Statistics s(r.times);
+        out << (i == 0 ? "\n" : ",\n") << "    {\n";
+        out << "      \"name\": " << jsonString(r.name) << ",\n";
+        out << "      \"description\": " << jsonString(r.description) << ",\n";
+        out << "      \"status\": " << jsonString(r.error.empty() ? "ok" : "error") << ",\n";
+        if (!r.error.empty())
+            out << "      \"error\": " << jsonString(r.error) << ",\n";
+        out << "      \"parameters\": {";
+        Size k = 0;
+        for (const auto& p : r.parameters)
+            out << (k++ == 0 ? "" : ", ") << jsonString(p.first) << ": " << p.second;
+        out << "},\n";
+        out << "      \"unit\": " << jsonString(r.unit) << ",\n";
+        out << "      \"items\": " << r.items << ",\n";
+        out << "      \"repetitions\": " << r.times.size() << ",\n";
+        out << "      \"setupTime\": " << r.setupTime << ",\n";
+        out << "      \"times\": [";
+        for (Size j = 0; j < r.times.size(); ++j)
+            out << (j == 0 ? "" : ", ") << r.times[j];
+        out << "],\n";
+        out << "      \"minTime\": " << s.min << ",\n";
+        out << "      \"medianTime\": " << s.median << ",\n";
+        out << "      \"meanTime\": " << s.mean << ",\n";
+        out << "      \"maxTime\": " << s.max << ",\n";
+        out << "      \"throughput\": " << (s.median > 0.0 ? r.items / s.median : 0.0) << ",\n";
+        out << "      \"peakMemoryBytes\": " << r.peakMemory << "\n";
+        out << "    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+void writeSummary(std::ostream& out, const vector<BenchmarkResult>& results) {
+    out << std::left << std::setw(28) << "Benchmark" << std::right << std::setw(12) << "Setup [s]" << std::setw(12)
+        << "Median [s]" << std::setw(12) << "Min [s]" << std::setw(16) << "Throughput"
+        << "  Unit" << std::endl;
+    for (const auto& r : results) {
+        out << std::left << std::setw(28) << r.name << std::right;
+        if (!r.error.empty()) {
+            out << "  ERROR: " << r.error << std::endl;
+            continue;
+        }
+        Statistics s(r.times);
+        out << std::fixed << std::setprecision(4) << std::setw(12) << r.setupTime << std::setw(12) << s.median
+            << std::setw(12) << s.min << std::setprecision(1) << std::setw(16)
+            << (s.median > 0.0 ? r.items / s.median : 0.0) << "  " << r.unit << "/s" << std::endl;
+    }
+}
+
+} // namespace orea_benchmark
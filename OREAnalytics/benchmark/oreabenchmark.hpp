@@ -0,0 +1,107 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file benchmark/oreabenchmark.hpp
+    \brief Timing harness and JSON output of the benchmark suite
+*/
+
+#pragma once
+
+#include <ql/types.hpp>
+
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace orea_benchmark {
+
+using QuantLib::Size;
+
+//! Timings of one benchmark
+struct BenchmarkResult {
+    BenchmarkResult() : items(0), setupTime(0.0), peakMemory(0) {}
+    std::string name;
+    std::string description;
+    //! the parameters the benchmark used, including the defaults
+    std::map<std::string, Size> parameters;
+    //! unit of work, e.g. "npv" for a cube build
+    std::string unit;
+    //! units of work per repetition
+    Size items;
+    //! wall time of the untimed setup in seconds
+    double setupTime;
+    //! wall time of each repetition in seconds
+    std::vector<double> times;
+    //! peak memory usage of the process after the benchmark in bytes
+    unsigned long long peakMemory;
+    //! error message if the benchmark failed, empty otherwise
+    std::string error;
+};
+
+//! Passed to each benchmark, holds its parameters and times its repetitions
+class BenchmarkState {
+public:
+    BenchmarkState(const std::map<std::string, Size>& overrides, Size repetitions, Size warmup,
+                   const std::string& inputPath, const std::string& workPath, BenchmarkResult& result);
+
+    //! value of a parameter, the default value unless it was overridden on the command line
+    Size parameter(const std::string& name, Size defaultValue);
+    //! directory with the ORE example input files
+    const std::string& inputPath() const { return inputPath_; }
+    //! directory for temporary files
+    const std::string& workPath() const { return workPath_; }
+
+    /*! Times the repetitions of f, which returns the number of units of work it did. The setup, if given, is run
+        before each repetition and is not timed. The time since the construction of the state until the first call
+        of run() is reported as setup time. */
+    void run(const std::string& unit, const std::function<Size()>& f,
+             const std::function<void()>& setup = std::function<void()>());
+
+private:
+    std::map<std::string, Size> overrides_;
+    Size repetitions_, warmup_;
+    std::string inputPath_, workPath_;
+    BenchmarkResult& result_;
+    double start_;
+};
+
+//! A named benchmark
+struct Benchmark {
+    std::string name;
+    std::string description;
+    std::function<void(BenchmarkState&)> function;
+};
+
+//! All benchmarks of the suite, see benchmarks.cpp
+std::vector<Benchmark> benchmarks();
+
+//! Run a benchmark, errors are reported in the result rather than thrown
+BenchmarkResult runBenchmark(const Benchmark& benchmark, const std::map<std::string, Size>& overrides,
+                             Size repetitions, Size warmup, const std::string& inputPath,
+                             const std::string& workPath);
+
+//! Write the results as a JSON document, with the given context (e.g. version, system details) as header fields
+void writeJson(std::ostream& out, const std::map<std::string, std::string>& context,
+               const std::vector<BenchmarkResult>& results);
+
+//! Write a summary table of the results
+void writeSummary(std::ostream& out, const std::vector<BenchmarkResult>& results);
+
+} // namespace orea_benchmark
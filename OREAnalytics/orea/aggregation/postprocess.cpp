@@ -29,7 +29,7 @@
 #include <ql/methods/montecarlo/lsmbasissystem.hpp>
 #include <ql/time/daycounters/actualactual.hpp>
 
-#include <qle/math/nadarayawatson.hpp>
+#include <qle/math/fastnadarayawatson.hpp>
 #include <qle/math/stabilisedglls.hpp>
 
 #include <boost/accumulators/accumulators.hpp>
@@ -118,6 +118,15 @@ PostProcess::PostProcess(const boost::shared_ptr<Portfolio>& portfolio,
                                                                         << cube_->ids()[i]);
     }
 
+    // the scenario data rows are read as raw arrays of cube samples, so the dimensions have to match
+    QL_REQUIRE(scenarioData_, "PostProcess::PostProcess(): no scenario data given");
+    QL_REQUIRE(scenarioData_->dimSamples() == cube_->samples() && scenarioData_->dimDates() == cube_->numDates(),
+               "PostProcess::PostProcess(): scenario data dimensions (" << scenarioData_->dimDates() << " dates, "
+                                                                        << scenarioData_->dimSamples()
+                                                                        << " samples) do not match cube dimensions ("
+                                                                        << cube_->numDates() << " dates, "
+                                                                        << cube_->samples() << " samples)");
+
     Size trades = portfolio->size();
     Size dates = cube_->dates().size();
     Size samples = cube->samples();
@@ -372,12 +381,14 @@ PostProcess::PostProcess(const boost::shared_ptr<Portfolio>& portfolio,
         boost::shared_ptr<NettingSetDefinition> netting = nettingSetManager->get(nettingSetId);
         string csaIndexName;
         Handle<IborIndex> csaIndex;
+        Size csaIndexData = 0;
         if (netting->activeCsaFlag()) {
             csaIndexName = netting->index();
             if (csaIndexName != "") {
                 csaIndex = market->iborIndex(csaIndexName);
                 QL_REQUIRE(scenarioData->has(AggregationScenarioDataType::IndexFixing, csaIndexName),
                            "scenario data does not provide index values for " << csaIndexName);
+                csaIndexData = scenarioData->handle(AggregationScenarioDataType::IndexFixing, csaIndexName);
             }
         }
 
@@ -450,7 +461,7 @@ PostProcess::PostProcess(const boost::shared_ptr<Portfolio>& portfolio,
                     Real indexValue = 0.0;
                     DayCounter dc = ActualActual();
                     if (csaIndexName != "") {
-                        indexValue = scenarioData->get(j, k, AggregationScenarioDataType::IndexFixing, csaIndexName);
+                        indexValue = scenarioData->get(csaIndexData, j, k);
                         dc = csaIndex->dayCounter();
                     }
                     Real dcf = dc.yearFraction(prevDate, date);
@@ -848,16 +859,20 @@ PostProcess::collateralPaths(const string& nettingSetId, const boost::shared_ptr
         QL_REQUIRE(scenarioData_->has(AggregationScenarioDataType::IndexFixing, csaIndexName),
                    "scenario data does not provide index values for " << csaIndexName);
     }
+    Size fxData = Null<Size>(), rateData = Null<Size>();
+    if (netting->csaCurrency() != baseCurrency_)
+        fxData = scenarioData_->handle(AggregationScenarioDataType::FXSpot, netting->csaCurrency());
+    if (csaIndexName != "")
+        rateData = scenarioData_->handle(AggregationScenarioDataType::IndexFixing, csaIndexName);
     for (Size j = 0; j < dates; ++j) {
-        for (Size k = 0; k < samples; ++k) {
-            if (netting->csaCurrency() != baseCurrency_)
-                csaScenFxRates[j][k] =
-                    scenarioData_->get(j, k, AggregationScenarioDataType::FXSpot, netting->csaCurrency());
-            else
-                csaScenFxRates[j][k] = 1.0;
-            if (csaIndexName != "") {
-                csaScenRates[j][k] = scenarioData_->get(j, k, AggregationScenarioDataType::IndexFixing, csaIndexName);
-            }
+        if (fxData != Null<Size>()) {
+            const Real* fx = scenarioData_->samples(fxData, j);
+            csaScenFxRates[j].assign(fx, fx + samples);
+        } else
+            csaScenFxRates[j].assign(samples, 1.0);
+        if (rateData != Null<Size>()) {
+            const Real* rates = scenarioData_->samples(rateData, j);
+            csaScenRates[j].assign(rates, rates + samples);
         }
     }
 
@@ -1132,22 +1147,29 @@ void PostProcess::updateAllocatedXVA() {
     }
 }
 
-Disposable<Array> PostProcess::regressorArray(string nettingSet, Size dateIndex, Size sampleIndex) {
-    Array a(dimRegressors_.size());
-    for (Size i = 0; i < dimRegressors_.size(); ++i) {
-        string variable = dimRegressors_[i];
+vector<Size> PostProcess::regressorHandles() {
+    vector<Size> handles;
+    for (auto const& variable : dimRegressors_) {
         if (boost::to_upper_copy(variable) ==
             "NPV") // this allows possibility to include NPV as a regressor alongside more fundamental risk factors
-            a[i] = nettingSetNPV_[nettingSet][dateIndex][sampleIndex];
+            handles.push_back(Null<Size>());
         else if (scenarioData_->has(AggregationScenarioDataType::IndexFixing, variable))
-            a[i] = scenarioData_->get(dateIndex, sampleIndex, AggregationScenarioDataType::IndexFixing, variable);
+            handles.push_back(scenarioData_->handle(AggregationScenarioDataType::IndexFixing, variable));
         else if (scenarioData_->has(AggregationScenarioDataType::FXSpot, variable))
-            a[i] = scenarioData_->get(dateIndex, sampleIndex, AggregationScenarioDataType::FXSpot, variable);
+            handles.push_back(scenarioData_->handle(AggregationScenarioDataType::FXSpot, variable));
         else if (scenarioData_->has(AggregationScenarioDataType::Generic, variable))
-            a[i] = scenarioData_->get(dateIndex, sampleIndex, AggregationScenarioDataType::Generic, variable);
+            handles.push_back(scenarioData_->handle(AggregationScenarioDataType::Generic, variable));
         else
             QL_FAIL("scenario data does not provide data for " << variable);
     }
+    return handles;
+}
+
+Disposable<Array> PostProcess::regressorArray(const vector<Real>& npvs, const vector<Size>& handles, Size dateIndex,
+                                              Size sampleIndex) {
+    Array a(handles.size());
+    for (Size i = 0; i < handles.size(); ++i)
+        a[i] = handles[i] == Null<Size>() ? npvs[sampleIndex] : scenarioData_->get(handles[i], dateIndex, sampleIndex);
     return a;
 }
 
@@ -1220,6 +1242,10 @@ void PostProcess::dynamicInitialMargin() {
     Size simple_dim_index_h = Size(floor(dimQuantile_ * (samples - 1) + 0.5));
     Size simple_dim_index_p = Size(floor((1.0 - dimQuantile_) * (samples - 1) + 0.5));
 
+    // resolve the scenario data once, the numeraire and regressor values are read by date as rows over the samples
+    Size numeraireData = scenarioData_->handle(AggregationScenarioDataType::Numeraire);
+    vector<Size> regressors = regressorHandles();
+
     Size nettingSetCount = 0;
     for (auto n : nettingSets) {
         LOG("Process netting set " << n);
@@ -1230,11 +1256,13 @@ void PostProcess::dynamicInitialMargin() {
             nettingSetDeltaNPV_[n][dates - 1][k] = 0.0;
         }
         for (Size j = 0; j < dates - 1; ++j) {
+            const Real* numeraires1 = scenarioData_->samples(numeraireData, j);
+            const Real* numeraires2 = scenarioData_->samples(numeraireData, j + 1);
             accumulator_set<double, stats<tag::mean, tag::variance>> accDiff;
             accumulator_set<double, stats<tag::mean>> accOneOverNumeraire;
             for (Size k = 0; k < samples; ++k) {
-                Real num1 = scenarioData_->get(j, k, AggregationScenarioDataType::Numeraire);
-                Real num2 = scenarioData_->get(j + 1, k, AggregationScenarioDataType::Numeraire);
+                Real num1 = numeraires1[k];
+                Real num2 = numeraires2[k];
                 Real npv1 = nettingSetNPV_[n][j][k];
                 Real flow = nettingSetFLOW_[n][j][k];
                 Real npv2 = nettingSetNPV_[n][j + 1][k];
@@ -1257,13 +1285,14 @@ void PostProcess::dynamicInitialMargin() {
             vector<Real> ry1(samples, 0.0);
             vector<Real> ry2(samples, 0.0);
             for (Size k = 0; k < samples; ++k) {
-                Real num1 = scenarioData_->get(j, k, AggregationScenarioDataType::Numeraire);
-                Real num2 = scenarioData_->get(j + 1, k, AggregationScenarioDataType::Numeraire);
+                Real num1 = numeraires1[k];
+                Real num2 = numeraires2[k];
                 Real x = nettingSetNPV_[n][j][k] * num1;
                 Real f = nettingSetFLOW_[n][j][k] * num1;
                 Real y = nettingSetNPV_[n][j + 1][k] * num2;
                 Real z = (y + f - x);
-                rx[k] = dimRegressors_.empty() ? Array(1, nettingSetNPV_[n][j][k]) : regressorArray(n, j, k);
+                rx[k] = dimRegressors_.empty() ? Array(1, nettingSetNPV_[n][j][k])
+                                               : regressorArray(nettingSetNPV_[n][j], regressors, j, k);
                 rx0[k] = rx[k][0];
                 ry1[k] = z;     // for local regression
                 ry2[k] = z * z; // for least squares regression
@@ -1299,19 +1328,20 @@ void PostProcess::dynamicInitialMargin() {
                 // Local regression versus first regression variable (i.e. we do not perform a
                 // multidimensional local regression):
                 // We evaluate this at a limited number of samples only for validation purposes.
-                // Note that computational effort scales quadratically with number of samples.
+                // The gaussian kernel is truncated at 6 bandwidths, so that the effort of evaluating the
+                // local regression at all samples scales with samples x log(samples) rather than quadratically.
                 // NadarayaWatson needs a large number of samples for good results.
-                QuantExt::NadarayaWatson lr(rx0.begin(), rx0.end(), ry1.begin(),
-                                            GaussianKernel(0.0, dimLocalRegressionBandwidth_));
+                QuantExt::FastNadarayaWatson lr(rx0.begin(), rx0.end(), ry1.begin(),
+                                                GaussianKernel(0.0, dimLocalRegressionBandwidth_),
+                                                6.0 * dimLocalRegressionBandwidth_);
                 Size localRegressionSamples = samples;
                 if (dimLocalRegressionEvaluations_ > 0)
                     localRegressionSamples = Size(floor(1.0 * samples / dimLocalRegressionEvaluations_ + .5));
 
                 // Evaluate regression function to compute DIM for each scenario
                 for (Size k = 0; k < samples; ++k) {
-                    Real num1 = scenarioData_->get(j, k, AggregationScenarioDataType::Numeraire);
-                    Array regressor =
-                        dimRegressors_.empty() ? Array(1, nettingSetNPV_[n][j][k]) : regressorArray(n, j, k);
+                    Real num1 = numeraires1[k];
+                    const Array& regressor = rx[k];
                     Real e = ls.eval(regressor, v);
                     if (e < 0.0)
                         LOG("Negative variance regression for date " << j << ", sample " << k
@@ -1655,8 +1685,10 @@ void PostProcess::performT0DimCalc() {
         vector<Real> t0_delMtM_dist(dist_size, 0.0);
         accumulator_set<double, stats<tag::mean, tag::variance>> acc_delMtm;
         accumulator_set<double, stats<tag::mean>> acc_OneOverNum;
+        const Real* numeraires =
+            scenarioData_->samples(scenarioData_->handle(AggregationScenarioDataType::Numeraire), relevantDateIdx);
         for (Size i = 0; i < dist_size; ++i) {
-            Real numeraire = scenarioData_->get(relevantDateIdx, i, AggregationScenarioDataType::Numeraire);
+            Real numeraire = numeraires[i];
             Real deltaMtmFromMean = numeraire * (t0_dist[i] - mean_t0_dist) * sqrtTimeScaling;
             t0_delMtM_dist[i] = deltaMtmFromMean;
             acc_delMtm(deltaMtmFromMean);
@@ -1747,9 +1779,9 @@ void PostProcess::exportDimRegression(const std::string& nettingSet, const std::
         QL_REQUIRE(timeStep < dates - 1, "selected time step " << timeStep << " out of range [0, " << dates - 1 << "]");
 
         Size samples = cube_->samples();
-        vector<Real> numeraires(samples, 0.0);
-        for (Size k = 0; k < samples; ++k)
-            numeraires[k] = scenarioData_->get(timeStep, k, AggregationScenarioDataType::Numeraire);
+        const Real* numeraireRow =
+            scenarioData_->samples(scenarioData_->handle(AggregationScenarioDataType::Numeraire), timeStep);
+        vector<Real> numeraires(numeraireRow, numeraireRow + samples);
 
         auto p = sort_permutation(regressorArray_[nettingSet][timeStep], lessThan);
         vector<Array> reg = apply_permutation(regressorArray_[nettingSet][timeStep], p);
@@ -295,8 +295,11 @@ private:
 
     //! Fill dynamic initial margin cube (per netting set, date and sample)
     void dynamicInitialMargin();
-    //! Compile the array of DIM regressors for the specified netting set, date and sample index
-    Disposable<Array> regressorArray(string nettingSet, Size dateIndex, Size sampleIndex);
+    //! Scenario data handles of the DIM regressors, Null<Size>() for the netting set NPV
+    vector<Size> regressorHandles();
+    //! Compile the array of DIM regressors for the given netting set NPVs by sample, date and sample index
+    Disposable<Array> regressorArray(const vector<Real>& npvs, const vector<Size>& handles, Size dateIndex,
+                                     Size sampleIndex);
     //! Perform the calculation of IM as of t=t0
     void performT0DimCalc();
 
@@ -38,6 +38,8 @@
 
 #include <orea/app/oreapp.hpp>
 
+#include <fstream>
+
 using namespace std;
 using namespace ore::data;
 using namespace ore::analytics;
@@ -56,6 +58,20 @@ vector<string> getFilenames(const string& fileString, const string& path) {
     return fileNames;
 }
 
+// the simulation configuration of a cube file is kept in a separate file next to it
+string cubeConfigurationFile(const string& cubeFile) { return cubeFile + ".config"; }
+
+void writeCubeConfiguration(const string& cubeFile, std::uint64_t hash, Size firstSample) {
+    ofstream out(cubeConfigurationFile(cubeFile).c_str());
+    out << hash << " " << firstSample << endl;
+    QL_REQUIRE(out.good(), "error writing " << cubeConfigurationFile(cubeFile));
+}
+
+bool readCubeConfiguration(const string& cubeFile, std::uint64_t& hash, Size& firstSample) {
+    ifstream in(cubeConfigurationFile(cubeFile).c_str());
+    return static_cast<bool>(in >> hash >> firstSample);
+}
+
 } // anonymous namespace
 
 namespace ore {
@@ -63,7 +79,8 @@ namespace analytics {
 
 OREApp::OREApp(boost::shared_ptr<Parameters> params, ostream& out)
     : tab_(40), progressBarWidth_(72 - std::min<Size>(tab_, 67)), params_(params),
-      asof_(parseDate(params_->get("setup", "asofDate"))), out_(out), cubeDepth_(0) {
+      asof_(parseDate(params_->get("setup", "asofDate"))), out_(out), cubeDepth_(0), cubeConfigurationHash_(0),
+      cubeFirstSample_(0) {
 
     // Set global evaluation date
     Settings::instance().evaluationDate() = asof_;
@@ -218,6 +235,12 @@ int OREApp::run() {
             if (writeDIMReport_)
                 writeDIMReport();
             out_ << "OK" << endl;
+
+            if (params_->has("xva", "whatIfPortfolioFile") && params_->get("xva", "whatIfPortfolioFile") != "") {
+                out_ << setw(tab_) << left << "What-if XVA... " << flush;
+                runWhatIfXVA();
+                out_ << "OK" << endl;
+            }
         } else {
             LOG("skip XVA reports");
             out_ << "SKIP" << endl;
@@ -229,6 +252,11 @@ int OREApp::run() {
         return 1;
     }
 
+    if (profile_) {
+        Profiler::instance().switchOff();
+        writeProfile();
+    }
+
     timer.stop();
     out_ << "run time: " << setprecision(2) << timer.format(default_places, "%w") << " sec" << endl;
     out_ << "ORE done." << endl;
@@ -274,6 +302,13 @@ void OREApp::readSetup() {
     continueOnError_ = false;
     if (params_->has("setup", "continueOnError"))
         continueOnError_ = parseBool(params_->get("setup", "continueOnError"));
+
+    profile_ = params_->has("setup", "profile") && parseBool(params_->get("setup", "profile"));
+    if (profile_) {
+        Profiler::instance().clear();
+        Profiler::instance().switchOn();
+        LOG("Profiling is on");
+    }
 }
 
 void OREApp::setupLog() {
@@ -295,11 +330,19 @@ void OREApp::setupLog() {
     Log::instance().registerLogger(boost::make_shared<FileLogger>(logFile));
     Log::instance().setMask(logMask);
     Log::instance().switchOn();
+
+    // Write the log file from a background thread if requested
+    if (params_->has("setup", "logAsync") && parseBool(params_->get("setup", "logAsync")))
+        Log::instance().startAsyncLogging();
 }
 
-void OREApp::closeLog() { Log::instance().removeAllLoggers(); }
+void OREApp::closeLog() {
+    Log::instance().stopAsyncLogging();
+    Log::instance().removeAllLoggers();
+}
 
 void OREApp::getReferenceData() {
+    ORE_PROFILE_SCOPE("OREApp", "ReferenceData");
     if (params_->has("setup", "referenceDataFile") && params_->get("setup", "referenceDataFile") != "") {
         string referenceDataFile = inputPath_ + "/" + params_->get("setup", "referenceDataFile");
         referenceData_ = boost::make_shared<BasicReferenceDataManager>(referenceDataFile);
@@ -328,6 +371,7 @@ void OREApp::getMarketParameters() {
 
 boost::shared_ptr<EngineFactory> OREApp::buildEngineFactory(const boost::shared_ptr<Market>& market,
                                                             const string& groupName) const {
+    ORE_PROFILE_SCOPE("OREApp", "EngineFactory");
     MEM_LOG;
     LOG("Building an engine factory")
 
@@ -355,6 +399,7 @@ boost::shared_ptr<TradeFactory> OREApp::buildTradeFactory() const {
 }
 
 boost::shared_ptr<Portfolio> OREApp::buildPortfolio(const boost::shared_ptr<EngineFactory>& factory) {
+    ORE_PROFILE_SCOPE("OREApp", "Portfolio");
     MEM_LOG;
     LOG("Building portfolio");
     boost::shared_ptr<Portfolio> portfolio = loadPortfolio();
@@ -390,6 +435,14 @@ boost::shared_ptr<ScenarioGeneratorData> OREApp::getScenarioGeneratorData() {
     return sgd;
 }
 
+std::uint64_t
+OREApp::simulationConfigurationHash(const boost::shared_ptr<ScenarioSimMarketParameters>& simMarketData,
+                                    const boost::shared_ptr<ScenarioGeneratorData>& sgd) {
+    CrossAssetModelData modelData;
+    modelData.fromFile(inputPath_ + "/" + params_->get("simulation", "simulationConfigFile"));
+    return scenarioStoreHash(modelData.toXMLString() + sgd->toXMLString() + simMarketData->toXMLString());
+}
+
 boost::shared_ptr<QuantExt::CrossAssetModel> OREApp::buildCam(boost::shared_ptr<Market> market,
                                                               const bool continueOnCalibrationError) {
     LOG("Build Simulation Model (continueOnCalibrationError = " << std::boolalpha << continueOnCalibrationError << ")");
@@ -424,12 +477,62 @@ boost::shared_ptr<ScenarioGenerator>
 OREApp::buildScenarioGenerator(boost::shared_ptr<Market> market,
                                boost::shared_ptr<ScenarioSimMarketParameters> simMarketData,
                                boost::shared_ptr<ScenarioGeneratorData> sgd, const bool continueOnCalibrationError) {
+    boost::shared_ptr<ScenarioFactory> sf = boost::make_shared<SimpleScenarioFactory>();
+
+    // Optionally replay the paths of a scenario store, the model is then neither calibrated nor simulated
+    string storeFile;
+    std::uint64_t storeHash = 0;
+    if (params_->has("simulation", "scenarioStoreFile")) {
+        storeFile = outputPath_ + "/" + params_->get("simulation", "scenarioStoreFile");
+        // the store is identified by the model, scenario generator and simulation market configuration
+        storeHash = simulationConfigurationHash(simMarketData, sgd);
+        if (boost::filesystem::exists(storeFile)) {
+            Size start = 0, end = sgd->samples();
+            if (params_->has("simulation", "sampleRangeStart"))
+                start = parseInteger(params_->get("simulation", "sampleRangeStart"));
+            if (params_->has("simulation", "sampleRangeEnd"))
+                end = parseInteger(params_->get("simulation", "sampleRangeEnd"));
+            boost::shared_ptr<ScenarioStoreGenerator> store =
+                boost::make_shared<ScenarioStoreGenerator>(storeFile, sf);
+            // the stored keys must be the keys of the simulation market, in any order
+            bool keysMatch = false;
+            if (simMarket_) {
+                set<RiskFactorKey> storeKeys(store->keys().begin(), store->keys().end());
+                const vector<RiskFactorKey>& simKeys = simMarket_->baseScenario()->keys();
+                keysMatch = storeKeys == set<RiskFactorKey>(simKeys.begin(), simKeys.end());
+            }
+            if (store->configurationHash() == storeHash && keysMatch && store->asof() == asof_ &&
+                store->dates() == sgd->grid()->dates() && store->firstSample() <= start &&
+                store->firstSample() + store->samples() >= end) {
+                LOG("Replay the scenarios of the store " << storeFile);
+                return store;
+            }
+            WLOG("Scenario store " << storeFile << " does not match the simulation (asof " << store->asof() << ", "
+                                   << store->dates().size() << " dates, samples " << store->firstSample() << " to "
+                                   << store->firstSample() + store->samples() << ", "
+                                   << (store->configurationHash() == storeHash ? "same" : "different")
+                                   << " configuration, " << (keysMatch ? "same" : "different")
+                                   << " keys), regenerate the scenarios");
+        }
+    }
+
     boost::shared_ptr<QuantExt::CrossAssetModel> model = buildCam(market, continueOnCalibrationError);
     LOG("Load Simulation Parameters");
-    ScenarioGeneratorBuilder sgb(sgd);
-    boost::shared_ptr<ScenarioFactory> sf = boost::make_shared<SimpleScenarioFactory>();
+    // Optionally draw the random variates of the paths in a background thread while the current path is priced
+    bool pipelinePaths =
+        params_->has("simulation", "pipelineScenarios") && parseBool(params_->get("simulation", "pipelineScenarios"));
+    if (pipelinePaths)
+        LOG("Draw the random variates of the paths in a background thread");
+    ScenarioGeneratorBuilder sgb(sgd, pipelinePaths);
     boost::shared_ptr<ScenarioGenerator> sg = sgb.build(
         model, sf, simMarketData, asof_, market, params_->get("markets", "simulation")); // pricing or simulation?
+    // Optionally store the scenarios for later runs
+    if (!storeFile.empty()) {
+        bool singlePrecision = params_->has("simulation", "scenarioStoreSinglePrecision") &&
+                               parseBool(params_->get("simulation", "scenarioStoreSinglePrecision"));
+        sg = boost::make_shared<ScenarioStoreWriter>(sg, storeFile, asof_, sgd->grid()->dates(), singlePrecision,
+                                                     storeHash);
+    }
     // Optionally write out scenarios
     if (params_->has("simulation", "scenariodump")) {
         string filename = outputPath_ + "/" + params_->get("simulation", "scenariodump");
@@ -440,6 +543,7 @@ OREApp::buildScenarioGenerator(boost::shared_ptr<Market> market,
 
 void OREApp::writeInitialReports() {
 
+    ORE_PROFILE_SCOPE("OREApp", "InitialReports");
     MEM_LOG;
     LOG("Writing initial reports");
 
@@ -503,6 +607,7 @@ boost::shared_ptr<SensitivityRunner> OREApp::getSensitivityRunner() {
 
 void OREApp::runStressTest() {
 
+    ORE_PROFILE_SCOPE("OREApp", "StressTest");
     MEM_LOG;
     LOG("Running stress test");
 
@@ -550,6 +655,7 @@ void OREApp::runStressTest() {
 
 void OREApp::runParametricVar() {
 
+    ORE_PROFILE_SCOPE("OREApp", "ParametricVar");
     MEM_LOG;
     LOG("Running parametric VaR");
 
@@ -557,7 +663,11 @@ void OREApp::runParametricVar() {
 
     LOG("Get sensitivity data");
     string sensiFile = inputPath_ + "/" + params_->get("parametricVar", "sensitivityInputFile");
-    auto ss = boost::make_shared<SensitivityFileStream>(sensiFile);
+    boost::shared_ptr<SensitivityStream> ss;
+    if (isSensitivityBinaryFile(sensiFile))
+        ss = boost::make_shared<SensitivityBinaryFileStream>(sensiFile);
+    else
+        ss = boost::make_shared<SensitivityFileStream>(sensiFile);
 
     LOG("Build trade to portfolio id mapping");
     map<string, set<string>> tradePortfolio;
@@ -607,6 +717,7 @@ OREApp::buildParametricVarCalculator(const std::map<std::string, std::set<std::s
 
 void OREApp::writeBaseScenario() {
 
+    ORE_PROFILE_SCOPE("OREApp", "BaseScenario");
     MEM_LOG;
     LOG("Writing base scenario");
 
@@ -667,19 +778,141 @@ void OREApp::buildNPVCube() {
     if (cubeDepth_ > 1)
         calculators.push_back(boost::make_shared<CashflowCalculator>(baseCurrency, asof_, grid_, 1));
     LOG("Build cube");
-    ValuationEngine engine(asof_, grid_, simMarket_);
     ostringstream o;
     o.str("");
     o << "Build Cube " << simPortfolio_->size() << " x " << grid_->size() << " x " << samples_ << "... ";
 
     auto progressBar = boost::make_shared<SimpleProgressBar>(o.str(), tab_, progressBarWidth_);
     auto progressLog = boost::make_shared<ProgressLog>("Building cube...");
+    boost::shared_ptr<ConvergenceMonitor> convergenceMonitor = buildConvergenceMonitor();
+    if (params_->has("simulation", "sampleRangeStart")) {
+        QL_REQUIRE(!convergenceMonitor, "convergence based early stopping is not supported for a sample range");
+        // the paths before the range are skipped in the scenario generator, the cube and scenario data start at 0
+        Size start = parseInteger(params_->get("simulation", "sampleRangeStart"));
+        if (start > 0)
+            simMarket_->scenarioGenerator()->skip(start);
+    }
+    if (params_->has("simulation", "proxy") && parseBool(params_->get("simulation", "proxy"))) {
+        QL_REQUIRE(!convergenceMonitor, "convergence based early stopping is not supported for proxy pricing");
+        QL_REQUIRE(!params_->has("simulation", "checkpointFile"), "checkpoints are not supported for proxy pricing");
+        boost::shared_ptr<ProxyValuationEngine> engine = buildProxyValuationEngine();
+        engine->registerProgressIndicator(progressBar);
+        engine->registerProgressIndicator(progressLog);
+        engine->buildCube(simPortfolio_, cube_, calculators);
+        out_ << "OK" << endl;
+        return;
+    }
+    ValuationEngine engine(asof_, grid_, simMarket_);
     engine.registerProgressIndicator(progressBar);
     engine.registerProgressIndicator(progressLog);
-    engine.buildCube(simPortfolio_, cube_, calculators);
+    if (params_->has("simulation", "checkpointFile")) {
+        string checkpointFile = outputPath_ + "/" + params_->get("simulation", "checkpointFile");
+        Size checkpointFrequency = 100;
+        if (params_->has("simulation", "checkpointFrequency"))
+            checkpointFrequency = parseInteger(params_->get("simulation", "checkpointFrequency"));
+        // the checkpoint is tied to the simulation configuration and to the first sample of the cube
+        string configuration = to_string(simulationConfigurationHash(getSimMarketData(), getScenarioGeneratorData()));
+        if (params_->has("simulation", "sampleRangeStart"))
+            configuration += "/" + params_->get("simulation", "sampleRangeStart");
+        cubeCheckpoint_ = boost::make_shared<CubeCheckpoint>(checkpointFile, checkpointFrequency, scenarioData_,
+                                                             scenarioStoreHash(configuration));
+    }
+    engine.buildCube(simPortfolio_, cube_, calculators, convergenceMonitor, cubeCheckpoint_);
+    if (cube_->samples() < samples_) {
+        // release the unused scenario data samples as well, the post processor expects matching sample sizes
+        scenarioData_->truncateSamples(cube_->samples());
+        samples_ = cube_->samples();
+    }
+    if (convergenceMonitor) {
+        for (auto const& e : convergenceMonitor->estimates())
+            LOG("Netting set " << e.first.first << " " << e.first.second << " " << e.second.value << " +- "
+                               << e.second.standardError);
+    }
     out_ << "OK" << endl;
 }
 
+boost::shared_ptr<ProxyValuationEngine> OREApp::buildProxyValuationEngine() {
+    vector<Date> sensitivityDates;
+    if (params_->has("simulation", "proxySensitivityDates")) {
+        for (auto const& p : parseListOfValues(params_->get("simulation", "proxySensitivityDates")))
+            sensitivityDates.push_back(asof_ + parsePeriod(p));
+    }
+    set<RiskFactorKey::KeyType> riskFactorTypes = ProxyValuationEngine::defaultRiskFactorTypes();
+    if (params_->has("simulation", "proxyRiskFactorTypes")) {
+        riskFactorTypes.clear();
+        for (auto const& t : parseListOfValues(params_->get("simulation", "proxyRiskFactorTypes")))
+            riskFactorTypes.insert(parseRiskFactorKeyType(t));
+    }
+    // trades to be fully revalued, by id or by trade type
+    set<string> fullRevaluationTrades;
+    if (params_->has("simulation", "proxyFullRevaluationTrades")) {
+        for (auto const& id : parseListOfValues(params_->get("simulation", "proxyFullRevaluationTrades")))
+            fullRevaluationTrades.insert(id);
+    }
+    if (params_->has("simulation", "proxyFullRevaluationTradeTypes")) {
+        vector<string> types = parseListOfValues(params_->get("simulation", "proxyFullRevaluationTradeTypes"));
+        for (auto const& trade : simPortfolio_->trades()) {
+            if (std::find(types.begin(), types.end(), trade->tradeType()) != types.end())
+                fullRevaluationTrades.insert(trade->id());
+        }
+    }
+    LOG("Proxy pricing with " << sensitivityDates.size() << " sensitivity dates and " << fullRevaluationTrades.size()
+                              << " fully revalued trades");
+    return boost::make_shared<ProxyValuationEngine>(asof_, grid_, simMarket_, sensitivityDates, riskFactorTypes,
+                                                    fullRevaluationTrades);
+}
+
+boost::shared_ptr<ConvergenceMonitor> OREApp::buildConvergenceMonitor() {
+    if (!params_->has("simulation", "convergenceRelativeTolerance") &&
+        !params_->has("simulation", "convergenceAbsoluteTolerance"))
+        return boost::shared_ptr<ConvergenceMonitor>();
+
+    Real relativeTolerance = 0.0, absoluteTolerance = 0.0;
+    Size minSamples = 1000, checkFrequency = 100;
+    if (params_->has("simulation", "convergenceRelativeTolerance"))
+        relativeTolerance = parseReal(params_->get("simulation", "convergenceRelativeTolerance"));
+    if (params_->has("simulation", "convergenceAbsoluteTolerance"))
+        absoluteTolerance = parseReal(params_->get("simulation", "convergenceAbsoluteTolerance"));
+    if (params_->has("simulation", "convergenceMinSamples"))
+        minSamples = parseInteger(params_->get("simulation", "convergenceMinSamples"));
+    if (params_->has("simulation", "convergenceCheckFrequency"))
+        checkFrequency = parseInteger(params_->get("simulation", "convergenceCheckFrequency"));
+
+    // CVA weights (1 - R) * (S(t_{j-1}) - S(t_j)) from the counterparty default curves of today's market
+    string configuration = params_->get("markets", "simulation");
+    map<string, vector<Real>> cvaWeights;
+    for (auto const& trade : simPortfolio_->trades()) {
+        const string& nettingSetId = trade->envelope().nettingSetId();
+        const string& counterparty = trade->envelope().counterparty();
+        if (cvaWeights.find(nettingSetId) != cvaWeights.end())
+            continue;
+        vector<Real> weights;
+        try {
+            Handle<DefaultProbabilityTermStructure> dts = market_->defaultCurve(counterparty, configuration);
+            Real lgd = 1.0 - market_->recoveryRate(counterparty, configuration)->value();
+            Real previous = 1.0;
+            for (auto const& d : grid_->dates()) {
+                Real survival = dts->survivalProbability(d);
+                weights.push_back(lgd * (previous - survival));
+                previous = survival;
+            }
+        } catch (const std::exception& e) {
+            WLOG("No CVA convergence monitoring for netting set " << nettingSetId << ": " << e.what());
+            weights.clear();
+        }
+        cvaWeights[nettingSetId] = weights;
+    }
+    for (auto it = cvaWeights.begin(); it != cvaWeights.end();) {
+        if (it->second.empty())
+            it = cvaWeights.erase(it);
+        else
+            ++it;
+    }
+
+    return boost::make_shared<ConvergenceMonitor>(simPortfolio_, asof_, grid_->dates(), relativeTolerance,
+                                                  absoluteTolerance, minSamples, checkFrequency, cvaWeights);
+}
+
 void OREApp::initialiseNPVCubeGeneration(boost::shared_ptr<Portfolio> portfolio) {
     out_ << setw(tab_) << left << "Simulation Setup... ";
     LOG("Load Simulation Market Parameters");
@@ -687,22 +920,25 @@ void OREApp::initialiseNPVCubeGeneration(boost::shared_ptr<Portfolio> portfolio)
     boost::shared_ptr<ScenarioGeneratorData> sgd = getScenarioGeneratorData();
     grid_ = sgd->grid();
     samples_ = sgd->samples();
+    cubeConfigurationHash_ = simulationConfigurationHash(simMarketData, sgd);
+    cubeFirstSample_ = 0;
+
+    // optionally generate the cube for the sample range [start, end) only, the shards are merged in the xva analytic
+    if (params_->has("simulation", "sampleRangeStart") || params_->has("simulation", "sampleRangeEnd")) {
+        Size start = 0, end = samples_;
+        if (params_->has("simulation", "sampleRangeStart"))
+            start = parseInteger(params_->get("simulation", "sampleRangeStart"));
+        if (params_->has("simulation", "sampleRangeEnd"))
+            end = parseInteger(params_->get("simulation", "sampleRangeEnd"));
+        QL_REQUIRE(start < end && end <= samples_, "sample range [" << start << ", " << end << ") must be a non-empty "
+                                                                    << "subrange of [0, " << samples_ << ")");
+        LOG("Generate the cube for the sample range [" << start << ", " << end << ")");
+        samples_ = end - start;
+        cubeFirstSample_ = start;
+    }
 
     if (buildSimMarket_) {
-        LOG("Build Simulation Market");
-
-        simMarket_ = boost::make_shared<ScenarioSimMarket>(market_, simMarketData, conventions_, getFixingManager(),
-                                                           params_->get("markets", "simulation"), curveConfigs_,
-                                                           marketParameters_, continueOnError_);
-        string groupName = "simulation";
-        boost::shared_ptr<EngineFactory> simFactory = buildEngineFactory(simMarket_, groupName);
-
-        auto continueOnCalErr = simFactory->engineData()->globalParameters().find("ContinueOnCalibrationError");
-        boost::shared_ptr<ScenarioGenerator> sg =
-            buildScenarioGenerator(market_, simMarketData, sgd,
-                                   continueOnCalErr != simFactory->engineData()->globalParameters().end() &&
-                                       parseBool(continueOnCalErr->second));
-        simMarket_->scenarioGenerator() = sg;
+        boost::shared_ptr<EngineFactory> simFactory = initSimMarket(simMarketData, sgd);
 
         LOG("Build portfolio linked to sim market");
         Size n = portfolio->size();
@@ -732,15 +968,123 @@ void OREApp::initialiseNPVCubeGeneration(boost::shared_ptr<Portfolio> portfolio)
     initCube(cube_, simPortfolio_->ids());
 }
 
+boost::shared_ptr<EngineFactory>
+OREApp::initSimMarket(const boost::shared_ptr<ScenarioSimMarketParameters>& simMarketData,
+                      const boost::shared_ptr<ScenarioGeneratorData>& sgd) {
+    LOG("Build Simulation Market");
+
+    simMarket_ = boost::make_shared<ScenarioSimMarket>(market_, simMarketData, conventions_, getFixingManager(),
+                                                       params_->get("markets", "simulation"), curveConfigs_,
+                                                       marketParameters_, continueOnError_);
+    string groupName = "simulation";
+    boost::shared_ptr<EngineFactory> simFactory = buildEngineFactory(simMarket_, groupName);
+
+    auto continueOnCalErr = simFactory->engineData()->globalParameters().find("ContinueOnCalibrationError");
+    boost::shared_ptr<ScenarioGenerator> sg =
+        buildScenarioGenerator(market_, simMarketData, sgd,
+                               continueOnCalErr != simFactory->engineData()->globalParameters().end() &&
+                                   parseBool(continueOnCalErr->second));
+    simMarket_->scenarioGenerator() = sg;
+    return simFactory;
+}
+
+void OREApp::buildAMCNPVCube() {
+    LOG("Build American Monte Carlo valuation engine");
+    string baseCurrency = params_->get("simulation", "baseCurrency");
+    auto continueOnCalErr = engineFactory_->engineData()->globalParameters().find("ContinueOnCalibrationError");
+    boost::shared_ptr<QuantExt::CrossAssetModel> model =
+        buildCam(market_, continueOnCalErr != engineFactory_->engineData()->globalParameters().end() &&
+                              parseBool(continueOnCalErr->second));
+    QL_REQUIRE(model->irlgm1f(0)->currency().code() == baseCurrency,
+               "American Monte Carlo requires the simulation base currency ("
+                   << baseCurrency << ") to be the domestic currency of the model ("
+                   << model->irlgm1f(0)->currency().code() << ")");
+    Size polynomOrder = 2;
+    if (params_->has("simulation", "amcRegressionOrder"))
+        polynomOrder = parseInteger(params_->get("simulation", "amcRegressionOrder"));
+    boost::shared_ptr<ScenarioSimMarketParameters> simMarketData = getSimMarketData();
+    string configuration = params_->get("markets", "simulation");
+    map<string, boost::shared_ptr<InterestRateIndex>> scenarioDataIndices;
+    for (auto const& i : simMarketData->additionalScenarioDataIndices()) {
+        boost::shared_ptr<InterestRateIndex> index;
+        try {
+            index = *market_->iborIndex(i, configuration);
+        } catch (...) {
+        }
+        try {
+            index = *market_->swapIndex(i, configuration);
+        } catch (...) {
+        }
+        QL_REQUIRE(index, "American Monte Carlo: additional scenario data index " << i << " not found in market");
+        scenarioDataIndices[i] = index;
+    }
+    LOG("Build cube");
+    AMCValuationEngine engine(model, getScenarioGeneratorData(), polynomOrder,
+                              simMarketData->additionalScenarioDataCcys(), scenarioDataIndices);
+    ostringstream o;
+    o.str("");
+    o << "Build AMC Cube " << simPortfolio_->size() << " x " << grid_->size() << " x " << samples_ << "... ";
+
+    auto progressBar = boost::make_shared<SimpleProgressBar>(o.str(), tab_, progressBarWidth_);
+    auto progressLog = boost::make_shared<ProgressLog>("Building cube...");
+    engine.registerProgressIndicator(progressBar);
+    engine.registerProgressIndicator(progressLog);
+    engine.buildCube(simPortfolio_, cube_, scenarioData_);
+    out_ << "OK" << endl;
+}
+
+void OREApp::initialiseAMCNPVCubeGeneration(boost::shared_ptr<Portfolio> portfolio) {
+    out_ << setw(tab_) << left << "Simulation Setup... ";
+    LOG("Load Scenario Generator Data");
+    boost::shared_ptr<ScenarioGeneratorData> sgd = getScenarioGeneratorData();
+    grid_ = sgd->grid();
+    samples_ = sgd->samples();
+
+    // the AMC engine projects the trade flows with the model, the trades are linked to today's market
+    LOG("Build portfolio linked to today's market");
+    Size n = portfolio->size();
+    portfolio->build(engineFactory_);
+    simPortfolio_ = portfolio;
+    if (simPortfolio_->size() != n) {
+        ALOG("There were errors during the portfolio building - could build " << simPortfolio_->size()
+                                                                              << " trades out of " << n);
+    }
+    out_ << "OK" << endl;
+
+    if (params_->has("simulation", "storeFlows") && params_->get("simulation", "storeFlows") == "Y")
+        cubeDepth_ = 2; // NPV and FLOW
+    else
+        cubeDepth_ = 1; // NPV only
+
+    ostringstream o;
+    o << "Aggregation Scenario Data " << grid_->size() << " x " << samples_ << "... ";
+    out_ << setw(tab_) << o.str() << flush;
+    initAggregationScenarioData();
+    out_ << "OK" << endl;
+
+    initCube(cube_, simPortfolio_->ids());
+}
+
 void OREApp::generateNPVCube() {
+    ORE_PROFILE_SCOPE("OREApp", "NPVCube");
     MEM_LOG;
     LOG("Running NPV cube generation");
 
     boost::shared_ptr<Portfolio> portfolio = loadPortfolio();
-    initialiseNPVCubeGeneration(portfolio);
-    buildNPVCube();
+    if (params_->has("simulation", "amc") && parseBool(params_->get("simulation", "amc"))) {
+        initialiseAMCNPVCubeGeneration(portfolio);
+        buildAMCNPVCube();
+    } else {
+        initialiseNPVCubeGeneration(portfolio);
+        buildNPVCube();
+    }
     writeCube(cube_);
     writeScenarioData();
+    // the results are persisted, a later run starts afresh
+    if (cubeCheckpoint_) {
+        cubeCheckpoint_->remove();
+        cubeCheckpoint_.reset();
+    }
 
     LOG("NPV cube generation completed");
     MEM_LOG;
@@ -752,6 +1096,9 @@ void OREApp::writeCube(boost::shared_ptr<NPVCube> cube) {
     if (params_->has("simulation", "cubeFile")) {
         string cubeFileName = outputPath_ + "/" + params_->get("simulation", "cubeFile");
         cube->save(cubeFileName);
+        // a later what-if run checks that it reproduces the paths of the cube
+        if (cubeConfigurationHash_ != 0)
+            writeCubeConfiguration(cubeFileName, cubeConfigurationHash_, cubeFirstSample_);
         out_ << "OK" << endl;
     } else
         out_ << "SKIP" << endl;
@@ -782,23 +1129,75 @@ void OREApp::writeScenarioData() {
 }
 
 void OREApp::loadScenarioData() {
-    string scenarioFile = outputPath_ + "/" + params_->get("xva", "scenarioFile");
-    scenarioData_ = boost::make_shared<InMemoryAggregationScenarioData>();
-    scenarioData_->load(scenarioFile);
+    ORE_PROFILE_SCOPE("OREApp", "LoadScenarioData");
+    vector<string> scenarioFiles;
+    boost::split(scenarioFiles, params_->get("xva", "scenarioFile"), boost::is_any_of(","));
+    vector<boost::shared_ptr<AggregationScenarioData>> shards;
+    Size samples = 0;
+    for (auto const& f : scenarioFiles) {
+        string scenarioFile = outputPath_ + "/" + boost::trim_copy(f);
+        shards.push_back(boost::make_shared<InMemoryAggregationScenarioData>());
+        LOG("Load scenario data from file " << scenarioFile);
+        shards.back()->load(scenarioFile);
+        samples += shards.back()->dimSamples();
+    }
+    if (shards.size() == 1) {
+        scenarioData_ = shards.front();
+    } else {
+        // scenario data generated for consecutive sample ranges
+        scenarioData_ = boost::make_shared<InMemoryAggregationScenarioData>(shards.front()->dimDates(), samples);
+        mergeAggregationScenarioData(shards, scenarioData_);
+    }
 }
 
 void OREApp::loadCube() {
-    string cubeFile = outputPath_ + "/" + params_->get("xva", "cubeFile");
+    ORE_PROFILE_SCOPE("OREApp", "LoadCube");
+    vector<string> cubeFiles;
+    boost::split(cubeFiles, params_->get("xva", "cubeFile"), boost::is_any_of(","));
     cubeDepth_ = 1;
     if (params_->has("xva", "hyperCube"))
         cubeDepth_ = parseBool(params_->get("xva", "hyperCube")) ? 2 : 1;
 
-    if (cubeDepth_ > 1)
-        cube_ = boost::make_shared<SinglePrecisionInMemoryCubeN>();
-    else
-        cube_ = boost::make_shared<SinglePrecisionInMemoryCube>();
-    LOG("Load cube from file " << cubeFile);
-    cube_->load(cubeFile);
+    vector<boost::shared_ptr<NPVCube>> shards;
+    Size samples = 0;
+    cubeConfigurationHash_ = 0;
+    cubeFirstSample_ = 0;
+    bool configurationKnown = true;
+    for (auto const& f : cubeFiles) {
+        string cubeFile = outputPath_ + "/" + boost::trim_copy(f);
+        // the shards must come from the same simulation, the merged cube starts at the first sample of the first one
+        std::uint64_t hash;
+        Size firstSample;
+        if (configurationKnown && readCubeConfiguration(cubeFile, hash, firstSample) &&
+            (shards.empty() || hash == cubeConfigurationHash_)) {
+            if (shards.empty()) {
+                cubeConfigurationHash_ = hash;
+                cubeFirstSample_ = firstSample;
+            }
+        } else {
+            configurationKnown = false;
+            cubeConfigurationHash_ = 0;
+        }
+        if (cubeDepth_ > 1)
+            shards.push_back(boost::make_shared<SinglePrecisionInMemoryCubeN>());
+        else
+            shards.push_back(boost::make_shared<SinglePrecisionInMemoryCube>());
+        LOG("Load cube from file " << cubeFile);
+        shards.back()->load(cubeFile);
+        samples += shards.back()->samples();
+    }
+    if (shards.size() == 1) {
+        cube_ = shards.front();
+    } else {
+        // cubes generated for consecutive sample ranges
+        const boost::shared_ptr<NPVCube>& c = shards.front();
+        if (cubeDepth_ > 1)
+            cube_ = boost::make_shared<SinglePrecisionInMemoryCubeN>(c->asof(), c->ids(), c->dates(), samples,
+                                                                     cubeDepth_);
+        else
+            cube_ = boost::make_shared<SinglePrecisionInMemoryCube>(c->asof(), c->ids(), c->dates(), samples);
+        mergeCubes(shards, cube_);
+    }
     LOG("Cube loading done");
 }
 
@@ -810,6 +1209,13 @@ boost::shared_ptr<NettingSetManager> OREApp::initNettingSetManager() {
 }
 
 void OREApp::runPostProcessor() {
+    ORE_PROFILE_SCOPE("OREApp", "PostProcessor");
+    postProcess_ = buildPostProcess(portfolio_, cube_, scenarioData_);
+}
+
+boost::shared_ptr<PostProcess>
+OREApp::buildPostProcess(const boost::shared_ptr<Portfolio>& portfolio, const boost::shared_ptr<NPVCube>& cube,
+                         const boost::shared_ptr<AggregationScenarioData>& scenarioData) {
     boost::shared_ptr<NettingSetManager> netting = initNettingSetManager();
     map<string, bool> analytics;
     analytics["exerciseNextBreak"] = parseBool(params_->get("xva", "exerciseNextBreak"));
@@ -893,8 +1299,8 @@ void OREApp::runPostProcessor() {
         flipViewLendingCurvePostfix = params_->get("xva", "flipViewLendingCurvePostfix");
     }
 
-    postProcess_ = boost::make_shared<PostProcess>(
-        portfolio_, netting, market_, marketConfiguration, cube_, scenarioData_, analytics, baseCurrency,
+    return boost::make_shared<PostProcess>(
+        portfolio, netting, market_, marketConfiguration, cube, scenarioData, analytics, baseCurrency,
         allocationMethod, marginalAllocationLimit, quantile, calculationType, dvaName, fvaBorrowingCurve,
         fvaLendingCurve, dimQuantile, dimHorizonCalendarDays, dimRegressionOrder, dimRegressors,
         dimLocalRegressionEvaluations, dimLocalRegressionBandwidth, dimScaling, fullInitialCollateralisation,
@@ -904,6 +1310,7 @@ void OREApp::runPostProcessor() {
 
 void OREApp::writeXVAReports() {
 
+    ORE_PROFILE_SCOPE("OREApp", "XVAReports");
     MEM_LOG;
     LOG("Writing XVA reports");
 
@@ -950,7 +1357,107 @@ void OREApp::writeXVAReports() {
     MEM_LOG;
 }
 
+void OREApp::runWhatIfXVA() {
+    ORE_PROFILE_SCOPE("OREApp", "WhatIfXVA");
+    LOG("Running what-if XVA");
+    QL_REQUIRE(!(params_->has("simulation", "amc") && parseBool(params_->get("simulation", "amc"))),
+               "what-if XVA is not supported for cubes generated with American Monte Carlo");
+
+    // new trades and amendments of portfolio trades with the same id
+    boost::shared_ptr<Portfolio> whatIf = boost::make_shared<Portfolio>();
+    for (auto const& f : getFilenames(params_->get("xva", "whatIfPortfolioFile"), inputPath_))
+        whatIf->load(f, buildTradeFactory());
+
+    // the sim market reproduces the cached paths, its scenario generator is deterministic given the seed
+    if (!grid_) {
+        boost::shared_ptr<ScenarioGeneratorData> sgd = getScenarioGeneratorData();
+        grid_ = sgd->grid();
+    }
+    QL_REQUIRE(grid_->dates() == cube_->dates(), "what-if XVA: simulation grid does not match the cube dates");
+    QL_REQUIRE(cubeConfigurationHash_ != 0, "what-if XVA: the simulation configuration of the cube is unknown, "
+                                            "regenerate the cube to reproduce its paths");
+    QL_REQUIRE(cubeConfigurationHash_ == simulationConfigurationHash(getSimMarketData(), getScenarioGeneratorData()),
+               "what-if XVA: the cube was generated with a different model, scenario generator or simulation market "
+               "configuration, its paths cannot be reproduced");
+    boost::shared_ptr<EngineFactory> simFactory;
+    if (simMarket_)
+        simFactory = buildEngineFactory(simMarket_, "simulation");
+    else
+        simFactory = initSimMarket(getSimMarketData(), getScenarioGeneratorData());
+    simMarket_->scenarioGenerator()->reset();
+    if (cubeFirstSample_ > 0)
+        simMarket_->scenarioGenerator()->skip(cubeFirstSample_);
+
+    LOG("Build what-if portfolio linked to sim market");
+    Size n = whatIf->size();
+    whatIf->build(simFactory);
+    if (whatIf->size() != n) {
+        ALOG("There were errors during the what-if portfolio building - could build " << whatIf->size()
+                                                                                     << " trades out of " << n);
+    }
+    QL_REQUIRE(whatIf->size() > 0, "what-if XVA: no what-if trades could be built");
+
+    // value the what-if trades only, the cached scenario data must not be overwritten
+    boost::shared_ptr<NPVCube> whatIfCube;
+    if (cube_->depth() > 1)
+        whatIfCube = boost::make_shared<SinglePrecisionInMemoryCubeN>(asof_, whatIf->ids(), cube_->dates(),
+                                                                      cube_->samples(), cube_->depth());
+    else
+        whatIfCube =
+            boost::make_shared<SinglePrecisionInMemoryCube>(asof_, whatIf->ids(), cube_->dates(), cube_->samples());
+    string baseCurrency = params_->get("simulation", "baseCurrency");
+    vector<boost::shared_ptr<ValuationCalculator>> calculators;
+    calculators.push_back(boost::make_shared<NPVCalculator>(baseCurrency));
+    if (cube_->depth() > 1)
+        calculators.push_back(boost::make_shared<CashflowCalculator>(baseCurrency, asof_, grid_, 1));
+    boost::shared_ptr<AggregationScenarioData> asd = simMarket_->aggregationScenarioData();
+    simMarket_->aggregationScenarioData() = boost::shared_ptr<AggregationScenarioData>();
+    ValuationEngine engine(asof_, grid_, simMarket_);
+    engine.buildCube(whatIf, whatIfCube, calculators);
+    simMarket_->aggregationScenarioData() = asd;
+
+    // the affected netting sets, including the original netting sets of amended trades
+    set<string> nettingSets, whatIfIds;
+    for (auto const& t : whatIf->trades()) {
+        nettingSets.insert(t->envelope().nettingSetId());
+        whatIfIds.insert(t->id());
+    }
+    for (auto const& t : portfolio_->trades()) {
+        if (whatIfIds.find(t->id()) != whatIfIds.end())
+            nettingSets.insert(t->envelope().nettingSetId());
+    }
+
+    // unchanged trades of the affected netting sets with their cached cube values, followed by the what-if trades
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    for (auto const& t : portfolio_->trades()) {
+        if (nettingSets.find(t->envelope().nettingSetId()) != nettingSets.end() &&
+            whatIfIds.find(t->id()) == whatIfIds.end())
+            portfolio->add(t);
+    }
+    for (auto const& t : whatIf->trades())
+        portfolio->add(t);
+    boost::shared_ptr<NPVCube> cube;
+    if (cube_->depth() > 1)
+        cube = boost::make_shared<SinglePrecisionInMemoryCubeN>(asof_, portfolio->ids(), cube_->dates(),
+                                                                cube_->samples(), cube_->depth());
+    else
+        cube = boost::make_shared<SinglePrecisionInMemoryCube>(asof_, portfolio->ids(), cube_->dates(),
+                                                               cube_->samples());
+    combineCubes({whatIfCube, cube_}, cube);
+    LOG("What-if XVA for " << nettingSets.size() << " netting sets with " << portfolio->size() << " trades, "
+                           << whatIf->size() << " of them new or amended");
+
+    boost::shared_ptr<PostProcess> whatIfPostProcess = buildPostProcess(portfolio, cube, scenarioData_);
+
+    CSVFileReport xvaReport(outputPath_ + "/xva_whatif.csv");
+    getReportWriter()->writeXVA(xvaReport, params_->get("xva", "allocationMethod"), portfolio, whatIfPostProcess);
+    CSVFileReport marginalReport(outputPath_ + "/xva_marginal.csv");
+    getReportWriter()->writeMarginalXVA(marginalReport, postProcess_, whatIfPostProcess);
+    LOG("What-if XVA reports written");
+}
+
 void OREApp::writeDIMReport() {
+    ORE_PROFILE_SCOPE("OREApp", "DIMReport");
     string dimFile1 = outputPath_ + "/" + params_->get("xva", "dimEvolutionFile");
     vector<string> dimFiles2;
     for (auto f : parseListOfValues(params_->get("xva", "dimRegressionFiles")))
@@ -966,9 +1473,19 @@ void OREApp::writeDIMReport() {
     postProcess_->exportDimRegression(nettingSet, dimOutputGridPoints, reportVec);
 }
 
+void OREApp::writeProfile() {
+    string fileName = outputPath_ + "/profile.csv";
+    if (params_->has("setup", "profileFile") && params_->get("setup", "profileFile") != "")
+        fileName = outputPath_ + "/" + params_->get("setup", "profileFile");
+    CSVFileReport report(fileName);
+    getReportWriter()->writeProfile(report);
+    LOG("Profile written to " << fileName);
+}
+
 void OREApp::buildMarket(const std::string& todaysMarketXML, const std::string& curveConfigXML,
                          const std::string& conventionsXML, const std::vector<string>& marketData,
                          const std::vector<string>& fixingData) {
+    ORE_PROFILE_SCOPE("OREApp", "Market");
     MEM_LOG;
     LOG("Building today's market");
 
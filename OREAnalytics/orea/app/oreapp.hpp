@@ -24,6 +24,7 @@
 #pragma once
 
 #include <boost/make_shared.hpp>
+#include <cstdint>
 #include <iostream>
 #include <orea/aggregation/collateralaccount.hpp>
 #include <orea/aggregation/collatexposurehelper.hpp>
@@ -31,7 +32,10 @@
 #include <orea/app/parameters.hpp>
 #include <orea/app/reportwriter.hpp>
 #include <orea/app/sensitivityrunner.hpp>
+#include <orea/cube/cubecheckpoint.hpp>
+#include <orea/engine/convergencemonitor.hpp>
 #include <orea/engine/parametricvar.hpp>
+#include <orea/engine/proxyvaluationengine.hpp>
 #include <orea/scenario/scenariogenerator.hpp>
 #include <orea/scenario/scenariogeneratorbuilder.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
@@ -108,13 +112,27 @@ protected:
     virtual void buildNPVCube();
     //! initialise NPV cube generation
     void initialiseNPVCubeGeneration(boost::shared_ptr<Portfolio> portfolio);
+    //! build the convergence monitor for the NPV cube generation, null if no tolerance is configured
+    boost::shared_ptr<ConvergenceMonitor> buildConvergenceMonitor();
+    //! build the delta-gamma proxy valuation engine for an approximate NPV cube
+    boost::shared_ptr<ProxyValuationEngine> buildProxyValuationEngine();
+    //! build an NPV cube with the American Monte Carlo valuation engine
+    virtual void buildAMCNPVCube();
+    //! initialise NPV cube generation with the American Monte Carlo valuation engine
+    void initialiseAMCNPVCubeGeneration(boost::shared_ptr<Portfolio> portfolio);
     //! load simMarketData
     boost::shared_ptr<ScenarioSimMarketParameters> getSimMarketData();
     //! load scenarioGeneratorData
     boost::shared_ptr<ScenarioGeneratorData> getScenarioGeneratorData();
+    //! hash of the model, scenario generator and simulation market configuration, identifies stored simulation results
+    std::uint64_t simulationConfigurationHash(const boost::shared_ptr<ScenarioSimMarketParameters>& simMarketData,
+                                              const boost::shared_ptr<ScenarioGeneratorData>& sgd);
     //! build CAM
     boost::shared_ptr<QuantExt::CrossAssetModel> buildCam(boost::shared_ptr<Market> market,
                                                           const bool continueOnCalibrationError);
+    //! build the simulation market and its scenario generator, returns an engine factory linked to the sim market
+    boost::shared_ptr<EngineFactory> initSimMarket(const boost::shared_ptr<ScenarioSimMarketParameters>& simMarketData,
+                                                   const boost::shared_ptr<ScenarioGeneratorData>& sgd);
     //! build scenarioGenerator
     virtual boost::shared_ptr<ScenarioGenerator>
     buildScenarioGenerator(boost::shared_ptr<Market> market,
@@ -127,6 +145,12 @@ protected:
     virtual void loadCube();
     //! run postProcessor to generate reports from cube
     void runPostProcessor();
+    //! build a postProcessor for the given portfolio, cube and scenario data using the xva parameters
+    boost::shared_ptr<PostProcess> buildPostProcess(const boost::shared_ptr<Portfolio>& portfolio,
+                                                    const boost::shared_ptr<NPVCube>& cube,
+                                                    const boost::shared_ptr<AggregationScenarioData>& scenarioData);
+    //! value what-if trades on the cached paths and recompute the XVA of the affected netting sets only
+    void runWhatIfXVA();
 
     //! run stress tests and write out report
     virtual void runStressTest();
@@ -145,6 +169,8 @@ protected:
     void writeScenarioData();
     //! write out base scenario
     void writeBaseScenario();
+    //! write out the profile collected during the run
+    void writeProfile();
     //! load in nettingSet data
     boost::shared_ptr<NettingSetManager> initNettingSetManager();
 
@@ -186,7 +212,9 @@ protected:
         return {};
     };
     //! Get fixing manager
-    virtual boost::shared_ptr<FixingManager> getFixingManager() { return boost::make_shared<FixingManager>(asof_); }
+    virtual boost::shared_ptr<FixingManager> getFixingManager() {
+        return boost::make_shared<FixingManager>(asof_, boost::make_shared<QuantExt::FixingOverlay>());
+    }
     //! Get parametric var calculator
     virtual boost::shared_ptr<ParametricVarCalculator>
     buildParametricVarCalculator(const std::map<std::string, std::set<std::string>>& tradePortfolio,
@@ -211,6 +239,7 @@ protected:
     bool parametricVar_;
     bool writeBaseScenario_;
     bool continueOnError_;
+    bool profile_;
     std::string inputPath_;
     std::string outputPath_;
 
@@ -229,7 +258,10 @@ protected:
 
     Size cubeDepth_;
     boost::shared_ptr<NPVCube> cube_;
+    std::uint64_t cubeConfigurationHash_; // simulation configuration of the cube, zero if unknown
+    Size cubeFirstSample_;                // simulation sample of the first cube sample
     boost::shared_ptr<AggregationScenarioData> scenarioData_;
+    boost::shared_ptr<CubeCheckpoint> cubeCheckpoint_; // checkpoint of the cube generation, if configured
     boost::shared_ptr<PostProcess> postProcess_;
 
     ore::data::CurveConfigurations curveConfigs_;
@@ -24,6 +24,8 @@
 #include <orea/orea.hpp>
 #include <ored/ored.hpp>
 #include <ored/portfolio/structuredtradeerror.hpp>
+#include <ored/report/inmemoryreport.hpp>
+#include <algorithm>
 #include <ostream>
 #include <ql/cashflows/averagebmacoupon.hpp>
 #include <ql/cashflows/indexedcashflow.hpp>
@@ -59,7 +61,15 @@ void ReportWriter::writeNpv(ore::data::Report& report, const std::string& baseCu
         .addColumn("Notional(Base)", double(), 2)
         .addColumn("NettingSet", string())
         .addColumn("CounterParty", string());
-    for (auto trade : portfolio->trades()) {
+    // the values are collected column by column, an in memory report takes them as one block per column
+    Size n = portfolio->size();
+    vector<string> ids(n), tradeTypes(n), npvCcys(n), baseCcys(n), notionalCcys(n), nettingSets(n), counterparties(n);
+    vector<Date> maturities(n);
+    vector<Real> maturityTimes(n), npvs(n), baseNpvs(n), notionals(n), baseNotionals(n);
+    for (Size i = 0; i < n; ++i) {
+        const boost::shared_ptr<ore::data::Trade>& trade = portfolio->trades()[i];
+        ids[i] = trade->id();
+        tradeTypes[i] = trade->tradeType();
         try {
             string npvCcy = trade->npvCurrency();
             Real fx = 1.0, fxNotional = 1.0;
@@ -69,40 +79,46 @@ void ReportWriter::writeNpv(ore::data::Report& report, const std::string& baseCu
                 fxNotional = market->fxSpot(trade->notionalCurrency() + baseCurrency, configuration)->value();
             Real npv = trade->instrument()->NPV();
             QL_REQUIRE(std::isfinite(npv), "npv is not finite (" << npv << ")");
-            Date maturity = trade->maturity();
-            report.next()
-                .add(trade->id())
-                .add(trade->tradeType())
-                .add(maturity)
-                .add(maturity == QuantLib::Null<Date>() ? Null<Real>() : dc.yearFraction(today, maturity))
-                .add(npv)
-                .add(npvCcy)
-                .add(npv * fx)
-                .add(baseCurrency)
-                .add(trade->notional())
-                .add(trade->notionalCurrency() == "" ? nullString_ : trade->notionalCurrency())
-                .add(trade->notional() == Null<Real>() || trade->notionalCurrency() == ""
-                         ? Null<Real>()
-                         : trade->notional() * fxNotional)
-                .add(trade->envelope().nettingSetId())
-                .add(trade->envelope().counterparty());
+            maturities[i] = trade->maturity();
+            npvs[i] = npv;
+            npvCcys[i] = npvCcy;
+            baseNpvs[i] = npv * fx;
+            baseCcys[i] = baseCurrency;
+            notionals[i] = trade->notional();
+            notionalCcys[i] = trade->notionalCurrency() == "" ? nullString_ : trade->notionalCurrency();
+            baseNotionals[i] = trade->notional() == Null<Real>() || trade->notionalCurrency() == ""
+                                   ? Null<Real>()
+                                   : trade->notional() * fxNotional;
+            nettingSets[i] = trade->envelope().nettingSetId();
+            counterparties[i] = trade->envelope().counterparty();
         } catch (std::exception& e) {
             ALOG(StructuredTradeErrorMessage(trade->id(), trade->tradeType(), "Error during trade pricing", e.what()));
-            Date maturity = trade->maturity();
+            maturities[i] = trade->maturity();
+            npvs[i] = baseNpvs[i] = notionals[i] = baseNotionals[i] = Null<Real>();
+            npvCcys[i] = baseCcys[i] = notionalCcys[i] = nettingSets[i] = counterparties[i] = nullString_;
+        }
+        maturityTimes[i] = maturities[i] == Null<Date>() ? Null<Real>() : dc.yearFraction(today, maturities[i]);
+    }
+    if (auto r = dynamic_cast<ore::data::InMemoryReport*>(&report)) {
+        r->append(0, ids).append(1, tradeTypes).append(2, maturities).append(3, maturityTimes).append(4, npvs);
+        r->append(5, npvCcys).append(6, baseNpvs).append(7, baseCcys).append(8, notionals).append(9, notionalCcys);
+        r->append(10, baseNotionals).append(11, nettingSets).append(12, counterparties);
+    } else {
+        for (Size i = 0; i < n; ++i) {
             report.next()
-                .add(trade->id())
-                .add(trade->tradeType())
-                .add(maturity)
-                .add(maturity == QuantLib::Null<Date>() ? Null<Real>() : dc.yearFraction(today, maturity))
-                .add(Null<Real>())
-                .add(nullString_)
-                .add(Null<Real>())
-                .add(nullString_)
-                .add(Null<Real>())
-                .add(nullString_)
-                .add(Null<Real>())
-                .add(nullString_)
-                .add(nullString_);
+                .add(ids[i])
+                .add(tradeTypes[i])
+                .add(maturities[i])
+                .add(maturityTimes[i])
+                .add(npvs[i])
+                .add(npvCcys[i])
+                .add(baseNpvs[i])
+                .add(baseCcys[i])
+                .add(notionals[i])
+                .add(notionalCcys[i])
+                .add(baseNotionals[i])
+                .add(nettingSets[i])
+                .add(counterparties[i]);
         }
     }
     report.end();
@@ -136,6 +152,32 @@ void ReportWriter::writeCashflow(ore::data::Report& report, boost::shared_ptr<or
     }
     const vector<boost::shared_ptr<Trade>>& trades = portfolio->trades();
 
+    // the rows are collected column by column, an in memory report takes them as one block per column
+    vector<string> ids, tradeTypes, flowTypes, ccys;
+    vector<Size> cashflowNos, legNos;
+    vector<Date> payDates, fixingDates, startDates, endDates;
+    vector<Real> amounts, coupons, accruals, fixingValues, notionals, discountFactors, presentValues;
+    auto addRow = [&](const boost::shared_ptr<Trade>& trade, Size cashflowNo, Size legNo, const Date& payDate,
+                      const string& flowType, Real amount, const string& ccy, Real coupon, Real accrual,
+                      const Date& fixingDate, Real fixingValue, Real notional, const Date& startDate,
+                      const Date& endDate) {
+        ids.push_back(trade->id());
+        tradeTypes.push_back(trade->tradeType());
+        cashflowNos.push_back(cashflowNo);
+        legNos.push_back(legNo);
+        payDates.push_back(payDate);
+        flowTypes.push_back(flowType);
+        amounts.push_back(amount);
+        ccys.push_back(ccy);
+        coupons.push_back(coupon);
+        accruals.push_back(accrual);
+        fixingDates.push_back(fixingDate);
+        fixingValues.push_back(fixingValue);
+        notionals.push_back(notional);
+        startDates.push_back(startDate);
+        endDates.push_back(endDate);
+    };
+
     for (Size k = 0; k < trades.size(); k++) {
         if (!trades[k]->hasCashflows()) {
             WLOG("cashflow for " << trades[k]->tradeType() << " " << trades[k]->id() << " skipped");
@@ -223,28 +265,13 @@ void ReportWriter::writeCashflow(ore::data::Report& report, boost::shared_ptr<or
                             fixingValue = Null<Real>();
                         }
                         Real effectiveAmount = amount * (amount == Null<Real>() ? 1.0 : multiplier);
-                        report.next()
-                            .add(trades[k]->id())
-                            .add(trades[k]->tradeType())
-                            .add(j + 1)
-                            .add(i)
-                            .add(payDate)
-                            .add(flowType)
-                            .add(effectiveAmount)
-                            .add(ccy)
-                            .add(coupon)
-                            .add(accrual)
-                            .add(fixingDate)
-                            .add(fixingValue)
-                            .add(notional * (notional == Null<Real>() ? 1.0 : multiplier))
-                            .add(startDate)
-                            .add(endDate);
-
+                        Real discountFactor = write_discount_factor ? discountCurve->discount(payDate) : Null<Real>();
+                        addRow(trades[k], j + 1, i, payDate, flowType, effectiveAmount, ccy, coupon, accrual,
+                               fixingDate, fixingValue, notional * (notional == Null<Real>() ? 1.0 : multiplier),
+                               startDate, endDate);
                         if (write_discount_factor) {
-                            Real discountFactor = discountCurve->discount(payDate);
-                            report.add(discountFactor);
-                            Real presentValue = discountFactor * effectiveAmount;
-                            report.add(presentValue);
+                            discountFactors.push_back(discountFactor);
+                            presentValues.push_back(discountFactor * effectiveAmount);
                         }
                     }
                 }
@@ -279,24 +306,16 @@ void ReportWriter::writeCashflow(ore::data::Report& report, boost::shared_ptr<or
                     for (Size i = 0; i < condCfAmountsVec.size(); ++i) {
                         Real effectiveAmount =
                             condCfAmountsVec[i] * (condCfAmountsVec[i] == Null<Real>() ? 1.0 : multiplier);
-                        report.next()
-                            .add(trades[k]->id())
-                            .add(trades[k]->tradeType())
-                            .add(i + 1)
-                            .add(i)
-                            .add(condCfDatesVec[i])
-                            .add("")
-                            .add(effectiveAmount)
-                            .add(condCfCurrenciesVec[i])
-                            .add(Null<Real>())
-                            .add(Null<Real>())
-                            .add(Null<Date>())
-                            .add(Null<Real>())
-                            .add(Null<Real>());
+                        Real discountFactor =
+                            write_discount_factor
+                                ? market->discountCurve(condCfCurrenciesVec[i])->discount(condCfDatesVec[i])
+                                : Null<Real>();
+                        addRow(trades[k], i + 1, i, condCfDatesVec[i], "", effectiveAmount, condCfCurrenciesVec[i],
+                               Null<Real>(), Null<Real>(), Null<Date>(), Null<Real>(), Null<Real>(), Null<Date>(),
+                               Null<Date>());
                         if (write_discount_factor) {
-                            Handle<YieldTermStructure> discountCurve = market->discountCurve(condCfCurrenciesVec[i]);
-                            Real discountFactor = discountCurve->discount(condCfDatesVec[i]);
-                            report.add(discountFactor).add(discountFactor * effectiveAmount);
+                            discountFactors.push_back(discountFactor);
+                            presentValues.push_back(discountFactor * effectiveAmount);
                         }
                     }
                 }
@@ -308,6 +327,35 @@ void ReportWriter::writeCashflow(ore::data::Report& report, boost::shared_ptr<or
             ALOG("Exception writing cashflow report : Unkown Exception");
         }
     }
+    if (auto r = dynamic_cast<ore::data::InMemoryReport*>(&report)) {
+        r->append(0, ids).append(1, tradeTypes).append(2, cashflowNos).append(3, legNos).append(4, payDates);
+        r->append(5, flowTypes).append(6, amounts).append(7, ccys).append(8, coupons).append(9, accruals);
+        r->append(10, fixingDates).append(11, fixingValues).append(12, notionals).append(13, startDates);
+        r->append(14, endDates);
+        if (write_discount_factor)
+            r->append(15, discountFactors).append(16, presentValues);
+    } else {
+        for (Size i = 0; i < ids.size(); ++i) {
+            report.next()
+                .add(ids[i])
+                .add(tradeTypes[i])
+                .add(cashflowNos[i])
+                .add(legNos[i])
+                .add(payDates[i])
+                .add(flowTypes[i])
+                .add(amounts[i])
+                .add(ccys[i])
+                .add(coupons[i])
+                .add(accruals[i])
+                .add(fixingDates[i])
+                .add(fixingValues[i])
+                .add(notionals[i])
+                .add(startDates[i])
+                .add(endDates[i]);
+            if (write_discount_factor)
+                report.add(discountFactors[i]).add(presentValues[i]);
+        }
+    }
     report.end();
     LOG("Cashflow report written");
 }
@@ -596,6 +644,45 @@ void ReportWriter::writeXVA(ore::data::Report& report, const string& allocationM
     report.end();
 }
 
+void ReportWriter::writeMarginalXVA(ore::data::Report& report, boost::shared_ptr<PostProcess> basePostProcess,
+                                    boost::shared_ptr<PostProcess> whatIfPostProcess) {
+    report.addColumn("NettingSetId", string());
+    vector<string> measures = {"CVA", "DVA", "FBA", "FCA", "COLVA", "MVA"};
+    for (auto const& m : measures)
+        report.addColumn("Base" + m, double(), 2)
+            .addColumn("WhatIf" + m, double(), 2)
+            .addColumn("Marginal" + m, double(), 2);
+
+    auto value = [](boost::shared_ptr<PostProcess> pp, const string& n, const string& m) -> Real {
+        if (!pp)
+            return 0.0;
+        const vector<string>& ids = pp->nettingSetIds();
+        if (std::find(ids.begin(), ids.end(), n) == ids.end())
+            return 0.0;
+        if (m == "CVA")
+            return pp->nettingSetCVA(n);
+        else if (m == "DVA")
+            return pp->nettingSetDVA(n);
+        else if (m == "FBA")
+            return pp->nettingSetFBA(n);
+        else if (m == "FCA")
+            return pp->nettingSetFCA(n);
+        else if (m == "COLVA")
+            return pp->nettingSetCOLVA(n);
+        else
+            return pp->nettingSetMVA(n);
+    };
+
+    for (auto const& n : whatIfPostProcess->nettingSetIds()) {
+        report.next().add(n);
+        for (auto const& m : measures) {
+            Real base = value(basePostProcess, n, m), whatIf = value(whatIfPostProcess, n, m);
+            report.add(base).add(whatIf).add(whatIf - base);
+        }
+    }
+    report.end();
+}
+
 void ReportWriter::writeNettingSetColva(ore::data::Report& report, boost::shared_ptr<PostProcess> postProcess,
                                         const string& nettingSetId) {
     const vector<Date> dates = postProcess->cube()->dates();
@@ -650,12 +737,30 @@ void ReportWriter::writeAggregationScenarioData(ore::data::Report& report, const
         std::string tmp = ore::data::to_string(k.first) + k.second;
         report.addColumn(tmp.c_str(), double(), 8);
     }
-    for (Size d = 0; d < data.dimDates(); ++d) {
-        for (Size s = 0; s < data.dimSamples(); ++s) {
-            report.next();
-            report.add(d).add(s);
-            for (auto const& k : data.keys()) {
-                report.add(data.get(d, s, k.first, k.second));
+    // an in memory report takes the values as one block per column
+    if (auto r = dynamic_cast<ore::data::InMemoryReport*>(&report)) {
+        Size n = data.dimDates() * data.dimSamples();
+        vector<Size> dates(n), samples(n);
+        vector<Real> values(n);
+        for (Size i = 0; i < n; ++i) {
+            dates[i] = i / data.dimSamples();
+            samples[i] = i % data.dimSamples();
+        }
+        r->append(0, dates).append(1, samples);
+        Size column = 2;
+        for (auto const& k : data.keys()) {
+            for (Size i = 0; i < n; ++i)
+                values[i] = data.get(dates[i], samples[i], k.first, k.second);
+            r->append(column++, values);
+        }
+    } else {
+        for (Size d = 0; d < data.dimDates(); ++d) {
+            for (Size s = 0; s < data.dimSamples(); ++s) {
+                report.next();
+                report.add(d).add(s);
+                for (auto const& k : data.keys()) {
+                    report.add(data.get(d, s, k.first, k.second));
+                }
             }
         }
     }
@@ -675,18 +780,20 @@ void ReportWriter::writeScenarioReport(ore::data::Report& report,
     report.addColumn("Scenario NPV", double(), 2);
     report.addColumn("Difference", double(), 2);
 
-    auto scenarioDescriptions = sensitivityCube->scenarioDescriptions();
-    auto tradeIds = sensitivityCube->tradeIds();
+    const auto& scenarioDescriptions = sensitivityCube->scenarioDescriptions();
+    const auto& tradeIds = sensitivityCube->tradeIds();
     auto npvCube = sensitivityCube->npvCube();
+    vector<Real> scenarioNpvs;
 
     for (Size i = 0; i < tradeIds.size(); i++) {
         Real baseNpv = npvCube->getT0(i);
-        auto tradeId = tradeIds[i];
+        const auto& tradeId = tradeIds[i];
+        sensitivityCube->npvs(i, scenarioNpvs);
 
         for (Size j = 0; j < scenarioDescriptions.size(); j++) {
-            auto scenarioDescription = scenarioDescriptions[j];
+            const auto& scenarioDescription = scenarioDescriptions[j];
 
-            Real scenarioNpv = npvCube->get(i, j);
+            Real scenarioNpv = scenarioNpvs[j];
             Real difference = scenarioNpv - baseNpv;
 
             if (fabs(difference) > outputThreshold) {
@@ -725,30 +832,86 @@ void ReportWriter::writeSensitivityReport(Report& report, const boost::shared_pt
     report.addColumn("Delta", double(), 2);
     report.addColumn("Gamma", double(), 2);
 
+    // the records are collected column by column, an in memory report takes them as one block per column
+    vector<string> ids, isPar, factors1, factors2, ccys;
+    vector<Real> shifts1, shifts2, baseNpvs, deltas, gammas;
+
     // Make sure that we are starting from the start
     ss->reset();
     while (SensitivityRecord sr = ss->next()) {
         if (fabs(sr.delta) > outputThreshold || (sr.gamma != Null<Real>() && fabs(sr.gamma) > outputThreshold)) {
-            report.next();
-            report.add(sr.tradeId);
-            report.add(to_string(sr.isPar));
-            report.add(reconstructFactor(sr.key_1, sr.desc_1));
-            report.add(sr.shift_1);
-            report.add(reconstructFactor(sr.key_2, sr.desc_2));
-            report.add(sr.shift_2);
-            report.add(sr.currency);
-            report.add(sr.baseNpv);
-            report.add(sr.delta);
-            report.add(sr.gamma);
+            ids.push_back(sr.tradeId);
+            isPar.push_back(to_string(sr.isPar));
+            factors1.push_back(reconstructFactor(sr.key_1, sr.desc_1));
+            shifts1.push_back(sr.shift_1);
+            factors2.push_back(reconstructFactor(sr.key_2, sr.desc_2));
+            shifts2.push_back(sr.shift_2);
+            ccys.push_back(sr.currency);
+            baseNpvs.push_back(sr.baseNpv);
+            deltas.push_back(sr.delta);
+            gammas.push_back(sr.gamma);
         } else if (!std::isfinite(sr.delta) || !std::isfinite(sr.gamma)) {
             // TODO: Again, is this needed?
             ALOG("sensitivity record has infinite values: " << sr);
         }
     }
 
+    if (auto r = dynamic_cast<ore::data::InMemoryReport*>(&report)) {
+        r->append(0, ids).append(1, isPar).append(2, factors1).append(3, shifts1).append(4, factors2);
+        r->append(5, shifts2).append(6, ccys).append(7, baseNpvs).append(8, deltas).append(9, gammas);
+    } else {
+        for (Size i = 0; i < ids.size(); ++i) {
+            report.next()
+                .add(ids[i])
+                .add(isPar[i])
+                .add(factors1[i])
+                .add(shifts1[i])
+                .add(factors2[i])
+                .add(shifts2[i])
+                .add(ccys[i])
+                .add(baseNpvs[i])
+                .add(deltas[i])
+                .add(gammas[i]);
+        }
+    }
+
     report.end();
     LOG("Sensitivity report finished");
 }
 
+void ReportWriter::writeProfile(Report& report) {
+
+    LOG("Writing Profile report");
+
+    report.addColumn("Thread", Size())
+        .addColumn("Category", string())
+        .addColumn("Name", string())
+        .addColumn("Count", Size())
+        .addColumn("TotalTime", double(), 6)
+        .addColumn("AverageTime", double(), 9)
+        .addColumn("MinTime", double(), 9)
+        .addColumn("MaxTime", double(), 9)
+        .addColumn("Allocations", Size())
+        .addColumn("AllocatedBytes", Size());
+
+    for (const auto& r : ore::data::Profiler::instance().records()) {
+        const ore::data::ProfileEntry& e = r.entry;
+        report.next()
+            .add(r.thread)
+            .add(r.category)
+            .add(r.name)
+            .add(e.count)
+            .add(e.totalTime)
+            .add(e.timed > 0 ? e.totalTime / e.timed : 0.0)
+            .add(e.minTime)
+            .add(e.maxTime)
+            .add(e.allocations)
+            .add(e.bytes);
+    }
+
+    report.end();
+    LOG("Profile report finished");
+}
+
 } // namespace analytics
 } // namespace ore
@@ -76,6 +76,10 @@ public:
     virtual void writeXVA(ore::data::Report& report, const string& allocationMethod,
                           boost::shared_ptr<Portfolio> portfolio, boost::shared_ptr<PostProcess> postProcess);
 
+    //! Netting set XVA before and after adding what-if trades, netting sets without base XVA count as zero
+    virtual void writeMarginalXVA(ore::data::Report& report, boost::shared_ptr<PostProcess> basePostProcess,
+                                  boost::shared_ptr<PostProcess> whatIfPostProcess);
+
     virtual void writeAggregationScenarioData(ore::data::Report& report, const AggregationScenarioData& data);
 
     virtual void writeScenarioReport(ore::data::Report& report,
@@ -85,6 +89,9 @@ public:
     virtual void writeSensitivityReport(ore::data::Report& report, const boost::shared_ptr<SensitivityStream>& ss,
                                         QuantLib::Real outputThreshold = 0.0);
 
+    //! Write the entries of the global Profiler, times in seconds
+    virtual void writeProfile(ore::data::Report& report);
+
     const std::string& nullString() const { return nullString_; }
 
 protected:
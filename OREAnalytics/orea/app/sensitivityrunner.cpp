@@ -18,9 +18,11 @@
 
 #include <orea/app/reportwriter.hpp>
 #include <orea/app/sensitivityrunner.hpp>
+#include <orea/engine/sensitivitybinaryfile.hpp>
 #include <orea/engine/sensitivitycubestream.hpp>
 #include <ored/report/csvreport.hpp>
 #include <ored/utilities/log.hpp>
+#include <ored/utilities/profiler.hpp>
 
 using namespace std;
 using namespace ore::data;
@@ -46,6 +48,7 @@ void SensitivityRunner::runSensitivityAnalysis(boost::shared_ptr<Market> market,
                                                const CurveConfigurations& curveConfigs,
                                                const TodaysMarketParameters& todaysMarketParams) {
 
+    ORE_PROFILE_SCOPE("OREApp", "Sensitivity");
     MEM_LOG;
     LOG("Running sensitivity analysis");
 
@@ -119,6 +122,15 @@ void SensitivityRunner::sensiOutputReports(const boost::shared_ptr<SensitivityAn
     outputFile = outputPath + "/" + params_->get("sensitivity", "sensitivityOutputFile");
     CSVFileReport sensiReport(outputFile);
     ReportWriter().writeSensitivityReport(sensiReport, ss, sensiThreshold);
+
+    // The binary file holds all sensitivities, the threshold is not applied
+    if (params_->has("sensitivity", "sensitivityBinaryOutputFile")) {
+        outputFile = outputPath + "/" + params_->get("sensitivity", "sensitivityBinaryOutputFile");
+        SensitivityBinaryFileWriter writer(outputFile);
+        writer.add(ss);
+        writer.close();
+        LOG("Wrote " << writer.records() << " sensitivity records to binary file " << outputFile);
+    }
 }
 
 } // namespace analytics
@@ -0,0 +1,239 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/cube/cubecheckpoint.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <boost/filesystem.hpp>
+#include <ql/errors.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+using namespace QuantLib;
+using namespace std;
+
+namespace ore {
+namespace analytics {
+
+namespace {
+
+const char magic[] = "ORECKPT2";
+
+void write(ostream& out, const std::uint64_t x) { out.write(reinterpret_cast<const char*>(&x), sizeof(x)); }
+void write(ostream& out, const double x) { out.write(reinterpret_cast<const char*>(&x), sizeof(x)); }
+void write(ostream& out, const string& s) {
+    write(out, static_cast<std::uint64_t>(s.size()));
+    out.write(s.data(), s.size());
+}
+
+bool read(istream& in, std::uint64_t& x) { return static_cast<bool>(in.read(reinterpret_cast<char*>(&x), sizeof(x))); }
+bool read(istream& in, double& x) { return static_cast<bool>(in.read(reinterpret_cast<char*>(&x), sizeof(x))); }
+bool read(istream& in, string& s) {
+    std::uint64_t n;
+    if (!read(in, n))
+        return false;
+    s.resize(n);
+    return n == 0 || static_cast<bool>(in.read(&s[0], n));
+}
+
+// values of one record in the file layout, they are applied once the record is known to be complete
+struct Record {
+    std::uint64_t first, last;
+    vector<double> cube;
+    vector<pair<AggregationScenarioDataType, string>> keys;
+    vector<vector<double>> scenarioData;
+};
+
+bool readRecord(istream& in, const boost::shared_ptr<NPVCube>& cube, Size dimDates, Record& r) {
+    if (!read(in, r.first) || !read(in, r.last))
+        return false;
+    QL_REQUIRE(r.last > r.first && r.last <= cube->samples(),
+               "CubeCheckpoint: invalid sample range " << r.first << "-" << r.last << " in checkpoint file");
+    Size n = (r.last - r.first) * cube->numIds() * cube->numDates() * cube->depth();
+    r.cube.resize(n);
+    for (Size i = 0; i < n; ++i) {
+        if (!read(in, r.cube[i]))
+            return false;
+    }
+    std::uint64_t numKeys;
+    if (!read(in, numKeys))
+        return false;
+    r.keys.resize(numKeys);
+    r.scenarioData.resize(numKeys);
+    for (Size l = 0; l < numKeys; ++l) {
+        std::uint64_t type;
+        if (!read(in, type) || !read(in, r.keys[l].second))
+            return false;
+        r.keys[l].first = static_cast<AggregationScenarioDataType>(type);
+        r.scenarioData[l].resize((r.last - r.first) * dimDates);
+        for (Size i = 0; i < r.scenarioData[l].size(); ++i) {
+            if (!read(in, r.scenarioData[l][i]))
+                return false;
+        }
+    }
+    // the record is complete if it is terminated by the end of its sample range
+    std::uint64_t last;
+    return read(in, last) && last == r.last;
+}
+
+} // namespace
+
+CubeCheckpoint::CubeCheckpoint(const string& fileName, Size frequency,
+                               const boost::shared_ptr<AggregationScenarioData>& scenarioData,
+                               const std::uint64_t configurationHash)
+    : fileName_(fileName), frequency_(frequency), scenarioData_(scenarioData), configurationHash_(configurationHash),
+      written_(0) {
+    QL_REQUIRE(frequency_ > 0, "CubeCheckpoint: frequency must be positive");
+}
+
+Size CubeCheckpoint::restore(const boost::shared_ptr<NPVCube>& cube) {
+    if (scenarioData_)
+        QL_REQUIRE(scenarioData_->dimDates() == cube->numDates() && scenarioData_->dimSamples() == cube->samples(),
+                   "CubeCheckpoint: scenario data dimensions do not match the cube");
+    written_ = 0;
+    file_.close();
+
+    ifstream in(fileName_.c_str(), ios::binary);
+    if (!in.is_open()) {
+        LOG("CubeCheckpoint: no checkpoint file " << fileName_ << " found, start from the first sample");
+        file_.open(fileName_.c_str(), ios::binary | ios::trunc);
+        QL_REQUIRE(file_.is_open(), "CubeCheckpoint: error opening file " << fileName_);
+        writeHeader(cube);
+        return 0;
+    }
+
+    // the header must match the configuration and the cube exactly
+    char m[sizeof(magic) - 1];
+    std::uint64_t hash, asof, numIds, numDates, samples, depth;
+    QL_REQUIRE(in.read(m, sizeof(m)) && std::memcmp(m, magic, sizeof(m)) == 0,
+               "CubeCheckpoint: " << fileName_ << " is not a checkpoint file");
+    QL_REQUIRE(read(in, hash), "CubeCheckpoint: could not read the header of " << fileName_);
+    QL_REQUIRE(hash == configurationHash_, "CubeCheckpoint: the checkpoint file "
+                                               << fileName_
+                                               << " was written with a different configuration, remove it to start "
+                                                  "afresh");
+    QL_REQUIRE(read(in, asof) && read(in, numIds) && read(in, numDates) && read(in, samples) && read(in, depth),
+               "CubeCheckpoint: could not read the header of " << fileName_);
+    QL_REQUIRE(asof == static_cast<std::uint64_t>(cube->asof().serialNumber()) && numIds == cube->numIds() &&
+                   numDates == cube->numDates() && samples == cube->samples() && depth == cube->depth(),
+               "CubeCheckpoint: the checkpoint file " << fileName_ << " (" << numIds << " x " << numDates << " x "
+                                                      << samples << " x " << depth
+                                                      << ") does not match the cube, remove it to start afresh");
+    for (Size i = 0; i < numIds; ++i) {
+        string id;
+        QL_REQUIRE(read(in, id) && id == cube->ids()[i],
+                   "CubeCheckpoint: id #" << i << " in " << fileName_ << " does not match the cube");
+    }
+    for (Size j = 0; j < numDates; ++j) {
+        std::uint64_t d;
+        QL_REQUIRE(read(in, d) && d == static_cast<std::uint64_t>(cube->dates()[j].serialNumber()),
+                   "CubeCheckpoint: date #" << j << " in " << fileName_ << " does not match the cube");
+    }
+    std::streamoff end = in.tellg();
+
+    Record r;
+    while (readRecord(in, cube, cube->numDates(), r)) {
+        QL_REQUIRE(r.first == written_, "CubeCheckpoint: record for samples "
+                                            << r.first << "-" << r.last << " does not follow sample " << written_);
+        Size n = 0;
+        for (Size k = r.first; k < r.last; ++k)
+            for (Size i = 0; i < cube->numIds(); ++i)
+                for (Size j = 0; j < cube->numDates(); ++j)
+                    for (Size d = 0; d < cube->depth(); ++d)
+                        cube->set(r.cube[n++], i, j, k, d);
+        if (scenarioData_) {
+            for (Size l = 0; l < r.keys.size(); ++l) {
+                n = 0;
+                for (Size k = r.first; k < r.last; ++k)
+                    for (Size j = 0; j < cube->numDates(); ++j)
+                        scenarioData_->set(j, k, r.scenarioData[l][n++], r.keys[l].first, r.keys[l].second);
+            }
+        }
+        written_ = r.last;
+        end = in.tellg();
+    }
+    in.close();
+
+    // drop an incomplete last record and append to the file from there on
+    if (static_cast<boost::uintmax_t>(end) < boost::filesystem::file_size(fileName_)) {
+        WLOG("CubeCheckpoint: discard incomplete record at the end of " << fileName_);
+        boost::filesystem::resize_file(fileName_, end);
+    }
+    file_.open(fileName_.c_str(), ios::binary | ios::app);
+    QL_REQUIRE(file_.is_open(), "CubeCheckpoint: error opening file " << fileName_);
+    LOG("CubeCheckpoint: restored " << written_ << " samples from " << fileName_);
+    return written_;
+}
+
+void CubeCheckpoint::update(const boost::shared_ptr<NPVCube>& cube, Size completedSamples) {
+    QL_REQUIRE(file_.is_open(), "CubeCheckpoint: restore() must be called before update()");
+    if (completedSamples >= written_ + frequency_)
+        writeRecord(cube, completedSamples);
+}
+
+void CubeCheckpoint::remove() {
+    file_.close();
+    boost::filesystem::remove(fileName_);
+    written_ = 0;
+}
+
+void CubeCheckpoint::writeHeader(const boost::shared_ptr<NPVCube>& cube) {
+    file_.write(magic, sizeof(magic) - 1);
+    write(file_, configurationHash_);
+    write(file_, static_cast<std::uint64_t>(cube->asof().serialNumber()));
+    write(file_, static_cast<std::uint64_t>(cube->numIds()));
+    write(file_, static_cast<std::uint64_t>(cube->numDates()));
+    write(file_, static_cast<std::uint64_t>(cube->samples()));
+    write(file_, static_cast<std::uint64_t>(cube->depth()));
+    for (auto const& id : cube->ids())
+        write(file_, id);
+    for (auto const& d : cube->dates())
+        write(file_, static_cast<std::uint64_t>(d.serialNumber()));
+    file_.flush();
+    QL_REQUIRE(file_.good(), "CubeCheckpoint: error writing to " << fileName_);
+}
+
+void CubeCheckpoint::writeRecord(const boost::shared_ptr<NPVCube>& cube, Size completedSamples) {
+    write(file_, static_cast<std::uint64_t>(written_));
+    write(file_, static_cast<std::uint64_t>(completedSamples));
+    for (Size k = written_; k < completedSamples; ++k)
+        for (Size i = 0; i < cube->numIds(); ++i)
+            for (Size j = 0; j < cube->numDates(); ++j)
+                for (Size d = 0; d < cube->depth(); ++d)
+                    write(file_, static_cast<double>(cube->get(i, j, k, d)));
+    vector<pair<AggregationScenarioDataType, string>> keys;
+    if (scenarioData_)
+        keys = scenarioData_->keys();
+    write(file_, static_cast<std::uint64_t>(keys.size()));
+    for (auto const& key : keys) {
+        write(file_, static_cast<std::uint64_t>(key.first));
+        write(file_, key.second);
+        for (Size k = written_; k < completedSamples; ++k)
+            for (Size j = 0; j < cube->numDates(); ++j)
+                write(file_, static_cast<double>(scenarioData_->get(j, k, key.first, key.second)));
+    }
+    write(file_, static_cast<std::uint64_t>(completedSamples));
+    file_.flush();
+    QL_REQUIRE(file_.good(), "CubeCheckpoint: error writing to " << fileName_);
+    DLOG("CubeCheckpoint: samples " << written_ << "-" << completedSamples << " written to " << fileName_);
+    written_ = completedSamples;
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,93 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/cubecheckpoint.hpp
+    \brief Checkpoint file for resuming an interrupted NPV cube generation
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+#include <orea/scenario/aggregationscenariodata.hpp>
+
+#include <boost/shared_ptr.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace ore {
+namespace analytics {
+
+//! Checkpoint file for the NPV cube generation
+/*! The checkpoint appends the completed samples of an NPV cube and, optionally, of the aggregation scenario data to
+    a binary file, one record per range of samples. On restart, restore() reads the records back into a freshly
+    initialised cube and returns the number of completed samples; the ValuationEngine then skips these samples in the
+    scenario generator and continues with the next one. Since the paths are reproduced exactly and the stored values
+    are restored without loss, the final cube and scenario data are identical to the ones of an uninterrupted run.
+
+    The file starts with a hash of the configuration that generated the samples, e.g. scenarioStoreHash() of the
+    model, scenario generator and simulation market XML, and with the cube dimensions, ids and dates. A restore with
+    a different configuration hash or into a cube of a different layout fails. A record that was not completely
+    written, e.g. because the process was killed, is discarded on restore.
+
+    \ingroup cube
+*/
+class CubeCheckpoint {
+public:
+    //! ctor
+    CubeCheckpoint(
+        //! Name of the checkpoint file
+        const std::string& fileName,
+        //! Number of samples between two writes to the file
+        Size frequency = 100,
+        //! Optional aggregation scenario data to store along with the cube
+        const boost::shared_ptr<AggregationScenarioData>& scenarioData = boost::shared_ptr<AggregationScenarioData>(),
+        //! Hash of the configuration that generates the samples, a checkpoint of another configuration is refused
+        const std::uint64_t configurationHash = 0);
+
+    //! Return the name of the checkpoint file
+    const std::string& fileName() const { return fileName_; }
+    //! Return the hash of the configuration that generates the samples
+    std::uint64_t configurationHash() const { return configurationHash_; }
+
+    /*! Read the completed samples from an existing checkpoint file into the cube and scenario data and return their
+        number, or create a new checkpoint file and return zero. */
+    Size restore(const boost::shared_ptr<NPVCube>& cube);
+
+    //! Write the samples completed since the last write to the file if due
+    void update(const boost::shared_ptr<NPVCube>& cube, Size completedSamples);
+
+    //! Close and delete the checkpoint file, typically after the cube has been written
+    void remove();
+
+private:
+    void writeHeader(const boost::shared_ptr<NPVCube>& cube);
+    void writeRecord(const boost::shared_ptr<NPVCube>& cube, Size completedSamples);
+
+    std::string fileName_;
+    Size frequency_;
+    boost::shared_ptr<AggregationScenarioData> scenarioData_;
+    std::uint64_t configurationHash_;
+    std::ofstream file_;
+    Size written_;
+};
+
+} // namespace analytics
+} // namespace ore
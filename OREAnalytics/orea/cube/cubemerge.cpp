@@ -0,0 +1,140 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/cube/cubemerge.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <map>
+
+using namespace QuantLib;
+using namespace std;
+
+namespace ore {
+namespace analytics {
+
+void mergeCubes(const vector<boost::shared_ptr<NPVCube>>& shards, const boost::shared_ptr<NPVCube>& result) {
+    QL_REQUIRE(!shards.empty(), "mergeCubes: no cubes given");
+    Size samples = 0;
+    for (Size s = 0; s < shards.size(); ++s) {
+        const boost::shared_ptr<NPVCube>& c = shards[s];
+        QL_REQUIRE(c->asof() == result->asof() && c->ids() == result->ids() && c->dates() == result->dates() &&
+                       c->depth() == result->depth(),
+                   "mergeCubes: cube #" << s << " (asof " << c->asof() << ", " << c->numIds() << " ids, "
+                                        << c->numDates() << " dates, depth " << c->depth()
+                                        << ") does not match the result cube");
+        samples += c->samples();
+    }
+    QL_REQUIRE(samples == result->samples(),
+               "mergeCubes: the cubes have " << samples << " samples, the result cube " << result->samples());
+
+    for (Size i = 0; i < result->numIds(); ++i) {
+        for (Size d = 0; d < result->depth(); ++d) {
+            Real t0 = shards.front()->getT0(i, d);
+            for (Size s = 1; s < shards.size(); ++s) {
+                if (shards[s]->getT0(i, d) != t0)
+                    WLOG("mergeCubes: T0 value of " << result->ids()[i] << " in cube #" << s << " ("
+                                                    << shards[s]->getT0(i, d) << ") differs from cube #0 (" << t0
+                                                    << ")");
+            }
+            result->setT0(t0, i, d);
+        }
+    }
+
+    Size offset = 0;
+    for (auto const& c : shards) {
+        for (Size i = 0; i < c->numIds(); ++i)
+            for (Size j = 0; j < c->numDates(); ++j)
+                for (Size k = 0; k < c->samples(); ++k)
+                    for (Size d = 0; d < c->depth(); ++d)
+                        result->set(c->get(i, j, k, d), i, j, offset + k, d);
+        offset += c->samples();
+    }
+    LOG("mergeCubes: merged " << shards.size() << " cubes into a cube with " << samples << " samples");
+}
+
+void mergeAggregationScenarioData(const vector<boost::shared_ptr<AggregationScenarioData>>& shards,
+                                  const boost::shared_ptr<AggregationScenarioData>& result) {
+    QL_REQUIRE(!shards.empty(), "mergeAggregationScenarioData: no scenario data given");
+    auto keys = shards.front()->keys();
+    std::sort(keys.begin(), keys.end());
+    Size samples = 0;
+    for (Size s = 0; s < shards.size(); ++s) {
+        QL_REQUIRE(shards[s]->dimDates() == result->dimDates(),
+                   "mergeAggregationScenarioData: scenario data #" << s << " has " << shards[s]->dimDates()
+                                                                   << " dates, expected " << result->dimDates());
+        auto k = shards[s]->keys();
+        std::sort(k.begin(), k.end());
+        QL_REQUIRE(k == keys, "mergeAggregationScenarioData: keys of scenario data #" << s
+                                                                                      << " differ from #0");
+        samples += shards[s]->dimSamples();
+    }
+    QL_REQUIRE(samples == result->dimSamples(), "mergeAggregationScenarioData: the scenario data have "
+                                                    << samples << " samples, the result " << result->dimSamples());
+
+    Size offset = 0;
+    for (auto const& a : shards) {
+        for (auto const& key : keys)
+            for (Size j = 0; j < a->dimDates(); ++j)
+                for (Size k = 0; k < a->dimSamples(); ++k)
+                    result->set(j, offset + k, a->get(j, k, key.first, key.second), key.first, key.second);
+        offset += a->dimSamples();
+    }
+    LOG("mergeAggregationScenarioData: merged " << shards.size() << " scenario data with " << samples
+                                                << " samples in total");
+}
+
+void combineCubes(const vector<boost::shared_ptr<NPVCube>>& cubes, const boost::shared_ptr<NPVCube>& result) {
+    QL_REQUIRE(!cubes.empty(), "combineCubes: no cubes given");
+    for (Size s = 0; s < cubes.size(); ++s) {
+        const boost::shared_ptr<NPVCube>& c = cubes[s];
+        QL_REQUIRE(c->asof() == result->asof() && c->dates() == result->dates() &&
+                       c->samples() == result->samples() && c->depth() == result->depth(),
+                   "combineCubes: cube #" << s << " (asof " << c->asof() << ", " << c->numDates() << " dates, "
+                                          << c->samples() << " samples, depth " << c->depth()
+                                          << ") does not match the result cube");
+    }
+
+    // source cube and index for each id, the first cube containing an id wins
+    map<string, pair<Size, Size>> source;
+    for (Size s = cubes.size(); s > 0; --s) {
+        const vector<string>& ids = cubes[s - 1]->ids();
+        for (Size i = 0; i < ids.size(); ++i)
+            source[ids[i]] = make_pair(s - 1, i);
+    }
+
+    for (Size i = 0; i < result->numIds(); ++i) {
+        const string& id = result->ids()[i];
+        auto it = source.find(id);
+        QL_REQUIRE(it != source.end(), "combineCubes: trade " << id << " not found in any of the cubes");
+        const boost::shared_ptr<NPVCube>& c = cubes[it->second.first];
+        Size index = it->second.second;
+        for (Size d = 0; d < result->depth(); ++d) {
+            result->setT0(c->getT0(index, d), i, d);
+            for (Size j = 0; j < result->numDates(); ++j)
+                for (Size k = 0; k < result->samples(); ++k)
+                    result->set(c->get(index, j, k, d), i, j, k, d);
+        }
+    }
+    DLOG("combineCubes: combined " << result->numIds() << " trades from " << cubes.size() << " cubes");
+}
+
+} // namespace analytics
+} // namespace ore
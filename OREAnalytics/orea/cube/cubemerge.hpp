@@ -0,0 +1,65 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/cubemerge.hpp
+    \brief Merge of NPV cubes and aggregation scenario data generated for consecutive sample ranges or trade sets
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+#include <orea/scenario/aggregationscenariodata.hpp>
+
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Concatenate the samples of the given cubes
+/*! The shards must be given in the order of their sample ranges and must agree in the asof date, ids, dates and
+    depth. The result cube must have the same layout and the total number of samples of the shards. The T0 values
+    are taken from the first shard. If the shards were generated for consecutive sample ranges of the same
+    simulation, the result is identical to the cube of a single run over all samples.
+
+    \ingroup cube
+*/
+void mergeCubes(const std::vector<boost::shared_ptr<NPVCube>>& shards, const boost::shared_ptr<NPVCube>& result);
+
+//! Concatenate the samples of the given aggregation scenario data
+/*! The shards must be given in the order of their sample ranges and must agree in the number of dates and the keys.
+    The result must have the same number of dates and the total number of samples of the shards.
+
+    \ingroup cube
+*/
+void mergeAggregationScenarioData(const std::vector<boost::shared_ptr<AggregationScenarioData>>& shards,
+                                  const boost::shared_ptr<AggregationScenarioData>& result);
+
+//! Fill the result cube with the trades of the given cubes
+/*! The cubes must agree with the result cube in the asof date, dates, samples and depth. The T0 and simulated
+    values of each id of the result cube are taken from the first of the given cubes that contains the id, i.e. a
+    cube of amended trades must precede the cube with the original trades.
+
+    \ingroup cube
+*/
+void combineCubes(const std::vector<boost::shared_ptr<NPVCube>>& cubes, const boost::shared_ptr<NPVCube>& result);
+
+} // namespace analytics
+} // namespace ore
@@ -98,6 +98,19 @@ public:
     //! Return the asof date (T0 date)
     QuantLib::Date asof() const override { return asof_; }
 
+    //! Reduce the number of samples, the memory of the dropped samples is released
+    void truncateSamples(Size samples) override {
+        QL_REQUIRE(samples > 0 && samples <= samples_,
+                   "InMemoryCube::truncateSamples samples (" << samples << ") must be in 1..." << samples_);
+        for (auto& v : data_) {
+            for (auto& w : v) {
+                w.resize(samples);
+                w.shrink_to_fit();
+            }
+        }
+        samples_ = samples;
+    }
+
 protected:
     void check(Size i, Size j, Size k, Size d) const {
         QL_REQUIRE(i < numIds(), "Out of bounds on ids (i=" << i << ")");
@@ -94,6 +94,9 @@ public:
     //! Persist cube contents to disk
     virtual void save(const std::string& fileName) const = 0;
 
+    //! Reduce the number of samples to the given number, e.g. after an early stop of the simulation
+    virtual void truncateSamples(Size) { QL_FAIL("NPVCube::truncateSamples() not implemented"); }
+
 protected:
     virtual Size index(const std::string& id) const {
         auto it = std::find(ids().begin(), ids().end(), id);
@@ -20,6 +20,8 @@
 
 #include <ored/utilities/log.hpp>
 
+#include <algorithm>
+
 using namespace QuantLib;
 using namespace std;
 
@@ -148,6 +150,20 @@ void SensitivityCube::initialise() {
                    equal(upFactors_.left.begin(), upFactors_.left.end(), downFactors_.begin(), pred),
                "The set of risk factor keys with an 'Up' shift and 'Down' shift should match");
 
+    // Populate the dense factor tables, the down factors have the same keys as the up factors, see above
+    for (auto const& kv : upFactors_.left) {
+        factorKeys_.push_back(kv.first);
+        upFactorData_.push_back(kv.second);
+    }
+    for (auto const& kv : downFactors_)
+        downIndices_.push_back(kv.second.index);
+    for (auto const& cf : crossFactors_) {
+        crossFactorKeys_.push_back(cf.first);
+        crossFactorIds1_.push_back(factorId(cf.first.first));
+        crossFactorIds2_.push_back(factorId(cf.first.second));
+        crossIndices_.push_back(std::get<2>(cf.second));
+    }
+
     // Log warnings if each factor does not have a shift size entry and that it is not a Null<Real>()
     if (upFactors_.size() != shiftSizes_.size()) {
         WLOG("The number of 'Up' shifts (" << upFactors_.size() << ") does not equal "
@@ -167,6 +183,19 @@ void SensitivityCube::initialise() {
 
 bool SensitivityCube::hasTrade(const string& tradeId) const { return tradeIdx_.count(tradeId) > 0; }
 
+Size SensitivityCube::tradeIndex(const string& tradeId) const {
+    auto it = tradeIdx_.find(tradeId);
+    QL_REQUIRE(it != tradeIdx_.end(), "Trade, " << tradeId << ", was not found in the sensitivity cube.");
+    return it->second;
+}
+
+Size SensitivityCube::factorId(const RiskFactorKey& riskFactorKey) const {
+    auto it = std::lower_bound(factorKeys_.begin(), factorKeys_.end(), riskFactorKey);
+    QL_REQUIRE(it != factorKeys_.end() && *it == riskFactorKey,
+               "Key, " << riskFactorKey << ", was not found in the sensitivity cube.");
+    return it - factorKeys_.begin();
+}
+
 RiskFactorKey SensitivityCube::upDownFactor(const Size upDownIndex) const {
     FactorData fd;
     fd.index = upDownIndex;
@@ -182,7 +211,7 @@ bool SensitivityCube::hasScenario(const ShiftScenarioDescription& scenarioDescri
 }
 
 std::string SensitivityCube::factorDescription(const RiskFactorKey& riskFactorKey) const {
-    Size scenarioIdx = index(riskFactorKey, upFactors_.left).index;
+    Size scenarioIdx = upFactorData_[factorId(riskFactorKey)].index;
     return scenarioDescriptions_[scenarioIdx].factor1();
 }
 
@@ -207,8 +236,7 @@ Real SensitivityCube::npv(Size id, Size scenarioIdx) const { return cube_->get(i
 
 Real SensitivityCube::npv(const string& tradeId, const ShiftScenarioDescription& scenarioDescription) const {
     Size scenarioIdx = index(scenarioDescription, scenarioIdx_);
-    Size tradeIdx = cube_->getTradeIndex(tradeId);
-    return npv(tradeIdx, scenarioIdx);
+    return npv(tradeIndex(tradeId), scenarioIdx);
 }
 
 Real SensitivityCube::delta(Size id, Size scenarioIdx) const {
@@ -216,9 +244,8 @@ Real SensitivityCube::delta(Size id, Size scenarioIdx) const {
 }
 
 Real SensitivityCube::delta(const string& tradeId, const RiskFactorKey& riskFactorKey) const {
-    Size scenarioIdx = index(riskFactorKey, upFactors_.left).index;
-    Size tradeIdx = cube_->getTradeIndex(tradeId);
-    return delta(tradeIdx, scenarioIdx);
+    Size scenarioIdx = upFactorData_[factorId(riskFactorKey)].index;
+    return delta(tradeIndex(tradeId), scenarioIdx);
 }
 
 Real SensitivityCube::gamma(Size id, Size upScenarioIdx, Size downScenarioIdx) const {
@@ -231,11 +258,9 @@ Real SensitivityCube::gamma(Size id, Size upScenarioIdx, Size downScenarioIdx) c
 }
 
 Real SensitivityCube::gamma(const std::string& tradeId, const RiskFactorKey& riskFactorKey) const {
-    Size upIdx = index(riskFactorKey, upFactors_.left).index;
-    Size downIdx = index(riskFactorKey, downFactors_).index;
-    Size tradeIdx = cube_->getTradeIndex(tradeId);
-
-    return gamma(tradeIdx, upIdx, downIdx);
+    Size f = factorId(riskFactorKey);
+    QL_REQUIRE(!downIndices_.empty(), "Key, " << riskFactorKey << ", has no down shift in the sensitivity cube.");
+    return gamma(tradeIndex(tradeId), upFactorData_[f].index, downIndices_[f]);
 }
 
 Real SensitivityCube::crossGamma(Size id, Size upIdx_1, Size upIdx_2, Size crossIdx) const {
@@ -266,10 +291,42 @@ Real SensitivityCube::crossGamma(const string& tradeId, const crossPair& riskFac
     std::tie(upFd_1, upFd_2, crossIdx) = index(riskFactorKeyPair, crossFactors_);
     upIdx_1 = upFd_1.index;
     upIdx_2 = upFd_2.index;
-    tradeIdx = cube_->getTradeIndex(tradeId);
+    tradeIdx = tradeIndex(tradeId);
 
     return crossGamma(tradeIdx, upIdx_1, upIdx_2, crossIdx);
 }
 
+void SensitivityCube::npvs(Size id, vector<Real>& result) const {
+    result.assign(cube_->samples(), cube_->getT0(id, 0));
+    for (auto const& kv : cube_->getTradeNPVs(id))
+        result[kv.first] = kv.second;
+}
+
+void SensitivityCube::sensitivities(Size id, vector<Real>& deltas, vector<Real>& gammas,
+                                    vector<Real>& crossGammas) const {
+    // same formulas as in delta(), gamma() and crossGamma() above
+    vector<Real> scenarioNpvs;
+    npvs(id, scenarioNpvs);
+    Real baseNpv = cube_->getT0(id, 0);
+
+    Size n = factorKeys_.size();
+    deltas.resize(n);
+    gammas.resize(n);
+    for (Size f = 0; f < n; ++f)
+        deltas[f] = scenarioNpvs[upFactorData_[f].index] - baseNpv;
+    if (downIndices_.empty()) {
+        std::fill(gammas.begin(), gammas.end(), Null<Real>());
+    } else {
+        for (Size f = 0; f < n; ++f)
+            gammas[f] = scenarioNpvs[upFactorData_[f].index] - 2.0 * baseNpv + scenarioNpvs[downIndices_[f]];
+    }
+
+    Size m = crossIndices_.size();
+    crossGammas.resize(m);
+    for (Size c = 0; c < m; ++c)
+        crossGammas[c] = scenarioNpvs[crossIndices_[c]] - scenarioNpvs[upFactorData_[crossFactorIds1_[c]].index] -
+                         scenarioNpvs[upFactorData_[crossFactorIds2_[c]].index] + baseNpv;
+}
+
 } // namespace analytics
 } // namespace ore
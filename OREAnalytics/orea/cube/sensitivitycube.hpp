@@ -134,10 +134,48 @@ public:
     QuantLib::Real crossGamma(QuantLib::Size id, QuantLib::Size upIdx_1, QuantLib::Size upIdx_2,
                               QuantLib::Size crossIdx) const;
 
+    /*! \name Factor ids
+        The risk factors with an up shift are numbered 0, ..., numberOfFactors() - 1 in the order of their keys,
+        i.e. in the order of upFactors(). The cross factor pairs are numbered 0, ..., numberOfCrossFactors() - 1
+        in the order of crossFactors().
+    */
+    //@{
+    QuantLib::Size numberOfFactors() const { return factorKeys_.size(); }
+    QuantLib::Size numberOfCrossFactors() const { return crossFactorKeys_.size(); }
+    //! Id of the risk factor with key \p riskFactorKey
+    QuantLib::Size factorId(const RiskFactorKey& riskFactorKey) const;
+    const RiskFactorKey& factorKey(QuantLib::Size factorIdx) const { return factorKeys_.at(factorIdx); }
+    const FactorData& upFactorData(QuantLib::Size factorIdx) const { return upFactorData_.at(factorIdx); }
+    //! True if there is a down shift for each risk factor with an up shift
+    bool hasDownFactors() const { return !downIndices_.empty(); }
+    const crossPair& crossFactorKeys(QuantLib::Size crossFactorId) const { return crossFactorKeys_.at(crossFactorId); }
+    //! Ids of the two risk factors of the cross factor pair
+    std::pair<QuantLib::Size, QuantLib::Size> crossFactorIds(QuantLib::Size crossFactorId) const {
+        return std::make_pair(crossFactorIds1_.at(crossFactorId), crossFactorIds2_.at(crossFactorId));
+    }
+    //@}
+
+    /*! \name Bulk access
+        Return all values for the trade with index \p id in the cube in one go, the NPVs of the scenarios that
+        are not stored in the cube being the base NPV (see NPVSensiCube::getTradeNPVs).
+    */
+    //@{
+    //! NPVs of the trade under all scenarios, indexed by scenario index
+    void npvs(QuantLib::Size id, std::vector<QuantLib::Real>& result) const;
+
+    /*! Deltas and gammas indexed by factor id and cross gammas indexed by cross factor id, the gammas are
+        Null<Real>() if there are no down shifts */
+    void sensitivities(QuantLib::Size id, std::vector<QuantLib::Real>& deltas, std::vector<QuantLib::Real>& gammas,
+                       std::vector<QuantLib::Real>& crossGammas) const;
+    //@}
+
 private:
     //! Initialise method used by the constructors
     void initialise();
 
+    //! Index of the trade with ID \p tradeId in the cube
+    QuantLib::Size tradeIndex(const std::string& tradeId) const;
+
     boost::shared_ptr<NPVSensiCube> cube_;
     std::vector<ShiftScenarioDescription> scenarioDescriptions_;
     std::map<RiskFactorKey, QuantLib::Real> shiftSizes_;
@@ -155,6 +193,14 @@ private:
     // map of crossPair to tuple of (data of first \p RiskFactorKey, data of second \p RiskFactorKey, index of
     // crossFactor)
     std::map<crossPair, std::tuple<FactorData, FactorData, QuantLib::Size>> crossFactors_;
+
+    // Dense factor tables indexed by factor id resp. cross factor id, they duplicate the maps above
+    std::vector<RiskFactorKey> factorKeys_;
+    std::vector<FactorData> upFactorData_;
+    // scenario index of the down shift, empty if there are no down shifts
+    std::vector<QuantLib::Size> downIndices_;
+    std::vector<crossPair> crossFactorKeys_;
+    std::vector<QuantLib::Size> crossFactorIds1_, crossFactorIds2_, crossIndices_;
 };
 
 std::ostream& operator<<(std::ostream& out, const SensitivityCube::crossPair& cp);
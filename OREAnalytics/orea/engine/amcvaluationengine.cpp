@@ -0,0 +1,672 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/engine/amcvaluationengine.hpp>
+#include <ored/portfolio/optionwrapper.hpp>
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/parsers.hpp>
+#include <ored/utilities/profiler.hpp>
+
+#include <qle/instruments/payment.hpp>
+#include <qle/math/stabilisedglls.hpp>
+#include <qle/methods/multipathgeneratorbase.hpp>
+
+#include <ql/cashflows/fixedratecoupon.hpp>
+#include <ql/cashflows/iborcoupon.hpp>
+#include <ql/cashflows/simplecashflow.hpp>
+#include <ql/errors.hpp>
+#include <ql/indexes/swapindex.hpp>
+#include <ql/instruments/nonstandardswaption.hpp>
+#include <ql/instruments/swaption.hpp>
+#include <ql/methods/montecarlo/lsmbasissystem.hpp>
+#include <ql/version.hpp>
+
+#include <boost/timer/timer.hpp>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
+
+using namespace QuantLib;
+using namespace QuantExt;
+using namespace QuantExt::CrossAssetModelTypes;
+using namespace std;
+using namespace ore::data;
+using boost::timer::cpu_timer;
+
+namespace ore {
+namespace analytics {
+
+namespace {
+
+#if QL_HEX_VERSION > 0x01150000
+typedef ext::function<Real(Array)> BasisFunction;
+#else // QL 1.14 and below
+typedef boost::function1<Real, Array> BasisFunction;
+#endif
+
+// A cash flow of a trade, the amounts are per path, in the flow currency and include the multiplier
+struct AmcFlow {
+    Date payDate;
+    // the flow belongs to the underlying entered into on an exercise date on or before this date
+    Date exerciseCutoff;
+    Size ccy;
+    boost::shared_ptr<CashFlow> cashflow;
+    Real multiplier;
+    vector<Real> amount;
+    vector<Real> deflatedAmount;
+};
+
+// The cash flows and exercise rights of a trade, for options the flows are those of the underlying
+struct AmcTrade {
+    vector<AmcFlow> flows;
+    vector<AmcFlow> additionalFlows;
+    vector<Date> exerciseDates;
+    bool isOption = false;
+    bool isPhysical = false;
+    Real optionMultiplier = 1.0;
+    // regression variables, the ir states of the domestic and trade currencies and the fx states
+    vector<Size> irCcys, fxCcys;
+    Date lastPayDate;
+};
+
+bool isSupported(const boost::shared_ptr<CashFlow>& c) {
+    return boost::dynamic_pointer_cast<FixedRateCoupon>(c) || boost::dynamic_pointer_cast<IborCoupon>(c) ||
+           boost::dynamic_pointer_cast<SimpleCashFlow>(c);
+}
+
+AmcTrade amcTrade(const boost::shared_ptr<Trade>& trade, const boost::shared_ptr<CrossAssetModel>& model,
+                  const Date& today) {
+    AmcTrade result;
+    boost::shared_ptr<InstrumentWrapper> wrapper = trade->instrument();
+    boost::shared_ptr<Instrument> instrument = wrapper->qlInstrument();
+    QL_REQUIRE(trade->legs().size() == trade->legPayers().size() &&
+                   trade->legs().size() == trade->legCurrencies().size(),
+               "inconsistent leg data");
+
+    boost::shared_ptr<QuantLib::Option> option = boost::dynamic_pointer_cast<QuantLib::Option>(instrument);
+    if (option) {
+        QL_REQUIRE(boost::dynamic_pointer_cast<QuantLib::Swaption>(option) ||
+                       boost::dynamic_pointer_cast<NonstandardSwaption>(option),
+                   "option type not supported, only swaptions are");
+        result.isOption = true;
+        for (auto const& d : option->exercise()->dates()) {
+            if (d > today)
+                result.exerciseDates.push_back(d);
+        }
+        if (auto optionWrapper = boost::dynamic_pointer_cast<OptionWrapper>(wrapper)) {
+            result.isPhysical = optionWrapper->isPhysicalDelivery();
+            result.optionMultiplier = (optionWrapper->isLong() ? 1.0 : -1.0) * optionWrapper->multiplier();
+        } else {
+            // cash settled European swaption, the multiplier carries the long / short sign
+            result.optionMultiplier = wrapper->multiplier();
+        }
+    } else {
+        QL_REQUIRE(boost::dynamic_pointer_cast<QuantLib::Swap>(instrument), "instrument type not supported");
+    }
+
+    for (Size i = 0; i < trade->legs().size(); ++i) {
+        Size ccy = model->ccyIndex(parseCurrency(trade->legCurrencies()[i]));
+        Real multiplier = (trade->legPayers()[i] ? -1.0 : 1.0) * (option ? 1.0 : wrapper->multiplier());
+        for (auto const& c : trade->legs()[i]) {
+            if (c->date() <= today)
+                continue;
+            QL_REQUIRE(isSupported(c), "cash flow type on leg " << i << " not supported");
+            boost::shared_ptr<Coupon> cpn = boost::dynamic_pointer_cast<Coupon>(c);
+            result.flows.push_back(
+                {c->date(), cpn ? cpn->accrualStartDate() : c->date(), ccy, c, multiplier, {}, {}});
+        }
+    }
+
+    for (Size i = 0; i < wrapper->additionalInstruments().size(); ++i) {
+        auto payment = boost::dynamic_pointer_cast<QuantExt::Payment>(wrapper->additionalInstruments()[i]);
+        QL_REQUIRE(payment, "additional instrument " << i << " not supported, only payments are");
+        boost::shared_ptr<CashFlow> c = payment->cashFlow();
+        if (c->date() > today)
+            result.additionalFlows.push_back({c->date(), c->date(), model->ccyIndex(payment->currency()), c,
+                                              wrapper->additionalMultipliers()[i], {}, {}});
+    }
+
+    set<Size> irCcys = {0}, fxCcys;
+    for (auto const* flows : {&result.flows, &result.additionalFlows}) {
+        for (auto const& f : *flows) {
+            irCcys.insert(f.ccy);
+            if (f.ccy > 0)
+                fxCcys.insert(f.ccy);
+            if (auto cpn = boost::dynamic_pointer_cast<IborCoupon>(f.cashflow))
+                irCcys.insert(model->ccyIndex(cpn->iborIndex()->currency()));
+            result.lastPayDate = std::max(result.lastPayDate, f.payDate);
+        }
+    }
+    result.irCcys.assign(irCcys.begin(), irCcys.end());
+    result.fxCcys.assign(fxCcys.begin(), fxCcys.end());
+
+    return result;
+}
+
+// The simulated model states on the dates on which they are needed. The states are registered date by date before
+// the simulation, only these are kept for all samples, not the full paths of all model components.
+class AmcPaths {
+public:
+    AmcPaths(const boost::shared_ptr<CrossAssetModel>& model) : model_(model), samples_(0) {}
+
+    // register the ir state of a currency, the fx state of a currency or the numeraire as needed on a date
+    void requireIr(const Date& d, Size ccy) { states_[d].ir[ccy]; }
+    void requireFx(const Date& d, Size ccy) {
+        // the domestic currency has no fx state
+        if (ccy > 0)
+            states_[d].fx[ccy];
+    }
+    void requireNumeraire(const Date& d) { states_[d].hasNumeraire = true; }
+    void requireRegressors(const Date& d, const vector<Size>& irCcys, const vector<Size>& fxCcys) {
+        for (auto c : irCcys)
+            requireIr(d, c);
+        for (auto c : fxCcys)
+            requireFx(d, c);
+    }
+
+    // generates the paths and stores the registered states
+    void simulate(const ScenarioGeneratorData& sgd, Size samples) {
+        samples_ = samples;
+        vector<Time> times;
+        for (auto const& s : states_) {
+            Time t = time(s.first);
+            QL_REQUIRE(t >= 0.0, "date " << s.first << " is before the model reference date");
+            if (t > 0.0)
+                times.push_back(t);
+        }
+        QL_REQUIRE(!times.empty(), "no dates after the model reference date to simulate");
+        TimeGrid grid(times.begin(), times.end());
+
+        vector<Size> gridIndex;
+        Size count = 0;
+        for (auto& s : states_) {
+            gridIndex.push_back(grid.index(time(s.first)));
+            for (auto* m : {&s.second.ir, &s.second.fx}) {
+                for (auto& v : *m)
+                    v.second.resize(samples_);
+            }
+            if (s.second.hasNumeraire)
+                s.second.numeraire.resize(samples_);
+            count += s.second.ir.size() + s.second.fx.size() + (s.second.hasNumeraire ? 1 : 0);
+        }
+        LOG("AMCValuationEngine: simulate " << samples_ << " paths on " << grid.size() - 1 << " time steps, store "
+                                            << count << " states on " << states_.size() << " dates");
+
+        boost::shared_ptr<MultiPathGeneratorBase> pathGenerator =
+            makeMultiPathGenerator(sgd.sequenceType(), model_->stateProcess(sgd.discretization()), grid, sgd.seed(),
+                                   sgd.ordering(), sgd.directionIntegers());
+        Size domesticIr = model_->pIdx(IR, 0);
+        for (Size p = 0; p < samples_; ++p) {
+            const MultiPath& path = pathGenerator->next().value;
+            Size k = 0;
+            for (auto& s : states_) {
+                Size t = gridIndex[k++];
+                for (auto& v : s.second.ir)
+                    v.second[p] = path[model_->pIdx(IR, v.first)][t];
+                for (auto& v : s.second.fx)
+                    v.second[p] = path[model_->pIdx(FX, v.first - 1)][t];
+                if (s.second.hasNumeraire)
+                    s.second.numeraire[p] = model_->numeraire(0, grid[t], path[domesticIr][t]);
+            }
+        }
+    }
+
+    Size samples() const { return samples_; }
+    Time time(const Date& d) const { return model_->irlgm1f(0)->termStructure()->timeFromReference(d); }
+
+    const vector<Real>& irState(const Date& d, Size ccy) const {
+        const States& s = states(d);
+        auto it = s.ir.find(ccy);
+        QL_REQUIRE(it != s.ir.end(), "ir state of currency " << ccy << " not simulated on " << d);
+        return it->second;
+    }
+    // domestic currency units per unit of the given currency
+    vector<Real> fx(const Date& d, Size ccy) const {
+        if (ccy == 0)
+            return vector<Real>(samples_, 1.0);
+        vector<Real> result = fxState(d, ccy);
+        for (auto& v : result)
+            v = std::exp(v);
+        return result;
+    }
+    const vector<Real>& numeraire(const Date& d) const {
+        const States& s = states(d);
+        QL_REQUIRE(s.hasNumeraire, "numeraire not simulated on " << d);
+        return s.numeraire;
+    }
+    vector<Array> regressors(const Date& d, const vector<Size>& irCcys, const vector<Size>& fxCcys) const {
+        vector<const vector<Real>*> rows;
+        for (auto c : irCcys)
+            rows.push_back(&irState(d, c));
+        for (auto c : fxCcys)
+            rows.push_back(&fxState(d, c));
+        vector<Array> x(samples_, Array(rows.size()));
+        for (Size p = 0; p < samples_; ++p) {
+            for (Size i = 0; i < rows.size(); ++i)
+                x[p][i] = (*rows[i])[p];
+        }
+        return x;
+    }
+
+private:
+    struct States {
+        map<Size, vector<Real>> ir, fx;
+        bool hasNumeraire = false;
+        vector<Real> numeraire;
+    };
+    const States& states(const Date& d) const {
+        auto it = states_.find(d);
+        QL_REQUIRE(it != states_.end(), "date " << d << " not in the simulation grid");
+        return it->second;
+    }
+    // log of the fx rate
+    const vector<Real>& fxState(const Date& d, Size ccy) const {
+        const States& s = states(d);
+        auto it = s.fx.find(ccy);
+        QL_REQUIRE(it != s.fx.end(), "fx state of currency " << ccy << " not simulated on " << d);
+        return it->second;
+    }
+
+    boost::shared_ptr<CrossAssetModel> model_;
+    Size samples_;
+    map<Date, States> states_;
+};
+
+// The fixing of an ibor or swap index on a fixing date, implied by the model state of the index currency on that
+// date. Swap rates are the ratio of the projected float leg and the annuity of the underlying swap.
+class ModelFixing {
+public:
+    ModelFixing(const boost::shared_ptr<CrossAssetModel>& model, const boost::shared_ptr<InterestRateIndex>& index,
+                const Date& fixingDate, const AmcPaths& paths)
+        : model_(model), ccy_(model->ccyIndex(index->currency())), t_(paths.time(fixingDate)) {
+        if (auto swapIndex = boost::dynamic_pointer_cast<SwapIndex>(index)) {
+            boost::shared_ptr<IborIndex> ibor = swapIndex->iborIndex();
+            forwardingCurve_ = ibor->forwardingTermStructure();
+            discountCurve_ =
+                swapIndex->exogenousDiscount() ? swapIndex->discountingTermStructure() : forwardingCurve_;
+            QL_REQUIRE(!discountCurve_.empty(), "no discount curve for index " << index->name());
+            boost::shared_ptr<VanillaSwap> swap = swapIndex->underlyingSwap(fixingDate);
+            for (auto const& c : swap->fixedLeg()) {
+                auto cpn = boost::dynamic_pointer_cast<Coupon>(c);
+                QL_REQUIRE(cpn, "fixed leg of index " << index->name() << " contains a cash flow that is no coupon");
+                annuity_.push_back({0.0, 0.0, 1.0, cpn->nominal() * cpn->accrualPeriod(), paths.time(c->date())});
+            }
+            for (auto const& c : swap->floatingLeg()) {
+                auto cpn = boost::dynamic_pointer_cast<IborCoupon>(c);
+                QL_REQUIRE(cpn, "float leg of index " << index->name() << " contains a cash flow that is no ibor "
+                                                                          "coupon");
+                periods_.push_back(period(*ibor, cpn->fixingDate(), cpn->nominal() * cpn->accrualPeriod(),
+                                          paths.time(c->date()), paths));
+            }
+        } else {
+            auto ibor = boost::dynamic_pointer_cast<IborIndex>(index);
+            QL_REQUIRE(ibor, "index " << index->name() << " not supported, only ibor and swap indices are");
+            forwardingCurve_ = ibor->forwardingTermStructure();
+            periods_.push_back(period(*ibor, fixingDate, 1.0, 0.0, paths));
+        }
+        QL_REQUIRE(!forwardingCurve_.empty(), "no forwarding curve for index " << index->name());
+    }
+
+    Size ccy() const { return ccy_; }
+
+    Real operator()(Real x) const {
+        if (annuity_.empty())
+            return forward(periods_.front(), x);
+        Real floatLeg = 0.0, annuity = 0.0;
+        for (auto const& p : periods_)
+            floatLeg += p.weight * forward(p, x) * model_->discountBond(ccy_, t_, p.pay, x, discountCurve_);
+        for (auto const& p : annuity_)
+            annuity += p.weight * model_->discountBond(ccy_, t_, p.pay, x, discountCurve_);
+        return floatLeg / annuity;
+    }
+
+private:
+    struct Period {
+        Time start, end;
+        Real tau, weight;
+        Time pay;
+    };
+    static Period period(const IborIndex& index, const Date& fixingDate, Real weight, Time pay,
+                         const AmcPaths& paths) {
+        Date start = index.valueDate(fixingDate);
+        Date end = index.maturityDate(start);
+        return {paths.time(start), paths.time(end), index.dayCounter().yearFraction(start, end), weight, pay};
+    }
+    Real forward(const Period& p, Real x) const {
+        return (model_->discountBond(ccy_, t_, p.start, x, forwardingCurve_) /
+                    model_->discountBond(ccy_, t_, p.end, x, forwardingCurve_) -
+                1.0) /
+               p.tau;
+    }
+
+    boost::shared_ptr<CrossAssetModel> model_;
+    Size ccy_;
+    Time t_;
+    Handle<YieldTermStructure> forwardingCurve_, discountCurve_;
+    vector<Period> periods_, annuity_;
+};
+
+// registers the model states needed to value the trade
+void requireStates(const AmcTrade& trade, const vector<Date>& simulationDates,
+                   const boost::shared_ptr<CrossAssetModel>& model, const Date& today, AmcPaths& paths) {
+    for (auto const* flows : {&trade.flows, &trade.additionalFlows}) {
+        for (auto const& f : *flows) {
+            paths.requireFx(f.payDate, f.ccy);
+            paths.requireNumeraire(f.payDate);
+            if (auto cpn = boost::dynamic_pointer_cast<IborCoupon>(f.cashflow)) {
+                if (cpn->fixingDate() > today)
+                    paths.requireIr(cpn->fixingDate(), model->ccyIndex(cpn->iborIndex()->currency()));
+            }
+        }
+    }
+    for (auto const& d : trade.exerciseDates) {
+        paths.requireRegressors(d, trade.irCcys, trade.fxCcys);
+        paths.requireNumeraire(d);
+    }
+    // the regression dates, the value is zero once all flows are paid
+    for (auto const& d : simulationDates) {
+        if (d < trade.lastPayDate)
+            paths.requireRegressors(d, trade.irCcys, trade.fxCcys);
+    }
+}
+
+// Projects the amounts of a flow on each path, future ibor fixings are implied from the model on the fixing date
+void setAmounts(AmcFlow& flow, const AmcPaths& paths, const boost::shared_ptr<CrossAssetModel>& model,
+                const Date& today) {
+    boost::shared_ptr<IborCoupon> cpn = boost::dynamic_pointer_cast<IborCoupon>(flow.cashflow);
+    if (cpn && cpn->fixingDate() > today) {
+        ModelFixing fixing(model, cpn->iborIndex(), cpn->fixingDate(), paths);
+        const vector<Real>& x = paths.irState(cpn->fixingDate(), fixing.ccy());
+        flow.amount.resize(paths.samples());
+        for (Size p = 0; p < paths.samples(); ++p)
+            flow.amount[p] = flow.multiplier * cpn->nominal() * cpn->accrualPeriod() *
+                             (cpn->gearing() * fixing(x[p]) + cpn->spread());
+    } else {
+        flow.amount.assign(paths.samples(), flow.multiplier * flow.cashflow->amount());
+    }
+    vector<Real> fx = paths.fx(flow.payDate, flow.ccy);
+    const vector<Real>& numeraire = paths.numeraire(flow.payDate);
+    flow.deflatedAmount.resize(paths.samples());
+    for (Size p = 0; p < paths.samples(); ++p)
+        flow.deflatedAmount[p] = flow.amount[p] * fx[p] / numeraire[p];
+}
+
+// Least squares regression of y on the basis functions of x, evaluated at x
+vector<Real> regress(const vector<Array>& x, const vector<Real>& y, const vector<BasisFunction>& basis) {
+    vector<Real> result(y.size(), 0.0);
+    if (std::all_of(y.begin(), y.end(), [](Real v) { return close_enough(v, 0.0); }))
+        return result;
+    StabilisedGLLS ls(x, y, basis, StabilisedGLLS::MeanStdDev);
+    for (Size p = 0; p < x.size(); ++p)
+        result[p] = ls.eval(x[p], basis);
+    return result;
+}
+
+// Replaces the underlying flows of an option by the flows received on exercise
+void exercise(AmcTrade& trade, const AmcPaths& paths, const vector<BasisFunction>& basis) {
+    Size samples = paths.samples();
+    Size n = trade.exerciseDates.size();
+    // exercise index per path, n means not exercised
+    vector<Size> exerciseIndex(samples, n);
+    // pathwise deflated value of the option and of the underlying on each exercise date, and the regression estimate
+    // of the latter given the model state on the exercise date
+    vector<Real> optionValue(samples, 0.0);
+    vector<vector<Real>> underlyingValue(n, vector<Real>(samples, 0.0)), exerciseValue(n);
+
+    // backward induction over the exercise dates, longstaff-schwartz
+    for (Size k = n; k-- > 0;) {
+        Date exerciseDate = trade.exerciseDates[k];
+        for (auto const& f : trade.flows) {
+            if (f.exerciseCutoff >= exerciseDate) {
+                for (Size p = 0; p < samples; ++p)
+                    underlyingValue[k][p] += f.deflatedAmount[p];
+            }
+        }
+        vector<Array> x = paths.regressors(exerciseDate, trade.irCcys, trade.fxCcys);
+        exerciseValue[k] = regress(x, underlyingValue[k], basis);
+        vector<Real> continuationEstimate = regress(x, optionValue, basis);
+        for (Size p = 0; p < samples; ++p) {
+            if (exerciseValue[k][p] > std::max(continuationEstimate[p], 0.0)) {
+                exerciseIndex[p] = k;
+                optionValue[p] = underlyingValue[k][p];
+            }
+        }
+    }
+
+    if (trade.isPhysical) {
+        for (auto& f : trade.flows) {
+            for (Size p = 0; p < samples; ++p) {
+                bool received = exerciseIndex[p] < n && f.exerciseCutoff >= trade.exerciseDates[exerciseIndex[p]];
+                f.amount[p] = received ? f.amount[p] * trade.optionMultiplier : 0.0;
+                f.deflatedAmount[p] = received ? f.deflatedAmount[p] * trade.optionMultiplier : 0.0;
+            }
+        }
+    } else {
+        // the cash settlement takes place strictly after the exercise date, as in the OptionWrapper; the amount is
+        // the value of the underlying given the state on the exercise date, the pathwise realised value of its flows
+        // would anticipate fixings after the exercise date and overstate the exposure variance up to the settlement
+        vector<AmcFlow> settlements;
+        for (Size k = 0; k < n; ++k) {
+            const vector<Real>& numeraire = paths.numeraire(trade.exerciseDates[k]);
+            AmcFlow s{trade.exerciseDates[k] + 1, trade.exerciseDates[k] + 1, 0, boost::shared_ptr<CashFlow>(),
+                      trade.optionMultiplier, vector<Real>(samples, 0.0), vector<Real>(samples, 0.0)};
+            for (Size p = 0; p < samples; ++p) {
+                if (exerciseIndex[p] == k) {
+                    s.deflatedAmount[p] = exerciseValue[k][p] * trade.optionMultiplier;
+                    s.amount[p] = s.deflatedAmount[p] * numeraire[p];
+                }
+            }
+            settlements.push_back(s);
+        }
+        trade.flows.swap(settlements);
+    }
+}
+
+} // namespace
+
+AMCValuationEngine::AMCValuationEngine(
+    const boost::shared_ptr<QuantExt::CrossAssetModel>& model,
+    const boost::shared_ptr<ScenarioGeneratorData>& scenarioGeneratorData, const Size polynomOrder,
+    const std::vector<std::string>& aggregationScenarioDataCurrencies,
+    const std::map<std::string, boost::shared_ptr<QuantLib::InterestRateIndex>>& aggregationScenarioDataIndices)
+    : model_(model), scenarioGeneratorData_(scenarioGeneratorData), polynomOrder_(polynomOrder),
+      aggregationScenarioDataCurrencies_(aggregationScenarioDataCurrencies),
+      aggregationScenarioDataIndices_(aggregationScenarioDataIndices) {
+
+    QL_REQUIRE(model_, "AMCValuationEngine: Error, Null CrossAssetModel");
+    QL_REQUIRE(scenarioGeneratorData_, "AMCValuationEngine: Error, Null ScenarioGeneratorData");
+    QL_REQUIRE(scenarioGeneratorData_->grid()->size() > 0, "AMCValuationEngine: Error, DateGrid size must be > 0");
+    Date today = model_->irlgm1f(0)->termStructure()->referenceDate();
+    QL_REQUIRE(today <= scenarioGeneratorData_->grid()->dates().front(),
+               "AMCValuationEngine: Error today (" << today << ") must not be later than first DateGrid date "
+                                                   << scenarioGeneratorData_->grid()->dates().front());
+    // the scenario data is written with the model states, all currencies must be model currencies
+    for (auto const& c : aggregationScenarioDataCurrencies_)
+        model_->ccyIndex(parseCurrency(c));
+    for (auto const& i : aggregationScenarioDataIndices_) {
+        QL_REQUIRE(i.second, "AMCValuationEngine: Error, Null index " << i.first);
+        model_->ccyIndex(i.second->currency());
+    }
+}
+
+void AMCValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfolio,
+                                   boost::shared_ptr<analytics::NPVCube> outputCube,
+                                   boost::shared_ptr<analytics::AggregationScenarioData> scenarioData) {
+
+    QL_REQUIRE(portfolio->size() > 0, "AMCValuationEngine: Error portfolio is empty");
+
+    const auto& dates = scenarioGeneratorData_->grid()->dates();
+    const auto& trades = portfolio->trades();
+    Size samples = outputCube->samples();
+
+    QL_REQUIRE(outputCube->numIds() == trades.size(),
+               "cube x dimension (" << outputCube->numIds() << ") "
+                                    << "different from portfolio size (" << trades.size() << ")");
+
+    QL_REQUIRE(outputCube->numDates() == dates.size(),
+               "cube y dimension (" << outputCube->numDates() << ") "
+                                    << "different from number of time steps (" << dates.size() << ")");
+
+    LOG("Starting AMCValuationEngine for " << trades.size() << " trades, " << samples << " samples and "
+                                           << dates.size() << " dates.");
+
+    cpu_timer timer;
+    Date today = model_->irlgm1f(0)->termStructure()->referenceDate();
+
+    // collect the trade flows, a netting set with a trade that can not be valued would be misstated, so all trades
+    // are checked before the simulation and the run fails if one of them is not supported
+    vector<AmcTrade> amcTrades(trades.size());
+    ostringstream unsupported;
+    Size numUnsupported = 0;
+    for (Size j = 0; j < trades.size(); ++j) {
+        try {
+            amcTrades[j] = amcTrade(trades[j], model_, today);
+        } catch (std::exception& e) {
+            ALOG("AMCValuationEngine: trade " << trades[j]->id() << " not supported: " << e.what());
+            unsupported << (numUnsupported++ > 0 ? ", " : "") << trades[j]->id();
+        }
+    }
+    QL_REQUIRE(numUnsupported == 0, "AMCValuationEngine: " << numUnsupported
+                                                           << " trade(s) not supported: " << unsupported.str());
+
+    // the model states needed by the trades and for the aggregation scenario data, date by date
+    AmcPaths paths(model_);
+    for (auto const& t : amcTrades)
+        requireStates(t, dates, model_, today, paths);
+    for (auto const& d : dates)
+        paths.requireNumeraire(d);
+    if (scenarioData) {
+        for (auto const& d : dates) {
+            for (auto const& c : aggregationScenarioDataCurrencies_)
+                paths.requireFx(d, model_->ccyIndex(parseCurrency(c)));
+            for (auto const& i : aggregationScenarioDataIndices_)
+                paths.requireIr(d, model_->ccyIndex(i.second->currency()));
+        }
+    }
+    {
+        ORE_PROFILE_SCOPE("AMCValuationEngine", "PathGeneration");
+        paths.simulate(*scenarioGeneratorData_, samples);
+    }
+
+    if (scenarioData) {
+        // the same data as written by the ScenarioSimMarket, fx spots in base currency units per unit of the
+        // currency and index fixings on the simulation dates
+        for (Size i = 0; i < dates.size(); ++i) {
+            const vector<Real>& numeraire = paths.numeraire(dates[i]);
+            for (Size p = 0; p < samples; ++p)
+                scenarioData->set(i, p, numeraire[p], AggregationScenarioDataType::Numeraire);
+            for (auto const& c : aggregationScenarioDataCurrencies_) {
+                Size ccy = model_->ccyIndex(parseCurrency(c));
+                if (ccy == 0)
+                    continue;
+                vector<Real> fx = paths.fx(dates[i], ccy);
+                for (Size p = 0; p < samples; ++p)
+                    scenarioData->set(i, p, fx[p], AggregationScenarioDataType::FXSpot, c);
+            }
+            for (auto const& index : aggregationScenarioDataIndices_) {
+                ModelFixing fixing(model_, index.second, dates[i], paths);
+                const vector<Real>& x = paths.irState(dates[i], fixing.ccy());
+                for (Size p = 0; p < samples; ++p)
+                    scenarioData->set(i, p, fixing(x[p]), AggregationScenarioDataType::IndexFixing, index.first);
+            }
+        }
+    }
+
+    map<Size, vector<BasisFunction>> bases;
+    Real t0Numeraire = model_->numeraire(0, 0.0, 0.0);
+
+    for (Size j = 0; j < trades.size(); ++j) {
+        updateProgress(j, trades.size());
+        ORE_PROFILE_SCOPE("AMCValuationEngine", trades[j]->tradeType());
+        AmcTrade& trade = amcTrades[j];
+        try {
+            Size dim = trade.irCcys.size() + trade.fxCcys.size();
+            if (bases.find(dim) == bases.end())
+                bases[dim] = LsmBasisSystem::multiPathBasisSystem(dim, polynomOrder_, LsmBasisSystem::Monomial);
+            const vector<BasisFunction>& basis = bases[dim];
+            QL_REQUIRE(samples > basis.size(),
+                       "not enough samples (" << samples << ") for " << basis.size() << " basis functions");
+
+            for (auto* flows : {&trade.flows, &trade.additionalFlows}) {
+                for (auto& f : *flows)
+                    setAmounts(f, paths, model_, today);
+            }
+            if (trade.isOption) {
+                ORE_PROFILE_SCOPE("AMCValuationEngine", "Exercise");
+                exercise(trade, paths, basis);
+            }
+            trade.flows.insert(trade.flows.end(), trade.additionalFlows.begin(), trade.additionalFlows.end());
+            std::sort(trade.flows.begin(), trade.flows.end(),
+                      [](const AmcFlow& a, const AmcFlow& b) { return a.payDate < b.payDate; });
+
+            // T0 value
+            Real t0 = 0.0;
+            for (auto const& f : trade.flows) {
+                for (Size p = 0; p < samples; ++p)
+                    t0 += f.deflatedAmount[p];
+            }
+            outputCube->setT0(t0 / samples * t0Numeraire, j);
+
+            // conditional expectation of the future deflated flows, backwards over the simulation dates
+            vector<Real> futureFlows(samples, 0.0);
+            auto next = trade.flows.rbegin();
+            for (Size i = dates.size(); i-- > 0;) {
+                for (; next != trade.flows.rend() && next->payDate > dates[i]; ++next) {
+                    for (Size p = 0; p < samples; ++p)
+                        futureFlows[p] += next->deflatedAmount[p];
+                }
+                // no flows after this date, the value is zero
+                if (next == trade.flows.rbegin())
+                    continue;
+                ORE_PROFILE_SCOPE("AMCValuationEngine", "Regression");
+                vector<Real> npv = regress(paths.regressors(dates[i], trade.irCcys, trade.fxCcys), futureFlows, basis);
+                for (Size p = 0; p < samples; ++p)
+                    outputCube->set(npv[p], j, i, p);
+            }
+            ORE_PROFILE_COUNT("AMCValuationEngine", "CubeWrites", dates.size() * samples);
+
+            // pathwise flows in (t, t+1], deflated with the numeraire at t as in the CashflowCalculator
+            if (outputCube->depth() > 1) {
+                for (auto const& f : trade.flows) {
+                    auto it = std::lower_bound(dates.begin(), dates.end(), f.payDate);
+                    if (it == dates.begin() || it == dates.end())
+                        continue;
+                    Size i = it - dates.begin() - 1;
+                    vector<Real> fx = paths.fx(dates[i], f.ccy);
+                    const vector<Real>& numeraire = paths.numeraire(dates[i]);
+                    for (Size p = 0; p < samples; ++p) {
+                        Real flow = f.amount[p] * fx[p] / numeraire[p];
+                        outputCube->set(outputCube->get(j, i, p, 1) + flow, j, i, p, 1);
+                    }
+                }
+            }
+        } catch (std::exception& e) {
+            QL_FAIL("AMCValuationEngine: failed to value trade " << trades[j]->id() << ": " << e.what());
+        }
+        // release the path data of the trade
+        trade = AmcTrade();
+    }
+
+    updateProgress(trades.size(), trades.size());
+    timer.stop();
+    LOG("AMCValuationEngine completed: " << timer.format(2, "%w") << " sec");
+}
+} // namespace analytics
+} // namespace ore
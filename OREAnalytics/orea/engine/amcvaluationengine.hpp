@@ -0,0 +1,103 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file engine/amcvaluationengine.hpp
+    \brief American Monte Carlo valuation engine for the NPV cube
+    \ingroup simulation
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+#include <orea/scenario/aggregationscenariodata.hpp>
+#include <orea/scenario/scenariogeneratordata.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/utilities/progressbar.hpp>
+
+#include <qle/models/crossassetmodel.hpp>
+
+#include <ql/indexes/interestrateindex.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! American Monte Carlo Valuation Engine
+/*!
+  Alternative to the ValuationEngine that does not reprice the trades on each simulation date and path. The cross
+  asset model paths are generated once on a time grid containing the simulation dates and the event dates of the
+  portfolio. The trade cash flows are projected and deflated pathwise, Bermudan exercise decisions are taken by
+  Longstaff-Schwartz regressions, and the deflated NPV on each simulation date is the regression of the future
+  deflated cash flows on the model states (the IR states of the trade and domestic currencies and the FX states of
+  the trade currencies) at that date. The resulting cube has the same layout as the one built by the
+  ValuationEngine with the NPVCalculator (depth 0) and optionally the CashflowCalculator (depth 1), i.e. it holds
+  deflated values in the domestic currency of the model.
+
+  Only the model states needed on each date are kept for all samples: the IR and FX states of the regression
+  variables on the simulation and exercise dates, the IR states of the index currencies on the fixing dates and the
+  FX states and the numeraire on the pay dates.
+
+  Supported are trades whose instrument is a QuantLib::Swap, and swaptions (QuantLib::Swaption and
+  QuantLib::NonstandardSwaption, European or Bermudan, cash or physically settled) on legs of fixed rate coupons,
+  ibor coupons and simple cash flows, plus premium payments. A cash settled swaption pays the regression estimate of
+  the underlying value on the exercise date one day after exercise. Since a netting set with a trade that can not be
+  valued would be misstated, the cube build fails if the portfolio contains other trades or a trade can not be valued.
+
+  The aggregation scenario data holds the numeraire, the FX spots of the given currencies and the fixings of the
+  given ibor and swap indices implied by the model on the simulation dates.
+
+  \ingroup simulation
+*/
+class AMCValuationEngine : public ore::data::ProgressReporter {
+public:
+    //! Constructor
+    AMCValuationEngine(
+        //! Simulation model, the domestic currency is the currency of the cube values
+        const boost::shared_ptr<QuantExt::CrossAssetModel>& model,
+        //! Simulation date grid and path generator settings
+        const boost::shared_ptr<ScenarioGeneratorData>& scenarioGeneratorData,
+        //! Order of the monomials used in the regressions
+        const Size polynomOrder = 2,
+        //! Currencies for which the fx spot is stored in the aggregation scenario data
+        const std::vector<std::string>& aggregationScenarioDataCurrencies = std::vector<std::string>(),
+        //! Indices for which the fixings are stored in the aggregation scenario data, linked to today's market
+        const std::map<std::string, boost::shared_ptr<QuantLib::InterestRateIndex>>& aggregationScenarioDataIndices =
+            std::map<std::string, boost::shared_ptr<QuantLib::InterestRateIndex>>());
+
+    //! Build NPV cube
+    void buildCube(
+        //! Portfolio to be valued, built against the market the model is calibrated to
+        const boost::shared_ptr<data::Portfolio>& portfolio,
+        //! Object for storing the resulting NPV cube, depth 1 or 2
+        boost::shared_ptr<analytics::NPVCube> outputCube,
+        //! Optional object to store the simulated numeraire, fx spots and index fixings in
+        boost::shared_ptr<analytics::AggregationScenarioData> scenarioData =
+            boost::shared_ptr<analytics::AggregationScenarioData>());
+
+private:
+    boost::shared_ptr<QuantExt::CrossAssetModel> model_;
+    boost::shared_ptr<ScenarioGeneratorData> scenarioGeneratorData_;
+    Size polynomOrder_;
+    std::vector<std::string> aggregationScenarioDataCurrencies_;
+    std::map<std::string, boost::shared_ptr<QuantLib::InterestRateIndex>> aggregationScenarioDataIndices_;
+};
+} // namespace analytics
+} // namespace ore
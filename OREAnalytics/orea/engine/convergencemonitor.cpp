@@ -0,0 +1,136 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/engine/convergencemonitor.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+
+using namespace QuantLib;
+using namespace std;
+using namespace boost::accumulators;
+
+namespace ore {
+namespace analytics {
+
+ConvergenceMonitor::ConvergenceMonitor(const boost::shared_ptr<ore::data::Portfolio>& portfolio, const Date& today,
+                                       const vector<Date>& dates, const Real relativeTolerance,
+                                       const Real absoluteTolerance, const Size minSamples, const Size checkFrequency,
+                                       const map<string, vector<Real>>& cvaWeights)
+    : relativeTolerance_(relativeTolerance), absoluteTolerance_(absoluteTolerance), minSamples_(minSamples),
+      checkFrequency_(checkFrequency), samples_(0), converged_(false) {
+
+    QL_REQUIRE(relativeTolerance_ >= 0.0 && absoluteTolerance_ >= 0.0,
+               "ConvergenceMonitor: tolerances must be non-negative");
+    QL_REQUIRE(checkFrequency_ > 0, "ConvergenceMonitor: check frequency must be positive");
+    QL_REQUIRE(!dates.empty() && dates.back() > today, "ConvergenceMonitor: dates after today required");
+
+    for (auto const& trade : portfolio->trades()) {
+        const string& id = trade->envelope().nettingSetId();
+        auto it = std::find(nettingSets_.begin(), nettingSets_.end(), id);
+        tradeNettingSet_.push_back(it - nettingSets_.begin());
+        if (it == nettingSets_.end())
+            nettingSets_.push_back(id);
+    }
+
+    Date previous = today;
+    for (auto const& d : dates) {
+        timeWeights_.push_back(std::max<Real>(d - previous, 0.0) / (dates.back() - today));
+        previous = std::max(d, previous);
+    }
+
+    cvaWeights_.resize(nettingSets_.size());
+    for (Size k = 0; k < nettingSets_.size(); ++k) {
+        auto w = cvaWeights.find(nettingSets_[k]);
+        if (w != cvaWeights.end()) {
+            QL_REQUIRE(w->second.size() == dates.size(), "ConvergenceMonitor: " << w->second.size()
+                                                                                 << " cva weights for netting set "
+                                                                                 << nettingSets_[k] << ", expected "
+                                                                                 << dates.size());
+            cvaWeights_[k] = w->second;
+        }
+    }
+
+    epe_.resize(nettingSets_.size());
+    ene_.resize(nettingSets_.size());
+    cva_.resize(nettingSets_.size());
+
+    LOG("ConvergenceMonitor for " << nettingSets_.size() << " netting sets, relative tolerance " << relativeTolerance_
+                                  << ", absolute tolerance " << absoluteTolerance_ << ", min samples " << minSamples_
+                                  << ", check frequency " << checkFrequency_);
+}
+
+bool ConvergenceMonitor::update(const boost::shared_ptr<NPVCube>& cube, Size sample) {
+    QL_REQUIRE(cube->numIds() == tradeNettingSet_.size(),
+               "ConvergenceMonitor: cube has " << cube->numIds() << " ids, expected " << tradeNettingSet_.size());
+    QL_REQUIRE(cube->numDates() == timeWeights_.size(),
+               "ConvergenceMonitor: cube has " << cube->numDates() << " dates, expected " << timeWeights_.size());
+
+    vector<Real> epe(nettingSets_.size(), 0.0), ene(nettingSets_.size(), 0.0), cva(nettingSets_.size(), 0.0);
+    vector<Real> value(nettingSets_.size());
+    for (Size j = 0; j < timeWeights_.size(); ++j) {
+        std::fill(value.begin(), value.end(), 0.0);
+        for (Size i = 0; i < tradeNettingSet_.size(); ++i)
+            value[tradeNettingSet_[i]] += cube->get(i, j, sample);
+        for (Size k = 0; k < nettingSets_.size(); ++k) {
+            epe[k] += timeWeights_[j] * std::max(value[k], 0.0);
+            ene[k] += timeWeights_[j] * std::max(-value[k], 0.0);
+            if (!cvaWeights_[k].empty())
+                cva[k] += cvaWeights_[k][j] * std::max(value[k], 0.0);
+        }
+    }
+    for (Size k = 0; k < nettingSets_.size(); ++k) {
+        epe_[k](epe[k]);
+        ene_[k](ene[k]);
+        cva_[k](cva[k]);
+    }
+    ++samples_;
+
+    if (samples_ >= std::max<Size>(minSamples_, 2) && samples_ % checkFrequency_ == 0) {
+        converged_ = check();
+        DLOG("ConvergenceMonitor: " << (converged_ ? "converged" : "not converged") << " after " << samples_
+                                    << " samples");
+    }
+    return converged_;
+}
+
+bool ConvergenceMonitor::check() const {
+    for (auto const& e : estimates()) {
+        if (e.second.standardError > std::max(relativeTolerance_ * std::abs(e.second.value), absoluteTolerance_))
+            return false;
+    }
+    return true;
+}
+
+map<pair<string, string>, ConvergenceMonitor::Estimate> ConvergenceMonitor::estimates() const {
+    map<pair<string, string>, Estimate> result;
+    if (samples_ < 2)
+        return result;
+    for (Size k = 0; k < nettingSets_.size(); ++k) {
+        result[make_pair(nettingSets_[k], "EPE")] = {mean(epe_[k]), error_of<tag::mean>(epe_[k])};
+        result[make_pair(nettingSets_[k], "ENE")] = {mean(ene_[k]), error_of<tag::mean>(ene_[k])};
+        if (!cvaWeights_[k].empty())
+            result[make_pair(nettingSets_[k], "CVA")] = {mean(cva_[k]), error_of<tag::mean>(cva_[k])};
+    }
+    return result;
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,116 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file engine/convergencemonitor.hpp
+    \brief Monte Carlo convergence monitoring of the exposure estimators during the cube generation
+    \ingroup simulation
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+#include <ored/portfolio/portfolio.hpp>
+
+#include <boost/accumulators/accumulators.hpp>
+#include <boost/accumulators/statistics/error_of_mean.hpp>
+#include <boost/accumulators/statistics/mean.hpp>
+#include <boost/accumulators/statistics/stats.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Convergence monitor for the Monte Carlo simulation of the NPV cube
+/*!
+  The monitor tracks running estimators of the time averaged expected positive exposure (EPE), the time averaged
+  expected negative exposure (ENE) and, if weights are given, the CVA of each netting set, together with their
+  standard errors, as the samples of the cube are filled. The exposures are the uncollateralised, deflated netting set
+  values stored in the cube. The CVA weights of a netting set are given per cube date, typically the loss given
+  default times the probability of default of the counterparty between the previous and the current date.
+
+  A quantity is converged when its standard error is at most max(relativeTolerance * |estimate|,
+  absoluteTolerance). The check is done every checkFrequency samples once minSamples samples are available. The
+  standard errors assume independent samples, they are an approximation for antithetic and low discrepancy
+  sequences.
+
+  \ingroup simulation
+*/
+class ConvergenceMonitor {
+public:
+    //! Estimate of a monitored quantity
+    struct Estimate {
+        Real value;
+        Real standardError;
+    };
+
+    ConvergenceMonitor(
+        //! Portfolio of the cube, defines the netting sets
+        const boost::shared_ptr<ore::data::Portfolio>& portfolio,
+        //! Valuation date
+        const QuantLib::Date& today,
+        //! Cube dates
+        const std::vector<QuantLib::Date>& dates,
+        //! Relative tolerance of the standard errors
+        const Real relativeTolerance,
+        //! Absolute tolerance of the standard errors, in base currency
+        const Real absoluteTolerance,
+        //! Number of samples before the first convergence check
+        const Size minSamples = 1000,
+        //! Number of samples between two convergence checks
+        const Size checkFrequency = 100,
+        //! CVA weights per netting set and cube date, netting sets without weights are not monitored for CVA
+        const std::map<std::string, std::vector<Real>>& cvaWeights = std::map<std::string, std::vector<Real>>());
+
+    /*! Adds the netting set exposures of the given sample of the cube to the estimators and checks the convergence
+        if due. Returns true if all monitored quantities have converged. */
+    bool update(const boost::shared_ptr<NPVCube>& cube, Size sample);
+
+    //! True if all quantities had converged at the last check
+    bool converged() const { return converged_; }
+    //! Number of samples added to the estimators
+    Size samples() const { return samples_; }
+    //! Estimates by netting set and quantity (EPE, ENE, CVA)
+    std::map<std::pair<std::string, std::string>, Estimate> estimates() const;
+
+private:
+    typedef boost::accumulators::accumulator_set<
+        Real, boost::accumulators::stats<boost::accumulators::tag::mean,
+                                         boost::accumulators::tag::error_of<boost::accumulators::tag::mean>>>
+        Accumulator;
+
+    bool check() const;
+
+    Real relativeTolerance_, absoluteTolerance_;
+    Size minSamples_, checkFrequency_;
+    std::vector<std::string> nettingSets_;
+    // netting set index of each trade in the cube
+    std::vector<Size> tradeNettingSet_;
+    // time weights of the cube dates for the time averaged exposures
+    std::vector<Real> timeWeights_;
+    // cva weights per netting set index, empty if not monitored
+    std::vector<std::vector<Real>> cvaWeights_;
+    std::vector<Accumulator> epe_, ene_, cva_;
+    Size samples_;
+    bool converged_;
+};
+
+} // namespace analytics
+} // namespace ore
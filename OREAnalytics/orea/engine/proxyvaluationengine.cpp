@@ -0,0 +1,420 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/cube/inmemorycube.hpp>
+#include <orea/engine/observationmode.hpp>
+#include <orea/engine/proxyvaluationengine.hpp>
+#include <orea/engine/valuationengine.hpp>
+#include <orea/scenario/deltascenario.hpp>
+#include <orea/scenario/scenariogenerator.hpp>
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/profiler.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace QuantLib;
+using namespace std;
+using namespace ore::data;
+
+namespace ore {
+namespace analytics {
+
+namespace {
+
+// a read only view of a scenario on another date with unit numeraire
+class DatedScenario : public Scenario {
+public:
+    DatedScenario(const boost::shared_ptr<Scenario>& scenario, const Date& asof) : scenario_(scenario), asof_(asof) {}
+    const Date& asof() const override { return asof_; }
+    const string& label() const override { return scenario_->label(); }
+    void label(const string&) override { QL_FAIL("DatedScenario::label() is read only"); }
+    Real getNumeraire() const override { return 1.0; }
+    void setNumeraire(Real) override { QL_FAIL("DatedScenario::setNumeraire() is read only"); }
+    bool has(const RiskFactorKey& key) const override { return scenario_->has(key); }
+    const vector<RiskFactorKey>& keys() const override { return scenario_->keys(); }
+    void add(const RiskFactorKey&, Real) override { QL_FAIL("DatedScenario::add() is read only"); }
+    Real get(const RiskFactorKey& key) const override { return scenario_->get(key); }
+    boost::shared_ptr<const vector<RiskFactorKey>> sharedKeys() const override { return scenario_->sharedKeys(); }
+    const Real* values() const override { return scenario_->values(); }
+    boost::shared_ptr<Scenario> clone() const override { return boost::make_shared<DatedScenario>(*this); }
+
+private:
+    boost::shared_ptr<Scenario> scenario_;
+    Date asof_;
+};
+
+// sample 0 is the base scenario on the given dates, samples 2 * i + 1 and 2 * i + 2 shift factor i up and down
+class ShiftedScenarioGenerator : public ScenarioGenerator {
+public:
+    ShiftedScenarioGenerator(const boost::shared_ptr<Scenario>& base, const vector<Date>& dates,
+                             const vector<RiskFactorKey>& factors, const vector<Real>& up, const vector<Real>& down)
+        : dates_(dates), factors_(factors), up_(up), down_(down), calls_(0) {
+        for (auto const& d : dates_)
+            bases_.push_back(boost::make_shared<DatedScenario>(base, d));
+    }
+    boost::shared_ptr<Scenario> next(const Date& d) override {
+        Size sample = calls_ / dates_.size(), j = calls_ % dates_.size();
+        ++calls_;
+        QL_REQUIRE(d == dates_[j], "ShiftedScenarioGenerator: date " << d << " does not match " << dates_[j]);
+        // only the shifted quote is updated when the scenario is applied on top of the base scenario
+        boost::shared_ptr<Scenario> s = boost::make_shared<DeltaScenario>(bases_[j], "", 1.0);
+        if (sample > 0) {
+            Size f = (sample - 1) / 2;
+            s->add(factors_[f], sample % 2 == 1 ? up_[f] : down_[f]);
+        }
+        return s;
+    }
+    void reset() override { calls_ = 0; }
+
+private:
+    vector<Date> dates_;
+    vector<RiskFactorKey> factors_;
+    vector<Real> up_, down_;
+    vector<boost::shared_ptr<Scenario>> bases_;
+    Size calls_;
+};
+
+// passes the scenarios of a generator on and keeps the last one
+class RecordingScenarioGenerator : public ScenarioGenerator {
+public:
+    RecordingScenarioGenerator(const boost::shared_ptr<ScenarioGenerator>& src) : src_(src) {}
+    boost::shared_ptr<Scenario> next(const Date& d) override {
+        last_ = src_->next(d);
+        return last_;
+    }
+    void reset() override { src_->reset(); }
+    void skip(Size n) override { src_->skip(n); }
+    const boost::shared_ptr<Scenario>& last() const { return last_; }
+
+private:
+    boost::shared_ptr<ScenarioGenerator> src_;
+    boost::shared_ptr<Scenario> last_;
+};
+
+// replaces the scenario generator and optionally detaches the aggregation scenario data of the sim market
+class SimMarketGuard {
+public:
+    SimMarketGuard(const boost::shared_ptr<ScenarioSimMarket>& simMarket,
+                   const boost::shared_ptr<ScenarioGenerator>& generator, bool detachScenarioData)
+        : simMarket_(simMarket), generator_(simMarket->scenarioGenerator()),
+          scenarioData_(simMarket->aggregationScenarioData()) {
+        simMarket_->scenarioGenerator() = generator;
+        if (detachScenarioData)
+            simMarket_->aggregationScenarioData() = boost::shared_ptr<AggregationScenarioData>();
+    }
+    ~SimMarketGuard() {
+        simMarket_->scenarioGenerator() = generator_;
+        simMarket_->aggregationScenarioData() = scenarioData_;
+    }
+
+private:
+    boost::shared_ptr<ScenarioSimMarket> simMarket_;
+    boost::shared_ptr<ScenarioGenerator> generator_;
+    boost::shared_ptr<AggregationScenarioData> scenarioData_;
+};
+
+bool logFactor(const RiskFactorKey::KeyType type) {
+    switch (type) {
+    case RiskFactorKey::KeyType::DiscountCurve:
+    case RiskFactorKey::KeyType::YieldCurve:
+    case RiskFactorKey::KeyType::IndexCurve:
+    case RiskFactorKey::KeyType::DividendYield:
+    case RiskFactorKey::KeyType::SurvivalProbability:
+    case RiskFactorKey::KeyType::FXSpot:
+    case RiskFactorKey::KeyType::EquitySpot:
+        return true;
+    default:
+        return false;
+    }
+}
+
+Real shiftSize(const RiskFactorKey::KeyType type) {
+    switch (type) {
+    case RiskFactorKey::KeyType::FXSpot:
+    case RiskFactorKey::KeyType::EquitySpot:
+        // 1% relative
+        return 0.01;
+    case RiskFactorKey::KeyType::DiscountCurve:
+    case RiskFactorKey::KeyType::YieldCurve:
+    case RiskFactorKey::KeyType::IndexCurve:
+    case RiskFactorKey::KeyType::DividendYield:
+    case RiskFactorKey::KeyType::SurvivalProbability:
+        // 1bp in the zero rate on a one year horizon
+        return 0.0001;
+    default:
+        return 0.001;
+    }
+}
+
+} // namespace
+
+DeltaGammaProxy::DeltaGammaProxy(Size numTrades, Size numFactors)
+    : numTrades_(numTrades), numFactors_(numFactors), deltas_(numTrades * numFactors, 0.0),
+      gammas_(numTrades * numFactors, 0.0), relevant_(numFactors, false) {}
+
+void DeltaGammaProxy::setSensitivities(Size factor, Real shiftSize, const vector<Real>& base, const vector<Real>& up,
+                                       const vector<Real>& down) {
+    QL_REQUIRE(factor < numFactors_, "DeltaGammaProxy: factor " << factor << " out of range");
+    QL_REQUIRE(shiftSize > 0.0, "DeltaGammaProxy: shift size must be positive");
+    QL_REQUIRE(base.size() == numTrades_ && up.size() == numTrades_ && down.size() == numTrades_,
+               "DeltaGammaProxy: " << numTrades_ << " values expected");
+    relevant_[factor] = false;
+    for (Size t = 0; t < numTrades_; ++t) {
+        Real delta = (up[t] - down[t]) / (2.0 * shiftSize);
+        Real gamma = (up[t] - 2.0 * base[t] + down[t]) / (shiftSize * shiftSize);
+        deltas_[factor * numTrades_ + t] = delta;
+        gammas_[factor * numTrades_ + t] = gamma;
+        if (delta != 0.0 || gamma != 0.0)
+            relevant_[factor] = true;
+    }
+}
+
+Size DeltaGammaProxy::numRelevantFactors() const { return std::count(relevant_.begin(), relevant_.end(), true); }
+
+void DeltaGammaProxy::evaluate(const vector<Real>& base, const Real* moves, Size samples, vector<Real>& result) const {
+    QL_REQUIRE(base.size() == numTrades_, "DeltaGammaProxy: " << numTrades_ << " base values expected");
+    result.resize(samples * numTrades_);
+    for (Size k = 0; k < samples; ++k) {
+        Real* r = result.data() + k * numTrades_;
+        std::copy(base.begin(), base.end(), r);
+        const Real* m = moves + k * numFactors_;
+        for (Size f = 0; f < numFactors_; ++f) {
+            Real x = m[f];
+            if (!relevant_[f] || x == 0.0)
+                continue;
+            Real x2 = 0.5 * x * x;
+            const Real* delta = deltas_.data() + f * numTrades_;
+            const Real* gamma = gammas_.data() + f * numTrades_;
+            for (Size t = 0; t < numTrades_; ++t)
+                r[t] += x * delta[t] + x2 * gamma[t];
+        }
+    }
+}
+
+ProxyValuationEngine::ProxyValuationEngine(const Date& today, const boost::shared_ptr<DateGrid>& dg,
+                                           const boost::shared_ptr<ScenarioSimMarket>& simMarket,
+                                           const vector<Date>& sensitivityDates,
+                                           const set<RiskFactorKey::KeyType>& riskFactorTypes,
+                                           const set<string>& fullRevaluationTrades, const Size blockSize)
+    : today_(today), dg_(dg), simMarket_(simMarket), sensitivityDates_(sensitivityDates),
+      riskFactorTypes_(riskFactorTypes), fullRevaluationTrades_(fullRevaluationTrades), blockSize_(blockSize) {
+    QL_REQUIRE(dg_->size() > 0, "ProxyValuationEngine: DateGrid size must be > 0");
+    QL_REQUIRE(simMarket_, "ProxyValuationEngine: Null SimMarket");
+    QL_REQUIRE(blockSize_ > 0, "ProxyValuationEngine: block size must be positive");
+    std::sort(sensitivityDates_.begin(), sensitivityDates_.end());
+    sensitivityDates_.erase(std::unique(sensitivityDates_.begin(), sensitivityDates_.end()), sensitivityDates_.end());
+    if (sensitivityDates_.empty())
+        sensitivityDates_.push_back(dg_->dates().front());
+    QL_REQUIRE(sensitivityDates_.front() > today_, "ProxyValuationEngine: sensitivity dates must be after today ("
+                                                       << today_ << ")");
+}
+
+set<RiskFactorKey::KeyType> ProxyValuationEngine::defaultRiskFactorTypes() {
+    return {RiskFactorKey::KeyType::DiscountCurve, RiskFactorKey::KeyType::YieldCurve,
+            RiskFactorKey::KeyType::IndexCurve, RiskFactorKey::KeyType::FXSpot, RiskFactorKey::KeyType::EquitySpot};
+}
+
+boost::shared_ptr<NPVCube> ProxyValuationEngine::shiftedValues(
+    const boost::shared_ptr<Portfolio>& portfolio, const vector<Date>& dates, const vector<RiskFactorKey>& factors,
+    const vector<Real>& up, const vector<Real>& down, const boost::shared_ptr<ValuationCalculator>& npvCalculator) {
+    boost::shared_ptr<NPVCube> cube =
+        boost::make_shared<DoublePrecisionInMemoryCube>(today_, portfolio->ids(), dates, 1 + 2 * factors.size());
+    boost::shared_ptr<ScenarioGenerator> generator =
+        boost::make_shared<ShiftedScenarioGenerator>(simMarket_->baseScenario(), dates, factors, up, down);
+    SimMarketGuard guard(simMarket_, generator, true);
+    ValuationEngine engine(today_, boost::make_shared<DateGrid>(dates), simMarket_);
+    engine.buildCube(portfolio, cube, {npvCalculator});
+    return cube;
+}
+
+void ProxyValuationEngine::buildCube(const boost::shared_ptr<Portfolio>& portfolio,
+                                     boost::shared_ptr<NPVCube> outputCube,
+                                     vector<boost::shared_ptr<ValuationCalculator>> calculators) {
+
+    QL_REQUIRE(portfolio->size() > 0, "ProxyValuationEngine: portfolio is empty");
+    QL_REQUIRE(!calculators.empty(), "ProxyValuationEngine: no calculators given");
+    QL_REQUIRE(outputCube->numIds() == portfolio->size(), "cube x dimension (" << outputCube->numIds()
+                                                                               << ") different from portfolio size ("
+                                                                               << portfolio->size() << ")");
+    QL_REQUIRE(outputCube->numDates() == dg_->size(), "cube y dimension (" << outputCube->numDates()
+                                                                            << ") different from number of time steps ("
+                                                                            << dg_->size() << ")");
+
+    // the fully revalued trades read the simulated fixings of the sim market's overlay, see ValuationEngine
+    QuantExt::FixingOverlayScope fixingOverlayScope(simMarket_->fixingManager()->overlay().get());
+
+    const vector<Date>& dates = dg_->dates();
+    const auto& trades = portfolio->trades();
+
+    // T0 values
+    for (Size i = 0; i < trades.size(); ++i) {
+        for (auto calc : calculators)
+            calc->calculateT0(trades[i], i, simMarket_, outputCube);
+    }
+
+    // proxied and fully revalued trades with their cube indices
+    boost::shared_ptr<Portfolio> proxyPortfolio = boost::make_shared<Portfolio>();
+    vector<Size> proxyIndex, fullIndex;
+    for (Size i = 0; i < trades.size(); ++i) {
+        if (fullRevaluationTrades_.find(trades[i]->id()) != fullRevaluationTrades_.end()) {
+            fullIndex.push_back(i);
+        } else {
+            proxyPortfolio->add(trades[i]);
+            proxyIndex.push_back(i);
+        }
+    }
+    LOG("ProxyValuationEngine: " << proxyIndex.size() << " proxied and " << fullIndex.size()
+                                 << " fully revalued trades");
+
+    // risk factors and their base values
+    boost::shared_ptr<Scenario> baseScenario = simMarket_->baseScenario();
+    vector<RiskFactorKey> factors;
+    vector<Real> baseValues, shifts, up, down;
+    vector<bool> logFactors;
+    for (auto const& key : baseScenario->keys()) {
+        if (riskFactorTypes_.find(key.keytype) == riskFactorTypes_.end())
+            continue;
+        Real v = baseScenario->get(key);
+        bool log = logFactor(key.keytype);
+        if (log && v <= 0.0) {
+            WLOG("ProxyValuationEngine: skip risk factor " << key << " with non-positive base value " << v);
+            continue;
+        }
+        Real h = shiftSize(key.keytype);
+        factors.push_back(key);
+        baseValues.push_back(v);
+        shifts.push_back(h);
+        logFactors.push_back(log);
+        up.push_back(log ? v * std::exp(h) : v + h);
+        down.push_back(log ? v * std::exp(-h) : v - h);
+    }
+    Size numTrades = proxyIndex.size(), numFactors = factors.size(), numDates = dates.size();
+
+    // sensitivity date used on each simulation date
+    vector<Size> anchor(numDates, 0);
+    for (Size j = 0; j < numDates; ++j) {
+        while (anchor[j] + 1 < sensitivityDates_.size() && sensitivityDates_[anchor[j] + 1] <= dates[j])
+            ++anchor[j];
+    }
+
+    // base values on the simulation dates and sensitivities on the sensitivity dates
+    vector<vector<Real>> baseNpvs(numDates, vector<Real>(numTrades, 0.0));
+    vector<DeltaGammaProxy> proxies;
+    if (numTrades > 0) {
+        ORE_PROFILE_SCOPE("ProxyValuationEngine", "Sensitivities");
+        boost::shared_ptr<NPVCube> baseCube = shiftedValues(proxyPortfolio, dates, {}, {}, {}, calculators.front());
+        for (Size j = 0; j < numDates; ++j)
+            for (Size t = 0; t < numTrades; ++t)
+                baseNpvs[j][t] = baseCube->get(t, j, 0);
+        boost::shared_ptr<NPVCube> sensiCube =
+            shiftedValues(proxyPortfolio, sensitivityDates_, factors, up, down, calculators.front());
+        vector<Real> base(numTrades), upNpvs(numTrades), downNpvs(numTrades);
+        for (Size a = 0; a < sensitivityDates_.size(); ++a) {
+            proxies.push_back(DeltaGammaProxy(numTrades, numFactors));
+            for (Size t = 0; t < numTrades; ++t)
+                base[t] = sensiCube->get(t, a, 0);
+            for (Size f = 0; f < numFactors; ++f) {
+                for (Size t = 0; t < numTrades; ++t) {
+                    upNpvs[t] = sensiCube->get(t, a, 2 * f + 1);
+                    downNpvs[t] = sensiCube->get(t, a, 2 * f + 2);
+                }
+                proxies.back().setSensitivities(f, shifts[f], base, upNpvs, downNpvs);
+            }
+            LOG("ProxyValuationEngine: " << proxies.back().numRelevantFactors() << " of " << numFactors
+                                         << " risk factors are relevant on " << sensitivityDates_[a]);
+        }
+    }
+    if (numTrades > 0 && outputCube->depth() > 1)
+        WLOG("ProxyValuationEngine: the cube depths > 0 of the proxied trades are set to zero");
+
+    // fully revalued trades
+    ObservationMode::Mode om = ObservationMode::instance().mode();
+    boost::shared_ptr<Portfolio> fullPortfolio = boost::make_shared<Portfolio>();
+    for (auto i : fullIndex) {
+        fullPortfolio->add(trades[i]);
+        trades[i]->instrument()->initialise(dates);
+    }
+    if (!fullIndex.empty())
+        simMarket_->fixingManager()->initialise(fullPortfolio);
+
+    // the scenarios of the sim market's generator are recorded to collect the risk factor moves
+    boost::shared_ptr<RecordingScenarioGenerator> recorder =
+        boost::make_shared<RecordingScenarioGenerator>(simMarket_->scenarioGenerator());
+    SimMarketGuard guard(simMarket_, recorder, false);
+
+    // moves and numeraires of a block of samples, by date
+    vector<Real> moves(numDates * blockSize_ * numFactors), numeraires(numDates * blockSize_), result;
+    Size samples = outputCube->samples();
+    for (Size sample = 0; sample < samples; ++sample) {
+        updateProgress(sample, samples);
+        Size b = sample % blockSize_;
+
+        for (auto i : fullIndex)
+            trades[i]->instrument()->reset();
+
+        for (Size j = 0; j < numDates; ++j) {
+            {
+                ORE_PROFILE_SCOPE("ProxyValuationEngine", "SimMarketUpdate");
+                simMarket_->update(dates[j]);
+            }
+            const boost::shared_ptr<Scenario>& s = recorder->last();
+            numeraires[j * blockSize_ + b] = s->getNumeraire();
+            Real* m = moves.data() + (j * blockSize_ + b) * numFactors;
+            for (Size f = 0; f < numFactors; ++f) {
+                Real v = s->has(factors[f]) ? s->get(factors[f]) : baseValues[f];
+                m[f] = logFactors[f] ? std::log(v / baseValues[f]) : v - baseValues[f];
+            }
+
+            for (auto i : fullIndex) {
+                ORE_PROFILE_SCOPE("Pricing", trades[i]->tradeType());
+                if (om == ObservationMode::Mode::Disable)
+                    trades[i]->instrument()->updateQlInstruments();
+                for (auto calc : calculators)
+                    calc->calculate(trades[i], i, simMarket_, outputCube, dates[j], j, sample);
+            }
+        }
+        simMarket_->fixingManager()->reset();
+
+        // evaluate the Taylor expansions once the block is complete
+        if (numTrades > 0 && (b + 1 == blockSize_ || sample + 1 == samples)) {
+            ORE_PROFILE_SCOPE("ProxyValuationEngine", "TaylorExpansion");
+            Size first = sample - b, n = b + 1;
+            for (Size j = 0; j < numDates; ++j) {
+                proxies[anchor[j]].evaluate(baseNpvs[j], moves.data() + j * blockSize_ * numFactors, n, result);
+                for (Size k = 0; k < n; ++k) {
+                    Real numeraire = numeraires[j * blockSize_ + k];
+                    for (Size t = 0; t < numTrades; ++t) {
+                        outputCube->set(result[k * numTrades + t] / numeraire, proxyIndex[t], j, first + k, 0);
+                        for (Size d = 1; d < outputCube->depth(); ++d)
+                            outputCube->set(0.0, proxyIndex[t], j, first + k, d);
+                    }
+                }
+            }
+        }
+    }
+
+    simMarket_->reset();
+    updateProgress(samples, samples);
+    LOG("ProxyValuationEngine completed");
+}
+
+} // namespace analytics
+} // namespace ore
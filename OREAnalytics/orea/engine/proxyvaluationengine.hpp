@@ -0,0 +1,153 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file engine/proxyvaluationengine.hpp
+    \brief Delta-gamma proxy valuation engine for approximate NPV cubes
+    \ingroup simulation
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+#include <orea/engine/valuationcalculator.hpp>
+#include <orea/scenario/scenario.hpp>
+#include <orea/scenario/scenariosimmarket.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/utilities/dategrid.hpp>
+#include <ored/utilities/progressbar.hpp>
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Delta-gamma Taylor expansion of the values of a set of trades in a set of risk factors
+/*! The deltas and gammas are stored factor by factor, each as a contiguous row over the trades, so that the
+    expansion for a block of samples is a product of the (samples x factors) matrix of risk factor moves and the
+    (factors x trades) sensitivity matrices. Factors to which no trade is sensitive are skipped.
+
+    \ingroup simulation
+*/
+class DeltaGammaProxy {
+public:
+    DeltaGammaProxy(QuantLib::Size numTrades, QuantLib::Size numFactors);
+
+    //! Set the sensitivities of a factor from the trade values under central shifts of size \p shiftSize
+    void setSensitivities(QuantLib::Size factor, QuantLib::Real shiftSize, const std::vector<QuantLib::Real>& base,
+                          const std::vector<QuantLib::Real>& up, const std::vector<QuantLib::Real>& down);
+
+    /*! Values base + delta * move + 1/2 * gamma * move^2 summed over the factors, \p moves holds the risk factor
+        moves of \p samples samples (row major, samples x factors), \p result is resized to samples x trades */
+    void evaluate(const std::vector<QuantLib::Real>& base, const QuantLib::Real* moves, QuantLib::Size samples,
+                  std::vector<QuantLib::Real>& result) const;
+
+    QuantLib::Size numTrades() const { return numTrades_; }
+    QuantLib::Size numFactors() const { return numFactors_; }
+    //! number of factors to which at least one trade is sensitive
+    QuantLib::Size numRelevantFactors() const;
+    QuantLib::Real delta(QuantLib::Size trade, QuantLib::Size factor) const {
+        return deltas_[factor * numTrades_ + trade];
+    }
+    QuantLib::Real gamma(QuantLib::Size trade, QuantLib::Size factor) const {
+        return gammas_[factor * numTrades_ + trade];
+    }
+
+private:
+    QuantLib::Size numTrades_, numFactors_;
+    std::vector<QuantLib::Real> deltas_, gammas_;
+    std::vector<bool> relevant_;
+};
+
+//! Proxy Valuation Engine
+/*!
+  Alternative to the ValuationEngine for fast, approximate NPV cubes. Instead of repricing each trade under each
+  scenario, the trade values are expanded to second order in the risk factors of the simulation market:
+
+  - the trades are valued once on all simulation dates with the base scenario of the simulation market, i.e. with
+    today's market rolled forward unchanged, which captures the ageing and the run-off of the trades
+  - at the given sensitivity dates the trades are revalued with each risk factor shifted up and down, which gives
+    the deltas and gammas (central differences, no cross gammas) that are used on the simulation dates up to the
+    next sensitivity date
+  - for each simulated scenario the moves of the risk factors against the base scenario are collected and the
+    Taylor expansions are evaluated for blocks of samples as matrix products, the results are deflated with the
+    scenario numeraire as in the NPVCalculator
+
+  The risk factors are the keys of the base scenario of the given types. Discount, index and yield curves,
+  dividend yield curves and survival probabilities are expanded in the logarithm of the discount factor, fx and
+  equity spots in the logarithm of the spot, all other factors in their value.
+
+  Trades flagged for full revaluation, e.g. highly non-linear ones, are repriced under each scenario with the given
+  calculators as in the ValuationEngine. For the proxied trades the cube is filled at depth 0 only, further depths
+  (e.g. the cash flows of the CashflowCalculator) are set to zero.
+
+  \ingroup simulation
+*/
+class ProxyValuationEngine : public ore::data::ProgressReporter {
+public:
+    //! Constructor
+    ProxyValuationEngine(
+        //! Valuation date
+        const QuantLib::Date& today,
+        //! Simulation date grid
+        const boost::shared_ptr<DateGrid>& dg,
+        //! Simulated market object, the trades must be linked to it
+        const boost::shared_ptr<ScenarioSimMarket>& simMarket,
+        //! Dates at which the sensitivities are computed, the first grid date is used if none are given
+        const std::vector<QuantLib::Date>& sensitivityDates = std::vector<QuantLib::Date>(),
+        //! Types of the risk factors in the Taylor expansions
+        const std::set<RiskFactorKey::KeyType>& riskFactorTypes = defaultRiskFactorTypes(),
+        //! Ids of the trades that are fully revalued under each scenario
+        const std::set<std::string>& fullRevaluationTrades = std::set<std::string>(),
+        //! Number of samples for which the Taylor expansions are evaluated in one go
+        const QuantLib::Size blockSize = 100);
+
+    //! Build NPV cube
+    void buildCube(
+        //! Portfolio to be priced
+        const boost::shared_ptr<data::Portfolio>& portfolio,
+        //! Object for storing the resulting NPV cube
+        boost::shared_ptr<analytics::NPVCube> outputCube,
+        //! Calculators for the T0 values and the fully revalued trades, the first one must be the NPVCalculator
+        std::vector<boost::shared_ptr<ValuationCalculator>> calculators);
+
+    //! Curves and spots
+    static std::set<RiskFactorKey::KeyType> defaultRiskFactorTypes();
+
+private:
+    // values of the given trades on the given dates under the base scenario (sample 0) and the scenarios with
+    // factor i set to the up value (sample 2 * i + 1) and the down value (sample 2 * i + 2)
+    boost::shared_ptr<NPVCube> shiftedValues(const boost::shared_ptr<data::Portfolio>& portfolio,
+                                             const std::vector<QuantLib::Date>& dates,
+                                             const std::vector<RiskFactorKey>& factors,
+                                             const std::vector<QuantLib::Real>& up,
+                                             const std::vector<QuantLib::Real>& down,
+                                             const boost::shared_ptr<ValuationCalculator>& npvCalculator);
+
+    QuantLib::Date today_;
+    boost::shared_ptr<DateGrid> dg_;
+    boost::shared_ptr<ScenarioSimMarket> simMarket_;
+    std::vector<QuantLib::Date> sensitivityDates_;
+    std::set<RiskFactorKey::KeyType> riskFactorTypes_;
+    std::set<std::string> fullRevaluationTrades_;
+    QuantLib::Size blockSize_;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -20,7 +20,7 @@
 #include <orea/cube/sensicube.hpp>
 #include <orea/engine/sensitivityanalysis.hpp>
 #include <orea/engine/valuationengine.hpp>
-#include <orea/scenario/clonescenariofactory.hpp>
+#include <orea/scenario/deltascenariofactory.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/osutils.hpp>
 #include <ored/utilities/to_string.hpp>
@@ -129,7 +129,7 @@ void SensitivityAnalysis::initializeSimMarket(boost::shared_ptr<ScenarioFactory>
     LOG("Create scenario factory for sensitivity analysis");
     boost::shared_ptr<Scenario> baseScenario = simMarket_->baseScenario();
     boost::shared_ptr<ScenarioFactory> scenarioFactory =
-        scenFact ? scenFact : boost::make_shared<CloneScenarioFactory>(baseScenario);
+        scenFact ? scenFact : boost::make_shared<DeltaScenarioFactory>(baseScenario);
     LOG("Scenario factory created for sensitivity analysis");
 
     LOG("Create scenario generator for sensitivity analysis (continueOnError=" << std::boolalpha << continueOnError_
@@ -0,0 +1,264 @@
+/*
+ Copyright (C) 2017 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/engine/sensitivitybinaryfile.hpp>
+#include <ored/utilities/log.hpp>
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+using std::string;
+
+namespace ore {
+namespace analytics {
+
+namespace {
+
+const char magic[8] = {'O', 'R', 'E', 'S', 'E', 'N', 'S', 'I'};
+const boost::uint32_t version = 1;
+const boost::uint32_t byteOrderMark = 0x01020304;
+const QuantLib::Size recordSize = sizeof(SensitivityBinaryFileRecord);
+
+static_assert(sizeof(SensitivityBinaryFileHeader) == 64, "unexpected binary sensitivity file header size");
+static_assert(sizeof(SensitivityBinaryFileRecord) == 64, "unexpected binary sensitivity file record size");
+
+// Reads values from the mapped dictionary, checking the bounds
+class DictionaryReader {
+public:
+    DictionaryReader(const char* begin, const char* end) : pos_(begin), end_(end) {}
+    template <class T> T get() {
+        T value;
+        QL_REQUIRE(static_cast<QuantLib::Size>(end_ - pos_) >= sizeof(T),
+                   "binary sensitivity file: corrupt dictionary");
+        std::memcpy(&value, pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+    string getString(QuantLib::Size length) {
+        QL_REQUIRE(static_cast<QuantLib::Size>(end_ - pos_) >= length, "binary sensitivity file: corrupt dictionary");
+        string s(pos_, length);
+        pos_ += length;
+        return s;
+    }
+
+private:
+    const char* pos_;
+    const char* end_;
+};
+
+template <class T> void put(std::ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+} // namespace
+
+bool isSensitivityBinaryFile(const string& fileName) {
+    std::ifstream file(fileName.c_str(), std::ios::binary);
+    char buffer[sizeof(magic)];
+    return file.read(buffer, sizeof(magic)) && std::equal(buffer, buffer + sizeof(magic), magic);
+}
+
+SensitivityBinaryFileWriter::SensitivityBinaryFileWriter(const string& fileName) : fileName_(fileName), records_(0) {
+    file_.open(fileName.c_str(), std::ios::binary | std::ios::trunc);
+    QL_REQUIRE(file_.is_open(), "error opening file " << fileName);
+    // placeholder for the header, written on close()
+    SensitivityBinaryFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    put(file_, header);
+}
+
+SensitivityBinaryFileWriter::~SensitivityBinaryFileWriter() {
+    if (file_.is_open()) {
+        try {
+            close();
+        } catch (const std::exception& e) {
+            ALOG("Error closing binary sensitivity file " << fileName_ << ": " << e.what());
+        }
+    }
+}
+
+boost::uint32_t SensitivityBinaryFileWriter::stringCode(const string& s) {
+    auto it = stringCodes_.find(s);
+    if (it != stringCodes_.end())
+        return it->second;
+    boost::uint32_t code = static_cast<boost::uint32_t>(strings_.size());
+    strings_.push_back(s);
+    stringCodes_[s] = code;
+    return code;
+}
+
+boost::uint32_t SensitivityBinaryFileWriter::factorCode(const RiskFactorKey& key, const string& desc) {
+    auto f = std::make_pair(key, desc);
+    auto it = factorCodes_.find(f);
+    if (it != factorCodes_.end())
+        return it->second;
+    boost::uint32_t code = static_cast<boost::uint32_t>(factors_.size());
+    factors_.push_back(f);
+    factorCodes_[f] = code;
+    return code;
+}
+
+void SensitivityBinaryFileWriter::add(const SensitivityRecord& sr) {
+    QL_REQUIRE(file_.is_open(), "binary sensitivity file " << fileName_ << " is closed");
+    SensitivityBinaryFileRecord r;
+    r.tradeId = stringCode(sr.tradeId);
+    r.currency = stringCode(sr.currency);
+    r.factor_1 = factorCode(sr.key_1, sr.desc_1);
+    r.factor_2 = factorCode(sr.key_2, sr.desc_2);
+    r.flags = sr.isPar ? 1 : 0;
+    r.reserved = 0;
+    r.shift_1 = sr.shift_1;
+    r.shift_2 = sr.shift_2;
+    r.baseNpv = sr.baseNpv;
+    r.delta = sr.delta;
+    r.gamma = sr.gamma;
+    put(file_, r);
+    ++records_;
+}
+
+void SensitivityBinaryFileWriter::add(const boost::shared_ptr<SensitivityStream>& ss) {
+    ss->reset();
+    while (SensitivityRecord sr = ss->next())
+        add(sr);
+}
+
+void SensitivityBinaryFileWriter::close() {
+    QL_REQUIRE(file_.is_open(), "binary sensitivity file " << fileName_ << " is closed");
+
+    SensitivityBinaryFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::copy(magic, magic + sizeof(magic), header.magic);
+    header.version = version;
+    header.byteOrderMark = byteOrderMark;
+    header.records = records_;
+    header.recordsOffset = sizeof(SensitivityBinaryFileHeader);
+    header.dictionaryOffset = header.recordsOffset + records_ * recordSize;
+
+    // the factor names and descriptions are added to the strings before the strings are written
+    std::vector<std::pair<boost::uint32_t, boost::uint32_t>> factorStrings;
+    for (auto const& f : factors_)
+        factorStrings.push_back(std::make_pair(stringCode(f.first.name), stringCode(f.second)));
+
+    put(file_, static_cast<boost::uint32_t>(strings_.size()));
+    for (auto const& s : strings_) {
+        put(file_, static_cast<boost::uint32_t>(s.size()));
+        file_.write(s.data(), s.size());
+    }
+    put(file_, static_cast<boost::uint32_t>(factors_.size()));
+    for (Size i = 0; i < factors_.size(); ++i) {
+        put(file_, static_cast<boost::uint32_t>(factors_[i].first.keytype));
+        put(file_, factorStrings[i].first);
+        put(file_, static_cast<boost::uint64_t>(factors_[i].first.index));
+        put(file_, factorStrings[i].second);
+        put(file_, boost::uint32_t(0));
+    }
+    header.dictionarySize = static_cast<boost::uint64_t>(file_.tellp()) - header.dictionaryOffset;
+
+    file_.seekp(0);
+    put(file_, header);
+    file_.close();
+    QL_REQUIRE(!file_.fail(), "error writing binary sensitivity file " << fileName_);
+    LOG("Wrote " << records_ << " records to binary sensitivity file " << fileName_);
+}
+
+SensitivityBinaryFileStream::SensitivityBinaryFileStream(const string& fileName, QuantLib::Size begin,
+                                                         QuantLib::Size end)
+    : mapping_(fileName.c_str(), boost::interprocess::read_only),
+      region_(mapping_, boost::interprocess::read_only), data_(static_cast<const char*>(region_.get_address())) {
+
+    QuantLib::Size size = region_.get_size();
+    SensitivityBinaryFileHeader header;
+    QL_REQUIRE(size >= sizeof(header), "binary sensitivity file " << fileName << " is too short");
+    std::memcpy(&header, data_, sizeof(header));
+    QL_REQUIRE(std::equal(magic, magic + sizeof(magic), header.magic),
+               "file " << fileName << " is not a binary sensitivity file");
+    QL_REQUIRE(header.version == version,
+               "binary sensitivity file " << fileName << " has unsupported version " << header.version);
+    QL_REQUIRE(header.byteOrderMark == byteOrderMark,
+               "binary sensitivity file " << fileName << " was written with a different byte order");
+    QL_REQUIRE(header.recordsOffset + header.records * recordSize == header.dictionaryOffset &&
+                   header.dictionaryOffset + header.dictionarySize == size,
+               "binary sensitivity file " << fileName << " is corrupt");
+
+    // decode the dictionary, the strings first since the factors refer to them
+    DictionaryReader reader(data_ + header.dictionaryOffset, data_ + size);
+    boost::uint32_t n = reader.get<boost::uint32_t>();
+    strings_.reserve(n);
+    for (boost::uint32_t i = 0; i < n; ++i)
+        strings_.push_back(reader.getString(reader.get<boost::uint32_t>()));
+    n = reader.get<boost::uint32_t>();
+    factors_.resize(n);
+    for (boost::uint32_t i = 0; i < n; ++i) {
+        factors_[i].first.keytype = static_cast<RiskFactorKey::KeyType>(reader.get<boost::uint32_t>());
+        boost::uint32_t name = reader.get<boost::uint32_t>();
+        factors_[i].first.index = static_cast<QuantLib::Size>(reader.get<boost::uint64_t>());
+        boost::uint32_t desc = reader.get<boost::uint32_t>();
+        reader.get<boost::uint32_t>();
+        QL_REQUIRE(name < strings_.size() && desc < strings_.size(),
+                   "binary sensitivity file " << fileName << ": corrupt factor dictionary");
+        factors_[i].first.name = strings_[name];
+        factors_[i].second = strings_[desc];
+    }
+
+    // the records starting within [begin, end)
+    fileRecords_ = header.records;
+    auto recordIndex = [&header, this](QuantLib::Size offset) {
+        if (offset <= header.recordsOffset)
+            return QuantLib::Size(0);
+        return std::min<QuantLib::Size>((offset - header.recordsOffset + recordSize - 1) / recordSize, fileRecords_);
+    };
+    first_ = recordIndex(begin);
+    last_ = std::max(first_, recordIndex(end));
+    data_ += header.recordsOffset;
+    current_ = first_;
+    DLOG("Streaming records " << first_ << " to " << last_ << " of " << fileRecords_
+                              << " from binary sensitivity file " << fileName);
+}
+
+SensitivityRecord SensitivityBinaryFileStream::next() {
+    SensitivityRecord sr;
+    if (current_ == last_)
+        return sr;
+
+    SensitivityBinaryFileRecord r;
+    std::memcpy(&r, data_ + current_ * recordSize, recordSize);
+    ++current_;
+
+    QL_REQUIRE(r.tradeId < strings_.size() && r.currency < strings_.size() && r.factor_1 < factors_.size() &&
+                   r.factor_2 < factors_.size(),
+               "binary sensitivity file: corrupt record " << current_ - 1);
+    sr.tradeId = strings_[r.tradeId];
+    sr.isPar = (r.flags & 1) != 0;
+    sr.key_1 = factors_[r.factor_1].first;
+    sr.desc_1 = factors_[r.factor_1].second;
+    sr.shift_1 = r.shift_1;
+    sr.key_2 = factors_[r.factor_2].first;
+    sr.desc_2 = factors_[r.factor_2].second;
+    sr.shift_2 = r.shift_2;
+    sr.currency = strings_[r.currency];
+    sr.baseNpv = r.baseNpv;
+    sr.delta = r.delta;
+    sr.gamma = r.gamma;
+    return sr;
+}
+
+void SensitivityBinaryFileStream::reset() { current_ = first_; }
+
+} // namespace analytics
+} // namespace ore
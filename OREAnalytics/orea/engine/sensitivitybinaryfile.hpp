@@ -0,0 +1,150 @@
+/*
+ Copyright (C) 2017 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/engine/sensitivitybinaryfile.hpp
+    \brief Binary file format for SensitivityRecords with writer and stream
+ */
+
+#pragma once
+
+#include <orea/engine/sensitivitystream.hpp>
+
+#include <boost/cstdint.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <fstream>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+/*! Layout of the binary sensitivity file, all numbers in the byte order of the writing machine:
+
+    - a header of 64 bytes, see SensitivityBinaryFileHeader
+    - the records of 64 bytes each, see SensitivityBinaryFileRecord, starting at byte 64
+    - the dictionary following the records: the number of strings (uint32) followed by each string as its
+      length (uint32) and characters, then the number of factors (uint32) followed by each factor as key type
+      (uint32), name (uint32 string code), index (uint64) and description (uint32 string code) plus 4 bytes
+      padding
+
+    Trade ids and currencies are stored as codes into the strings, the risk factor keys and descriptions as
+    codes into the factors. Since the records have a fixed width, a file can be split into byte ranges that
+    are read in parallel, see SensitivityBinaryFileStream.
+*/
+struct SensitivityBinaryFileHeader {
+    char magic[8];
+    boost::uint32_t version;
+    boost::uint32_t byteOrderMark;
+    boost::uint64_t records;
+    boost::uint64_t recordsOffset;
+    boost::uint64_t dictionaryOffset;
+    boost::uint64_t dictionarySize;
+    boost::uint64_t reserved[2];
+};
+
+//! Fixed width record of the binary sensitivity file
+struct SensitivityBinaryFileRecord {
+    boost::uint32_t tradeId;
+    boost::uint32_t currency;
+    boost::uint32_t factor_1;
+    boost::uint32_t factor_2;
+    //! bit 0 is set for par sensitivities
+    boost::uint32_t flags;
+    boost::uint32_t reserved;
+    double shift_1;
+    double shift_2;
+    double baseNpv;
+    double delta;
+    double gamma;
+};
+
+//! Returns true if the file \p fileName starts with the header of a binary sensitivity file
+bool isSensitivityBinaryFile(const std::string& fileName);
+
+//! Class for writing SensitivityRecords to a binary sensitivity file
+class SensitivityBinaryFileWriter {
+public:
+    //! Constructor providing the path to the binary file \p fileName
+    SensitivityBinaryFileWriter(const std::string& fileName);
+    //! Destructor, closes the file if not done yet
+    ~SensitivityBinaryFileWriter();
+
+    //! Append a record to the file
+    void add(const SensitivityRecord& sr);
+    //! Append all records of the stream \p ss to the file, starting from the beginning of the stream
+    void add(const boost::shared_ptr<SensitivityStream>& ss);
+    //! Write the dictionary and the header, no records can be added afterwards
+    void close();
+
+    //! Number of records written so far
+    QuantLib::Size records() const { return records_; }
+
+private:
+    boost::uint32_t stringCode(const std::string& s);
+    boost::uint32_t factorCode(const RiskFactorKey& key, const std::string& desc);
+
+    std::string fileName_;
+    std::ofstream file_;
+    QuantLib::Size records_;
+    std::vector<std::string> strings_;
+    std::unordered_map<std::string, boost::uint32_t> stringCodes_;
+    std::vector<std::pair<RiskFactorKey, std::string>> factors_;
+    std::map<std::pair<RiskFactorKey, std::string>, boost::uint32_t> factorCodes_;
+};
+
+//! Class for streaming SensitivityRecords from a binary sensitivity file
+/*! The file is mapped into memory, the records are read from the mapping directly. Only the dictionary is
+    decoded when the stream is constructed.
+
+    The stream can be restricted to a byte range of the file: it then returns the records starting within
+    the range. Splitting the file size into consecutive ranges yields streams that together return each
+    record exactly once.
+*/
+class SensitivityBinaryFileStream : public SensitivityStream {
+public:
+    //! Constructor providing the path to the binary file \p fileName and the byte range [\p begin, \p end)
+    SensitivityBinaryFileStream(const std::string& fileName, QuantLib::Size begin = 0,
+                                QuantLib::Size end = std::numeric_limits<QuantLib::Size>::max());
+    //! Returns the next SensitivityRecord in the stream
+    SensitivityRecord next() override;
+    //! Resets the stream so that SensitivityRecord objects can be streamed again
+    void reset() override;
+
+    //! Number of records in the file
+    QuantLib::Size fileRecords() const { return fileRecords_; }
+    //! Number of records in the byte range of this stream
+    QuantLib::Size records() const { return last_ - first_; }
+
+private:
+    boost::interprocess::file_mapping mapping_;
+    boost::interprocess::mapped_region region_;
+    const char* data_;
+    QuantLib::Size fileRecords_, first_, last_, current_;
+    std::vector<std::string> strings_;
+    std::vector<std::pair<RiskFactorKey, std::string>> factors_;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -31,69 +31,69 @@ namespace analytics {
 using crossPair = SensitivityCube::crossPair;
 
 SensitivityCubeStream::SensitivityCubeStream(const boost::shared_ptr<SensitivityCube>& cube, const string& currency)
-    : cube_(cube), currency_(currency), upRiskFactor_(cube_->upFactors().begin()),
-      downRiskFactor_(cube_->downFactors().begin()), itCrossPair_(cube_->crossFactors().begin()),
-      tradeIdx_(cube_->tradeIdx().begin()) {}
+    : cube_(cube), currency_(currency), factorId_(0), crossFactorId_(0), tradeIdx_(cube_->tradeIdx().begin()),
+      tradeLoaded_(false) {}
+
+void SensitivityCubeStream::loadTrade() {
+    baseNpv_ = cube_->npv(tradeIdx_->second);
+    cube_->sensitivities(tradeIdx_->second, deltas_, gammas_, crossGammas_);
+    tradeLoaded_ = true;
+}
 
 SensitivityRecord SensitivityCubeStream::next() {
 
     SensitivityRecord sr;
 
-    // If exhausted deltas, gammas AND cross gammas, update to next trade and reset iterators
-    if (upRiskFactor_ == cube_->upFactors().end() && itCrossPair_ == cube_->crossFactors().end()) {
+    // If exhausted deltas, gammas AND cross gammas, update to next trade and reset factor ids
+    if (factorId_ == cube_->numberOfFactors() && crossFactorId_ == cube_->numberOfCrossFactors() &&
+        tradeIdx_ != cube_->tradeIdx().end()) {
         tradeIdx_++;
-        upRiskFactor_ = cube_->upFactors().begin();
-        downRiskFactor_ = cube_->downFactors().begin();
-        itCrossPair_ = cube_->crossFactors().begin();
+        factorId_ = 0;
+        crossFactorId_ = 0;
+        tradeLoaded_ = false;
     }
 
     // Give back next record if we have a valid trade index
     if (tradeIdx_ != cube_->tradeIdx().end()) {
-        Size tradeIdx = tradeIdx_->second;
+        if (!tradeLoaded_)
+            loadTrade();
         sr.tradeId = tradeIdx_->first;
         sr.isPar = false;
         sr.currency = currency_;
-        sr.baseNpv = cube_->npv(tradeIdx);
+        sr.baseNpv = baseNpv_;
 
         // Are there more deltas and gammas for current trade ID
-        if (upRiskFactor_ != cube_->upFactors().end()) {
-            Size usrx = upRiskFactor_->right.index;
-            sr.key_1 = upRiskFactor_->left;
-            sr.desc_1 = upRiskFactor_->right.factorDesc;
-            sr.shift_1 = upRiskFactor_->right.shiftSize;
-            sr.delta = cube_->delta(tradeIdx, usrx);
-            if (downRiskFactor_ != cube_->downFactors().end()) {
-                Size dsrx = downRiskFactor_->second.index;
-                sr.gamma = cube_->gamma(tradeIdx, usrx, dsrx);
-                downRiskFactor_++;
-            } else {
-                sr.gamma = Null<Real>(); // marks na result
-            }
-
-            upRiskFactor_++;
+        if (factorId_ < cube_->numberOfFactors()) {
+            const SensitivityCube::FactorData& fd = cube_->upFactorData(factorId_);
+            sr.key_1 = cube_->factorKey(factorId_);
+            sr.desc_1 = fd.factorDesc;
+            sr.shift_1 = fd.shiftSize;
+            sr.delta = deltas_[factorId_];
+            sr.gamma = gammas_[factorId_]; // Null<Real>() marks na result
+
+            factorId_++;
 
             TLOG("Next record is: " << sr);
             return sr;
         }
 
         // Are there more cross pairs for current trade ID
-        if (itCrossPair_ != cube_->crossFactors().end()) {
-            sr.key_1 = itCrossPair_->first.first;
-            sr.desc_1 = std::get<0>(itCrossPair_->second).factorDesc;
-            sr.shift_1 = std::get<0>(itCrossPair_->second).shiftSize;
+        if (crossFactorId_ < cube_->numberOfCrossFactors()) {
+            std::pair<Size, Size> ids = cube_->crossFactorIds(crossFactorId_);
+            const SensitivityCube::FactorData& fd_1 = cube_->upFactorData(ids.first);
+            const SensitivityCube::FactorData& fd_2 = cube_->upFactorData(ids.second);
 
-            sr.key_2 = itCrossPair_->first.second;
-            sr.desc_2 = std::get<1>(itCrossPair_->second).factorDesc;
-            sr.shift_2 = std::get<1>(itCrossPair_->second).shiftSize;
+            sr.key_1 = cube_->factorKey(ids.first);
+            sr.desc_1 = fd_1.factorDesc;
+            sr.shift_1 = fd_1.shiftSize;
 
-            Size id_1, id_2, id_x;
-            id_1 = std::get<0>(itCrossPair_->second).index;
-            id_2 = std::get<1>(itCrossPair_->second).index;
-            id_x = std::get<2>(itCrossPair_->second);
+            sr.key_2 = cube_->factorKey(ids.second);
+            sr.desc_2 = fd_2.factorDesc;
+            sr.shift_2 = fd_2.shiftSize;
 
-            sr.gamma = cube_->crossGamma(tradeIdx, id_1, id_2, id_x);
+            sr.gamma = crossGammas_[crossFactorId_];
 
-            itCrossPair_++;
+            crossFactorId_++;
 
             TLOG("Next record is: " << sr);
             return sr;
@@ -106,11 +106,11 @@ SensitivityRecord SensitivityCubeStream::next() {
 }
 
 void SensitivityCubeStream::reset() {
-    // Reset indices and iterators
+    // Reset indices and factor ids
     tradeIdx_ = cube_->tradeIdx().begin();
-    upRiskFactor_ = cube_->upFactors().begin();
-    downRiskFactor_ = cube_->downFactors().begin();
-    itCrossPair_ = cube_->crossFactors().begin();
+    factorId_ = 0;
+    crossFactorId_ = 0;
+    tradeLoaded_ = false;
 }
 
 } // namespace analytics
@@ -28,6 +28,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 namespace ore {
 namespace analytics {
@@ -51,20 +52,23 @@ public:
     void reset() override;
 
 private:
+    //! Load the sensitivities of the current trade from the cube
+    void loadTrade();
+
     //! Handle on the SensitivityCube
     boost::shared_ptr<SensitivityCube> cube_;
     //! Currency of the sensitivities in the SensitivityCube
     std::string currency_;
 
-    //! Iterator to risk factor keys in the cube
-    boost::bimap<RiskFactorKey, ore::analytics::SensitivityCube::FactorData>::const_iterator upRiskFactor_;
-    std::map<RiskFactorKey, ore::analytics::SensitivityCube::FactorData>::const_iterator downRiskFactor_;
-    //! Iterator to cross factors in the cube
-    std::map<ore::analytics::SensitivityCube::crossPair,
-             std::tuple<ore::analytics::SensitivityCube::FactorData, ore::analytics::SensitivityCube::FactorData,
-                        QuantLib::Size>>::const_iterator itCrossPair_;
+    //! Id of the current risk factor and cross factor in the cube
+    QuantLib::Size factorId_;
+    QuantLib::Size crossFactorId_;
     //! Index of current trade Id in the cube
     std::map<std::string, QuantLib::Size>::const_iterator tradeIdx_;
+    //! Sensitivities of the current trade, see SensitivityCube::sensitivities()
+    bool tradeLoaded_;
+    QuantLib::Real baseNpv_;
+    std::vector<QuantLib::Real> deltas_, gammas_, crossGammas_;
 };
 
 } // namespace analytics
@@ -28,6 +28,16 @@
 namespace ore {
 namespace analytics {
 
+namespace {
+// fx rate converting ccy into baseCcy, read from the cross rate matrix of the sim market
+Real fxRate(const boost::shared_ptr<SimMarket>& simMarket, const std::string& ccy, const std::string& baseCcy) {
+    if (ccy == baseCcy)
+        return 1.0;
+    boost::shared_ptr<FXCrossRates> crossRates = simMarket->fxCrossRates();
+    return crossRates->rate(crossRates->index(ccy), crossRates->index(baseCcy));
+}
+} // namespace
+
 void NPVCalculator::calculate(const boost::shared_ptr<Trade>& trade, Size tradeIndex,
                               const boost::shared_ptr<SimMarket>& simMarket, boost::shared_ptr<NPVCube>& outputCube,
                               const Date& date, Size dateIndex, Size sample) {
@@ -42,7 +52,7 @@ void NPVCalculator::calculateT0(const boost::shared_ptr<Trade>& trade, Size trad
 Real NPVCalculator::npv(const boost::shared_ptr<Trade>& trade, const boost::shared_ptr<SimMarket>& simMarket) {
     Real npv = 0;
     try {
-        Real fx = simMarket->fxSpot(trade->npvCurrency() + baseCcyCode_)->value();
+        Real fx = fxRate(simMarket, trade->npvCurrency(), baseCcyCode_);
         Real numeraire = simMarket->numeraire();
 
         npv = trade->instrument()->NPV() * fx / numeraire;
@@ -94,7 +104,7 @@ void CashflowCalculator::calculate(const boost::shared_ptr<Trade>& trade, Size t
                 }
                 if (legFlow != 0) {
                     // Do FX conversion and add to netFlow
-                    Real fx = simMarket->fxSpot(trade->legCurrencies()[i] + baseCcyCode_)->value();
+                    Real fx = fxRate(simMarket, trade->legCurrencies()[i], baseCcyCode_);
                     Real direction = trade->legPayers()[i] ? -1.0 : 1.0;
                     netFlow += legFlow * direction * longShort * fx;
                 }
@@ -16,6 +16,7 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <orea/engine/convergencemonitor.hpp>
 #include <orea/engine/observationmode.hpp>
 #include <orea/engine/valuationengine.hpp>
 #include <orea/simulation/simmarket.hpp>
@@ -23,6 +24,7 @@
 #include <ored/portfolio/portfolio.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/parsers.hpp>
+#include <ored/utilities/profiler.hpp>
 #include <ored/utilities/progressbar.hpp>
 
 #include <boost/timer/timer.hpp>
@@ -52,7 +54,9 @@ ValuationEngine::ValuationEngine(const Date& today, const boost::shared_ptr<Date
 
 void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfolio,
                                 boost::shared_ptr<analytics::NPVCube> outputCube,
-                                vector<boost::shared_ptr<ValuationCalculator>> calculators) {
+                                vector<boost::shared_ptr<ValuationCalculator>> calculators,
+                                const boost::shared_ptr<ConvergenceMonitor>& convergenceMonitor,
+                                const boost::shared_ptr<CubeCheckpoint>& checkpoint) {
 
     QL_REQUIRE(portfolio->size() > 0, "ValuationEngine: Error portfolio is empty");
 
@@ -64,6 +68,9 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
                "cube y dimension (" << outputCube->numDates() << ") "
                                     << "different from number of time steps (" << dg_->dates().size() << ")");
 
+    // the simulated fixings of a fixing manager with an overlay are visible to the pricers on this thread only
+    QuantExt::FixingOverlayScope fixingOverlayScope(simMarket_->fixingManager()->overlay().get());
+
     LOG("Starting ValuationEngine for " << portfolio->size() << " trades, " << outputCube->samples() << " samples and "
                                         << dg_->size() << " dates.");
 
@@ -110,12 +117,29 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
 
     simMarket_->fixingManager()->initialise(portfolio);
 
+    // resume after the samples completed in a previous run
+    Size firstSample = 0;
+    if (checkpoint) {
+        firstSample = checkpoint->restore(outputCube);
+        if (firstSample > 0) {
+            LOG("ValuationEngine: resume after " << firstSample << " samples restored from "
+                                                 << checkpoint->fileName());
+            simMarket_->skipSamples(firstSample);
+            for (Size sample = 0; convergenceMonitor && sample < firstSample; ++sample) {
+                if (convergenceMonitor->update(outputCube, sample) && sample + 1 < outputCube->samples()) {
+                    outputCube->truncateSamples(sample + 1);
+                    firstSample = sample + 1;
+                }
+            }
+        }
+    }
+
     cpu_timer timer;
     cpu_timer loopTimer;
 
     // We call Cube::samples() each time her to allow for dynamic stopping times
     // e.g. MC convergence tests
-    for (Size sample = 0; sample < outputCube->samples(); ++sample) {
+    for (Size sample = firstSample; sample < outputCube->samples(); ++sample) {
         updateProgress(sample, outputCube->samples());
 
         for (auto& trade : trades)
@@ -127,10 +151,14 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
 
             timer.start();
 
-            simMarket_->update(d);
+            {
+                ORE_PROFILE_SCOPE("ValuationEngine", "SimMarketUpdate");
+                simMarket_->update(d);
+            }
 
             // recalibrate models
             for (auto const& b : modelBuilders_) {
+                ORE_PROFILE_SCOPE("ValuationEngine", "ModelRecalibration");
                 if (om == ObservationMode::Mode::Disable)
                     b.second->forceRecalculate();
                 b.second->recalibrate();
@@ -143,6 +171,7 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
             timer.start();
             for (Size j = 0; j < trades.size(); ++j) {
                 auto trade = trades[j];
+                ORE_PROFILE_SCOPE("Pricing", trade->tradeType());
 
                 // We can avoid checking mode here and always call updateQlInstruments()
                 if (om == ObservationMode::Mode::Disable)
@@ -151,11 +180,25 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
                 for (auto calc : calculators)
                     calc->calculate(trade, j, simMarket_, outputCube, d, i, sample);
             }
+            // each calculator writes to the cube once per trade
+            ORE_PROFILE_COUNT("ValuationEngine", "CubeWrites", trades.size() * calculators.size());
             timer.stop();
             pricingTime += timer.elapsed().wall * 1e-9;
         }
 
+        // stop early and release the remaining samples once the exposure estimators have converged
+        if (convergenceMonitor && convergenceMonitor->update(outputCube, sample) &&
+            sample + 1 < outputCube->samples()) {
+            LOG("ValuationEngine: exposures converged after " << sample + 1 << " of " << outputCube->samples()
+                                                              << " samples");
+            outputCube->truncateSamples(sample + 1);
+        }
+
+        if (checkpoint)
+            checkpoint->update(outputCube, sample + 1);
+
         timer.start();
+        ORE_PROFILE_SCOPE("ValuationEngine", "FixingReset");
         simMarket_->fixingManager()->reset();
         fixingTime += timer.elapsed().wall * 1e-9;
     }
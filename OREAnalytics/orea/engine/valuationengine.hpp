@@ -23,7 +23,9 @@
 
 #pragma once
 
+#include <orea/cube/cubecheckpoint.hpp>
 #include <orea/cube/npvcube.hpp>
+#include <orea/engine/convergencemonitor.hpp>
 #include <orea/engine/valuationcalculator.hpp>
 #include <orea/simulation/simmarket.hpp>
 #include <ored/model/modelbuilder.hpp>
@@ -47,7 +49,12 @@ using std::set;
   The number of dates is defined by the DateGrid passed to the constructor.
   The number of trades is defined by the size of the portfolio passed to buildCube().
   The number of samples is defined by the NPVCube that is passed to buildCube(), this
-  can be dynamic.
+  can be dynamic: if a ConvergenceMonitor is given, the cube is truncated to the samples
+  generated so far as soon as the monitored exposures have converged.
+
+  If a CubeCheckpoint is given, the completed samples are written to the checkpoint file
+  periodically. A restarted run restores them, skips them in the scenario generator and
+  continues with the first sample that was not completed.
 
   In addition to storing the resulting NPVs it can be given any number of calculators
   that can store additional values in the cube.
@@ -75,7 +82,11 @@ public:
         //! Object for storing the resulting NPV cube
         boost::shared_ptr<analytics::NPVCube> outputCube,
         //! Calculators to use
-        std::vector<boost::shared_ptr<ValuationCalculator>> calculators);
+        std::vector<boost::shared_ptr<ValuationCalculator>> calculators,
+        //! Optional convergence monitor, the cube samples are truncated once it reports convergence
+        const boost::shared_ptr<ConvergenceMonitor>& convergenceMonitor = boost::shared_ptr<ConvergenceMonitor>(),
+        //! Optional checkpoint, the samples completed in a previous run are restored and skipped
+        const boost::shared_ptr<CubeCheckpoint>& checkpoint = boost::shared_ptr<CubeCheckpoint>());
 
 private:
     QuantLib::Date today_;
@@ -13,18 +13,24 @@
 #include <orea/app/reportwriter.hpp>
 #include <orea/app/sensitivityrunner.hpp>
 #include <orea/app/structuredanalyticserror.hpp>
+#include <orea/cube/cubecheckpoint.hpp>
+#include <orea/cube/cubemerge.hpp>
 #include <orea/cube/cubewriter.hpp>
 #include <orea/cube/inmemorycube.hpp>
 #include <orea/cube/npvcube.hpp>
 #include <orea/cube/npvsensicube.hpp>
 #include <orea/cube/sensicube.hpp>
 #include <orea/cube/sensitivitycube.hpp>
+#include <orea/engine/amcvaluationengine.hpp>
+#include <orea/engine/convergencemonitor.hpp>
 #include <orea/engine/filteredsensitivitystream.hpp>
 #include <orea/engine/observationmode.hpp>
 #include <orea/engine/parametricvar.hpp>
+#include <orea/engine/proxyvaluationengine.hpp>
 #include <orea/engine/riskfilter.hpp>
 #include <orea/engine/sensitivityaggregator.hpp>
 #include <orea/engine/sensitivityanalysis.hpp>
+#include <orea/engine/sensitivitybinaryfile.hpp>
 #include <orea/engine/sensitivitycubestream.hpp>
 #include <orea/engine/sensitivityfilestream.hpp>
 #include <orea/engine/sensitivityinmemorystream.hpp>
@@ -36,7 +42,10 @@
 #include <orea/scenario/aggregationscenariodata.hpp>
 #include <orea/scenario/clonescenariofactory.hpp>
 #include <orea/scenario/crossassetmodelscenariogenerator.hpp>
+#include <orea/scenario/deltascenario.hpp>
+#include <orea/scenario/deltascenariofactory.hpp>
 #include <orea/scenario/lgmscenariogenerator.hpp>
+#include <orea/scenario/pipelinedmultipathgenerator.hpp>
 #include <orea/scenario/scenario.hpp>
 #include <orea/scenario/scenariofactory.hpp>
 #include <orea/scenario/scenariogenerator.hpp>
@@ -44,6 +53,7 @@
 #include <orea/scenario/scenariogeneratordata.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/scenario/scenariosimmarketparameters.hpp>
+#include <orea/scenario/scenariostore.hpp>
 #include <orea/scenario/scenariowriter.hpp>
 #include <orea/scenario/sensitivityscenariodata.hpp>
 #include <orea/scenario/sensitivityscenariogenerator.hpp>
@@ -29,8 +29,11 @@
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
 #include <boost/serialization/map.hpp>
+#include <boost/serialization/utility.hpp>
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
 
+#include <algorithm>
 #include <fstream>
 #include <map>
 #include <vector>
@@ -45,6 +48,21 @@ using std::vector;
 
 enum class AggregationScenarioDataType { IndexFixing, FXSpot, Numeraire, Generic };
 
+inline std::ostream& operator<<(std::ostream& out, const AggregationScenarioDataType& t) {
+    switch (t) {
+    case AggregationScenarioDataType::IndexFixing:
+        return out << "IndexFixing";
+    case AggregationScenarioDataType::FXSpot:
+        return out << "FXSpot";
+    case AggregationScenarioDataType::Numeraire:
+        return out << "Numeraire";
+    case AggregationScenarioDataType::Generic:
+        return out << "Generic";
+    default:
+        return out << "Unknown aggregation scenario data type";
+    }
+}
+
 //! Container for storing simulated marekt data
 /*! The indexes for dates and samples are (by convention) the
     same as in the npv cube
@@ -83,6 +101,25 @@ public:
     //! Persist cube contents to disk
     virtual void save(const std::string&) const {}
 
+    //! Reduce the number of samples to the given number, e.g. after an early stop of the simulation
+    virtual void truncateSamples(Size) { QL_FAIL("AggregationScenarioData::truncateSamples() not implemented"); }
+
+    //! \name Handle based access
+    /*! A handle resolves a (type, qualifier) pair once, so that repeated reads, e.g. in the post processing loops
+        over dates and samples, avoid the key lookup. Handles stay valid as long as the data lives, the row pointers
+        returned by samples() until data for a new key is set or the samples are truncated.
+    */
+    //@{
+    //! Handle of the data for the given type, throws if there is no such data
+    virtual Size handle(const AggregationScenarioDataType&, const string& = "") const {
+        QL_FAIL("AggregationScenarioData::handle() not implemented");
+    }
+    //! Values of all samples on the given date as a contiguous row of dimSamples() values
+    virtual const Real* samples(Size, Size) const { QL_FAIL("AggregationScenarioData::samples() not implemented"); }
+    //! Get a value by handle
+    Real get(Size handle, Size dateIndex, Size sampleIndex) const { return samples(handle, dateIndex)[sampleIndex]; }
+    //@}
+
     //! Set a value in the cube, assumes normal traversal of the cube (dates then samples)
     void set(Real value, const AggregationScenarioDataType& type, const string& qualifier = "") {
         set(dIndex_, sIndex_, value, type, qualifier);
@@ -96,6 +133,11 @@ public:
             sIndex_++;
         }
     }
+    //! Skip the given number of samples, assumes we are at the first date of a sample
+    void skipSamples(Size samples) {
+        QL_REQUIRE(dIndex_ == 0, "AggregationScenarioData::skipSamples() called within a sample");
+        sIndex_ += samples;
+    }
 
 private:
     Size dIndex_, sIndex_;
@@ -113,7 +155,7 @@ public:
     Size dimSamples() const override { return dimSamples_; }
 
     bool has(const AggregationScenarioDataType& type, const string& qualifier = "") const override {
-        return data_.find(std::make_pair(type, qualifier)) != data_.end();
+        return index_.find(std::make_pair(type, qualifier)) != index_.end();
     }
 
     /*! might throw (the underlying's container exception),
@@ -121,12 +163,14 @@ public:
     Real get(Size dateIndex, Size sampleIndex, const AggregationScenarioDataType& type,
              const string& qualifier = "") const override {
         check(dateIndex, sampleIndex, type, qualifier);
-        return data_.at(std::make_pair(type, qualifier))[dateIndex][sampleIndex];
+        return data_[offset(index_.at(std::make_pair(type, qualifier)), dateIndex) + sampleIndex];
     }
+    using AggregationScenarioData::get;
 
+    //! the keys are returned in the order of (type, qualifier)
     std::vector<std::pair<AggregationScenarioDataType, std::string>> keys() const override {
         std::vector<std::pair<AggregationScenarioDataType, std::string>> res;
-        for (auto const& k : data_)
+        for (auto const& k : index_)
             res.push_back(k.first);
         return res;
     }
@@ -135,11 +179,25 @@ public:
              const string& qualifier = "") override {
         check(dateIndex, sampleIndex, type, qualifier);
         auto key = std::make_pair(type, qualifier);
-        auto it = data_.find(key);
-        if (it == data_.end()) {
-            data_.insert(make_pair(key, vector<vector<Real>>(dimDates_, vector<Real>(dimSamples_, 0.0))));
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            it = index_.insert(std::make_pair(key, keys_.size())).first;
+            keys_.push_back(key);
+            data_.resize(keys_.size() * dimDates_ * dimSamples_, 0.0);
         }
-        data_[key][dateIndex][sampleIndex] = value;
+        data_[offset(it->second, dateIndex) + sampleIndex] = value;
+    }
+
+    Size handle(const AggregationScenarioDataType& type, const string& qualifier = "") const override {
+        auto it = index_.find(std::make_pair(type, qualifier));
+        QL_REQUIRE(it != index_.end(), "no aggregation scenario data for " << type << " " << qualifier);
+        return it->second;
+    }
+
+    const Real* samples(Size handle, Size dateIndex) const override {
+        QL_REQUIRE(handle < keys_.size(), "handle (" << handle << ") out of range 0..." << keys_.size() - 1);
+        QL_REQUIRE(dateIndex < dimDates_, "dateIndex (" << dateIndex << ") out of range 0..." << dimDates_ - 1);
+        return data_.data() + offset(handle, dateIndex);
     }
 
     void load(const std::string& fileName) override {
@@ -156,14 +214,48 @@ public:
         oa&* this;
     }
 
+    void truncateSamples(Size samples) override {
+        QL_REQUIRE(samples > 0 && samples <= dimSamples_, "InMemoryAggregationScenarioData::truncateSamples samples ("
+                                                              << samples << ") must be in 1..." << dimSamples_);
+        // the rows move to the front, the target of each row lies before its source
+        for (Size r = 1; r < keys_.size() * dimDates_; ++r)
+            std::copy(data_.begin() + r * dimSamples_, data_.begin() + r * dimSamples_ + samples,
+                      data_.begin() + r * samples);
+        dimSamples_ = samples;
+        data_.resize(keys_.size() * dimDates_ * dimSamples_);
+        data_.shrink_to_fit();
+    }
+
 private:
     friend class boost::serialization::access;
-    template <class Archive> void serialize(Archive& ar, const unsigned int) {
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
         ar& dimDates_;
         ar& dimSamples_;
-        ar& data_;
+        if (version == 0) {
+            // files written before version 1 hold the values by key, date and sample in nested containers
+            map<std::pair<AggregationScenarioDataType, string>, vector<vector<Real>>> data;
+            ar& data;
+            keys_.clear();
+            data_.clear();
+            data_.reserve(data.size() * dimDates_ * dimSamples_);
+            for (auto const& d : data) {
+                keys_.push_back(d.first);
+                for (auto const& v : d.second)
+                    data_.insert(data_.end(), v.begin(), v.end());
+            }
+        } else {
+            ar& keys_;
+            ar& data_;
+        }
+        if (Archive::is_loading::value) {
+            index_.clear();
+            for (Size i = 0; i < keys_.size(); ++i)
+                index_[keys_[i]] = i;
+        }
     }
 
+    Size offset(Size handle, Size dateIndex) const { return (handle * dimDates_ + dateIndex) * dimSamples_; }
+
     void check(Size dateIndex, Size sampleIndex, const AggregationScenarioDataType& type,
                const string& qualifier) const {
         QL_REQUIRE(dateIndex < dimDates_, "dateIndex (" << dateIndex << ") out of range 0..." << dimDates_ - 1);
@@ -172,23 +264,14 @@ private:
         return;
     }
     Size dimDates_, dimSamples_;
-    map<std::pair<AggregationScenarioDataType, string>, vector<vector<Real>>> data_;
+    // keys in the order of their handles and the handle by key
+    vector<std::pair<AggregationScenarioDataType, string>> keys_;
+    map<std::pair<AggregationScenarioDataType, string>, Size> index_;
+    // one block of dimDates x dimSamples values per key in one buffer
+    vector<Real> data_;
 };
 
-inline std::ostream& operator<<(std::ostream& out, const AggregationScenarioDataType& t) {
-    switch (t) {
-    case AggregationScenarioDataType::IndexFixing:
-        return out << "IndexFixing";
-    case AggregationScenarioDataType::FXSpot:
-        return out << "FXSpot";
-    case AggregationScenarioDataType::Numeraire:
-        return out << "Numeraire";
-    case AggregationScenarioDataType::Generic:
-        return out << "Generic";
-    default:
-        return out << "Unknown aggregation scenario data type";
-    }
-}
-
 } // namespace analytics
 } // namespace ore
+
+BOOST_CLASS_VERSION(ore::analytics::InMemoryAggregationScenarioData, 1)
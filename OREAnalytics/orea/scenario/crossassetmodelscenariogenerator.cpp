@@ -169,66 +169,70 @@ CrossAssetModelScenarioGenerator::CrossAssetModelScenarioGenerator(
             }
         }
     }
-}
-
-std::vector<boost::shared_ptr<Scenario>> CrossAssetModelScenarioGenerator::nextPath() {
-    std::vector<boost::shared_ptr<Scenario>> scenarios(dates_.size());
-    Sample<MultiPath> sample = pathGenerator_->next();
-    Size n_ccy = model_->components(IR);
-    Size n_eq = model_->components(EQ);
-    Size n_inf = model_->components(INF);
-    Size n_indices = simMarketConfig_->indices().size();
-    Size n_curves = simMarketConfig_->yieldCurveNames().size();
-    Size n_zeroinf = simMarketConfig_->zeroInflationIndices().size();
-    Size n_yoyinf = simMarketConfig_->yoyInflationIndices().size();
-    vector<boost::shared_ptr<QuantExt::LgmImpliedYieldTermStructure>> curves, fwdCurves, yieldCurves;
-    vector<boost::shared_ptr<QuantExt::DkImpliedZeroInflationTermStructure>> zeroInfCurves;
-    vector<boost::shared_ptr<QuantExt::DkImpliedYoYInflationTermStructure>> yoyInfCurves;
-    vector<boost::shared_ptr<IborIndex>> indices;
-    vector<Currency> yieldCurveCurrency;
-    vector<boost::shared_ptr<QuantExt::LgmImpliedYieldTermStructure>> equityForecastCurves;
-    vector<Currency> equityForecastCurrency;
-    vector<string> zeroInflationIndex, yoyInflationIndex;
 
-    DayCounter dc = model_->irlgm1f(0)->termStructure()->dayCounter();
+    // Set up the implied term structures and the inflation base data once, nextPath() only moves the term structures
+    // along the path and does not touch the initial market
+    dc_ = model_->irlgm1f(0)->termStructure()->dayCounter();
 
     for (Size j = 0; j < n_ccy; ++j) {
-        curves.push_back(boost::make_shared<QuantExt::LgmImpliedYieldTermStructure>(model_->lgm(j), dc, true));
+        curves_.push_back(boost::make_shared<QuantExt::LgmImpliedYieldTermStructure>(model_->lgm(j), dc_, true));
     }
 
     for (Size j = 0; j < n_indices; ++j) {
         std::string indexName = simMarketConfig_->indices()[j];
         boost::shared_ptr<IborIndex> index = *initMarket_->iborIndex(indexName, configuration_);
         Handle<YieldTermStructure> fts = index->forwardingTermStructure();
-        auto impliedFwdCurve = boost::make_shared<LgmImpliedYtsFwdFwdCorrected>(
-            model_->lgm(model_->ccyIndex(index->currency())), fts, dc, false);
-        fwdCurves.push_back(impliedFwdCurve);
-        indices.push_back(index->clone(Handle<YieldTermStructure>(impliedFwdCurve)));
+        Size ccyIdx = model_->ccyIndex(index->currency());
+        fwdCurves_.push_back(boost::make_shared<LgmImpliedYtsFwdFwdCorrected>(model_->lgm(ccyIdx), fts, dc_, false));
+        indexCcyIdx_.push_back(ccyIdx);
     }
 
     for (Size j = 0; j < n_curves; ++j) {
         std::string curveName = simMarketConfig_->yieldCurveNames()[j];
         Currency ccy = ore::data::parseCurrency(simMarketConfig_->yieldCurveCurrencies().at(curveName));
         Handle<YieldTermStructure> yts = initMarket_->yieldCurve(curveName, configuration_);
-        auto impliedYieldCurve =
-            boost::make_shared<LgmImpliedYtsFwdFwdCorrected>(model_->lgm(model_->ccyIndex(ccy)), yts, dc, false);
-        yieldCurves.push_back(impliedYieldCurve);
-        yieldCurveCurrency.push_back(ccy);
+        Size ccyIdx = model_->ccyIndex(ccy);
+        yieldCurves_.push_back(boost::make_shared<LgmImpliedYtsFwdFwdCorrected>(model_->lgm(ccyIdx), yts, dc_, false));
+        yieldCurveCcyIdx_.push_back(ccyIdx);
     }
 
-    for (Size j = 0; j < n_zeroinf; ++j) {
-        zeroInfCurves.push_back(boost::make_shared<QuantExt::DkImpliedZeroInflationTermStructure>(model_, j));
+    for (Size j = 0; j < n_inf; ++j) {
+        boost::shared_ptr<ZeroInflationIndex> index = *initMarket_->zeroInflationIndex(model_->infdk(j)->name());
+        Date baseDate = index->zeroInflationTermStructure()->baseDate();
+        baseCpis_.push_back(index->fixing(baseDate));
+        cpiRelativeTimes_.push_back(vector<Time>(dates_.size()));
+        for (Size i = 0; i < dates_.size(); ++i) {
+            cpiRelativeTimes_.back()[i] =
+                inflationYearFraction(index->zeroInflationTermStructure()->frequency(),
+                                      index->zeroInflationTermStructure()->indexIsInterpolated(),
+                                      index->zeroInflationTermStructure()->dayCounter(), baseDate,
+                                      dates_[i] - index->zeroInflationTermStructure()->observationLag());
+        }
     }
 
-    for (Size j = 0; j < n_yoyinf; ++j) {
-        yoyInfCurves.push_back(boost::make_shared<QuantExt::DkImpliedYoYInflationTermStructure>(model_, j));
+    for (Size j = 0; j < simMarketConfig_->zeroInflationIndices().size(); ++j) {
+        zeroInfCurves_.push_back(boost::make_shared<QuantExt::DkImpliedZeroInflationTermStructure>(model_, j));
+        zeroInfIdx_.push_back(model_->infIndex(simMarketConfig_->zeroInflationIndices()[j]));
     }
 
-    for (Size j = 0; j < n_eq; ++j) {
-        std::string curveName = simMarketConfig_->equityNames()[j];
-        Currency ccy = model_->eqbs(j)->currency();
-        equityForecastCurrency.push_back(ccy);
+    for (Size j = 0; j < simMarketConfig_->yoyInflationIndices().size(); ++j) {
+        yoyInfCurves_.push_back(boost::make_shared<QuantExt::DkImpliedYoYInflationTermStructure>(model_, j));
+        yoyInfIdx_.push_back(model_->infIndex(simMarketConfig_->yoyInflationIndices()[j]));
+        yoyInfCcyIdx_.push_back(model_->ccyIndex(model_->infdk(j)->currency()));
     }
+}
+
+std::vector<boost::shared_ptr<Scenario>> CrossAssetModelScenarioGenerator::nextPath() {
+    std::vector<boost::shared_ptr<Scenario>> scenarios(dates_.size());
+    Sample<MultiPath> sample = pathGenerator_->next();
+    Size n_ccy = model_->components(IR);
+    Size n_eq = model_->components(EQ);
+    Size n_inf = model_->components(INF);
+    Size n_indices = simMarketConfig_->indices().size();
+    Size n_curves = simMarketConfig_->yieldCurveNames().size();
+    Size n_zeroinf = simMarketConfig_->zeroInflationIndices().size();
+    Size n_yoyinf = simMarketConfig_->yoyInflationIndices().size();
+    const DayCounter& dc = dc_;
 
     for (Size i = 0; i < dates_.size(); i++) {
         Real t = timeGrid_[i + 1]; // recall: time grid has inserted t=0
@@ -244,35 +248,35 @@ std::vector<boost::shared_ptr<Scenario>> CrossAssetModelScenarioGenerator::nextP
         for (Size j = 0; j < n_ccy; j++) {
             // LGM factor value, second index = 0 holds initial values
             Real z = sample.value[model_->pIdx(IR, j)][i + 1];
-            curves[j]->move(t, z);
+            curves_[j]->move(t, z);
             for (Size k = 0; k < ten_dsc_[j].size(); k++) {
                 Date d = dates_[i] + ten_dsc_[j][k];
                 Time T = dc.yearFraction(dates_[i], d);
-                Real discount = std::max(curves[j]->discount(T), 0.00001);
+                Real discount = std::max(curves_[j]->discount(T), 0.00001);
                 scenarios[i]->add(discountCurveKeys_[j * ten_dsc_[j].size() + k], discount);
             }
         }
 
         // Index curves and Index fixings
         for (Size j = 0; j < n_indices; ++j) {
-            Real z = sample.value[model_->pIdx(IR, model_->ccyIndex(indices[j]->currency()))][i + 1];
-            fwdCurves[j]->move(dates_[i], z);
+            Real z = sample.value[model_->pIdx(IR, indexCcyIdx_[j])][i + 1];
+            fwdCurves_[j]->move(dates_[i], z);
             for (Size k = 0; k < ten_idx_[j].size(); ++k) {
                 Date d = dates_[i] + ten_idx_[j][k];
                 Time T = dc.yearFraction(dates_[i], d);
-                Real discount = std::max(fwdCurves[j]->discount(T), 0.00001);
+                Real discount = std::max(fwdCurves_[j]->discount(T), 0.00001);
                 scenarios[i]->add(indexCurveKeys_[j * ten_idx_[j].size() + k], discount);
             }
         }
 
         // Yield curves
         for (Size j = 0; j < n_curves; ++j) {
-            Real z = sample.value[model_->pIdx(IR, model_->ccyIndex(yieldCurveCurrency[j]))][i + 1];
-            yieldCurves[j]->move(dates_[i], z);
+            Real z = sample.value[model_->pIdx(IR, yieldCurveCcyIdx_[j])][i + 1];
+            yieldCurves_[j]->move(dates_[i], z);
             for (Size k = 0; k < ten_yc_[j].size(); ++k) {
                 Date d = dates_[i] + ten_yc_[j][k];
                 Time T = dc.yearFraction(dates_[i], d);
-                Real discount = std::max(yieldCurves[j]->discount(T), 0.00001);
+                Real discount = std::max(yieldCurves_[j]->discount(T), 0.00001);
                 scenarios[i]->add(yieldCurveKeys_[j * ten_yc_[j].size() + k], discount);
             }
         }
@@ -336,45 +340,32 @@ std::vector<boost::shared_ptr<Scenario>> CrossAssetModelScenarioGenerator::nextP
             // LGM factor value, second index = 0 holds initial values
             Real z = sample.value[model_->pIdx(INF, j, 0)][i + 1];
             Real y = sample.value[model_->pIdx(INF, j, 1)][i + 1];
-
-            // update fixing manage with fixing for base date
-            boost::shared_ptr<ZeroInflationIndex> index = *initMarket_->zeroInflationIndex(model_->infdk(j)->name());
-            Date baseDate = index->zeroInflationTermStructure()->baseDate();
-            Time relativeTime =
-                inflationYearFraction(index->zeroInflationTermStructure()->frequency(),
-                                      index->zeroInflationTermStructure()->indexIsInterpolated(),
-                                      index->zeroInflationTermStructure()->dayCounter(), baseDate,
-                                      dates_[i] - index->zeroInflationTermStructure()->observationLag());
+            Time relativeTime = cpiRelativeTimes_[j][i];
             std::pair<Real, Real> ii = model_->infdkI(j, relativeTime, relativeTime, z, y);
-
-            Real baseCPI = index->fixing(baseDate);
-            scenarios[i]->add(cpiKeys_[j], baseCPI * ii.first);
+            scenarios[i]->add(cpiKeys_[j], baseCpis_[j] * ii.first);
         }
 
         for (Size j = 0; j < n_zeroinf; ++j) {
-            std::string indexName = simMarketConfig_->zeroInflationIndices()[j];
-            Real z = sample.value[model_->pIdx(INF, model_->infIndex(indexName), 0)][i + 1];
-            Real y = sample.value[model_->pIdx(INF, model_->infIndex(indexName), 1)][i + 1];
-            zeroInfCurves[j]->move(dates_[i], z, y);
+            Real z = sample.value[model_->pIdx(INF, zeroInfIdx_[j], 0)][i + 1];
+            Real y = sample.value[model_->pIdx(INF, zeroInfIdx_[j], 1)][i + 1];
+            zeroInfCurves_[j]->move(dates_[i], z, y);
             for (Size k = 0; k < ten_zinf_[j].size(); k++) {
                 Date d = dates_[i] + ten_zinf_[j][k];
                 Time T = dc.yearFraction(dates_[i], d);
-                Real zero = zeroInfCurves[j]->zeroRate(T);
+                Real zero = zeroInfCurves_[j]->zeroRate(T);
                 scenarios[i]->add(zeroInflationKeys_[j * ten_zinf_[j].size() + k], zero);
             }
         }
 
         for (Size j = 0; j < n_yoyinf; ++j) {
-            std::string indexName = simMarketConfig_->yoyInflationIndices()[j];
-            Size ccy = model_->ccyIndex(model_->infdk(j)->currency());
-            Real z = sample.value[model_->pIdx(INF, model_->infIndex(indexName), 0)][i + 1];
-            Real y = sample.value[model_->pIdx(INF, model_->infIndex(indexName), 1)][i + 1];
-            Real ir_z = sample.value[model_->pIdx(IR, ccy)][i + 1];
-            yoyInfCurves[j]->move(dates_[i], z, y, ir_z);
+            Real z = sample.value[model_->pIdx(INF, yoyInfIdx_[j], 0)][i + 1];
+            Real y = sample.value[model_->pIdx(INF, yoyInfIdx_[j], 1)][i + 1];
+            Real ir_z = sample.value[model_->pIdx(IR, yoyInfCcyIdx_[j])][i + 1];
+            yoyInfCurves_[j]->move(dates_[i], z, y, ir_z);
             vector<Date> d_yinf;
             for (Size k = 0; k < ten_yinf_[j].size(); k++)
                 d_yinf.push_back(dates_[i] + ten_yinf_[j][k]);
-            map<Date, Real> yoyRates = yoyInfCurves[j]->yoyRates(d_yinf);
+            map<Date, Real> yoyRates = yoyInfCurves_[j]->yoyRates(d_yinf);
             for (Size l = 0; l < d_yinf.size(); l++) {
                 scenarios[i]->add(yoyInflationKeys_[j * ten_yinf_[j].size() + l], yoyRates[d_yinf[l]]);
             }
@@ -34,6 +34,9 @@
 #include <qle/models/crossassetmodel.hpp>
 #include <qle/models/crossassetmodelimpliedeqvoltermstructure.hpp>
 #include <qle/models/crossassetmodelimpliedfxvoltermstructure.hpp>
+#include <qle/models/dkimpliedyoyinflationtermstructure.hpp>
+#include <qle/models/dkimpliedzeroinflationtermstructure.hpp>
+#include <qle/models/lgmimpliedyieldtermstructure.hpp>
 
 namespace ore {
 namespace analytics {
@@ -67,6 +70,9 @@ public:
     std::vector<boost::shared_ptr<Scenario>> nextPath();
     void reset() { pathGenerator_->reset(); }
 
+protected:
+    void skipPaths(Size n) { pathGenerator_->skip(n); }
+
 private:
     boost::shared_ptr<QuantExt::CrossAssetModel> model_;
     boost::shared_ptr<QuantExt::MultiPathGeneratorBase> pathGenerator_;
@@ -80,6 +86,16 @@ private:
     std::vector<boost::shared_ptr<QuantExt::CrossAssetModelImpliedFxVolTermStructure>> fxVols_;
     std::vector<boost::shared_ptr<QuantExt::CrossAssetModelImpliedEqVolTermStructure>> eqVols_;
     std::vector<std::vector<Period>> ten_dsc_, ten_idx_, ten_yc_, ten_efc_, ten_zinf_, ten_yinf_;
+    // implied term structures that are moved along the paths
+    DayCounter dc_;
+    std::vector<boost::shared_ptr<QuantExt::LgmImpliedYieldTermStructure>> curves_, fwdCurves_, yieldCurves_;
+    std::vector<boost::shared_ptr<QuantExt::DkImpliedZeroInflationTermStructure>> zeroInfCurves_;
+    std::vector<boost::shared_ptr<QuantExt::DkImpliedYoYInflationTermStructure>> yoyInfCurves_;
+    // model indices of the curve currencies and inflation components
+    std::vector<Size> indexCcyIdx_, yieldCurveCcyIdx_, zeroInfIdx_, yoyInfIdx_, yoyInfCcyIdx_;
+    // base CPI fixings and inflation year fractions per simulation date
+    std::vector<Real> baseCpis_;
+    std::vector<std::vector<Time>> cpiRelativeTimes_;
 };
 } // namespace analytics
 } // namespace ore
@@ -0,0 +1,84 @@
+/*
+ Copyright (C) 2019 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file scenario/deltascenario.hpp
+    \brief Delta scenario class
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <orea/scenario/scenario.hpp>
+
+namespace ore {
+namespace analytics {
+
+//! Delta Scenario class
+/*! A delta scenario refers to a base scenario and only stores the values that differ from it. Keys that are not
+    stored in the delta are looked up in the base scenario, so the keys of a delta scenario are those of the base
+    scenario. A delta scenario built on top of another delta scenario refers to the base scenario of the latter
+    and starts with a copy of its delta.
+
+    This keeps the memory footprint of a large number of scenarios that each shift a few risk factors against a
+    common base small, e.g. sensitivity scenarios. The ScenarioSimMarket recognises delta scenarios and only
+    updates the quotes stored in the delta when applying them on top of their base scenario.
+
+  \ingroup scenario
+*/
+class DeltaScenario : public Scenario {
+public:
+    //! Constructor
+    DeltaScenario(const boost::shared_ptr<Scenario>& baseScenario, const std::string& label = "", Real numeraire = 0);
+
+    //! Return the scenario asof date, i.e. the asof date of the base scenario
+    const Date& asof() const override { return baseScenario_->asof(); }
+
+    //! Return the scenario label
+    const std::string& label() const override { return label_; }
+    //! set the label
+    void label(const string& s) override { label_ = s; }
+
+    //! Get Numeraire ratio n = N(t) / N(0) so that Price(0) = N(0) * E [Price(t) / N(t) ]
+    Real getNumeraire() const override { return numeraire_; }
+    //! Set the Numeraire ratio n = N(t) / N(0) so that Price(0) = N(0) * E [Price(t) / N(t) ]
+    void setNumeraire(Real n) override { numeraire_ = n; }
+
+    //! Check, get, add a single market point, only keys of the base scenario can be added
+    bool has(const RiskFactorKey& key) const override { return baseScenario_->has(key); }
+    const std::vector<RiskFactorKey>& keys() const override { return baseScenario_->keys(); }
+    void add(const RiskFactorKey& key, Real value) override;
+    Real get(const RiskFactorKey& key) const override;
+
+    boost::shared_ptr<Scenario> clone() const override;
+
+    //! Inspectors
+    //@{
+    //! The base scenario
+    const boost::shared_ptr<Scenario>& baseScenario() const { return baseScenario_; }
+    //! The values stored in this scenario on top of the base scenario
+    const std::map<RiskFactorKey, Real>& delta() const { return delta_; }
+    //@}
+
+private:
+    boost::shared_ptr<Scenario> baseScenario_;
+    Real numeraire_;
+    std::string label_;
+    std::map<RiskFactorKey, Real> delta_;
+};
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,50 @@
+/*
+ Copyright (C) 2019 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/scenario/deltascenariofactory.hpp
+    \brief factory class for delta scenarios on top of a base scenario
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <orea/scenario/scenariofactory.hpp>
+
+namespace ore {
+namespace analytics {
+
+//! Factory class for building delta scenario objects
+/*! The scenarios built are DeltaScenario instances sharing the given base scenario. As opposed to the
+    CloneScenarioFactory no data of the base scenario is copied.
+
+    \ingroup scenario
+ */
+class DeltaScenarioFactory : public ScenarioFactory {
+public:
+    //! Constructor
+    DeltaScenarioFactory(const boost::shared_ptr<Scenario>& baseScenario);
+    //! returns a new scenario, using the base scenario as a starting point
+    const boost::shared_ptr<Scenario> buildScenario(Date asof, const std::string& label = "",
+                                                    Real numeraire = 0.0) const;
+
+private:
+    boost::shared_ptr<Scenario> baseScenario_;
+};
+
+} // namespace analytics
+} // namespace ore
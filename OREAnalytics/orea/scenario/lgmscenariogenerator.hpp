@@ -59,6 +59,9 @@ public:
     std::vector<boost::shared_ptr<Scenario>> nextPath();
     void reset() { pathGenerator_->reset(); }
 
+protected:
+    void skipPaths(Size n) { pathGenerator_->skip(n); }
+
 private:
     boost::shared_ptr<QuantExt::LGM> model_;
     boost::shared_ptr<QuantExt::MultiPathGeneratorBase> pathGenerator_;
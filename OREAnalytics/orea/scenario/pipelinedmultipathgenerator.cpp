@@ -0,0 +1,192 @@
+/*
+ Copyright (C) 2019 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/scenario/pipelinedmultipathgenerator.hpp>
+
+#include <boost/make_shared.hpp>
+
+#include <chrono>
+
+using namespace QuantExt;
+
+namespace ore {
+namespace analytics {
+
+PipelinedMultiPathGenerator::PipelinedMultiPathGenerator(const SequenceType s,
+                                                         const boost::shared_ptr<StochasticProcess>& process,
+                                                         const TimeGrid& timeGrid, const BigNatural seed,
+                                                         const SobolBrownianGenerator::Ordering ordering,
+                                                         const SobolRsg::DirectionIntegers directionIntegers,
+                                                         const Size queueSize)
+    : sequenceType_(s), process_(process), grid_(timeGrid), seed_(seed), ordering_(ordering),
+      directionIntegers_(directionIntegers),
+      // the Brownian bridge generator draws one variate per process dimension, see
+      // MultiPathGeneratorSobolBrownianBridge
+      factors_(s == SobolBrownianBridge ? process->size() : process->factors()), queue_(queueSize), head_(0),
+      tail_(0), stop_(false), failed_(false), next_(MultiPath(process->size(), timeGrid), 1.0),
+      antitheticVariate_(true) {
+    QL_REQUIRE(queueSize > 0, "PipelinedMultiPathGenerator: queue size must be positive");
+    reset();
+}
+
+PipelinedMultiPathGenerator::~PipelinedMultiPathGenerator() { stop(); }
+
+void PipelinedMultiPathGenerator::reset() {
+    stop();
+    // the sequence generators are set up as in makeMultiPathGenerator()
+    Size steps = grid_.size() - 1;
+    switch (sequenceType_) {
+    case MersenneTwister:
+    case MersenneTwisterAntithetic: {
+        auto rsg = boost::make_shared<PseudoRandom::rsg_type>(
+            PseudoRandom::make_sequence_generator(process_->size() * steps, seed_));
+        draw_ = [rsg](Variates& v) {
+            const PseudoRandom::rsg_type::sample_type& s = rsg->nextSequence();
+            v.values = s.value;
+            v.weight = s.weight;
+        };
+        break;
+    }
+    case Sobol: {
+        auto rsg = boost::make_shared<InverseCumulativeRsg<SobolRsg, InverseCumulativeNormal>>(
+            SobolRsg(process_->size() * steps, seed_, directionIntegers_));
+        draw_ = [rsg](Variates& v) {
+            const Sample<std::vector<Real>>& s = rsg->nextSequence();
+            v.values = s.value;
+            v.weight = s.weight;
+        };
+        break;
+    }
+    case SobolBrownianBridge: {
+        auto gen = boost::make_shared<SobolBrownianGenerator>(process_->size(), steps, ordering_, seed_,
+                                                              directionIntegers_);
+        Size factors = factors_;
+        draw_ = [gen, factors, steps](Variates& v) {
+            v.weight = gen->nextPath();
+            v.values.resize(factors * steps);
+            std::vector<Real> output(factors);
+            for (Size i = 0; i < steps; ++i) {
+                gen->nextStep(output);
+                std::copy(output.begin(), output.end(), v.values.begin() + i * factors);
+            }
+        };
+        break;
+    }
+    default:
+        QL_FAIL("PipelinedMultiPathGenerator: unknown sequence type");
+    }
+    for (auto& v : queue_)
+        v.values.clear();
+    head_.store(0);
+    tail_.store(0);
+    stop_.store(false);
+    failed_.store(false);
+    error_ = std::exception_ptr();
+    antitheticVariate_ = true;
+}
+
+const Sample<MultiPath>& PipelinedMultiPathGenerator::next() const {
+    // every second path is the antithetic one of the previous path, as in MultiPathGeneratorMersenneTwister
+    if (sequenceType_ == MersenneTwisterAntithetic) {
+        antitheticVariate_ = !antitheticVariate_;
+        if (antitheticVariate_) {
+            evolve(true);
+            return next_;
+        }
+    }
+    pop();
+    evolve(false);
+    return next_;
+}
+
+void PipelinedMultiPathGenerator::skip(Size n) {
+    for (Size i = 0; i < n; ++i) {
+        if (sequenceType_ == MersenneTwisterAntithetic) {
+            antitheticVariate_ = !antitheticVariate_;
+            if (antitheticVariate_)
+                continue;
+        }
+        pop();
+    }
+}
+
+void PipelinedMultiPathGenerator::evolve(bool antithetic) const {
+    MultiPath& path = next_.value;
+    Array asset = process_->initialValues();
+    for (Size j = 0; j < asset.size(); ++j)
+        path[j].front() = asset[j];
+    next_.weight = current_.weight;
+    Array dw(factors_);
+    for (Size i = 1; i < grid_.size(); ++i) {
+        Size offset = (i - 1) * factors_;
+        for (Size k = 0; k < factors_; ++k)
+            dw[k] = antithetic ? -current_.values[offset + k] : current_.values[offset + k];
+        asset = process_->evolve(grid_[i - 1], asset, grid_.dt(i - 1), dw);
+        for (Size j = 0; j < asset.size(); ++j)
+            path[j][i] = asset[j];
+    }
+}
+
+void PipelinedMultiPathGenerator::start() const {
+    producer_ = std::thread(&PipelinedMultiPathGenerator::produce, this);
+}
+
+void PipelinedMultiPathGenerator::stop() const {
+    if (producer_.joinable()) {
+        stop_.store(true);
+        producer_.join();
+    }
+}
+
+void PipelinedMultiPathGenerator::produce() const {
+    try {
+        while (!stop_.load()) {
+            Variates v;
+            draw_(v);
+            // wait for a free slot, the consumer might take a while to price a path
+            Size tail = tail_.load(std::memory_order_relaxed);
+            while (tail - head_.load(std::memory_order_acquire) == queue_.size()) {
+                if (stop_.load())
+                    return;
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            queue_[tail % queue_.size()] = std::move(v);
+            tail_.store(tail + 1, std::memory_order_release);
+        }
+    } catch (...) {
+        error_ = std::current_exception();
+        failed_.store(true, std::memory_order_release);
+    }
+}
+
+void PipelinedMultiPathGenerator::pop() const {
+    if (!producer_.joinable())
+        start();
+    Size head = head_.load(std::memory_order_relaxed);
+    while (head == tail_.load(std::memory_order_acquire)) {
+        // the flag is set after the last variates were added, so check the queue once more before giving up
+        if (failed_.load(std::memory_order_acquire) && head == tail_.load(std::memory_order_acquire))
+            std::rethrow_exception(error_);
+        std::this_thread::yield();
+    }
+    current_ = std::move(queue_[head % queue_.size()]);
+    head_.store(head + 1, std::memory_order_release);
+}
+
+} // namespace analytics
+} // namespace ore
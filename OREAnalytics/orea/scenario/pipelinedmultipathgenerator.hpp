@@ -0,0 +1,108 @@
+/*
+ Copyright (C) 2019 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file scenario/pipelinedmultipathgenerator.hpp
+    \brief Multi path generator that draws the random variates in a background thread
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <qle/methods/multipathgeneratorbase.hpp>
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+using namespace QuantLib;
+
+//! Multi path generator that draws the random variates in a background thread
+/*! The generator returns the same paths as the generator built by makeMultiPathGenerator() for the same sequence
+    type, seed and settings. A producer thread draws the Gaussian variates of the next paths from its own random
+    sequence generator and puts them into a bounded lock-free queue. next() takes the variates of a path from the
+    queue and evolves the state process with them on the calling thread.
+
+    Only the random sequence generators run on the producer thread. They do not read or modify any QuantLib global
+    state. The state process and the term structures it reads stay on the calling thread, typically the valuation
+    thread, which also sets the evaluation date and updates the market. Evolving the paths in the background would
+    race with these updates.
+
+    The producer thread is started by the first call to next() or skip() and stopped by reset() or the destructor.
+
+    \ingroup scenario
+*/
+class PipelinedMultiPathGenerator : public QuantExt::MultiPathGeneratorBase {
+public:
+    PipelinedMultiPathGenerator(const QuantExt::SequenceType s, const boost::shared_ptr<StochasticProcess>& process,
+                                const TimeGrid& timeGrid, const BigNatural seed,
+                                const SobolBrownianGenerator::Ordering ordering = SobolBrownianGenerator::Steps,
+                                const SobolRsg::DirectionIntegers directionIntegers = SobolRsg::JoeKuoD7,
+                                const Size queueSize = 16);
+    //! Destructor, stops the producer thread
+    ~PipelinedMultiPathGenerator();
+
+    const Sample<MultiPath>& next() const override;
+    //! Stops the producer and restarts the random sequence, the next path is the first one again
+    void reset() override;
+    //! Skips the paths by taking their variates from the queue without evolving the process
+    void skip(Size n) override;
+
+private:
+    // the variates of one path, step by step
+    struct Variates {
+        std::vector<Real> values;
+        Real weight;
+    };
+
+    void start() const;
+    void stop() const;
+    void produce() const;
+    void pop() const;
+    void evolve(bool antithetic) const;
+
+    const QuantExt::SequenceType sequenceType_;
+    const boost::shared_ptr<StochasticProcess> process_;
+    TimeGrid grid_;
+    BigNatural seed_;
+    SobolBrownianGenerator::Ordering ordering_;
+    SobolRsg::DirectionIntegers directionIntegers_;
+    // number of variates per time step
+    Size factors_;
+
+    // draws the variates of the next path, used by the producer thread only
+    std::function<void(Variates&)> draw_;
+
+    // ring buffer of variates, head_ and tail_ count the paths taken and added so far
+    mutable std::vector<Variates> queue_;
+    mutable std::atomic<Size> head_, tail_;
+    mutable std::atomic<bool> stop_, failed_;
+    mutable std::exception_ptr error_;
+    mutable std::thread producer_;
+
+    // the variates of the last path taken from the queue and the path built from them
+    mutable Variates current_;
+    mutable Sample<MultiPath> next_;
+    mutable bool antitheticVariate_;
+};
+
+} // namespace analytics
+} // namespace ore
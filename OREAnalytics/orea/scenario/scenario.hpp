@@ -154,6 +154,14 @@ public:
     //! Get an element from the scenario
     virtual Real get(const RiskFactorKey& key) const = 0;
 
+    //! Keys shared with other scenarios that have the same keys in the same order, null if not shared
+    /*! The shared keys are not modified while they are held, so they identify the key order of keys() */
+    virtual boost::shared_ptr<const std::vector<RiskFactorKey>> sharedKeys() const {
+        return boost::shared_ptr<const std::vector<RiskFactorKey>>();
+    }
+    //! Values in the order of keys() if the scenario stores them contiguously, null otherwise
+    virtual const Real* values() const { return nullptr; }
+
     //! clones a scenario and returns a pointer to the new object
     virtual boost::shared_ptr<Scenario> clone() const = 0;
 
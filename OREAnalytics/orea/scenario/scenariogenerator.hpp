@@ -50,6 +50,10 @@ public:
     //! Reset the generator so calls to next() return the first scenario.
     /*! This allows re-generation of scenarios if required. */
     virtual void reset() = 0;
+
+    //! Skip the next n paths, so that the next call to next() returns the first scenario of path n + 1
+    /*! This allows resuming an interrupted simulation. */
+    virtual void skip(Size) { QL_FAIL("ScenarioGenerator::skip() not implemented"); }
 };
 
 //! Scenario generator that generates an entire path
@@ -70,6 +74,12 @@ public:
         QL_REQUIRE(dates.front() > today, "date grid must start in the future");
     }
 
+    //! Skip the next n paths, must be called at the end of a path
+    virtual void skip(Size n) {
+        QL_REQUIRE(path_.empty() || pathStep_ == dates_.size(), "ScenarioPathGenerator::skip() called within a path");
+        skipPaths(n);
+    }
+
     virtual boost::shared_ptr<Scenario> next(const Date& d) {
         if (d == dates_.front()) { // new path
             path_ = nextPath();
@@ -81,6 +91,11 @@ public:
 
 protected:
     virtual std::vector<boost::shared_ptr<Scenario>> nextPath() = 0;
+    //! Skip the next n paths, the default implementation generates and discards them
+    virtual void skipPaths(Size n) {
+        for (Size i = 0; i < n; ++i)
+            nextPath();
+    }
 
     Date today_;
     vector<Date> dates_;
@@ -16,6 +16,7 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <orea/scenario/pipelinedmultipathgenerator.hpp>
 #include <orea/scenario/scenariogeneratorbuilder.hpp>
 #include <orea/scenario/simplescenariofactory.hpp>
 #include <ored/utilities/log.hpp>
@@ -49,9 +50,14 @@ ScenarioGeneratorBuilder::build(boost::shared_ptr<QuantExt::CrossAssetModel> mod
 
     boost::shared_ptr<StochasticProcess> stateProcess = model->stateProcess(data_->discretization());
 
-    boost::shared_ptr<QuantExt::MultiPathGeneratorBase> pathGen =
-        makeMultiPathGenerator(data_->sequenceType(), stateProcess, data_->grid()->timeGrid(), data_->seed(),
-                               data_->ordering(), data_->directionIntegers());
+    boost::shared_ptr<QuantExt::MultiPathGeneratorBase> pathGen;
+    if (pipelinePaths_)
+        pathGen = boost::make_shared<PipelinedMultiPathGenerator>(data_->sequenceType(), stateProcess,
+                                                                  data_->grid()->timeGrid(), data_->seed(),
+                                                                  data_->ordering(), data_->directionIntegers());
+    else
+        pathGen = makeMultiPathGenerator(data_->sequenceType(), stateProcess, data_->grid()->timeGrid(),
+                                         data_->seed(), data_->ordering(), data_->directionIntegers());
 
     boost::shared_ptr<ScenarioGenerator> scenGen = boost::make_shared<CrossAssetModelScenarioGenerator>(
         model, pathGen, scenarioFactory, marketConfig, asof, data_->grid(), initMarket, configuration);
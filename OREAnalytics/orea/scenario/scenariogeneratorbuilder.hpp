@@ -53,10 +53,11 @@ using namespace QuantLib;
 class ScenarioGeneratorBuilder {
 public:
     //! Default constructor
-    ScenarioGeneratorBuilder() {}
+    ScenarioGeneratorBuilder() : pipelinePaths_(false) {}
 
-    //! Constructor
-    ScenarioGeneratorBuilder(boost::shared_ptr<ScenarioGeneratorData> data) : data_(data) {}
+    //! Constructor, optionally the random variates of the paths are drawn in a background thread
+    ScenarioGeneratorBuilder(boost::shared_ptr<ScenarioGeneratorData> data, const bool pipelinePaths = false)
+        : data_(data), pipelinePaths_(pipelinePaths) {}
 
     //! Build function
     boost::shared_ptr<ScenarioGenerator>
@@ -67,6 +68,7 @@ public:
 
 private:
     boost::shared_ptr<ScenarioGeneratorData> data_;
+    bool pipelinePaths_;
 };
 } // namespace analytics
 } // namespace ore
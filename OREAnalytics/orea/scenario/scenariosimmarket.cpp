@@ -47,8 +47,10 @@
 #include <ored/marketdata/curvespecparser.hpp>
 #include <ored/utilities/indexparser.hpp>
 #include <ored/utilities/log.hpp>
+#include <ored/utilities/profiler.hpp>
 #include <qle/indexes/inflationindexobserver.hpp>
 #include <qle/indexes/inflationindexwrapper.hpp>
+#include <qle/termstructures/cachedinterpolateddiscountcurve.hpp>
 #include <qle/termstructures/blackvariancesurfacestddevs.hpp>
 #include <qle/termstructures/dynamicblackvoltermstructure.hpp>
 #include <qle/termstructures/dynamiccpivolatilitystructure.hpp>
@@ -167,7 +169,7 @@ void ScenarioSimMarket::addYieldCurve(const boost::shared_ptr<Market>& initMarke
 
     if (ObservationMode::instance().mode() == ObservationMode::Mode::Unregister) {
         yieldCurve = boost::shared_ptr<YieldTermStructure>(
-            new QuantExt::InterpolatedDiscountCurve(yieldCurveTimes, quotes, 0, TARGET(), dc));
+            new QuantExt::CachedInterpolatedDiscountCurve(yieldCurveTimes, quotes, 0, TARGET(), dc));
     } else {
         yieldCurve = boost::shared_ptr<YieldTermStructure>(
             new QuantExt::InterpolatedDiscountCurve2(yieldCurveTimes, quotes, dc));
@@ -195,7 +197,7 @@ ScenarioSimMarket::ScenarioSimMarket(
     const std::string& configuration, const ore::data::CurveConfigurations& curveConfigs,
     const ore::data::TodaysMarketParameters& todaysMarketParams, const bool continueOnError)
     : SimMarket(conventions), parameters_(parameters), fixingManager_(fixingManager),
-      filter_(boost::make_shared<ScenarioFilter>()) {
+      filter_(boost::make_shared<ScenarioFilter>()), compiledCount_(0) {
 
     LOG("building ScenarioSimMarket...");
     asof_ = initMarket->asofDate();
@@ -295,8 +297,9 @@ ScenarioSimMarket::ScenarioSimMarket(
                         // FIXME interpolation fixed to linear, added to xml??
                         boost::shared_ptr<YieldTermStructure> indexCurve;
                         if (ObservationMode::instance().mode() == ObservationMode::Mode::Unregister) {
-                            indexCurve = boost::shared_ptr<YieldTermStructure>(new QuantExt::InterpolatedDiscountCurve(
-                                yieldCurveTimes, quotes, 0, index->fixingCalendar(), dc));
+                            indexCurve =
+                                boost::shared_ptr<YieldTermStructure>(new QuantExt::CachedInterpolatedDiscountCurve(
+                                    yieldCurveTimes, quotes, 0, index->fixingCalendar(), dc));
                         } else {
                             indexCurve = boost::shared_ptr<YieldTermStructure>(
                                 new QuantExt::InterpolatedDiscountCurve2(yieldCurveTimes, quotes, dc));
@@ -1869,33 +1872,30 @@ ScenarioSimMarket::ScenarioSimMarket(
     baseScenario_ = boost::make_shared<SimpleScenario>(initMarket->asofDate(), "BASE", 1.0);
     for (auto const& data : simData_) {
         baseScenario_->add(data.first, data.second->value());
+        quotes_.push_back(data.second.get());
+        baseValues_.push_back(data.second->value());
     }
     LOG("building base scenario done");
 }
 
 void ScenarioSimMarket::applyScenario(const boost::shared_ptr<Scenario>& scenario) {
-    const vector<RiskFactorKey>& keys = scenario->keys();
-
-    Size count = 0;
-    for (const auto& key : keys) {
-        // Loop through the scenario keys and check which keys are present in simData_,
-        // adding to the count when a match is identified
-        // Then check that the count=simData_.size - this ensures that simData_ is a valid
-        // subset of the scenario - fails is a member of simData is not present in the
-        // scenario
-        auto it = simData_.find(key);
-        if (it == simData_.end()) {
-            ALOG("simulation data point missing for key " << key);
-        } else {
-            if (filter_->allow(key)) {
-                it->second->setValue(scenario->get(key));
-            }
-            count++;
-        }
+    ORE_PROFILE_SCOPE("SimMarket", "ApplyScenario");
+    if (auto delta = boost::dynamic_pointer_cast<DeltaScenario>(scenario)) {
+        // only patch the quotes of the delta if its base scenario is what the market currently shows
+        if (delta->baseScenario() != appliedScenario_ || filter_ != appliedFilter_)
+            applyScenario(delta->baseScenario());
+        applyDeltaScenario(delta);
+        return;
     }
 
-    if (count != simData_.size()) {
-        ALOG("mismatch between scenario and sim data size, " << count << " vs " << simData_.size());
+    // all quotes are set below, so there is nothing left to restore
+    patchedQuotes_.clear();
+
+    // Check that the count of scenario keys present in simData_ equals simData_.size - this ensures that simData_
+    // is a valid subset of the scenario - fails if a member of simData is not present in the scenario
+    compileScenario(scenario);
+    if (compiledCount_ != simData_.size()) {
+        ALOG("mismatch between scenario and sim data size, " << compiledCount_ << " vs " << simData_.size());
         for (auto it : simData_) {
             if (!scenario->has(it.first))
                 ALOG("Key " << it.first << " missing in scenario");
@@ -1903,20 +1903,90 @@ void ScenarioSimMarket::applyScenario(const boost::shared_ptr<Scenario>& scenari
         QL_FAIL("mismatch between scenario and sim data size, exit.");
     }
 
+    if (const Real* values = scenario->values()) {
+        for (Size i = 0; i < compiledPositions_.size(); ++i)
+            quotes_[compiledSlots_[i]]->setValue(values[compiledPositions_[i]]);
+    } else {
+        const vector<RiskFactorKey>& keys = scenario->keys();
+        for (Size i = 0; i < compiledPositions_.size(); ++i)
+            quotes_[compiledSlots_[i]]->setValue(scenario->get(keys[compiledPositions_[i]]));
+    }
+
+    appliedScenario_ = scenario;
+    appliedFilter_ = filter_;
+
+    // update market asof date
+    asof_ = scenario->asof();
+}
+
+void ScenarioSimMarket::applyDeltaScenario(const boost::shared_ptr<DeltaScenario>& scenario) {
+    for (auto const& p : patchedQuotes_)
+        p.first->setValue(p.second);
+    patchedQuotes_.clear();
+
+    for (auto const& d : scenario->delta()) {
+        auto it = simData_.find(d.first);
+        if (it == simData_.end()) {
+            ALOG("simulation data point missing for key " << d.first);
+        } else if (filter_->allow(d.first)) {
+            patchedQuotes_.push_back(std::make_pair(it->second, scenario->baseScenario()->get(d.first)));
+            it->second->setValue(d.second);
+        }
+    }
+
     // update market asof date
     asof_ = scenario->asof();
 }
 
+void ScenarioSimMarket::compileScenario(const boost::shared_ptr<Scenario>& scenario) {
+    // scenarios sharing their keys are recognised without comparing the keys
+    boost::shared_ptr<const vector<RiskFactorKey>> keys = scenario->sharedKeys();
+    if (compiledKeys_ && filter_ == compiledFilter_ &&
+        (keys ? keys == compiledKeys_ : scenario->keys() == *compiledKeys_))
+        return;
+
+    ORE_PROFILE_SCOPE("SimMarket", "CompileScenario");
+    if (!keys)
+        keys = boost::make_shared<vector<RiskFactorKey>>(scenario->keys());
+    // the slots follow the order of simData_, which is the key order of the base scenario
+    map<RiskFactorKey, Size> slots;
+    for (auto const& data : simData_)
+        slots.insert(slots.end(), std::make_pair(data.first, slots.size()));
+
+    compiledPositions_.clear();
+    compiledSlots_.clear();
+    compiledCount_ = 0;
+    for (Size i = 0; i < keys->size(); ++i) {
+        auto it = slots.find((*keys)[i]);
+        if (it == slots.end()) {
+            ALOG("simulation data point missing for key " << (*keys)[i]);
+        } else {
+            if (filter_->allow((*keys)[i])) {
+                compiledPositions_.push_back(i);
+                compiledSlots_.push_back(it->second);
+            }
+            compiledCount_++;
+        }
+    }
+    compiledKeys_ = keys;
+    compiledFilter_ = filter_;
+}
+
 void ScenarioSimMarket::reset() {
-    auto filterBackup = filter_;
-    // no filter
-    filter_ = boost::make_shared<ScenarioFilter>();
     // reset eval date
     Settings::instance().evaluationDate() = baseScenario_->asof();
     // reset numeraire
     numeraire_ = baseScenario_->getNumeraire();
-    // reset term structures
-    applyScenario(baseScenario_);
+    // reset term structures, regardless of the filter only the quotes that differ from the base scenario are set
+    for (Size i = 0; i < quotes_.size(); ++i) {
+        if (quotes_[i]->value() != baseValues_[i])
+            quotes_[i]->setValue(baseValues_[i]);
+    }
+    patchedQuotes_.clear();
+    asof_ = baseScenario_->asof();
+    // all quotes show the base scenario, so delta scenarios can be patched on top under any filter
+    appliedScenario_ = baseScenario_;
+    appliedFilter_ = filter_;
     // see the comment in update() for why this is necessary...
     if (ObservationMode::instance().mode() == ObservationMode::Mode::Unregister) {
         boost::shared_ptr<QuantLib::Observable> obs = QuantLib::Settings::instance().evaluationDate();
@@ -1924,8 +1994,13 @@ void ScenarioSimMarket::reset() {
     }
     // reset fixing manager
     fixingManager_->reset();
-    // restore the filter
-    filter_ = filterBackup;
+}
+
+void ScenarioSimMarket::skipSamples(Size samples) {
+    QL_REQUIRE(scenarioGenerator_ != nullptr, "ScenarioSimMarket::skipSamples: no scenario generator set");
+    scenarioGenerator_->skip(samples);
+    if (asd_)
+        asd_->skipSamples(samples);
 }
 
 void ScenarioSimMarket::update(const Date& d) {
@@ -1938,7 +2013,11 @@ void ScenarioSimMarket::update(const Date& d) {
     else if (om == ObservationMode::Mode::Defer)
         ObservableSettings::instance().disableUpdates(true);
 
-    boost::shared_ptr<Scenario> scenario = scenarioGenerator_->next(d);
+    boost::shared_ptr<Scenario> scenario;
+    {
+        ORE_PROFILE_SCOPE("SimMarket", "ScenarioGeneration");
+        scenario = scenarioGenerator_->next(d);
+    }
     QL_REQUIRE(scenario->asof() == d, "Invalid Scenario date " << scenario->asof() << ", expected " << d);
 
     numeraire_ = scenario->getNumeraire();
@@ -1960,6 +2039,7 @@ void ScenarioSimMarket::update(const Date& d) {
 
     // Observation Mode - key to update these before fixings are set
     if (om == ObservationMode::Mode::Disable) {
+        ORE_PROFILE_SCOPE("SimMarket", "Refresh");
         refresh();
         ObservableSettings::instance().enableUpdates();
     } else if (om == ObservationMode::Mode::Defer) {
@@ -1967,9 +2047,13 @@ void ScenarioSimMarket::update(const Date& d) {
     }
 
     // Apply fixings as historical fixings. Must do this before we populate ASD
-    fixingManager_->update(d);
+    {
+        ORE_PROFILE_SCOPE("SimMarket", "Fixings");
+        fixingManager_->update(d);
+    }
 
     if (asd_) {
+        ORE_PROFILE_SCOPE("SimMarket", "AggregationScenarioData");
         // add additional scenario data to the given container, if required
         for (auto i : parameters_->additionalScenarioDataIndices()) {
             boost::shared_ptr<QuantLib::Index> index;
@@ -1986,8 +2070,11 @@ void ScenarioSimMarket::update(const Date& d) {
         }
 
         for (auto c : parameters_->additionalScenarioDataCcys()) {
-            if (c != parameters_->baseCcy())
-                asd_->set(fxSpot(c + parameters_->baseCcy())->value(), AggregationScenarioDataType::FXSpot, c);
+            if (c != parameters_->baseCcy()) {
+                boost::shared_ptr<FXCrossRates> crossRates = fxCrossRates();
+                asd_->set(crossRates->rate(crossRates->index(c), crossRates->index(parameters_->baseCcy())),
+                          AggregationScenarioDataType::FXSpot, c);
+            }
         }
 
         asd_->set(numeraire_, AggregationScenarioDataType::Numeraire);
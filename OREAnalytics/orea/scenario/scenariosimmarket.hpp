@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <orea/scenario/deltascenario.hpp>
 #include <orea/scenario/scenario.hpp>
 #include <orea/scenario/scenariogenerator.hpp>
 #include <orea/scenario/scenariosimmarketparameters.hpp>
@@ -104,7 +105,7 @@ public:
     ScenarioFilter() {}
     virtual ~ScenarioFilter() {}
 
-    //! Allow this key to be updated
+    //! Allow this key to be updated, the result must not change while the filter is set in a sim market
     virtual bool allow(const RiskFactorKey& key) const { return true; }
 };
 
@@ -138,6 +139,8 @@ public:
     const boost::shared_ptr<AggregationScenarioData>& aggregationScenarioData() const { return asd_; }
 
     //! Set scenarioFilter
+    /*! The filter decisions are evaluated once per filter object and scenario key order, to change them a new filter
+        object has to be set. */
     boost::shared_ptr<ScenarioFilter>& filter() { return filter_; }
     //! Get scenarioFilter
     const boost::shared_ptr<ScenarioFilter>& filter() const { return filter_; }
@@ -148,6 +151,9 @@ public:
     //! Reset sim market to initial state
     virtual void reset() override;
 
+    //! Skip the next samples in the scenario generator and the aggregation scenario data
+    void skipSamples(Size samples) override;
+
     //! Scenario representing the initial state of the market
     boost::shared_ptr<Scenario> baseScenario() const { return baseScenario_; }
 
@@ -159,6 +165,13 @@ public:
 
 protected:
     virtual void applyScenario(const boost::shared_ptr<Scenario>& scenario);
+    /*! Applies the delta on top of its base scenario, which must be the scenario applied last. The quotes
+        patched by the previous delta scenario are restored to their base values first. */
+    void applyDeltaScenario(const boost::shared_ptr<DeltaScenario>& scenario);
+    /*! Resolves the keys of the scenario to the quote slots and evaluates the filter for them, unless the key order
+        and the filter are the ones of the last call. Scenarios with shared keys are compared by the identity of
+        their keys, other scenarios by the keys themselves. */
+    void compileScenario(const boost::shared_ptr<Scenario>& scenario);
     void addYieldCurve(const boost::shared_ptr<Market>& initMarket, const std::string& configuration,
                        const RiskFactorKey::KeyType rf, const string& key, const vector<Period>& tenors,
                        const std::string& dc, bool simulate = true);
@@ -180,6 +193,22 @@ protected:
     std::map<RiskFactorKey, boost::shared_ptr<SimpleQuote>> simData_;
     boost::shared_ptr<Scenario> baseScenario_;
 
+    // last scenario applied in full and the filter used, delta scenarios on top of it are applied as patches
+    boost::shared_ptr<Scenario> appliedScenario_;
+    boost::shared_ptr<ScenarioFilter> appliedFilter_;
+    // quotes patched by the last delta scenario and their values in the applied scenario
+    std::vector<std::pair<boost::shared_ptr<SimpleQuote>, Real>> patchedQuotes_;
+
+    // the quotes of simData_ and their values in the base scenario, in the key order of the base scenario
+    std::vector<SimpleQuote*> quotes_;
+    std::vector<Real> baseValues_;
+    // the compiled key order and filter: the positions of the keys allowed by the filter in the key order and
+    // their quote slots, and the number of keys found in simData_
+    boost::shared_ptr<const std::vector<RiskFactorKey>> compiledKeys_;
+    boost::shared_ptr<ScenarioFilter> compiledFilter_;
+    std::vector<Size> compiledPositions_, compiledSlots_;
+    Size compiledCount_;
+
     std::set<RiskFactorKey::KeyType> nonSimulatedFactors_;
 };
 } // namespace analytics
@@ -0,0 +1,264 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/scenario/scenariostore.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <ql/errors.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+using namespace QuantLib;
+using namespace std;
+
+namespace ore {
+namespace analytics {
+
+namespace {
+
+const char magic[] = "ORESCN02";
+
+void append(vector<char>& buffer, const void* p, Size n) {
+    const char* c = static_cast<const char*>(p);
+    buffer.insert(buffer.end(), c, c + n);
+}
+void append(vector<char>& buffer, const std::uint64_t x) { append(buffer, &x, sizeof(x)); }
+void append(vector<char>& buffer, const string& s) {
+    append(buffer, static_cast<std::uint64_t>(s.size()));
+    append(buffer, s.data(), s.size());
+}
+
+// bounds checked reads from the mapped header
+class HeaderReader {
+public:
+    HeaderReader(const char* begin, const char* end, const string& fileName)
+        : p_(begin), end_(end), fileName_(fileName) {}
+    void read(void* x, Size n) {
+        QL_REQUIRE(p_ + n <= end_, "ScenarioStoreGenerator: unexpected end of header in " << fileName_);
+        std::memcpy(x, p_, n);
+        p_ += n;
+    }
+    std::uint64_t readInteger() {
+        std::uint64_t x;
+        read(&x, sizeof(x));
+        return x;
+    }
+    string readString() {
+        Size n = readInteger();
+        QL_REQUIRE(p_ + n <= end_, "ScenarioStoreGenerator: unexpected end of header in " << fileName_);
+        string s(p_, n);
+        p_ += n;
+        return s;
+    }
+    const char* position() const { return p_; }
+
+private:
+    const char *p_, *end_;
+    string fileName_;
+};
+
+} // namespace
+
+std::uint64_t scenarioStoreHash(const string& configuration) {
+    std::uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : configuration) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+ScenarioStoreWriter::ScenarioStoreWriter(const boost::shared_ptr<ScenarioGenerator>& src, const string& fileName,
+                                         const Date& asof, const vector<Date>& dates, const bool singlePrecision,
+                                         const std::uint64_t configurationHash)
+    : src_(src), fileName_(fileName), asof_(asof), dates_(dates), singlePrecision_(singlePrecision),
+      configurationHash_(configurationHash), step_(0), firstSample_(0), paths_(0), headerWritten_(false) {
+    QL_REQUIRE(src_, "ScenarioStoreWriter: no scenario generator given");
+    QL_REQUIRE(!dates_.empty(), "ScenarioStoreWriter: no dates given");
+    file_.open(fileName_.c_str(), ios::binary | ios::trunc);
+    QL_REQUIRE(file_.is_open(), "ScenarioStoreWriter: error opening file " << fileName_);
+}
+
+ScenarioStoreWriter::~ScenarioStoreWriter() { file_.close(); }
+
+void ScenarioStoreWriter::reset() {
+    src_->reset();
+    if (file_.is_open()) {
+        file_.close();
+        LOG("ScenarioStoreWriter: " << paths_ << " paths written to " << fileName_);
+    }
+}
+
+void ScenarioStoreWriter::skip(Size n) {
+    QL_REQUIRE(!headerWritten_ || !file_.is_open(),
+               "ScenarioStoreWriter: paths can only be skipped before the first scenario is written");
+    src_->skip(n);
+    firstSample_ += n;
+}
+
+void ScenarioStoreWriter::writeHeader(const boost::shared_ptr<Scenario>& s) {
+    keys_ = s->keys();
+    QL_REQUIRE(!keys_.empty(), "ScenarioStoreWriter: no keys in scenario");
+    vector<char> header;
+    append(header, magic, sizeof(magic) - 1);
+    append(header, static_cast<std::uint64_t>(asof_.serialNumber()));
+    append(header, configurationHash_);
+    append(header, static_cast<std::uint64_t>(singlePrecision_ ? sizeof(float) : sizeof(double)));
+    append(header, static_cast<std::uint64_t>(firstSample_));
+    append(header, static_cast<std::uint64_t>(dates_.size()));
+    for (auto const& d : dates_)
+        append(header, static_cast<std::uint64_t>(d.serialNumber()));
+    append(header, static_cast<std::uint64_t>(keys_.size()));
+    for (auto const& k : keys_) {
+        append(header, static_cast<std::uint64_t>(k.keytype));
+        append(header, k.name);
+        append(header, static_cast<std::uint64_t>(k.index));
+    }
+    file_.write(header.data(), header.size());
+    headerWritten_ = true;
+}
+
+boost::shared_ptr<Scenario> ScenarioStoreWriter::next(const Date& d) {
+    boost::shared_ptr<Scenario> s = src_->next(d);
+    if (!file_.is_open())
+        return s;
+    if (!headerWritten_)
+        writeHeader(s);
+    if (d == dates_.front()) {
+        // a new path, an incomplete previous path is dropped
+        path_.clear();
+        step_ = 0;
+    }
+    QL_REQUIRE(step_ < dates_.size() && d == dates_[step_],
+               "ScenarioStoreWriter: scenario date " << d << " does not match the store dates");
+    QL_REQUIRE(s->keys().size() == keys_.size(), "ScenarioStoreWriter: scenario has "
+                                                     << s->keys().size() << " keys, the key dictionary "
+                                                     << keys_.size());
+    double numeraire = s->getNumeraire();
+    append(path_, &numeraire, sizeof(numeraire));
+    for (auto const& k : keys_) {
+        if (singlePrecision_) {
+            float v = static_cast<float>(s->get(k));
+            append(path_, &v, sizeof(v));
+        } else {
+            double v = s->get(k);
+            append(path_, &v, sizeof(v));
+        }
+    }
+    if (++step_ == dates_.size()) {
+        file_.write(path_.data(), path_.size());
+        file_.flush();
+        QL_REQUIRE(file_.good(), "ScenarioStoreWriter: error writing to " << fileName_);
+        path_.clear();
+        ++paths_;
+    }
+    return s;
+}
+
+ScenarioStoreGenerator::ScenarioStoreGenerator(const string& fileName,
+                                               const boost::shared_ptr<ScenarioFactory>& scenarioFactory)
+    : fileName_(fileName), scenarioFactory_(scenarioFactory), sample_(0), current_(0), step_(0) {
+    using namespace boost::interprocess;
+    QL_REQUIRE(scenarioFactory_, "ScenarioStoreGenerator: no scenario factory given");
+    try {
+        file_ = file_mapping(fileName_.c_str(), read_only);
+        region_ = mapped_region(file_, read_only);
+    } catch (const interprocess_exception& e) {
+        QL_FAIL("ScenarioStoreGenerator: error mapping file " << fileName_ << ": " << e.what());
+    }
+    data_ = static_cast<const char*>(region_.get_address());
+
+    HeaderReader header(data_, data_ + region_.get_size(), fileName_);
+    char m[sizeof(magic) - 1];
+    header.read(m, sizeof(m));
+    QL_REQUIRE(std::memcmp(m, magic, sizeof(m)) == 0, "ScenarioStoreGenerator: " << fileName_
+                                                                                   << " is not a scenario store");
+    asof_ = Date(static_cast<Date::serial_type>(header.readInteger()));
+    configurationHash_ = header.readInteger();
+    Size precision = header.readInteger();
+    QL_REQUIRE(precision == sizeof(float) || precision == sizeof(double),
+               "ScenarioStoreGenerator: invalid value size " << precision << " in " << fileName_);
+    singlePrecision_ = precision == sizeof(float);
+    firstSample_ = header.readInteger();
+    dates_.resize(header.readInteger());
+    for (auto& d : dates_)
+        d = Date(static_cast<Date::serial_type>(header.readInteger()));
+    QL_REQUIRE(!dates_.empty(), "ScenarioStoreGenerator: no dates in " << fileName_);
+    keys_.resize(header.readInteger());
+    for (auto& k : keys_) {
+        k.keytype = static_cast<RiskFactorKey::KeyType>(header.readInteger());
+        k.name = header.readString();
+        k.index = header.readInteger();
+    }
+
+    headerSize_ = header.position() - data_;
+    scenarioSize_ = sizeof(double) + keys_.size() * precision;
+    Size pathSize = dates_.size() * scenarioSize_;
+    samples_ = (region_.get_size() - headerSize_) / pathSize;
+    if (headerSize_ + samples_ * pathSize < region_.get_size())
+        WLOG("ScenarioStoreGenerator: ignore incomplete path at the end of " << fileName_);
+    LOG("ScenarioStoreGenerator: " << samples_ << " paths from sample " << firstSample_ << " with " << dates_.size()
+                                   << " dates and " << keys_.size() << " keys in " << fileName_);
+}
+
+void ScenarioStoreGenerator::reset() {
+    sample_ = 0;
+    step_ = 0;
+}
+
+void ScenarioStoreGenerator::skip(Size n) {
+    QL_REQUIRE(step_ == 0 || step_ == dates_.size(), "ScenarioStoreGenerator::skip() called within a path");
+    sample_ += n;
+}
+
+boost::shared_ptr<Scenario> ScenarioStoreGenerator::next(const Date& d) {
+    if (d == dates_.front()) {
+        QL_REQUIRE(sample_ >= firstSample_ && sample_ < firstSample_ + samples_,
+                   "ScenarioStoreGenerator: path " << sample_ << " is not in the store " << fileName_ << " (samples "
+                                                   << firstSample_ << " to " << firstSample_ + samples_ << ")");
+        current_ = sample_++;
+        step_ = 0;
+    }
+    QL_REQUIRE(step_ < dates_.size() && d == dates_[step_],
+               "ScenarioStoreGenerator: scenario date " << d << " does not match the store dates");
+
+    const char* p = data_ + headerSize_ + ((current_ - firstSample_) * dates_.size() + step_) * scenarioSize_;
+    double numeraire;
+    std::memcpy(&numeraire, p, sizeof(numeraire));
+    p += sizeof(numeraire);
+    boost::shared_ptr<Scenario> s = scenarioFactory_->buildScenario(d, "", numeraire);
+    for (auto const& k : keys_) {
+        if (singlePrecision_) {
+            float v;
+            std::memcpy(&v, p, sizeof(v));
+            p += sizeof(v);
+            s->add(k, v);
+        } else {
+            double v;
+            std::memcpy(&v, p, sizeof(v));
+            p += sizeof(v);
+            s->add(k, v);
+        }
+    }
+    ++step_;
+    return s;
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,130 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file scenario/scenariostore.hpp
+    \brief Binary store of simulated scenario paths and a scenario generator replaying it
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <orea/scenario/scenario.hpp>
+#include <orea/scenario/scenariofactory.hpp>
+#include <orea/scenario/scenariogenerator.hpp>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Hash of a configuration text, e.g. the XML of the model and simulation parameters, to identify a store
+/*! The hash (64 bit FNV-1a) does not depend on the platform or the build, so that it can be compared across runs. */
+std::uint64_t scenarioStoreHash(const std::string& configuration);
+
+//! Scenario generator that writes the scenarios of a wrapped generator to a binary scenario store
+/*! The store consists of a header with the asof date, a hash of the configuration that generated the scenarios, the
+    simulation dates and a key dictionary shared by all scenarios, followed by one block per path. A path block holds
+    for each date the numeraire in double precision and the values of all keys in the order of the dictionary, in
+    single or double precision. Only complete paths are written, so that the store of an interrupted run can still be
+    replayed.
+
+    If paths are skipped before the first scenario is written, the store starts at that sample. Skipping paths
+    afterwards is not supported. After a reset the wrapped generator is reset and no further paths are written.
+
+    \ingroup scenario
+*/
+class ScenarioStoreWriter : public ScenarioGenerator {
+public:
+    ScenarioStoreWriter(const boost::shared_ptr<ScenarioGenerator>& src, const std::string& fileName,
+                        const Date& asof, const std::vector<Date>& dates, const bool singlePrecision = false,
+                        const std::uint64_t configurationHash = 0);
+    ~ScenarioStoreWriter();
+
+    boost::shared_ptr<Scenario> next(const Date& d) override;
+    void reset() override;
+    void skip(Size n) override;
+
+private:
+    void writeHeader(const boost::shared_ptr<Scenario>& s);
+
+    boost::shared_ptr<ScenarioGenerator> src_;
+    std::string fileName_;
+    Date asof_;
+    std::vector<Date> dates_;
+    bool singlePrecision_;
+    std::uint64_t configurationHash_;
+    std::ofstream file_;
+    std::vector<RiskFactorKey> keys_;
+    std::vector<char> path_;
+    Size step_, firstSample_, paths_;
+    bool headerWritten_;
+};
+
+//! Scenario generator replaying the paths of a binary scenario store
+/*! The store file is memory-mapped, so that the paths are read on demand and shared by concurrent processes
+    replaying the same store. The generator keeps the path numbering of the simulation, i.e. after a reset it is
+    positioned at path 0 and only the paths firstSample() to firstSample() + samples() - 1 can be replayed, the
+    paths before a store starting at a later sample must be skipped.
+
+    \ingroup scenario
+*/
+class ScenarioStoreGenerator : public ScenarioGenerator {
+public:
+    ScenarioStoreGenerator(const std::string& fileName, const boost::shared_ptr<ScenarioFactory>& scenarioFactory);
+
+    boost::shared_ptr<Scenario> next(const Date& d) override;
+    void reset() override;
+    void skip(Size n) override;
+
+    //! \name Inspectors
+    //@{
+    const Date& asof() const { return asof_; }
+    //! hash of the configuration the scenarios were generated with
+    std::uint64_t configurationHash() const { return configurationHash_; }
+    const std::vector<Date>& dates() const { return dates_; }
+    const std::vector<RiskFactorKey>& keys() const { return keys_; }
+    bool singlePrecision() const { return singlePrecision_; }
+    //! index of the first stored sample
+    Size firstSample() const { return firstSample_; }
+    //! number of stored samples
+    Size samples() const { return samples_; }
+    //@}
+
+private:
+    std::string fileName_;
+    boost::shared_ptr<ScenarioFactory> scenarioFactory_;
+    boost::interprocess::file_mapping file_;
+    boost::interprocess::mapped_region region_;
+    const char* data_;
+    Date asof_;
+    std::uint64_t configurationHash_;
+    std::vector<Date> dates_;
+    std::vector<RiskFactorKey> keys_;
+    bool singlePrecision_;
+    Size firstSample_, samples_, headerSize_, scenarioSize_;
+    Size sample_, current_, step_;
+};
+
+} // namespace analytics
+} // namespace ore
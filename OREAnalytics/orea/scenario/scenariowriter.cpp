@@ -55,10 +55,18 @@ void ScenarioWriter::close() {
     }
 }
 
+void ScenarioWriter::skip(Size n) {
+    QL_REQUIRE(src_, "No ScenarioGenerator found.");
+    src_->skip(n);
+    // keep the scenario numbering of an uninterrupted run, i_ is bumped by the first date of the next path
+    i_ += n;
+}
+
 boost::shared_ptr<Scenario> ScenarioWriter::next(const Date& d) {
     QL_REQUIRE(src_, "No ScenarioGenerator found.");
     boost::shared_ptr<Scenario> s = src_->next(d);
-    writeScenario(s, i_ == 0);
+    // the header is written with the first scenario, i_ might be positive if paths were skipped before
+    writeScenario(s, firstDate_ == Date());
     return s;
 }
 
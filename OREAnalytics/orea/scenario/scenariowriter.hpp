@@ -51,6 +51,9 @@ public:
     //! Reset the generator so calls to next() return the first scenario.
     virtual void reset();
 
+    //! Skip the next n paths of the wrapped generator, the skipped paths are not written
+    virtual void skip(Size n);
+
     //! Close the file if it is open, not normally needed by client code
     void close();
 
@@ -16,6 +16,7 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <orea/scenario/deltascenario.hpp>
 #include <orea/scenario/sensitivityscenariogenerator.hpp>
 #include <ored/utilities/indexparser.hpp>
 #include <ored/utilities/log.hpp>
@@ -27,6 +28,7 @@
 #include <qle/termstructures/swaptionvolconstantspread.hpp>
 
 #include <algorithm>
+#include <set>
 
 using namespace QuantLib;
 using namespace QuantExt;
@@ -204,14 +206,24 @@ void SensitivityScenarioGenerator::generateScenarios() {
 
     // add simultaneous up-moves in two risk factors for cross gamma calculation
 
-    // store base scenario values
-    vector<RiskFactorKey> keys = baseScenario_->keys();
+    // delta scenarios on top of the base scenario only differ from the base in the keys stored in their deltas
+    Size index = scenarios_.size();
+    bool deltaScenarios = true;
+    for (Size i = 1; i < index && deltaScenarios; ++i) {
+        auto delta = boost::dynamic_pointer_cast<DeltaScenario>(scenarios_[i]);
+        deltaScenarios = delta && delta->baseScenario() == baseScenario_;
+    }
+
+    // store base scenario values, unless the scenarios are delta scenarios
+    vector<RiskFactorKey> keys;
     vector<Real> baseValues;
-    for (auto k : keys) {
-        baseValues.push_back(baseScenario_->get(k));
+    if (!deltaScenarios) {
+        keys = baseScenario_->keys();
+        for (auto k : keys) {
+            baseValues.push_back(baseScenario_->get(k));
+        }
     }
 
-    Size index = scenarios_.size();
     for (Size i = 0; i < index; ++i) {
         ScenarioDescription iDesc = scenarioDescriptions_[i];
         if (iDesc.type() != ScenarioDescription::Type::Up)
@@ -243,13 +255,30 @@ void SensitivityScenarioGenerator::generateScenarios() {
 
             boost::shared_ptr<Scenario> crossScenario = sensiScenarioFactory_->buildScenario(asof);
             boost::shared_ptr<Scenario> jScenario = scenarios_[j];
-            for (Size k = 0; k < keys.size(); k++) {
-                Real iValue = iValues[k];
-                Real jValue = jScenario->get(keys[k]);
-                Real baseValue = baseValues[k];
-                if (!close_enough(iValue, baseValue) || !close_enough(jValue, baseValue)) {
-                    Real newVal = iValue + jValue - baseValue;
-                    crossScenario->add(keys[k], newVal);
+            if (deltaScenarios) {
+                std::set<RiskFactorKey> deltaKeys;
+                for (auto const& d : boost::static_pointer_cast<DeltaScenario>(iScenario)->delta())
+                    deltaKeys.insert(d.first);
+                for (auto const& d : boost::static_pointer_cast<DeltaScenario>(jScenario)->delta())
+                    deltaKeys.insert(d.first);
+                for (auto const& k : deltaKeys) {
+                    Real iValue = iScenario->get(k);
+                    Real jValue = jScenario->get(k);
+                    Real baseValue = baseScenario_->get(k);
+                    if (!close_enough(iValue, baseValue) || !close_enough(jValue, baseValue)) {
+                        Real newVal = iValue + jValue - baseValue;
+                        crossScenario->add(k, newVal);
+                    }
+                }
+            } else {
+                for (Size k = 0; k < keys.size(); k++) {
+                    Real iValue = iValues[k];
+                    Real jValue = jScenario->get(keys[k]);
+                    Real baseValue = baseValues[k];
+                    if (!close_enough(iValue, baseValue) || !close_enough(jValue, baseValue)) {
+                        Real newVal = iValue + jValue - baseValue;
+                        crossScenario->add(keys[k], newVal);
+                    }
                 }
             }
 
@@ -51,6 +51,8 @@ using namespace data;
 
   The generator then produces comprehensive scenarios that can be applied to the simulation market,
   i.e. covering all quotes in the simulation market, possibly filled with "base" scenario values.
+  If the scenario factory builds DeltaScenario objects (see DeltaScenarioFactory) only the shifted
+  quotes are stored per scenario, the remaining values are read from the shared base scenario.
 
   Both UP and DOWN shifts are generated in order to facilitate delta and gamma calculation.
 
@@ -26,18 +26,57 @@ namespace analytics {
 
 // Simple Scenario class
 
-bool SimpleScenario::has(const RiskFactorKey& key) const { return data_.find(key) != data_.end(); }
+bool SimpleScenario::has(const RiskFactorKey& key) const {
+    auto it = keySet_->positions.find(key);
+    return it != keySet_->positions.end() && it->second < data_.size();
+}
 
 void SimpleScenario::add(const RiskFactorKey& key, Real value) {
-    data_[key] = value; // key might already exist, so we cannot use insert/emplace
-    if (std::find(keys_.begin(), keys_.end(), key) == keys_.end())
-        keys_.emplace_back(key);
+    Size n = data_.size();
+    // the next key of the key set
+    if (n < keySet_->keys.size() && keySet_->keys[n] == key) {
+        data_.push_back(value);
+        return;
+    }
+    // key might already exist
+    auto it = keySet_->positions.find(key);
+    if (it != keySet_->positions.end() && it->second < n) {
+        data_[it->second] = value;
+        return;
+    }
+    // a new key, the key set is only extended in place if no other scenario uses it
+    if (keySet_.use_count() > 1 || keySet_->keys.size() > n)
+        copyKeySet(n);
+    keySet_->positions[key] = n;
+    keySet_->keys.push_back(key);
+    data_.push_back(value);
 }
 
 Real SimpleScenario::get(const RiskFactorKey& key) const {
-    auto it = data_.find(key);
-    QL_REQUIRE(it != data_.end(), "Scenario does not provide data for key " << key);
-    return it->second;
+    auto it = keySet_->positions.find(key);
+    QL_REQUIRE(it != keySet_->positions.end() && it->second < data_.size(),
+               "Scenario does not provide data for key " << key);
+    return data_[it->second];
+}
+
+boost::shared_ptr<const std::vector<RiskFactorKey>> SimpleScenario::sharedKeys() const {
+    // the aliasing constructor keeps the key set alive, so that it is not extended in place
+    const boost::shared_ptr<KeySet>& k = keySet();
+    return boost::shared_ptr<const std::vector<RiskFactorKey>>(k, &k->keys);
+}
+
+const boost::shared_ptr<SimpleScenario::KeySet>& SimpleScenario::keySet() const {
+    if (keySet_->keys.size() != data_.size())
+        copyKeySet(data_.size());
+    return keySet_;
+}
+
+void SimpleScenario::copyKeySet(Size n) const {
+    auto keySet = boost::make_shared<KeySet>();
+    keySet->keys.assign(keySet_->keys.begin(), keySet_->keys.begin() + n);
+    for (Size i = 0; i < n; ++i)
+        keySet->positions[keySet->keys[i]] = i;
+    keySet_ = keySet;
 }
 
 boost::shared_ptr<Scenario> SimpleScenario::clone() const { return boost::make_shared<SimpleScenario>(*this); }
@@ -25,8 +25,10 @@
 
 #include <orea/scenario/scenario.hpp>
 
+#include <boost/make_shared.hpp>
 #include <boost/serialization/export.hpp>
-#include <boost/serialization/map.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/string.hpp>
 #include <boost/serialization/vector.hpp>
 
 namespace ore {
@@ -35,19 +37,28 @@ using std::string;
 
 //-----------------------------------------------------------------------------------------------
 //! Simple Scenario class
-/*! This implementation stores the data in several maps within in each scenario class instance.
-  This contains redundant information (keys) across scenario instances which can cause issues
-  when many scenario instances are managed in memory.
+/*! This implementation stores the values in the order of the keys. The keys and their positions are held in a key
+  set, which can be shared by scenarios that have the same keys in the same order, e.g. the scenarios built by a
+  SimpleScenarioFactory. A scenario built on a key set stores the values of keys added in the order of the key set
+  without a lookup. A scenario that adds keys in another order or adds other keys copies the key set first.
 
   \ingroup scenario
 */
 class SimpleScenario : public Scenario {
 public:
+    //! Keys of a scenario and their positions in the key order
+    struct KeySet {
+        std::vector<RiskFactorKey> keys;
+        std::map<RiskFactorKey, Size> positions;
+    };
+
     //! Constructor
-    SimpleScenario() {}
-    //! Constructor
-    SimpleScenario(Date asof, const std::string& label = "", Real numeraire = 0)
-        : asof_(asof), numeraire_(numeraire), label_(label) {}
+    SimpleScenario() : keySet_(boost::make_shared<KeySet>()) {}
+    //! Constructor, the keys are expected to be added in the order of the given key set, if any
+    SimpleScenario(Date asof, const std::string& label = "", Real numeraire = 0,
+                   const boost::shared_ptr<KeySet>& keySet = boost::shared_ptr<KeySet>())
+        : asof_(asof), numeraire_(numeraire), label_(label),
+          keySet_(keySet ? keySet : boost::make_shared<KeySet>()) {}
 
     //! Return the scenario asof date
     const Date& asof() const override { return asof_; }
@@ -64,27 +75,50 @@ public:
 
     //! Check, get, add a single market point
     bool has(const RiskFactorKey& key) const override;
-    const std::vector<RiskFactorKey>& keys() const override { return keys_; }
+    const std::vector<RiskFactorKey>& keys() const override { return keySet()->keys; }
     void add(const RiskFactorKey& key, Real value) override;
     Real get(const RiskFactorKey& key) const override;
 
+    boost::shared_ptr<const std::vector<RiskFactorKey>> sharedKeys() const override;
+    const Real* values() const override { return data_.data(); }
+
     boost::shared_ptr<Scenario> clone() const override;
 
+    //! The key set holding exactly the keys of this scenario
+    const boost::shared_ptr<KeySet>& keySet() const;
+
 private:
+    // replace the key set by a copy of its first n keys
+    void copyKeySet(Size n) const;
+
     friend class boost::serialization::access;
-    template <class Archive> void serialize(Archive& ar, const unsigned int) {
+    template <class Archive> void save(Archive& ar, const unsigned int) const {
+        ar& boost::serialization::base_object<Scenario>(*this);
+        ar& asof_;
+        ar& numeraire_;
+        ar& keys();
+        ar& data_;
+        ar& label_;
+    }
+    template <class Archive> void load(Archive& ar, const unsigned int) {
         ar& boost::serialization::base_object<Scenario>(*this);
         ar& asof_;
         ar& numeraire_;
+        keySet_ = boost::make_shared<KeySet>();
+        ar& keySet_->keys;
+        for (Size i = 0; i < keySet_->keys.size(); ++i)
+            keySet_->positions[keySet_->keys[i]] = i;
         ar& data_;
-        ar& keys_;
         ar& label_;
     }
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+
     Date asof_;
     Real numeraire_;
-    std::map<RiskFactorKey, Real> data_;
-    std::vector<RiskFactorKey> keys_;
     std::string label_;
+    // the first data_.size() keys of the key set are the keys of this scenario
+    mutable boost::shared_ptr<KeySet> keySet_;
+    std::vector<Real> data_;
 };
 } // namespace analytics
 } // namespace ore
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <boost/make_shared.hpp>
+#include <boost/weak_ptr.hpp>
 #include <orea/scenario/scenariofactory.hpp>
 #include <orea/scenario/simplescenario.hpp>
 
@@ -31,14 +32,25 @@ namespace ore {
 namespace analytics {
 
 //! Factory class for building simple scenario objects
-/*! \ingroup scenario
+/*! A scenario is built on the key set of the scenario built before, if that one is still alive, so that scenarios
+    filled with the same keys in the same order share their keys.
+
+    \ingroup scenario
  */
 class SimpleScenarioFactory : public ScenarioFactory {
 public:
     const boost::shared_ptr<Scenario> buildScenario(Date asof, const std::string& label = "",
                                                     Real numeraire = 0.0) const {
-        return boost::make_shared<SimpleScenario>(asof, label, numeraire);
+        if (auto last = last_.lock())
+            keySet_ = last->keySet();
+        auto scenario = boost::make_shared<SimpleScenario>(asof, label, numeraire, keySet_);
+        last_ = scenario;
+        return scenario;
     }
+
+private:
+    mutable boost::shared_ptr<SimpleScenario::KeySet> keySet_;
+    mutable boost::weak_ptr<SimpleScenario> last_;
 };
 
 } // namespace analytics
@@ -58,12 +58,27 @@ void FixingManager::initialise(const boost::shared_ptr<Portfolio>& portfolio) {
         }
     }
 
-    // Now cache the original fixings so we can re-write on reset()
-    for (auto m : fixingMap_) {
-        fixingCache_[m.first] = IndexManager::instance().getHistory(m.first->name());
+    // Now cache the original fixings so we can re-write on reset(). The fixings of indices that are only read through
+    // a fixing history go to the overlay, if there is one, and their histories are left unchanged.
+    for (auto const& m : fixingMap_) {
+        auto r = readsOverlay_.find(m.first);
+        if (overlay_ && r != readsOverlay_.end() && r->second) {
+            overlayHandles_[m.first] = QuantExt::FixingOverlay::handle(m.first->name());
+            DLOG("FixingManager: fixings of " << m.first->name() << " are written to the overlay");
+        } else
+            fixingCache_[m.first] = IndexManager::instance().getHistory(m.first->name());
     }
 }
 
+void FixingManager::addFixingDate(const boost::shared_ptr<Index>& index, const Date& d, const bool readsOverlay) {
+    fixingMap_[index].insert(d);
+    // the FxIndex reads its past fixings through a fixing history in any case
+    bool overlay = readsOverlay || boost::dynamic_pointer_cast<FxIndex>(index) != nullptr;
+    auto r = readsOverlay_.insert(std::make_pair(index, overlay));
+    if (!overlay)
+        r.first->second = false;
+}
+
 void FixingManager::processCashFlows(const boost::shared_ptr<QuantLib::CashFlow> cf) {
 
     // For any coupon type that requires fixings, it must be handled here
@@ -80,8 +95,11 @@ void FixingManager::processCashFlows(const boost::shared_ptr<QuantLib::CashFlow>
     // extract underlying from cap/floored coupons
     boost::shared_ptr<FloatingRateCoupon> frc;
     auto cfCpn = boost::dynamic_pointer_cast<CappedFlooredCoupon>(cf);
+    auto cfOnCpn = boost::dynamic_pointer_cast<QuantExt::CappedFlooredOvernightIndexedCoupon>(cf);
     if (cfCpn)
         frc = cfCpn->underlying();
+    else if (cfOnCpn)
+        frc = cfOnCpn->underlying();
     else
         frc = boost::dynamic_pointer_cast<FloatingRateCoupon>(cf);
 
@@ -89,43 +107,43 @@ void FixingManager::processCashFlows(const boost::shared_ptr<QuantLib::CashFlow>
         // A1 indices with fixings derived from underlying indices
         auto cmssp = boost::dynamic_pointer_cast<CmsSpreadCoupon>(frc);
         if (cmssp) {
-            fixingMap_[cmssp->swapSpreadIndex()->swapIndex1()].insert(frc->fixingDate());
-            fixingMap_[cmssp->swapSpreadIndex()->swapIndex2()].insert(frc->fixingDate());
+            addFixingDate(cmssp->swapSpreadIndex()->swapIndex1(), frc->fixingDate());
+            addFixingDate(cmssp->swapSpreadIndex()->swapIndex2(), frc->fixingDate());
             return;
         }
         auto dcmssp = boost::dynamic_pointer_cast<DigitalCmsSpreadCoupon>(frc);
         if (dcmssp) {
-            fixingMap_
-                [boost::dynamic_pointer_cast<CmsSpreadCoupon>(dcmssp->underlying())->swapSpreadIndex()->swapIndex1()]
-                    .insert(frc->fixingDate());
-            fixingMap_
-                [boost::dynamic_pointer_cast<CmsSpreadCoupon>(dcmssp->underlying())->swapSpreadIndex()->swapIndex2()]
-                    .insert(frc->fixingDate());
+            auto spreadIndex = boost::dynamic_pointer_cast<CmsSpreadCoupon>(dcmssp->underlying())->swapSpreadIndex();
+            addFixingDate(spreadIndex->swapIndex1(), frc->fixingDate());
+            addFixingDate(spreadIndex->swapIndex2(), frc->fixingDate());
             return;
         }
 
         // A2 indices with native fixings, but no only on the standard fixing date
+        // the QuantExt overnight indexed coupon and BRL CDI pricers read the past fixings through the coupon's fixing
+        // history, other pricers might read the IndexManager
         auto on = boost::dynamic_pointer_cast<QuantExt::OvernightIndexedCoupon>(frc);
         if (on) {
+            bool readsOverlay = on->readsFixingHistory();
             for (auto const& d : on->fixingDates())
-                fixingMap_[on->index()].insert(d);
+                addFixingDate(on->index(), d, readsOverlay);
             return;
         }
         auto avon = boost::dynamic_pointer_cast<AverageONIndexedCoupon>(frc);
         if (avon) {
             for (auto const& d : avon->fixingDates())
-                fixingMap_[avon->index()].insert(d);
+                addFixingDate(avon->index(), d);
             return;
         }
         auto bma = boost::dynamic_pointer_cast<AverageBMACoupon>(frc);
         if (bma) {
             for (auto const& d : bma->fixingDates())
-                fixingMap_[bma->index()].insert(d);
+                addFixingDate(bma->index(), d);
             return;
         }
 
         // A3 standard case
-        fixingMap_[frc->index()].insert(frc->fixingDate());
+        addFixingDate(frc->index(), frc->fixingDate());
     }
 
     // B other coupon types
@@ -133,32 +151,32 @@ void FixingManager::processCashFlows(const boost::shared_ptr<QuantLib::CashFlow>
     boost::shared_ptr<FloatingRateFXLinkedNotionalCoupon> fc =
         boost::dynamic_pointer_cast<FloatingRateFXLinkedNotionalCoupon>(cf);
     if (fc) {
-        fixingMap_[fc->index()].insert(fc->fixingDate());
-        fixingMap_[fc->fxIndex()].insert(fc->fxFixingDate());
+        addFixingDate(fc->index(), fc->fixingDate());
+        addFixingDate(fc->fxIndex(), fc->fxFixingDate());
         return;
     }
 
     boost::shared_ptr<FXLinkedCashFlow> flcf = boost::dynamic_pointer_cast<FXLinkedCashFlow>(cf);
     if (flcf) {
-        fixingMap_[flcf->fxIndex()].insert(flcf->fxFixingDate());
+        addFixingDate(flcf->fxIndex(), flcf->fxFixingDate());
         return;
     }
 
     boost::shared_ptr<CPICoupon> cpc = boost::dynamic_pointer_cast<CPICoupon>(cf);
     if (cpc) {
-        fixingMap_[cpc->index()].insert(cpc->fixingDate());
+        addFixingDate(cpc->index(), cpc->fixingDate());
         return;
     }
 
     boost::shared_ptr<InflationCoupon> ic = boost::dynamic_pointer_cast<InflationCoupon>(cf);
     if (ic) {
-        fixingMap_[ic->index()].insert(ic->fixingDate());
+        addFixingDate(ic->index(), ic->fixingDate());
         return;
     }
 
     boost::shared_ptr<CPICashFlow> cpcf = boost::dynamic_pointer_cast<CPICashFlow>(cf);
     if (cpcf) {
-        fixingMap_[cpcf->index()].insert(cpcf->fixingDate());
+        addFixingDate(cpcf->index(), cpcf->fixingDate());
         return;
     }
 }
@@ -177,6 +195,8 @@ void FixingManager::update(Date d) {
 //! Reset fixings to t0 (today)
 void FixingManager::reset() {
     if (modifiedFixingHistory_) {
+        if (overlay_)
+            overlay_->clear();
         for (auto& kv : fixingCache_)
             IndexManager::instance().setHistory(kv.first->name(), kv.second);
         modifiedFixingHistory_ = false;
@@ -243,7 +263,12 @@ void FixingManager::applyFixings(Date start, Date end) {
                 if (d >= fixEnd)
                     break;
             }
-            m.first->addFixings(history, true);
+            auto h = overlayHandles_.find(m.first);
+            if (h != overlayHandles_.end()) {
+                for (auto const& f : history)
+                    overlay_->addFixing(h->second, f.first, f.second);
+            } else
+                m.first->addFixings(history, true);
         }
     }
 }
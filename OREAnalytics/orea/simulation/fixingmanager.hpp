@@ -23,6 +23,7 @@
 #pragma once
 
 #include <ored/portfolio/portfolio.hpp>
+#include <qle/indexes/fixinghistory.hpp>
 
 namespace ore {
 namespace analytics {
@@ -42,11 +43,21 @@ using ore::data::Portfolio;
   When stepping between simulation dated t_(n-1) and t_(n) and update a fixing t with t_(n-1) < t < t(n) than the fixing
   from t(n) will be backfilled. There is currently no interpolation of fixings.
 
+  If a fixing overlay is given, the fixings of indices whose past fixings are only read through a
+  QuantExt::FixingHistory are written to the overlay instead of the IndexManager, and a reset clears the overlay.
+  These are the FxIndex and overnight indices that are used only by QuantExt::OvernightIndexedCoupons whose pricer
+  reads the coupon's fixing history, i.e. the default pricer and the BRLCdiCouponPricer. The fixings of
+  all other indices, e.g. Ibor, inflation or overnight indices in average coupons, are written to the IndexManager
+  and restored on reset as without an overlay. The overlay must be made current on the pricing thread with a
+  QuantExt::FixingOverlayScope.
+
   \ingroup simulation
  */
 class FixingManager {
 public:
-    FixingManager(Date today) : today_(today), fixingsEnd_(today), modifiedFixingHistory_(false) {}
+    FixingManager(Date today, const boost::shared_ptr<QuantExt::FixingOverlay>& overlay =
+                                  boost::shared_ptr<QuantExt::FixingOverlay>())
+        : today_(today), fixingsEnd_(today), modifiedFixingHistory_(false), overlay_(overlay) {}
     virtual ~FixingManager() {}
 
     //! Initialise the manager with these flows and indices from the given portfolio
@@ -60,11 +71,18 @@ public:
     //! Reset fixings to t0 (today)
     void reset();
 
+    //! The overlay the fixings are written to, null if they are written to the IndexManager
+    const boost::shared_ptr<QuantExt::FixingOverlay>& overlay() const { return overlay_; }
+
 protected:
     void applyFixings(Date start, Date end);
+    /*! Add a fixing date of an index, readsOverlay is true if the cashflow reads the past fixings of the index through
+        a QuantExt::FixingHistory. Indices added to the fixingMap_ directly are written to the IndexManager. */
+    void addFixingDate(const boost::shared_ptr<Index>& index, const Date& d, const bool readsOverlay = false);
 
     Date today_, fixingsEnd_;
     bool modifiedFixingHistory_;
+    boost::shared_ptr<QuantExt::FixingOverlay> overlay_;
 
     struct indexComp {
         bool operator()(const boost::shared_ptr<Index>& a, const boost::shared_ptr<Index>& b) const {
@@ -73,6 +91,10 @@ protected:
     };
     std::map<boost::shared_ptr<Index>, TimeSeries<Real>, indexComp> fixingCache_;
     std::map<boost::shared_ptr<Index>, std::set<Date>, indexComp> fixingMap_;
+    // true if all cashflows read the past fixings of the index through a fixing history
+    std::map<boost::shared_ptr<Index>, bool, indexComp> readsOverlay_;
+    // overlay handles of the indices in fixingMap_ whose fixings are written to the overlay
+    std::map<boost::shared_ptr<Index>, Size, indexComp> overlayHandles_;
 };
 } // namespace analytics
 } // namespace ore
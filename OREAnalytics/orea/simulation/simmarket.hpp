@@ -54,6 +54,9 @@ public:
     //! Reset sim market to initial state
     virtual void reset() = 0;
 
+    //! Skip the given number of samples, e.g. to resume an interrupted simulation
+    virtual void skipSamples(Size) { QL_FAIL("SimMarket::skipSamples() not implemented"); }
+
     //! Get the fixing manager
     virtual const boost::shared_ptr<FixingManager>& fixingManager() const = 0;
 
@@ -21,6 +21,8 @@
 #include <oret/toplevelfixture.hpp>
 #include <test/oreatoplevelfixture.hpp>
 
+#include <cstdio>
+
 using namespace ore::analytics;
 using namespace boost::unit_test_framework;
 
@@ -65,6 +67,58 @@ BOOST_AUTO_TEST_CASE(testInMemoryAggregationScenarioData) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testHandles) {
+    InMemoryAggregationScenarioData data(3, 5);
+    for (Size i = 0; i < 3; ++i) {
+        for (Size j = 0; j < 5; ++j) {
+            data.set(i, j, 1.0 + 0.1 * i + 0.01 * j, AggregationScenarioDataType::Numeraire);
+            data.set(i, j, i + 0.1 * j, AggregationScenarioDataType::FXSpot, "EURUSD");
+        }
+    }
+
+    BOOST_CHECK_THROW(data.handle(AggregationScenarioDataType::FXSpot, "EURGBP"), std::exception);
+    Size numeraire = data.handle(AggregationScenarioDataType::Numeraire);
+    Size fx = data.handle(AggregationScenarioDataType::FXSpot, "EURUSD");
+    BOOST_CHECK(numeraire != fx);
+    BOOST_CHECK_THROW(data.samples(2, 0), std::exception);
+    BOOST_CHECK_THROW(data.samples(fx, 3), std::exception);
+
+    // the handles stay valid when data for a new key is added
+    data.set(0, 0, 0.5, AggregationScenarioDataType::IndexFixing, "OIS_EUR");
+    BOOST_CHECK_EQUAL(data.handle(AggregationScenarioDataType::FXSpot, "EURUSD"), fx);
+
+    Real tol = 1.0E-12;
+    for (Size i = 0; i < 3; ++i) {
+        const Real* row = data.samples(numeraire, i);
+        for (Size j = 0; j < 5; ++j) {
+            BOOST_CHECK_CLOSE(row[j], 1.0 + 0.1 * i + 0.01 * j, tol);
+            BOOST_CHECK_CLOSE(data.get(fx, i, j), i + 0.1 * j, tol);
+        }
+    }
+
+    // truncation keeps the first samples of each row
+    data.truncateSamples(2);
+    BOOST_CHECK_EQUAL(data.dimSamples(), 2);
+    for (Size i = 0; i < 3; ++i) {
+        for (Size j = 0; j < 2; ++j) {
+            BOOST_CHECK_CLOSE(data.get(numeraire, i, j), 1.0 + 0.1 * i + 0.01 * j, tol);
+            BOOST_CHECK_CLOSE(data.get(i, j, AggregationScenarioDataType::FXSpot, "EURUSD"), i + 0.1 * j, tol);
+        }
+    }
+
+    // the handles are restored on load
+    string fileName = "aggregationscenariodata_test.dat";
+    data.save(fileName);
+    InMemoryAggregationScenarioData loaded;
+    loaded.load(fileName);
+    std::remove(fileName.c_str());
+    BOOST_CHECK(loaded.keys() == data.keys());
+    BOOST_CHECK_EQUAL(loaded.handle(AggregationScenarioDataType::FXSpot, "EURUSD"), fx);
+    for (Size i = 0; i < 3; ++i)
+        for (Size j = 0; j < 2; ++j)
+            BOOST_CHECK_EQUAL(loaded.get(numeraire, i, j), data.get(numeraire, i, j));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,299 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "testmarket.hpp"
+#include "testportfolio.hpp"
+#include <boost/test/unit_test.hpp>
+#include <orea/cube/inmemorycube.hpp>
+#include <orea/engine/amcvaluationengine.hpp>
+#include <orea/scenario/aggregationscenariodata.hpp>
+#include <orea/scenario/scenariogeneratordata.hpp>
+#include <ored/model/crossassetmodelbuilder.hpp>
+#include <ored/model/crossassetmodeldata.hpp>
+#include <ored/model/lgmdata.hpp>
+#include <ored/portfolio/builders/capfloor.hpp>
+#include <ored/portfolio/builders/swap.hpp>
+#include <ored/portfolio/builders/swaption.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/utilities/dategrid.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <qle/pricingengines/analyticlgmswaptionengine.hpp>
+#include <qle/pricingengines/numericlgmswaptionengine.hpp>
+#include <ql/instruments/swaption.hpp>
+#include <ql/time/date.hpp>
+#include <test/oreatoplevelfixture.hpp>
+
+using namespace std;
+using namespace QuantLib;
+using namespace QuantExt;
+using namespace ore::analytics;
+using namespace ore::data;
+using namespace boost::unit_test_framework;
+
+using testsuite::buildBermudanSwaption;
+using testsuite::buildCap;
+using testsuite::buildEuropeanSwaption;
+using testsuite::buildSwap;
+using testsuite::TestMarket;
+
+namespace {
+
+struct AmcSetup {
+    AmcSetup() : today(14, April, 2016), samples(2000) {
+        Settings::instance().evaluationDate() = today;
+        market = boost::make_shared<TestMarket>(today);
+
+        vector<string> expiries = {"1Y", "2Y", "3Y", "5Y", "7Y", "10Y", "15Y", "20Y", "30Y"};
+        vector<string> terms(expiries.size(), "5Y");
+        vector<string> strikes(expiries.size(), "ATM");
+        vector<boost::shared_ptr<IrLgmData>> irConfigs;
+        irConfigs.push_back(boost::make_shared<IrLgmData>(
+            "EUR", CalibrationType::Bootstrap, LgmData::ReversionType::HullWhite, LgmData::VolatilityType::Hagan, false,
+            ParamType::Constant, vector<Time>(), vector<Real>(1, 0.02), true, ParamType::Piecewise, vector<Time>(),
+            vector<Real>(1, 0.008), 0.0, 1.0, expiries, terms, strikes));
+        boost::shared_ptr<CrossAssetModelData> config = boost::make_shared<CrossAssetModelData>(
+            irConfigs, vector<boost::shared_ptr<FxBsData>>(), map<pair<string, string>, Handle<Quote>>());
+        model = *CrossAssetModelBuilder(market, config).model();
+
+        grid = boost::make_shared<DateGrid>("40,3M");
+        sgd = boost::make_shared<ScenarioGeneratorData>(CrossAssetStateProcess::exact, grid,
+                                                        MersenneTwisterAntithetic, 42, samples);
+
+        boost::shared_ptr<EngineData> data = boost::make_shared<EngineData>();
+        data->model("Swap") = "DiscountedCashflows";
+        data->engine("Swap") = "DiscountingSwapEngine";
+        data->model("EuropeanSwaption") = "BlackBachelier";
+        data->engine("EuropeanSwaption") = "BlackBachelierSwaptionEngine";
+        data->model("BermudanSwaption") = "LGM";
+        data->modelParameters("BermudanSwaption")["Calibration"] = "Bootstrap";
+        data->modelParameters("BermudanSwaption")["CalibrationStrategy"] = "CoterminalATM";
+        data->modelParameters("BermudanSwaption")["Reversion"] = "0.02";
+        data->modelParameters("BermudanSwaption")["ReversionType"] = "HullWhite";
+        data->modelParameters("BermudanSwaption")["Volatility"] = "0.008";
+        data->modelParameters("BermudanSwaption")["VolatilityType"] = "Hagan";
+        data->modelParameters("BermudanSwaption")["Tolerance"] = "0.0001";
+        data->engine("BermudanSwaption") = "Grid";
+        data->engineParameters("BermudanSwaption")["sy"] = "3.0";
+        data->engineParameters("BermudanSwaption")["ny"] = "10";
+        data->engineParameters("BermudanSwaption")["sx"] = "3.0";
+        data->engineParameters("BermudanSwaption")["nx"] = "10";
+        data->model("CapFloor") = "IborCapModel";
+        data->engine("CapFloor") = "IborCapEngine";
+        factory = boost::make_shared<EngineFactory>(data, market);
+        factory->registerBuilder(boost::make_shared<SwapEngineBuilder>());
+        factory->registerBuilder(boost::make_shared<EuropeanSwaptionEngineBuilder>());
+        factory->registerBuilder(boost::make_shared<LGMGridBermudanSwaptionEngineBuilder>());
+        factory->registerBuilder(boost::make_shared<CapFloorEngineBuilder>());
+    }
+
+    boost::shared_ptr<NPVCube>
+    buildCube(const boost::shared_ptr<Portfolio>& portfolio,
+              const boost::shared_ptr<AggregationScenarioData>& asd = nullptr,
+              const map<string, boost::shared_ptr<InterestRateIndex>>& indices = {}) {
+        boost::shared_ptr<NPVCube> cube =
+            boost::make_shared<DoublePrecisionInMemoryCube>(today, portfolio->ids(), grid->dates(), samples);
+        AMCValuationEngine engine(model, sgd, 2, vector<string>(), indices);
+        engine.buildCube(portfolio, cube, asd);
+        return cube;
+    }
+
+    SavedSettings backup;
+    Date today;
+    Size samples;
+    boost::shared_ptr<Market> market;
+    boost::shared_ptr<CrossAssetModel> model;
+    boost::shared_ptr<DateGrid> grid;
+    boost::shared_ptr<ScenarioGeneratorData> sgd;
+    boost::shared_ptr<EngineFactory> factory;
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(AMCValuationEngineTest)
+
+BOOST_AUTO_TEST_CASE(testSwapT0Value) {
+
+    BOOST_TEST_MESSAGE("Testing AMC valuation of a swap against its discounting NPV...");
+
+    AmcSetup setup;
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    portfolio->add(buildSwap("Swap_1", "EUR", true, 1000000.0, 0, 10, 0.02, 0.0, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->add(buildSwap("Swap_2", "EUR", false, 1000000.0, 1, 5, 0.01, 0.001, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->build(setup.factory);
+
+    boost::shared_ptr<AggregationScenarioData> asd =
+        boost::make_shared<InMemoryAggregationScenarioData>(setup.grid->size(), setup.samples);
+    boost::shared_ptr<NPVCube> cube = setup.buildCube(portfolio, asd);
+
+    for (Size j = 0; j < portfolio->size(); ++j) {
+        Real npv = portfolio->trades()[j]->instrument()->NPV();
+        BOOST_TEST_MESSAGE("trade " << portfolio->trades()[j]->id() << ": npv " << npv << " amc "
+                                    << cube->getT0(j));
+        BOOST_CHECK_SMALL(cube->getT0(j) - npv, 2000.0);
+    }
+
+    // the simulation grid (10Y) reaches beyond the maturity of the second swap
+    for (Size p = 0; p < setup.samples; ++p)
+        BOOST_CHECK_EQUAL(cube->get(1, setup.grid->size() - 1, p), 0.0);
+
+    BOOST_CHECK(asd->has(AggregationScenarioDataType::Numeraire));
+    for (Size p = 0; p < setup.samples; ++p)
+        BOOST_CHECK(asd->get(0, p, AggregationScenarioDataType::Numeraire) > 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(testSwaptionLongShort) {
+
+    BOOST_TEST_MESSAGE("Testing AMC valuation of long and short physically settled swaptions...");
+
+    AmcSetup setup;
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    portfolio->add(buildEuropeanSwaption("Swaption_Long", "Long", "EUR", true, 1000000.0, 2, 5, 0.02, 0.0, "1Y",
+                                         "30/360", "6M", "A360", "EUR-EURIBOR-6M", "Physical"));
+    portfolio->add(buildEuropeanSwaption("Swaption_Short", "Short", "EUR", true, 1000000.0, 2, 5, 0.02, 0.0, "1Y",
+                                         "30/360", "6M", "A360", "EUR-EURIBOR-6M", "Physical"));
+    portfolio->build(setup.factory);
+
+    boost::shared_ptr<NPVCube> cube = setup.buildCube(portfolio);
+
+    BOOST_TEST_MESSAGE("swaption npv " << portfolio->trades()[0]->instrument()->NPV() << " amc " << cube->getT0(0));
+    BOOST_CHECK(cube->getT0(0) > 0.0);
+    BOOST_CHECK_SMALL(cube->getT0(0) + cube->getT0(1), 1E-6);
+    for (Size i = 0; i < setup.grid->size(); ++i) {
+        for (Size p = 0; p < setup.samples; ++p)
+            BOOST_CHECK_SMALL(cube->get(0, i, p) + cube->get(1, i, p), 1E-6);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testEuropeanSwaption) {
+
+    BOOST_TEST_MESSAGE("Testing AMC valuation of European swaptions against the analytic LGM price...");
+
+    AmcSetup setup;
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    portfolio->add(buildEuropeanSwaption("Swaption_Physical", "Long", "EUR", true, 1000000.0, 2, 5, 0.02, 0.0, "1Y",
+                                         "30/360", "6M", "A360", "EUR-EURIBOR-6M", "Physical"));
+    portfolio->add(buildEuropeanSwaption("Swaption_Cash", "Long", "EUR", true, 1000000.0, 2, 5, 0.02, 0.0, "1Y",
+                                         "30/360", "6M", "A360", "EUR-EURIBOR-6M", "Cash"));
+    portfolio->build(setup.factory);
+
+    // the reference price in the simulation model, i.e. the LGM component of the cross asset model
+    auto swaption = boost::dynamic_pointer_cast<Swaption>(portfolio->trades()[0]->instrument()->qlInstrument());
+    BOOST_REQUIRE(swaption);
+    swaption->setPricingEngine(boost::make_shared<AnalyticLgmSwaptionEngine>(setup.model, 0));
+    Real reference = swaption->NPV();
+
+    boost::shared_ptr<NPVCube> cube = setup.buildCube(portfolio);
+
+    // the cash settlement is the value of the underlying on the exercise date, so both prices agree
+    for (Size j = 0; j < portfolio->size(); ++j) {
+        BOOST_TEST_MESSAGE(portfolio->trades()[j]->id() << ": analytic " << reference << " amc " << cube->getT0(j));
+        BOOST_CHECK_SMALL(cube->getT0(j) - reference, 1000.0);
+    }
+
+    // the cash settled swaption is settled one day after the exercise date, the physically settled swaption lives on
+    Date settlement = swaption->exercise()->dates().back() + 1;
+    for (Size i = 0; i < setup.grid->size(); ++i) {
+        if (setup.grid->dates()[i] <= settlement)
+            continue;
+        Real physical = 0.0;
+        for (Size p = 0; p < setup.samples; ++p) {
+            BOOST_CHECK_EQUAL(cube->get(1, i, p), 0.0);
+            physical += std::fabs(cube->get(0, i, p));
+        }
+        if (setup.grid->dates()[i] < swaption->underlyingSwap()->maturityDate())
+            BOOST_CHECK(physical > 0.0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testBermudanSwaption) {
+
+    BOOST_TEST_MESSAGE("Testing AMC valuation of a Bermudan swaption against the LGM grid engine...");
+
+    AmcSetup setup;
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    portfolio->add(buildBermudanSwaption("Bermudan", "Long", "EUR", true, 1000000.0, 5, 2, 8, 0.02, 0.0, "1Y",
+                                         "30/360", "6M", "A360", "EUR-EURIBOR-6M", "Physical"));
+    portfolio->add(buildEuropeanSwaption("European", "Long", "EUR", true, 1000000.0, 2, 8, 0.02, 0.0, "1Y", "30/360",
+                                         "6M", "A360", "EUR-EURIBOR-6M", "Physical"));
+    portfolio->build(setup.factory);
+
+    // the reference price of the grid engine in the LGM component of the cross asset model
+    auto swaption = boost::dynamic_pointer_cast<Swaption>(portfolio->trades()[0]->instrument()->qlInstrument());
+    BOOST_REQUIRE(swaption);
+    swaption->setPricingEngine(boost::make_shared<NumericLgmSwaptionEngine>(setup.model->lgm(0), 7.0, 16, 7.0, 32));
+    Real reference = swaption->NPV();
+
+    boost::shared_ptr<NPVCube> cube = setup.buildCube(portfolio);
+    BOOST_TEST_MESSAGE("grid engine " << reference << " amc " << cube->getT0(0) << " european amc "
+                                      << cube->getT0(1));
+
+    // the longstaff-schwartz exercise is suboptimal, the amc price is biased low by a small amount
+    BOOST_CHECK_SMALL(cube->getT0(0) - reference, 1500.0);
+    // the first exercise into the full swap is worth less than the Bermudan
+    BOOST_CHECK(cube->getT0(1) < cube->getT0(0));
+}
+
+BOOST_AUTO_TEST_CASE(testScenarioDataIndexFixings) {
+
+    BOOST_TEST_MESSAGE("Testing the index fixings in the AMC aggregation scenario data...");
+
+    AmcSetup setup;
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    portfolio->add(buildSwap("Swap_1", "EUR", true, 1000000.0, 0, 10, 0.02, 0.0, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->build(setup.factory);
+
+    boost::shared_ptr<IborIndex> index = *setup.market->iborIndex("EUR-EURIBOR-6M");
+    boost::shared_ptr<AggregationScenarioData> asd =
+        boost::make_shared<InMemoryAggregationScenarioData>(setup.grid->size(), setup.samples);
+    setup.buildCube(portfolio, asd, {{"EUR-EURIBOR-6M", index}});
+
+    BOOST_REQUIRE(asd->has(AggregationScenarioDataType::IndexFixing, "EUR-EURIBOR-6M"));
+    // the mean fixing is the forward up to a small convexity adjustment
+    for (Size i : {Size(0), Size(19)}) {
+        Date d = setup.grid->dates()[i];
+        Real mean = 0.0;
+        for (Size p = 0; p < setup.samples; ++p)
+            mean += asd->get(i, p, AggregationScenarioDataType::IndexFixing, "EUR-EURIBOR-6M") / setup.samples;
+        BOOST_TEST_MESSAGE("date " << d << ": forward " << index->forecastFixing(d) << " mean fixing " << mean);
+        BOOST_CHECK_SMALL(mean - index->forecastFixing(d), 0.0005);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testUnsupportedTrade) {
+
+    BOOST_TEST_MESSAGE("Testing that the AMC cube build fails for unsupported trades...");
+
+    AmcSetup setup;
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    portfolio->add(buildSwap("Swap_1", "EUR", true, 1000000.0, 0, 10, 0.02, 0.0, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->add(buildCap("Cap_1", "EUR", "Long", 0.05, 1000000.0, 0, 10, "6M", "A360", "EUR-EURIBOR-6M"));
+    portfolio->build(setup.factory);
+    BOOST_REQUIRE_EQUAL(portfolio->size(), 2);
+
+    BOOST_CHECK_THROW(setup.buildCube(portfolio), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,156 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "testportfolio.hpp"
+#include <boost/test/unit_test.hpp>
+#include <orea/cube/inmemorycube.hpp>
+#include <orea/engine/convergencemonitor.hpp>
+#include <orea/scenario/aggregationscenariodata.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <ql/math/distributions/normaldistribution.hpp>
+#include <ql/math/randomnumbers/inversecumulativerng.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+#include <ql/time/date.hpp>
+#include <test/oreatoplevelfixture.hpp>
+
+using namespace std;
+using namespace QuantLib;
+using namespace ore::analytics;
+using namespace ore::data;
+using namespace boost::unit_test_framework;
+
+using testsuite::buildSwap;
+
+namespace {
+
+boost::shared_ptr<Portfolio> buildPortfolio() {
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    portfolio->add(buildSwap("Swap_1", "EUR", true, 1000000.0, 0, 10, 0.02, 0.0, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->add(buildSwap("Swap_2", "EUR", false, 1000000.0, 0, 5, 0.01, 0.0, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    return portfolio;
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(ConvergenceMonitorTest)
+
+BOOST_AUTO_TEST_CASE(testTruncateSamples) {
+
+    BOOST_TEST_MESSAGE("Testing truncation of the cube and aggregation scenario data samples...");
+
+    Date today(14, April, 2016);
+    vector<Date> dates = {today + 1 * Years, today + 2 * Years};
+    vector<string> ids = {"Trade_1", "Trade_2"};
+    Size samples = 10;
+
+    SinglePrecisionInMemoryCubeN cube(today, ids, dates, samples, 2);
+    InMemoryAggregationScenarioData asd(dates.size(), samples);
+    for (Size i = 0; i < ids.size(); ++i) {
+        cube.setT0(100.0 * i, i);
+        for (Size j = 0; j < dates.size(); ++j)
+            for (Size k = 0; k < samples; ++k)
+                for (Size d = 0; d < 2; ++d)
+                    cube.set(1000.0 * i + 100.0 * j + 10.0 * k + d, i, j, k, d);
+    }
+    for (Size j = 0; j < dates.size(); ++j)
+        for (Size k = 0; k < samples; ++k)
+            asd.set(j, k, 10.0 * j + k, AggregationScenarioDataType::Numeraire);
+
+    cube.truncateSamples(4);
+    asd.truncateSamples(4);
+
+    BOOST_CHECK_EQUAL(cube.samples(), 4);
+    BOOST_CHECK_EQUAL(asd.dimSamples(), 4);
+    for (Size i = 0; i < ids.size(); ++i) {
+        BOOST_CHECK_EQUAL(cube.getT0(i), 100.0 * i);
+        for (Size j = 0; j < dates.size(); ++j)
+            for (Size k = 0; k < 4; ++k)
+                for (Size d = 0; d < 2; ++d)
+                    BOOST_CHECK_EQUAL(cube.get(i, j, k, d), 1000.0 * i + 100.0 * j + 10.0 * k + d);
+    }
+    for (Size j = 0; j < dates.size(); ++j)
+        for (Size k = 0; k < 4; ++k)
+            BOOST_CHECK_EQUAL(asd.get(j, k, AggregationScenarioDataType::Numeraire), 10.0 * j + k);
+
+    BOOST_CHECK_THROW(cube.get(0, 0, 4), QuantLib::Error);
+    BOOST_CHECK_THROW(cube.truncateSamples(5), QuantLib::Error);
+    BOOST_CHECK_THROW(asd.truncateSamples(0), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_CASE(testConvergence) {
+
+    BOOST_TEST_MESSAGE("Testing the convergence monitor on normally distributed netting set values...");
+
+    Date today(14, April, 2016);
+    vector<Date> dates = {today + 1 * Years, today + 2 * Years, today + 4 * Years};
+    boost::shared_ptr<Portfolio> portfolio = buildPortfolio();
+    Size maxSamples = 100000;
+    boost::shared_ptr<NPVCube> cube =
+        boost::make_shared<DoublePrecisionInMemoryCube>(today, portfolio->ids(), dates, maxSamples);
+
+    // each trade value is N(0.5, 1), the netting set value is N(1, 2), hence EPE = s phi(m/s) + m Phi(m/s)
+    Real m = 1.0, s = std::sqrt(2.0);
+    Real expectedEpe = s * NormalDistribution()(m / s) + m * CumulativeNormalDistribution()(m / s);
+    Real expectedEne = expectedEpe - m;
+    // the cva weights sum to 0.05
+    map<string, vector<Real>> cvaWeights = {{"", {0.01, 0.02, 0.02}}};
+
+    ConvergenceMonitor monitor(portfolio, today, dates, 0.01, 0.0, 1000, 100, cvaWeights);
+    InverseCumulativeRng<MersenneTwisterUniformRng, InverseCumulativeNormal> rng(MersenneTwisterUniformRng(42));
+
+    Size sample = 0;
+    bool converged = false;
+    for (; sample < maxSamples && !converged; ++sample) {
+        for (Size i = 0; i < cube->numIds(); ++i)
+            for (Size j = 0; j < cube->numDates(); ++j)
+                cube->set(0.5 + rng.next().value, i, j, sample);
+        converged = monitor.update(cube, sample);
+        if (sample + 1 < 1000)
+            BOOST_CHECK(!converged);
+    }
+
+    BOOST_TEST_MESSAGE("converged after " << sample << " samples");
+    BOOST_CHECK(converged);
+    BOOST_CHECK(sample < maxSamples);
+    BOOST_CHECK_EQUAL(sample % 100, 0);
+    BOOST_CHECK_EQUAL(monitor.samples(), sample);
+
+    auto estimates = monitor.estimates();
+    BOOST_REQUIRE_EQUAL(estimates.size(), 3);
+    auto epe = estimates.at(make_pair(string(""), string("EPE")));
+    auto ene = estimates.at(make_pair(string(""), string("ENE")));
+    auto cva = estimates.at(make_pair(string(""), string("CVA")));
+    BOOST_TEST_MESSAGE("EPE " << epe.value << " +- " << epe.standardError << " expected " << expectedEpe);
+    BOOST_TEST_MESSAGE("ENE " << ene.value << " +- " << ene.standardError << " expected " << expectedEne);
+    BOOST_TEST_MESSAGE("CVA " << cva.value << " +- " << cva.standardError << " expected " << 0.05 * expectedEpe);
+    BOOST_CHECK(epe.standardError <= 0.01 * epe.value);
+    BOOST_CHECK(ene.standardError <= 0.01 * ene.value);
+    BOOST_CHECK(cva.standardError <= 0.01 * cva.value);
+    BOOST_CHECK_SMALL(epe.value - expectedEpe, 4.0 * epe.standardError);
+    BOOST_CHECK_SMALL(ene.value - expectedEne, 4.0 * ene.standardError);
+    BOOST_CHECK_SMALL(cva.value - 0.05 * expectedEpe, 4.0 * cva.standardError);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -19,6 +19,9 @@
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
 #include <orea/cube/inmemorycube.hpp>
+#include <orea/cube/sensicube.hpp>
+#include <orea/cube/sensitivitycube.hpp>
+#include <orea/engine/sensitivitycubestream.hpp>
 #include <oret/toplevelfixture.hpp>
 #include <test/oreatoplevelfixture.hpp>
 
@@ -200,6 +203,76 @@ BOOST_AUTO_TEST_CASE(testInMemoryCubeGetSetbyDateID) {
     testCubeGetSetbyDateID(cube, 1e-14);
 }
 
+BOOST_AUTO_TEST_CASE(testSensitivityCubeBulkAccess) {
+
+    BOOST_TEST_MESSAGE("Testing SensitivityCube bulk access and SensitivityCubeStream...");
+
+    typedef ShiftScenarioGenerator::ScenarioDescription Description;
+    RiskFactorKey k0(RiskFactorKey::KeyType::DiscountCurve, "EUR", 0);
+    RiskFactorKey k1(RiskFactorKey::KeyType::DiscountCurve, "EUR", 1);
+    Description up0(Description::Type::Up, k0, "1Y"), down0(Description::Type::Down, k0, "1Y");
+    Description up1(Description::Type::Up, k1, "2Y"), down1(Description::Type::Down, k1, "2Y");
+    vector<Description> descriptions = {Description(Description::Type::Base), up0, down0, up1, down1,
+                                        Description(up0, up1)};
+    std::map<RiskFactorKey, Real> shiftSizes = {{k0, 1E-4}, {k1, 2E-4}};
+
+    // trade ids deliberately not sorted, the npv of trade1 under the down shift of k1 is not stored
+    vector<string> ids = {"trade2", "trade1"};
+    auto npvCube = boost::make_shared<DoublePrecisionSensiCube>(ids, Date(15, QuantLib::Jan, 2018), descriptions.size());
+    for (Size i = 0; i < ids.size(); ++i) {
+        npvCube->setT0(100.0 * (i + 1), i, 0);
+        for (Size k = 1; k < descriptions.size(); ++k) {
+            if (i != 1 || k != 4)
+                npvCube->set(100.0 * (i + 1) + k * k * (i + 1.5), i, 0, k, 0);
+        }
+    }
+    auto cube = boost::make_shared<SensitivityCube>(npvCube, descriptions, shiftSizes);
+
+    BOOST_REQUIRE_EQUAL(cube->numberOfFactors(), 2);
+    BOOST_REQUIRE_EQUAL(cube->numberOfCrossFactors(), 1);
+    BOOST_CHECK(cube->hasDownFactors());
+    BOOST_CHECK_EQUAL(cube->factorId(k1), 1);
+    BOOST_CHECK_THROW(cube->factorId(RiskFactorKey(RiskFactorKey::KeyType::DiscountCurve, "USD", 0)),
+                      QuantLib::Error);
+    BOOST_CHECK_EQUAL(cube->crossFactorIds(0).second, 1);
+
+    vector<Real> npvs, deltas, gammas, crossGammas;
+    cube->npvs(1, npvs);
+    BOOST_REQUIRE_EQUAL(npvs.size(), descriptions.size());
+    BOOST_CHECK_EQUAL(npvs[4], 200.0);
+    for (Size i = 0; i < ids.size(); ++i) {
+        cube->sensitivities(i, deltas, gammas, crossGammas);
+        BOOST_REQUIRE_EQUAL(deltas.size(), 2);
+        BOOST_REQUIRE_EQUAL(crossGammas.size(), 1);
+        for (Size f = 0; f < 2; ++f) {
+            BOOST_CHECK_EQUAL(deltas[f], cube->delta(ids[i], cube->factorKey(f)));
+            BOOST_CHECK_EQUAL(gammas[f], cube->gamma(ids[i], cube->factorKey(f)));
+        }
+        BOOST_CHECK_EQUAL(crossGammas[0], cube->crossGamma(ids[i], std::make_pair(k0, k1)));
+    }
+
+    // the stream returns the trades in the order of their ids
+    SensitivityCubeStream stream(cube, "EUR");
+    for (Size pass = 0; pass < 2; ++pass) {
+        vector<SensitivityRecord> records;
+        while (SensitivityRecord sr = stream.next())
+            records.push_back(sr);
+        BOOST_REQUIRE_EQUAL(records.size(), 6);
+        BOOST_CHECK_EQUAL(records[0].tradeId, "trade1");
+        BOOST_CHECK_EQUAL(records[0].baseNpv, 200.0);
+        BOOST_CHECK_EQUAL(records[1].key_1, k1);
+        BOOST_CHECK_EQUAL(records[1].desc_1, "2Y");
+        BOOST_CHECK_EQUAL(records[1].shift_1, 2E-4);
+        BOOST_CHECK_EQUAL(records[1].delta, cube->delta("trade1", k1));
+        BOOST_CHECK_EQUAL(records[1].gamma, cube->gamma("trade1", k1));
+        BOOST_CHECK(records[2].isCrossGamma());
+        BOOST_CHECK_EQUAL(records[2].key_2, k1);
+        BOOST_CHECK_EQUAL(records[2].gamma, cube->crossGamma("trade1", std::make_pair(k0, k1)));
+        BOOST_CHECK_EQUAL(records[3].tradeId, "trade2");
+        stream.reset();
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,238 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <orea/cube/cubecheckpoint.hpp>
+#include <orea/cube/inmemorycube.hpp>
+#include <orea/scenario/aggregationscenariodata.hpp>
+#include <orea/scenario/scenariostore.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <qle/methods/multipathgeneratorbase.hpp>
+#include <ql/math/matrix.hpp>
+#include <ql/processes/geometricbrownianprocess.hpp>
+#include <ql/processes/stochasticprocessarray.hpp>
+#include <ql/time/date.hpp>
+#include <test/oreatoplevelfixture.hpp>
+#include <test/testvalues.hpp>
+
+using namespace std;
+using namespace QuantLib;
+using namespace QuantExt;
+using namespace ore::analytics;
+using namespace boost::unit_test_framework;
+using testsuite::testValue;
+
+namespace {
+
+struct CheckpointSetup {
+    CheckpointSetup()
+        : today(14, April, 2016), dates({today + 1 * Years, today + 2 * Years, today + 3 * Years}),
+          ids({"Trade_1", "Trade_2"}), samples(50), fileName("checkpoint_test.dat") {
+        boost::filesystem::remove(fileName);
+    }
+    ~CheckpointSetup() { boost::filesystem::remove(fileName); }
+
+    boost::shared_ptr<NPVCube> cube() const {
+        return boost::make_shared<SinglePrecisionInMemoryCubeN>(today, ids, dates, samples, 2);
+    }
+    boost::shared_ptr<AggregationScenarioData> scenarioData() const {
+        return boost::make_shared<InMemoryAggregationScenarioData>(dates.size(), samples);
+    }
+
+    void fill(const boost::shared_ptr<NPVCube>& c, const boost::shared_ptr<AggregationScenarioData>& asd,
+              Size k) const {
+        for (Size i = 0; i < ids.size(); ++i)
+            for (Size j = 0; j < dates.size(); ++j)
+                for (Size d = 0; d < 2; ++d)
+                    c->set(testValue(i, j, k, d), i, j, k, d);
+        for (Size j = 0; j < dates.size(); ++j) {
+            asd->set(j, k, testValue(0, j, k, 0), AggregationScenarioDataType::Numeraire);
+            asd->set(j, k, testValue(1, j, k, 1), AggregationScenarioDataType::FXSpot, "USD");
+        }
+    }
+
+    Date today;
+    vector<Date> dates;
+    vector<string> ids;
+    Size samples;
+    string fileName;
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(CubeCheckpointTest)
+
+BOOST_AUTO_TEST_CASE(testRestore) {
+
+    BOOST_TEST_MESSAGE("Testing restore of the cube and scenario data from a checkpoint file...");
+
+    CheckpointSetup setup;
+
+    // first run, interrupted after 37 samples, i.e. 30 samples are written with a frequency of 10
+    boost::shared_ptr<NPVCube> cube = setup.cube();
+    boost::shared_ptr<AggregationScenarioData> asd = setup.scenarioData();
+    CubeCheckpoint checkpoint(setup.fileName, 10, asd);
+    BOOST_CHECK_EQUAL(checkpoint.restore(cube), 0);
+    for (Size k = 0; k < 37; ++k) {
+        setup.fill(cube, asd, k);
+        checkpoint.update(cube, k + 1);
+    }
+
+    // simulate a crash while writing the next record
+    boost::uintmax_t size = boost::filesystem::file_size(setup.fileName);
+    {
+        ofstream out(setup.fileName.c_str(), ios::binary | ios::app);
+        Size garbage[] = {30, 40, 42};
+        out.write(reinterpret_cast<const char*>(garbage), sizeof(garbage));
+    }
+
+    // second run restores the 30 samples and finishes the cube
+    boost::shared_ptr<NPVCube> resumedCube = setup.cube();
+    boost::shared_ptr<AggregationScenarioData> resumedAsd = setup.scenarioData();
+    CubeCheckpoint resumed(setup.fileName, 10, resumedAsd);
+    Size first = resumed.restore(resumedCube);
+    BOOST_CHECK_EQUAL(first, 30);
+    BOOST_CHECK_EQUAL(boost::filesystem::file_size(setup.fileName), size);
+    for (Size k = first; k < setup.samples; ++k) {
+        setup.fill(resumedCube, resumedAsd, k);
+        resumed.update(resumedCube, k + 1);
+    }
+
+    // compare with an uninterrupted run
+    boost::shared_ptr<NPVCube> fullCube = setup.cube();
+    boost::shared_ptr<AggregationScenarioData> fullAsd = setup.scenarioData();
+    for (Size k = 0; k < setup.samples; ++k)
+        setup.fill(fullCube, fullAsd, k);
+    for (Size i = 0; i < setup.ids.size(); ++i)
+        for (Size j = 0; j < setup.dates.size(); ++j)
+            for (Size k = 0; k < setup.samples; ++k)
+                for (Size d = 0; d < 2; ++d)
+                    BOOST_CHECK_EQUAL(resumedCube->get(i, j, k, d), fullCube->get(i, j, k, d));
+    for (Size j = 0; j < setup.dates.size(); ++j) {
+        for (Size k = 0; k < setup.samples; ++k) {
+            BOOST_CHECK_EQUAL(resumedAsd->get(j, k, AggregationScenarioDataType::Numeraire),
+                              fullAsd->get(j, k, AggregationScenarioDataType::Numeraire));
+            BOOST_CHECK_EQUAL(resumedAsd->get(j, k, AggregationScenarioDataType::FXSpot, "USD"),
+                              fullAsd->get(j, k, AggregationScenarioDataType::FXSpot, "USD"));
+        }
+    }
+
+    // a third run finds all samples
+    CubeCheckpoint complete(setup.fileName, 10, setup.scenarioData());
+    BOOST_CHECK_EQUAL(complete.restore(setup.cube()), setup.samples);
+    complete.remove();
+    BOOST_CHECK(!boost::filesystem::exists(setup.fileName));
+}
+
+BOOST_AUTO_TEST_CASE(testLayoutMismatch) {
+
+    BOOST_TEST_MESSAGE("Testing that a checkpoint file is not restored into a different cube...");
+
+    CheckpointSetup setup;
+    CubeCheckpoint checkpoint(setup.fileName, 10);
+    checkpoint.restore(setup.cube());
+
+    boost::shared_ptr<NPVCube> other =
+        boost::make_shared<SinglePrecisionInMemoryCubeN>(setup.today, setup.ids, setup.dates, setup.samples + 1, 2);
+    CubeCheckpoint resumed(setup.fileName, 10);
+    BOOST_CHECK_THROW(resumed.restore(other), QuantLib::Error);
+
+    vector<string> ids = {"Trade_1", "Trade_3"};
+    other = boost::make_shared<SinglePrecisionInMemoryCubeN>(setup.today, ids, setup.dates, setup.samples, 2);
+    BOOST_CHECK_THROW(resumed.restore(other), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_CASE(testConfigurationMismatch) {
+
+    BOOST_TEST_MESSAGE("Testing that a checkpoint file is not restored for a different configuration...");
+
+    CheckpointSetup setup;
+    std::uint64_t hash = scenarioStoreHash("<Simulation><Seed>42</Seed></Simulation>");
+    boost::shared_ptr<NPVCube> cube = setup.cube();
+    CubeCheckpoint checkpoint(setup.fileName, 10, boost::shared_ptr<AggregationScenarioData>(), hash);
+    BOOST_CHECK_EQUAL(checkpoint.restore(cube), 0);
+    for (Size k = 0; k < 20; ++k) {
+        setup.fill(cube, setup.scenarioData(), k);
+        checkpoint.update(cube, k + 1);
+    }
+
+    // same cube layout, but e.g. another seed
+    CubeCheckpoint other(setup.fileName, 10, boost::shared_ptr<AggregationScenarioData>(),
+                         scenarioStoreHash("<Simulation><Seed>43</Seed></Simulation>"));
+    BOOST_CHECK_THROW(other.restore(setup.cube()), QuantLib::Error);
+    CubeCheckpoint noHash(setup.fileName, 10);
+    BOOST_CHECK_THROW(noHash.restore(setup.cube()), QuantLib::Error);
+
+    // the refused restore leaves the file intact for the matching configuration
+    CubeCheckpoint resumed(setup.fileName, 10, boost::shared_ptr<AggregationScenarioData>(), hash);
+    BOOST_CHECK_EQUAL(resumed.restore(setup.cube()), 20);
+}
+
+BOOST_AUTO_TEST_CASE(testPathGeneratorSkip) {
+
+    BOOST_TEST_MESSAGE("Testing that skipped paths do not change the following paths...");
+
+    Matrix correlation(2, 2, 0.5);
+    correlation[0][0] = correlation[1][1] = 1.0;
+    vector<boost::shared_ptr<StochasticProcess1D>> processes = {
+        boost::make_shared<GeometricBrownianMotionProcess>(100.0, 0.01, 0.2),
+        boost::make_shared<GeometricBrownianMotionProcess>(50.0, 0.02, 0.3)};
+    boost::shared_ptr<StochasticProcess> process = boost::make_shared<StochasticProcessArray>(processes, correlation);
+    TimeGrid grid(3.0, 3);
+
+    for (auto s : {MersenneTwister, MersenneTwisterAntithetic, Sobol, SobolBrownianBridge}) {
+        for (Size skip : {1, 4, 7}) {
+            boost::shared_ptr<MultiPathGeneratorBase> full = makeMultiPathGenerator(s, process, grid, 42);
+            boost::shared_ptr<MultiPathGeneratorBase> resumed = makeMultiPathGenerator(s, process, grid, 42);
+            // skip from the start and after a few paths, the latter covers skips within an antithetic pair
+            for (Size round = 0; round < 2; ++round) {
+                for (Size p = 0; p < skip; ++p)
+                    full->next();
+                resumed->skip(skip);
+                for (Size p = 0; p < 3; ++p) {
+                    MultiPath a = full->next().value;
+                    MultiPath b = resumed->next().value;
+                    for (Size i = 0; i < a.assetNumber(); ++i)
+                        for (Size t = 0; t < a.pathSize(); ++t)
+                            BOOST_CHECK_EQUAL(a[i][t], b[i][t]);
+                }
+            }
+        }
+    }
+
+    // the Mersenne Twister generator builds the same paths as QuantLib's path generator
+    for (bool antithetic : {false, true}) {
+        MultiPathGeneratorMersenneTwister pg(process, grid, 42, antithetic);
+        MultiPathGenerator<PseudoRandom::rsg_type> ql(
+            process, grid, PseudoRandom::make_sequence_generator(process->size() * (grid.size() - 1), 42), false);
+        for (Size p = 0; p < 6; ++p) {
+            MultiPath a = pg.next().value;
+            MultiPath b = antithetic && p % 2 == 1 ? ql.antithetic().value : ql.next().value;
+            for (Size i = 0; i < a.assetNumber(); ++i)
+                for (Size t = 0; t < a.pathSize(); ++t)
+                    BOOST_CHECK_EQUAL(a[i][t], b[i][t]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
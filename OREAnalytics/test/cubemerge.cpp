@@ -0,0 +1,176 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <orea/cube/cubemerge.hpp>
+#include <orea/cube/inmemorycube.hpp>
+#include <orea/scenario/aggregationscenariodata.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <ql/time/date.hpp>
+#include <test/oreatoplevelfixture.hpp>
+#include <test/testvalues.hpp>
+
+using namespace std;
+using namespace QuantLib;
+using namespace ore::analytics;
+using namespace boost::unit_test_framework;
+using testsuite::testValue;
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(CubeMergeTest)
+
+BOOST_AUTO_TEST_CASE(testMerge) {
+
+    BOOST_TEST_MESSAGE("Testing the merge of cubes and scenario data for consecutive sample ranges...");
+
+    Date today(14, April, 2016);
+    vector<Date> dates = {today + 1 * Years, today + 2 * Years};
+    vector<string> ids = {"Trade_1", "Trade_2", "Trade_3"};
+    vector<Size> ranges = {0, 7, 8, 20};
+    Size samples = ranges.back();
+
+    vector<boost::shared_ptr<NPVCube>> cubes;
+    vector<boost::shared_ptr<AggregationScenarioData>> asds;
+    for (Size s = 0; s + 1 < ranges.size(); ++s) {
+        Size n = ranges[s + 1] - ranges[s];
+        cubes.push_back(boost::make_shared<SinglePrecisionInMemoryCubeN>(today, ids, dates, n, 2));
+        asds.push_back(boost::make_shared<InMemoryAggregationScenarioData>(dates.size(), n));
+        for (Size i = 0; i < ids.size(); ++i) {
+            for (Size d = 0; d < 2; ++d) {
+                cubes.back()->setT0(testValue(i, 0, 0, d), i, d);
+                for (Size j = 0; j < dates.size(); ++j)
+                    for (Size k = 0; k < n; ++k)
+                        cubes.back()->set(testValue(i, j, ranges[s] + k, d), i, j, k, d);
+            }
+        }
+        for (Size j = 0; j < dates.size(); ++j) {
+            for (Size k = 0; k < n; ++k) {
+                asds.back()->set(j, k, testValue(0, j, ranges[s] + k, 0), AggregationScenarioDataType::Numeraire);
+                asds.back()->set(j, k, testValue(1, j, ranges[s] + k, 1), AggregationScenarioDataType::FXSpot, "USD");
+            }
+        }
+    }
+
+    boost::shared_ptr<NPVCube> cube = boost::make_shared<SinglePrecisionInMemoryCubeN>(today, ids, dates, samples, 2);
+    boost::shared_ptr<AggregationScenarioData> asd =
+        boost::make_shared<InMemoryAggregationScenarioData>(dates.size(), samples);
+    mergeCubes(cubes, cube);
+    mergeAggregationScenarioData(asds, asd);
+
+    // compare with a cube filled in one go
+    SinglePrecisionInMemoryCubeN full(today, ids, dates, samples, 2);
+    for (Size i = 0; i < ids.size(); ++i) {
+        for (Size d = 0; d < 2; ++d) {
+            full.setT0(testValue(i, 0, 0, d), i, d);
+            BOOST_CHECK_EQUAL(cube->getT0(i, d), full.getT0(i, d));
+            for (Size j = 0; j < dates.size(); ++j) {
+                for (Size k = 0; k < samples; ++k) {
+                    full.set(testValue(i, j, k, d), i, j, k, d);
+                    BOOST_CHECK_EQUAL(cube->get(i, j, k, d), full.get(i, j, k, d));
+                }
+            }
+        }
+    }
+    for (Size j = 0; j < dates.size(); ++j) {
+        for (Size k = 0; k < samples; ++k) {
+            BOOST_CHECK_EQUAL(asd->get(j, k, AggregationScenarioDataType::Numeraire), testValue(0, j, k, 0));
+            BOOST_CHECK_EQUAL(asd->get(j, k, AggregationScenarioDataType::FXSpot, "USD"), testValue(1, j, k, 1));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testMergeMismatch) {
+
+    BOOST_TEST_MESSAGE("Testing that cubes of different layouts are not merged...");
+
+    Date today(14, April, 2016);
+    vector<Date> dates = {today + 1 * Years, today + 2 * Years};
+    vector<string> ids = {"Trade_1", "Trade_2"}, otherIds = {"Trade_1", "Trade_3"};
+
+    vector<boost::shared_ptr<NPVCube>> cubes = {
+        boost::make_shared<DoublePrecisionInMemoryCube>(today, ids, dates, 5),
+        boost::make_shared<DoublePrecisionInMemoryCube>(today, otherIds, dates, 5)};
+    BOOST_CHECK_THROW(mergeCubes(cubes, boost::make_shared<DoublePrecisionInMemoryCube>(today, ids, dates, 10)),
+                      QuantLib::Error);
+
+    cubes.back() = boost::make_shared<DoublePrecisionInMemoryCube>(today, ids, dates, 5);
+    BOOST_CHECK_THROW(mergeCubes(cubes, boost::make_shared<DoublePrecisionInMemoryCube>(today, ids, dates, 11)),
+                      QuantLib::Error);
+    BOOST_CHECK_NO_THROW(mergeCubes(cubes, boost::make_shared<DoublePrecisionInMemoryCube>(today, ids, dates, 10)));
+}
+
+BOOST_AUTO_TEST_CASE(testCombine) {
+
+    BOOST_TEST_MESSAGE("Testing the combination of a cached cube with a cube of new and amended trades...");
+
+    Date today(14, April, 2016);
+    vector<Date> dates = {today + 1 * Years, today + 2 * Years};
+    Size samples = 5;
+    vector<string> cachedIds = {"Trade_1", "Trade_2", "Trade_3"}, whatIfIds = {"Trade_2", "Trade_4"};
+
+    boost::shared_ptr<NPVCube> cached =
+        boost::make_shared<SinglePrecisionInMemoryCubeN>(today, cachedIds, dates, samples, 2);
+    boost::shared_ptr<NPVCube> whatIf =
+        boost::make_shared<SinglePrecisionInMemoryCubeN>(today, whatIfIds, dates, samples, 2);
+    for (Size d = 0; d < 2; ++d) {
+        for (Size i = 0; i < cachedIds.size(); ++i) {
+            cached->setT0(testValue(i, 0, 0, d), i, d);
+            for (Size j = 0; j < dates.size(); ++j)
+                for (Size k = 0; k < samples; ++k)
+                    cached->set(testValue(i, j, k, d), i, j, k, d);
+        }
+        for (Size i = 0; i < whatIfIds.size(); ++i) {
+            whatIf->setT0(-testValue(i, 0, 0, d), i, d);
+            for (Size j = 0; j < dates.size(); ++j)
+                for (Size k = 0; k < samples; ++k)
+                    whatIf->set(-testValue(i, j, k, d), i, j, k, d);
+        }
+    }
+
+    // Trade_2 is amended, Trade_4 is new, Trade_1 is in another netting set
+    vector<string> ids = {"Trade_3", "Trade_2", "Trade_4"};
+    boost::shared_ptr<NPVCube> cube = boost::make_shared<SinglePrecisionInMemoryCubeN>(today, ids, dates, samples, 2);
+    combineCubes({whatIf, cached}, cube);
+    for (Size d = 0; d < 2; ++d) {
+        BOOST_CHECK_EQUAL(cube->getT0(0, d), cached->getT0(2, d));
+        BOOST_CHECK_EQUAL(cube->getT0(1, d), whatIf->getT0(0, d));
+        BOOST_CHECK_EQUAL(cube->getT0(2, d), whatIf->getT0(1, d));
+        for (Size j = 0; j < dates.size(); ++j) {
+            for (Size k = 0; k < samples; ++k) {
+                BOOST_CHECK_EQUAL(cube->get(0, j, k, d), cached->get(2, j, k, d));
+                BOOST_CHECK_EQUAL(cube->get(1, j, k, d), whatIf->get(0, j, k, d));
+                BOOST_CHECK_EQUAL(cube->get(2, j, k, d), whatIf->get(1, j, k, d));
+            }
+        }
+    }
+
+    // unknown trades and different sample sizes are rejected
+    vector<string> unknownIds = {"Trade_5"};
+    BOOST_CHECK_THROW(
+        combineCubes({whatIf, cached},
+                     boost::make_shared<SinglePrecisionInMemoryCubeN>(today, unknownIds, dates, samples, 2)),
+        QuantLib::Error);
+    BOOST_CHECK_THROW(
+        combineCubes({whatIf, cached}, boost::make_shared<SinglePrecisionInMemoryCubeN>(today, ids, dates, 6, 2)),
+        QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
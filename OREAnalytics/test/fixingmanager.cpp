@@ -0,0 +1,220 @@
+/*
+ Copyright (C) 2019 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <orea/simulation/fixingmanager.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/portfolio/trade.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <ql/cashflows/couponpricer.hpp>
+#include <ql/cashflows/iborcoupon.hpp>
+#include <ql/indexes/ibor/eonia.hpp>
+#include <ql/indexes/ibor/euribor.hpp>
+#include <ql/settings.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/calendars/target.hpp>
+#include <ql/time/daycounters/actual360.hpp>
+#include <qle/cashflows/averageonindexedcoupon.hpp>
+#include <qle/cashflows/averageonindexedcouponpricer.hpp>
+#include <qle/cashflows/brlcdicouponpricer.hpp>
+#include <qle/cashflows/couponpricer.hpp>
+#include <qle/cashflows/overnightindexedcoupon.hpp>
+#include <qle/indexes/fixinghistory.hpp>
+#include <qle/indexes/ibor/brlcdi.hpp>
+#include <test/oreatoplevelfixture.hpp>
+
+using namespace std;
+using namespace QuantLib;
+using namespace QuantExt;
+using namespace ore::analytics;
+using namespace boost::unit_test_framework;
+
+namespace {
+
+// trade holding the given legs, the fixing manager only reads the legs
+class LegTrade : public ore::data::Trade {
+public:
+    LegTrade(const string& id, const vector<Leg>& legs) : Trade("Swap") {
+        this->id() = id;
+        legs_ = legs;
+    }
+    void build(const boost::shared_ptr<ore::data::EngineFactory>&) override {}
+};
+
+struct TestData {
+    TestData() : today(5, February, 2016) {
+        Settings::instance().evaluationDate() = today;
+        Handle<YieldTermStructure> curve(boost::make_shared<FlatForward>(today, 0.02, Actual360()));
+        euribor = boost::make_shared<Euribor6M>(curve);
+        eonia = boost::make_shared<Eonia>(curve);
+        brlCdi = boost::make_shared<BRLCdi>(curve);
+        // the coupons fix after today and before the simulation date
+        schedule = Schedule(today + 1 * Months, today + 2 * Years, 6 * Months, TARGET(), ModifiedFollowing,
+                            ModifiedFollowing, DateGeneration::Forward, false);
+        simDate = TARGET().adjust(today + 3 * Months);
+    }
+
+    Leg iborLeg() const {
+        Leg leg = IborLeg(schedule, euribor).withNotionals(1.0E6);
+        setCouponPricer(leg, boost::make_shared<BlackIborCouponPricer>());
+        return leg;
+    }
+    Leg overnightLeg() const { return QuantExt::OvernightLeg(schedule, eonia).withNotionals(1.0E6); }
+    Leg brlCdiLeg() const {
+        Leg leg = QuantExt::OvernightLeg(schedule, brlCdi).withNotionals(1.0E6);
+        QuantExt::setCouponPricer(leg, boost::make_shared<BRLCdiCouponPricer>());
+        return leg;
+    }
+    Leg averageOvernightLeg() const {
+        return AverageONLeg(schedule, eonia)
+            .withNotionals({1.0E6})
+            .withAverageONIndexedCouponPricer(boost::make_shared<AverageONIndexedCouponPricer>());
+    }
+
+    Date today, simDate;
+    boost::shared_ptr<IborIndex> euribor;
+    boost::shared_ptr<OvernightIndex> eonia, brlCdi;
+    Schedule schedule;
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(FixingManagerTest)
+
+BOOST_AUTO_TEST_CASE(testOverlayWithMixedPortfolio) {
+
+    BOOST_TEST_MESSAGE("Testing the fixing manager overlay on a portfolio with Ibor and overnight indexed coupons...");
+
+    TestData d;
+    auto portfolio = boost::make_shared<ore::data::Portfolio>();
+    portfolio->add(boost::make_shared<LegTrade>("IborLeg", vector<Leg>{d.iborLeg()}));
+    portfolio->add(boost::make_shared<LegTrade>("OvernightLeg", vector<Leg>{d.overnightLeg()}));
+    auto iborCpn = boost::dynamic_pointer_cast<IborCoupon>(portfolio->trades()[0]->legs()[0].front());
+    auto onCpn =
+        boost::dynamic_pointer_cast<QuantExt::OvernightIndexedCoupon>(portfolio->trades()[1]->legs()[0].front());
+    BOOST_REQUIRE(iborCpn && onCpn);
+    BOOST_REQUIRE(iborCpn->fixingDate() >= d.today && iborCpn->fixingDate() < d.simDate);
+
+    auto overlay = boost::make_shared<FixingOverlay>();
+    FixingManager fixingManager(d.today, overlay);
+    fixingManager.initialise(portfolio);
+
+    Settings::instance().evaluationDate() = d.simDate;
+    fixingManager.update(d.simDate);
+    FixingOverlayScope scope(overlay.get());
+
+    // the Ibor fixings are not read through the overlay, they go to the IndexManager
+    Real iborFixing = d.euribor->fixing(d.simDate);
+    BOOST_CHECK_CLOSE(IndexManager::instance().getHistory(d.euribor->name())[iborCpn->fixingDate()], iborFixing,
+                      1.0E-10);
+    BOOST_CHECK_CLOSE(iborCpn->rate(), iborFixing, 1.0E-10);
+
+    // the overnight fixings go to the overlay only
+    BOOST_CHECK(IndexManager::instance().getHistory(d.eonia->name()).empty());
+    BOOST_CHECK(overlay->size() > 0);
+    Real onFixing = d.eonia->fixing(d.simDate);
+    BOOST_CHECK_CLOSE(onCpn->fixingHistory().fixing(onCpn->fixingDates().front()), onFixing, 1.0E-10);
+    BOOST_CHECK_NO_THROW(onCpn->amount());
+    {
+        // the simulated overnight fixings are not visible without the overlay
+        FixingOverlayScope noOverlay(nullptr);
+        BOOST_CHECK_THROW(onCpn->amount(), QuantLib::Error);
+    }
+
+    // a reset clears the overlay and restores the Ibor history
+    fixingManager.reset();
+    BOOST_CHECK_EQUAL(overlay->size(), 0);
+    BOOST_CHECK(IndexManager::instance().getHistory(d.euribor->name()).empty());
+}
+
+BOOST_AUTO_TEST_CASE(testOverlayWithSharedOvernightIndex) {
+
+    BOOST_TEST_MESSAGE("Testing that overnight fixings read outside the overlay go to the IndexManager...");
+
+    TestData d;
+    auto portfolio = boost::make_shared<ore::data::Portfolio>();
+    portfolio->add(boost::make_shared<LegTrade>("OvernightLeg", vector<Leg>{d.overnightLeg()}));
+    portfolio->add(boost::make_shared<LegTrade>("AverageOvernightLeg", vector<Leg>{d.averageOvernightLeg()}));
+
+    auto overlay = boost::make_shared<FixingOverlay>();
+    FixingManager fixingManager(d.today, overlay);
+    fixingManager.initialise(portfolio);
+
+    Settings::instance().evaluationDate() = d.simDate;
+    fixingManager.update(d.simDate);
+
+    // the average overnight coupon reads the IndexManager, so both coupons see the fixings there
+    BOOST_CHECK_EQUAL(overlay->size(), 0);
+    BOOST_CHECK(!IndexManager::instance().getHistory(d.eonia->name()).empty());
+    for (auto const& t : portfolio->trades())
+        BOOST_CHECK_NO_THROW(t->legs()[0].front()->amount());
+
+    fixingManager.reset();
+    BOOST_CHECK(IndexManager::instance().getHistory(d.eonia->name()).empty());
+}
+
+BOOST_AUTO_TEST_CASE(testOverlayWithBrlCdiCoupons) {
+
+    BOOST_TEST_MESSAGE("Testing the fixing manager overlay with BRL CDI coupons...");
+
+    TestData d;
+    auto portfolio = boost::make_shared<ore::data::Portfolio>();
+    portfolio->add(boost::make_shared<LegTrade>("BrlCdiLeg", vector<Leg>{d.brlCdiLeg()}));
+    // an overnight leg with a pricer that does not read the coupon's fixing history
+    Leg overnightLeg = d.overnightLeg();
+    QuantExt::setCouponPricer(overnightLeg, boost::make_shared<BlackIborCouponPricer>());
+    portfolio->add(boost::make_shared<LegTrade>("OvernightLeg", vector<Leg>{overnightLeg}));
+    auto cdiCpn =
+        boost::dynamic_pointer_cast<QuantExt::OvernightIndexedCoupon>(portfolio->trades()[0]->legs()[0].front());
+    auto onCpn = boost::dynamic_pointer_cast<QuantExt::OvernightIndexedCoupon>(overnightLeg.front());
+    BOOST_REQUIRE(cdiCpn && onCpn);
+    BOOST_CHECK(cdiCpn->readsFixingHistory());
+    BOOST_CHECK(!onCpn->readsFixingHistory());
+
+    auto overlay = boost::make_shared<FixingOverlay>();
+    FixingManager fixingManager(d.today, overlay);
+    fixingManager.initialise(portfolio);
+
+    Settings::instance().evaluationDate() = d.simDate;
+    fixingManager.update(d.simDate);
+    FixingOverlayScope scope(overlay.get());
+
+    // the BRL CDI pricer reads the simulated fixings from the overlay
+    BOOST_CHECK(IndexManager::instance().getHistory(d.brlCdi->name()).empty());
+    BOOST_CHECK(overlay->size() > 0);
+    BOOST_CHECK_CLOSE(cdiCpn->fixingHistory().fixing(cdiCpn->fixingDates().front()), d.brlCdi->fixing(d.simDate),
+                      1.0E-10);
+    BOOST_CHECK_NO_THROW(cdiCpn->amount());
+    {
+        FixingOverlayScope noOverlay(nullptr);
+        BOOST_CHECK_THROW(cdiCpn->amount(), QuantLib::Error);
+    }
+
+    // the fixings of the other overnight coupon go to the IndexManager
+    BOOST_CHECK(!IndexManager::instance().getHistory(d.eonia->name()).empty());
+
+    fixingManager.reset();
+    BOOST_CHECK_EQUAL(overlay->size(), 0);
+    BOOST_CHECK(IndexManager::instance().getHistory(d.eonia->name()).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,201 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "testmarket.hpp"
+#include "testportfolio.hpp"
+#include <boost/test/unit_test.hpp>
+#include <orea/cube/inmemorycube.hpp>
+#include <orea/engine/proxyvaluationengine.hpp>
+#include <orea/engine/valuationcalculator.hpp>
+#include <orea/engine/valuationengine.hpp>
+#include <orea/scenario/crossassetmodelscenariogenerator.hpp>
+#include <orea/scenario/scenariosimmarket.hpp>
+#include <orea/scenario/scenariosimmarketparameters.hpp>
+#include <orea/scenario/simplescenariofactory.hpp>
+#include <ored/model/crossassetmodelbuilder.hpp>
+#include <ored/model/crossassetmodeldata.hpp>
+#include <ored/model/lgmdata.hpp>
+#include <ored/portfolio/builders/swap.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/utilities/dategrid.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <qle/methods/multipathgeneratorbase.hpp>
+#include <test/oreatoplevelfixture.hpp>
+
+using namespace std;
+using namespace QuantLib;
+using namespace QuantExt;
+using namespace ore::analytics;
+using namespace ore::data;
+using namespace boost::unit_test_framework;
+
+using testsuite::buildSwap;
+using testsuite::TestMarket;
+
+namespace {
+
+// quadratic in the first factor, linear in the second, independent of the third factor
+Real value(Size trade, Real x1, Real x2, Real) {
+    Real a = 100.0 * (trade + 1), b = 10.0 - 3.0 * trade, c = 50.0 * trade, e = -20.0 + trade;
+    return a + b * x1 + c * x1 * x1 + e * x2;
+}
+
+// a single currency simulation of the test market in an LGM model
+struct ProxySetup {
+    ProxySetup() : today(14, April, 2016), samples(100) {
+        Settings::instance().evaluationDate() = today;
+        boost::shared_ptr<Market> market = boost::make_shared<TestMarket>(today);
+
+        boost::shared_ptr<ScenarioSimMarketParameters> parameters = boost::make_shared<ScenarioSimMarketParameters>();
+        parameters->baseCcy() = "EUR";
+        parameters->setDiscountCurveNames({"EUR"});
+        parameters->setYieldCurveTenors("", {1 * Months, 6 * Months, 1 * Years, 2 * Years, 5 * Years, 10 * Years,
+                                             20 * Years});
+        parameters->setIndices({"EUR-EURIBOR-6M"});
+        parameters->interpolation() = "LogLinear";
+        parameters->extrapolate() = true;
+        parameters->setYieldCurveDayCounters("", "ACT/ACT");
+
+        vector<string> expiries = {"1Y", "2Y", "3Y", "5Y", "7Y", "10Y", "15Y", "20Y", "30Y"};
+        vector<string> terms(expiries.size(), "5Y");
+        vector<string> strikes(expiries.size(), "ATM");
+        vector<boost::shared_ptr<IrLgmData>> irConfigs;
+        irConfigs.push_back(boost::make_shared<IrLgmData>(
+            "EUR", CalibrationType::Bootstrap, LgmData::ReversionType::HullWhite, LgmData::VolatilityType::Hagan, false,
+            ParamType::Constant, vector<Time>(), vector<Real>(1, 0.02), true, ParamType::Piecewise, vector<Time>(),
+            vector<Real>(1, 0.008), 0.0, 1.0, expiries, terms, strikes));
+        boost::shared_ptr<CrossAssetModelData> config = boost::make_shared<CrossAssetModelData>(
+            irConfigs, vector<boost::shared_ptr<FxBsData>>(), map<pair<string, string>, Handle<Quote>>());
+        boost::shared_ptr<CrossAssetModel> model = *CrossAssetModelBuilder(market, config).model();
+
+        // monthly dates up to the second fixing of the swaps, the proxy does not see the simulated fixings
+        grid = boost::make_shared<DateGrid>("5,1M");
+        simMarket = boost::make_shared<ScenarioSimMarket>(market, parameters, Conventions());
+        boost::shared_ptr<MultiPathGeneratorBase> pathGen =
+            boost::make_shared<MultiPathGeneratorMersenneTwister>(model->stateProcess(), grid->timeGrid(), 42);
+        simMarket->scenarioGenerator() = boost::make_shared<CrossAssetModelScenarioGenerator>(
+            model, pathGen, boost::make_shared<SimpleScenarioFactory>(), parameters, today, grid, market);
+
+        boost::shared_ptr<EngineData> data = boost::make_shared<EngineData>();
+        data->model("Swap") = "DiscountedCashflows";
+        data->engine("Swap") = "DiscountingSwapEngine";
+        factory = boost::make_shared<EngineFactory>(data, simMarket);
+        factory->registerBuilder(boost::make_shared<SwapEngineBuilder>());
+
+        calculators.push_back(boost::make_shared<NPVCalculator>("EUR"));
+    }
+
+    boost::shared_ptr<NPVCube> cube(const boost::shared_ptr<Portfolio>& portfolio) const {
+        return boost::make_shared<DoublePrecisionInMemoryCube>(today, portfolio->ids(), grid->dates(), samples);
+    }
+
+    SavedSettings backup;
+    Date today;
+    Size samples;
+    boost::shared_ptr<DateGrid> grid;
+    boost::shared_ptr<ScenarioSimMarket> simMarket;
+    boost::shared_ptr<EngineFactory> factory;
+    vector<boost::shared_ptr<ValuationCalculator>> calculators;
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(ProxyValuationEngineTest)
+
+BOOST_AUTO_TEST_CASE(testDeltaGammaProxy) {
+
+    BOOST_TEST_MESSAGE("Testing the delta-gamma proxy on quadratic trade values...");
+
+    Size numTrades = 3, numFactors = 3;
+    Real h = 0.01;
+    DeltaGammaProxy proxy(numTrades, numFactors);
+    vector<Real> base(numTrades), up(numTrades), down(numTrades);
+    for (Size t = 0; t < numTrades; ++t)
+        base[t] = value(t, 0.0, 0.0, 0.0);
+    for (Size f = 0; f < numFactors; ++f) {
+        for (Size t = 0; t < numTrades; ++t) {
+            up[t] = value(t, f == 0 ? h : 0.0, f == 1 ? h : 0.0, f == 2 ? h : 0.0);
+            down[t] = value(t, f == 0 ? -h : 0.0, f == 1 ? -h : 0.0, f == 2 ? -h : 0.0);
+        }
+        proxy.setSensitivities(f, h, base, up, down);
+    }
+    BOOST_CHECK_EQUAL(proxy.numRelevantFactors(), 2);
+    BOOST_CHECK_CLOSE(proxy.delta(1, 0), 7.0, 1e-8);
+    BOOST_CHECK_CLOSE(proxy.gamma(2, 0), 200.0, 1e-6);
+    BOOST_CHECK_SMALL(proxy.gamma(0, 1), 1e-6);
+
+    // the expansion is exact for quadratic values, the third factor is irrelevant
+    vector<Real> moves = {0.05, -0.02, 1.0, -0.1, 0.3, -2.0, 0.0, 0.0, 0.5, 0.2, 0.0, 0.0};
+    Size samples = moves.size() / numFactors;
+    vector<Real> result;
+    proxy.evaluate(base, moves.data(), samples, result);
+    BOOST_REQUIRE_EQUAL(result.size(), samples * numTrades);
+    for (Size k = 0; k < samples; ++k) {
+        const Real* x = moves.data() + k * numFactors;
+        for (Size t = 0; t < numTrades; ++t)
+            BOOST_CHECK_CLOSE(result[k * numTrades + t], value(t, x[0], x[1], x[2]), 1e-8);
+    }
+
+    BOOST_CHECK_THROW(proxy.setSensitivities(numFactors, h, base, up, down), QuantLib::Error);
+    BOOST_CHECK_THROW(proxy.evaluate(vector<Real>(1, 0.0), moves.data(), samples, result), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_CASE(testBuildCube) {
+
+    BOOST_TEST_MESSAGE("Testing the proxy cube against the full revaluation cube...");
+
+    ProxySetup setup;
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    portfolio->add(buildSwap("Swap_Short", "EUR", true, 1000000.0, 0, 2, 0.02, 0.0, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->add(buildSwap("Swap_Flagged", "EUR", false, 1000000.0, 0, 10, 0.03, 0.0, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->build(setup.factory);
+
+    // sensitivities on every simulation date, the flagged swap is repriced under each scenario
+    boost::shared_ptr<NPVCube> proxyCube = setup.cube(portfolio);
+    ProxyValuationEngine proxyEngine(setup.today, setup.grid, setup.simMarket, setup.grid->dates(),
+                                     ProxyValuationEngine::defaultRiskFactorTypes(), {"Swap_Flagged"});
+    proxyEngine.buildCube(portfolio, proxyCube, setup.calculators);
+
+    // the same paths with full revaluation
+    setup.simMarket->scenarioGenerator()->reset();
+    boost::shared_ptr<NPVCube> fullCube = setup.cube(portfolio);
+    ValuationEngine engine(setup.today, setup.grid, setup.simMarket);
+    engine.buildCube(portfolio, fullCube, setup.calculators);
+
+    Real maxError = 0.0;
+    for (Size i = 0; i < portfolio->size(); ++i)
+        BOOST_CHECK_EQUAL(proxyCube->getT0(i), fullCube->getT0(i));
+    for (Size j = 0; j < setup.grid->size(); ++j) {
+        for (Size k = 0; k < setup.samples; ++k) {
+            // the swap is close to quadratic in the log discount factors, the deviation is third order in the moves
+            Real error = std::fabs(proxyCube->get(0, j, k) - fullCube->get(0, j, k));
+            maxError = std::max(maxError, error);
+            BOOST_CHECK_SMALL(error, 100.0);
+            BOOST_CHECK_EQUAL(proxyCube->get(1, j, k), fullCube->get(1, j, k));
+        }
+    }
+    BOOST_TEST_MESSAGE("maximum proxy error of the short swap " << maxError);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -19,6 +19,7 @@
 #include <boost/test/unit_test.hpp>
 #include <orea/scenario/crossassetmodelscenariogenerator.hpp>
 #include <orea/scenario/lgmscenariogenerator.hpp>
+#include <orea/scenario/pipelinedmultipathgenerator.hpp>
 #include <orea/scenario/scenariogeneratorbuilder.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/scenario/simplescenario.hpp>
@@ -1272,6 +1273,65 @@ BOOST_AUTO_TEST_CASE(testCpiSwapExposure) {
                                                     << capNpv << "), tolerance is " << tol);
 }
 
+BOOST_AUTO_TEST_CASE(testPipelinedPaths) {
+    BOOST_TEST_MESSAGE("Testing that the pipelined path generator reproduces the scenarios of a serial run...");
+
+    TestData d;
+
+    Date today = d.referenceDate;
+    std::vector<Period> tenorGrid = {1 * Years, 2 * Years, 3 * Years, 5 * Years, 7 * Years, 10 * Years};
+    boost::shared_ptr<DateGrid> grid = boost::make_shared<DateGrid>(tenorGrid);
+
+    boost::shared_ptr<ScenarioSimMarketParameters> simMarketConfig(new ScenarioSimMarketParameters);
+    simMarketConfig->setYieldCurveTenors("", {3 * Months, 1 * Years, 5 * Years, 10 * Years, 30 * Years});
+    simMarketConfig->setYieldCurveDayCounters("", "ACT/ACT");
+    simMarketConfig->setSimulateFXVols(false);
+    simMarketConfig->setSimulateEquityVols(false);
+    simMarketConfig->setZeroInflationTenors("", {1 * Years, 5 * Years, 10 * Years});
+    simMarketConfig->setZeroInflationDayCounters("", "ACT/ACT");
+
+    boost::shared_ptr<ScenarioFactory> sf = boost::make_shared<SimpleScenarioFactory>();
+    Size samples = 20;
+
+    for (auto sequenceType : {QuantExt::MersenneTwister, QuantExt::MersenneTwisterAntithetic, QuantExt::Sobol,
+                              QuantExt::SobolBrownianBridge}) {
+        BOOST_TEST_MESSAGE("sequence type " << sequenceType);
+        boost::shared_ptr<ScenarioGeneratorData> sgd(new ScenarioGeneratorData);
+        sgd->discretization() = QuantExt::CrossAssetStateProcess::exact;
+        sgd->sequenceType() = sequenceType;
+        sgd->seed() = 42;
+        sgd->grid() = grid;
+
+        // both generators run on this thread, only the variates of the pipelined one are drawn in the background
+        boost::shared_ptr<ScenarioGenerator> serial =
+            ScenarioGeneratorBuilder(sgd).build(d.ccLgm, sf, simMarketConfig, today, d.market);
+        boost::shared_ptr<ScenarioGenerator> pipelined =
+            ScenarioGeneratorBuilder(sgd, true).build(d.ccLgm, sf, simMarketConfig, today, d.market);
+
+        // run through the samples twice, the reset must restart with the first path, skip an odd number of paths
+        // in the second run to cover the antithetic pairs
+        for (Size run = 0; run < 2; ++run) {
+            if (run == 1) {
+                serial->skip(3);
+                pipelined->skip(3);
+            }
+            for (Size i = 0; i < samples; ++i) {
+                for (Date date : grid->dates()) {
+                    boost::shared_ptr<Scenario> s1 = serial->next(date);
+                    boost::shared_ptr<Scenario> s2 = pipelined->next(date);
+                    BOOST_REQUIRE_EQUAL(s1->asof(), s2->asof());
+                    BOOST_CHECK_EQUAL(s1->getNumeraire(), s2->getNumeraire());
+                    BOOST_REQUIRE_EQUAL(s1->keys().size(), s2->keys().size());
+                    for (auto const& k : s1->keys())
+                        BOOST_CHECK_EQUAL(s1->get(k), s2->get(k));
+                }
+            }
+            serial->reset();
+            pipelined->reset();
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -61,6 +61,8 @@ public:
     static void testFxForwardExposure();
     //! Test consistency of FX Forward Exposure evolutions with FX Forward Option prices when IR vols vanish
     static void testFxForwardExposureZeroIrVol();
+    //! Test that the pipelined path generator reproduces the scenarios of a serial run
+    static void testPipelinedPaths();
 
     static boost::unit_test_framework::test_suite* suite();
 };
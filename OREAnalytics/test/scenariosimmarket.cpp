@@ -17,8 +17,11 @@
 */
 
 #include <boost/test/unit_test.hpp>
+#include <orea/scenario/deltascenario.hpp>
+#include <orea/scenario/deltascenariofactory.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/scenario/scenariosimmarketparameters.hpp>
+#include <orea/scenario/simplescenariofactory.hpp>
 #include <ored/configuration/conventions.hpp>
 #include <ored/marketdata/market.hpp>
 #include <ored/marketdata/marketimpl.hpp>
@@ -34,6 +37,7 @@
 #include <test/testmarket.hpp>
 
 #include <ql/indexes/ibor/all.hpp>
+#include <ql/math/comparison.hpp>
 
 using namespace QuantLib;
 using namespace QuantExt;
@@ -275,6 +279,31 @@ void testToXML(boost::shared_ptr<analytics::ScenarioSimMarketParameters> params)
     remove("simtest.xml");
 }
 
+namespace {
+// Returns a fixed sequence of scenarios
+class FixedScenarioGenerator : public ore::analytics::ScenarioGenerator {
+public:
+    FixedScenarioGenerator(const vector<boost::shared_ptr<ore::analytics::Scenario>>& scenarios)
+        : scenarios_(scenarios), counter_(0) {}
+    boost::shared_ptr<ore::analytics::Scenario> next(const Date&) override { return scenarios_.at(counter_++); }
+    void reset() override { counter_ = 0; }
+
+private:
+    vector<boost::shared_ptr<ore::analytics::Scenario>> scenarios_;
+    Size counter_;
+};
+
+// Allows the keys of one type only
+class TypeScenarioFilter : public ore::analytics::ScenarioFilter {
+public:
+    TypeScenarioFilter(const ore::analytics::RiskFactorKey::KeyType type) : type_(type) {}
+    bool allow(const ore::analytics::RiskFactorKey& key) const override { return key.keytype == type_; }
+
+private:
+    ore::analytics::RiskFactorKey::KeyType type_;
+};
+} // namespace
+
 BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
 
 BOOST_AUTO_TEST_SUITE(ScenarioSimMarketTest)
@@ -311,6 +340,170 @@ BOOST_AUTO_TEST_CASE(testScenarioSimMarket) {
     testToXML(parameters);
 }
 
+BOOST_AUTO_TEST_CASE(testDeltaScenarios) {
+    BOOST_TEST_MESSAGE("Testing delta scenarios applied to the ScenarioSimMarket...");
+
+    SavedSettings backup;
+
+    Date today(20, Jan, 2015);
+    Settings::instance().evaluationDate() = today;
+    boost::shared_ptr<ore::data::Market> initMarket = boost::make_shared<TestMarket>(today);
+    boost::shared_ptr<analytics::ScenarioSimMarketParameters> parameters = scenarioParameters();
+    Conventions conventions = *convs();
+    boost::shared_ptr<analytics::ScenarioSimMarket> simMarket(
+        new analytics::ScenarioSimMarket(initMarket, parameters, conventions));
+
+    using analytics::RiskFactorKey;
+    boost::shared_ptr<analytics::Scenario> base = simMarket->baseScenario();
+    RiskFactorKey fxKey(RiskFactorKey::KeyType::FXSpot, "USDEUR");
+    RiskFactorKey discountKey(RiskFactorKey::KeyType::DiscountCurve, "EUR", 0);
+    Real baseFx = base->get(fxKey);
+    Real baseDiscount = simMarket->discountCurve("EUR")->discount(0.5);
+
+    analytics::DeltaScenarioFactory factory(base);
+    boost::shared_ptr<analytics::Scenario> fxUp = factory.buildScenario(today, "fxUp");
+    fxUp->add(fxKey, 1.1 * baseFx);
+    boost::shared_ptr<analytics::Scenario> discountUp = factory.buildScenario(today, "discountUp");
+    discountUp->add(discountKey, 0.9 * base->get(discountKey));
+
+    // the delta scenarios only store the shifted values
+    boost::shared_ptr<analytics::DeltaScenario> delta = boost::dynamic_pointer_cast<analytics::DeltaScenario>(fxUp);
+    BOOST_REQUIRE(delta);
+    BOOST_CHECK_EQUAL(delta->delta().size(), 1);
+    BOOST_CHECK_EQUAL(fxUp->keys().size(), base->keys().size());
+    BOOST_CHECK_EQUAL(fxUp->get(discountKey), base->get(discountKey));
+    BOOST_CHECK_EQUAL(fxUp->getNumeraire(), base->getNumeraire());
+    BOOST_CHECK_EQUAL(fxUp->label(), "fxUp");
+    BOOST_CHECK_THROW(fxUp->add(RiskFactorKey(RiskFactorKey::KeyType::FXSpot, "XXXEUR"), 1.0), QuantLib::Error);
+
+    simMarket->scenarioGenerator() = boost::make_shared<FixedScenarioGenerator>(
+        vector<boost::shared_ptr<analytics::Scenario>>{fxUp, discountUp, base, discountUp});
+
+    // a delta without its base applied first
+    simMarket->update(today);
+    BOOST_CHECK_CLOSE(simMarket->fxSpot("USDEUR")->value(), 1.1 * baseFx, 1e-12);
+    BOOST_CHECK_CLOSE(simMarket->discountCurve("EUR")->discount(0.5), baseDiscount, 1e-12);
+
+    // the fx spot is restored when the next delta is applied
+    simMarket->update(today);
+    BOOST_CHECK_CLOSE(simMarket->fxSpot("USDEUR")->value(), baseFx, 1e-12);
+    BOOST_CHECK(!close_enough(simMarket->discountCurve("EUR")->discount(0.5), baseDiscount));
+
+    simMarket->update(today);
+    BOOST_CHECK_CLOSE(simMarket->fxSpot("USDEUR")->value(), baseFx, 1e-12);
+    BOOST_CHECK_CLOSE(simMarket->discountCurve("EUR")->discount(0.5), baseDiscount, 1e-12);
+
+    // the market is back to the base scenario after the reset
+    simMarket->update(today);
+    simMarket->reset();
+    BOOST_CHECK_CLOSE(simMarket->fxSpot("USDEUR")->value(), baseFx, 1e-12);
+    BOOST_CHECK_CLOSE(simMarket->discountCurve("EUR")->discount(0.5), baseDiscount, 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE(testFilterAndReset) {
+    BOOST_TEST_MESSAGE("Testing scenario filters and the reset of the ScenarioSimMarket...");
+
+    SavedSettings backup;
+
+    Date today(20, Jan, 2015);
+    Settings::instance().evaluationDate() = today;
+    boost::shared_ptr<ore::data::Market> initMarket = boost::make_shared<TestMarket>(today);
+    boost::shared_ptr<analytics::ScenarioSimMarketParameters> parameters = scenarioParameters();
+    Conventions conventions = *convs();
+    boost::shared_ptr<analytics::ScenarioSimMarket> simMarket(
+        new analytics::ScenarioSimMarket(initMarket, parameters, conventions));
+
+    using analytics::RiskFactorKey;
+    boost::shared_ptr<analytics::Scenario> base = simMarket->baseScenario();
+    RiskFactorKey fxKey(RiskFactorKey::KeyType::FXSpot, "USDEUR");
+    RiskFactorKey discountKey(RiskFactorKey::KeyType::DiscountCurve, "EUR", 0);
+    Real baseFx = base->get(fxKey);
+    Real baseDiscount = simMarket->discountCurve("EUR")->discount(0.5);
+
+    boost::shared_ptr<analytics::Scenario> shifted = base->clone();
+    shifted->add(fxKey, 1.1 * baseFx);
+    shifted->add(discountKey, 0.9 * base->get(discountKey));
+    simMarket->scenarioGenerator() =
+        boost::make_shared<FixedScenarioGenerator>(vector<boost::shared_ptr<analytics::Scenario>>{shifted, shifted});
+
+    // only the fx spot passes the filter
+    simMarket->filter() = boost::make_shared<TypeScenarioFilter>(RiskFactorKey::KeyType::FXSpot);
+    simMarket->update(today);
+    BOOST_CHECK_CLOSE(simMarket->fxSpot("USDEUR")->value(), 1.1 * baseFx, 1e-12);
+    BOOST_CHECK_CLOSE(simMarket->discountCurve("EUR")->discount(0.5), baseDiscount, 1e-12);
+
+    // a new filter object takes effect with the next update, the reset restores the base scenario
+    simMarket->filter() = boost::make_shared<analytics::ScenarioFilter>();
+    simMarket->update(today);
+    BOOST_CHECK(!close_enough(simMarket->discountCurve("EUR")->discount(0.5), baseDiscount));
+    simMarket->reset();
+    BOOST_CHECK_CLOSE(simMarket->fxSpot("USDEUR")->value(), baseFx, 1e-12);
+    BOOST_CHECK_CLOSE(simMarket->discountCurve("EUR")->discount(0.5), baseDiscount, 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE(testSharedScenarioKeys) {
+    BOOST_TEST_MESSAGE("Testing scenarios with shared keys in the ScenarioSimMarket...");
+
+    SavedSettings backup;
+
+    Date today(20, Jan, 2015);
+    Settings::instance().evaluationDate() = today;
+
+    using analytics::RiskFactorKey;
+    RiskFactorKey fxKey(RiskFactorKey::KeyType::FXSpot, "USDEUR");
+    RiskFactorKey discountKey(RiskFactorKey::KeyType::DiscountCurve, "EUR", 0);
+
+    // scenarios filled in the same key order share their keys, the values are stored in that order
+    analytics::SimpleScenarioFactory factory;
+    boost::shared_ptr<analytics::Scenario> s1 = factory.buildScenario(today);
+    s1->add(fxKey, 1.0);
+    s1->add(discountKey, 0.9);
+    boost::shared_ptr<analytics::Scenario> s2 = factory.buildScenario(today);
+    s2->add(fxKey, 1.1);
+    s2->add(discountKey, 0.8);
+    BOOST_REQUIRE(s1->sharedKeys() && s1->sharedKeys() == s2->sharedKeys());
+    BOOST_CHECK_EQUAL(s2->values()[0], 1.1);
+    BOOST_CHECK_EQUAL(s2->values()[1], 0.8);
+    BOOST_CHECK_EQUAL(s2->get(discountKey), 0.8);
+    s2->add(fxKey, 1.2);
+    BOOST_CHECK_EQUAL(s2->get(fxKey), 1.2);
+    BOOST_CHECK(s1->sharedKeys() == s2->sharedKeys());
+
+    // another key order or a partially filled scenario gets its own keys
+    boost::shared_ptr<analytics::Scenario> s3 = factory.buildScenario(today);
+    s3->add(discountKey, 0.7);
+    s3->add(fxKey, 1.3);
+    BOOST_CHECK(s3->sharedKeys() != s1->sharedKeys());
+    BOOST_CHECK_EQUAL(s3->keys().front(), discountKey);
+    BOOST_CHECK_EQUAL(s3->get(fxKey), 1.3);
+    BOOST_CHECK_EQUAL(s1->get(fxKey), 1.0);
+    boost::shared_ptr<analytics::Scenario> s4 = factory.buildScenario(today);
+    s4->add(discountKey, 0.6);
+    BOOST_CHECK(!s4->has(fxKey));
+    BOOST_CHECK_EQUAL(s4->keys().size(), 1);
+    BOOST_CHECK_EQUAL(s3->keys().size(), 2);
+
+    // the sim market applies scenarios with the key order of the base scenario
+    boost::shared_ptr<ore::data::Market> initMarket = boost::make_shared<TestMarket>(today);
+    boost::shared_ptr<analytics::ScenarioSimMarketParameters> parameters = scenarioParameters();
+    Conventions conventions = *convs();
+    boost::shared_ptr<analytics::ScenarioSimMarket> simMarket(
+        new analytics::ScenarioSimMarket(initMarket, parameters, conventions));
+    boost::shared_ptr<analytics::Scenario> base = simMarket->baseScenario();
+    vector<boost::shared_ptr<analytics::Scenario>> scenarios;
+    for (Size i = 0; i < 2; ++i) {
+        scenarios.push_back(factory.buildScenario(today, "", 1.0));
+        for (auto const& k : base->keys())
+            scenarios.back()->add(k, (k == fxKey ? 1.0 + 0.1 * (i + 1) : 1.0) * base->get(k));
+    }
+    BOOST_REQUIRE(scenarios[0]->sharedKeys() == scenarios[1]->sharedKeys());
+    simMarket->scenarioGenerator() = boost::make_shared<FixedScenarioGenerator>(scenarios);
+    for (Size i = 0; i < 2; ++i) {
+        simMarket->update(today);
+        BOOST_CHECK_CLOSE(simMarket->fxSpot("USDEUR")->value(), (1.0 + 0.1 * (i + 1)) * base->get(fxKey), 1e-12);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -34,6 +34,8 @@ namespace testsuite {
 class ScenarioSimMarketTest {
 public:
     static void testScenarioSimMarket();
+    //! Test applying delta scenarios to the sim market
+    static void testDeltaScenarios();
     static boost::unit_test_framework::test_suite* suite();
 };
 } // namespace testsuite
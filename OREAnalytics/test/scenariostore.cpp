@@ -0,0 +1,175 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <orea/scenario/scenariostore.hpp>
+#include <orea/scenario/simplescenariofactory.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <ql/time/date.hpp>
+#include <test/oreatoplevelfixture.hpp>
+#include <test/testvalues.hpp>
+
+using namespace std;
+using namespace QuantLib;
+using namespace ore::analytics;
+using namespace boost::unit_test_framework;
+using testsuite::testValue;
+
+namespace {
+
+// value of the key on the given path and step
+Real value(Size path, Size step, Size key) { return testValue(13 * path, step, key, 0); }
+
+// generates the values above for three keys
+class TestScenarioGenerator : public ScenarioGenerator {
+public:
+    TestScenarioGenerator(const vector<Date>& dates) : dates_(dates), path_(0), step_(0) {
+        keys_ = {RiskFactorKey(RiskFactorKey::KeyType::DiscountCurve, "EUR", 0),
+                 RiskFactorKey(RiskFactorKey::KeyType::DiscountCurve, "EUR", 1),
+                 RiskFactorKey(RiskFactorKey::KeyType::FXSpot, "USDEUR", 0)};
+    }
+    boost::shared_ptr<Scenario> next(const Date& d) override {
+        if (d == dates_.front() && step_ > 0) {
+            ++path_;
+            step_ = 0;
+        }
+        BOOST_REQUIRE(d == dates_[step_]);
+        boost::shared_ptr<Scenario> s = boost::make_shared<SimpleScenario>(d, "", 1.0 / value(path_, step_, 9));
+        for (Size k = 0; k < keys_.size(); ++k)
+            s->add(keys_[k], value(path_, step_, k));
+        ++step_;
+        return s;
+    }
+    void reset() override { path_ = step_ = 0; }
+    void skip(Size n) override { path_ += n; }
+
+    vector<Date> dates_;
+    vector<RiskFactorKey> keys_;
+    Size path_, step_;
+};
+
+struct StoreSetup {
+    StoreSetup() : today(14, April, 2016), dates({today + 1 * Years, today + 2 * Years}), fileName("store_test.dat") {
+        boost::filesystem::remove(fileName);
+    }
+    ~StoreSetup() { boost::filesystem::remove(fileName); }
+
+    // write the paths [first, last) to the store
+    void write(Size first, Size last, bool singlePrecision, std::uint64_t configurationHash = 0) {
+        auto src = boost::make_shared<TestScenarioGenerator>(dates);
+        ScenarioStoreWriter writer(src, fileName, today, dates, singlePrecision, configurationHash);
+        writer.skip(first);
+        for (Size p = first; p < last; ++p)
+            for (auto const& d : dates)
+                writer.next(d);
+        // an incomplete path is not stored
+        writer.next(dates.front());
+    }
+
+    Date today;
+    vector<Date> dates;
+    string fileName;
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(ScenarioStoreTest)
+
+BOOST_AUTO_TEST_CASE(testReplay) {
+
+    BOOST_TEST_MESSAGE("Testing the replay of stored scenarios...");
+
+    for (bool singlePrecision : {false, true}) {
+        StoreSetup setup;
+        setup.write(0, 10, singlePrecision);
+
+        ScenarioStoreGenerator store(setup.fileName, boost::make_shared<SimpleScenarioFactory>());
+        BOOST_CHECK_EQUAL(store.asof(), setup.today);
+        BOOST_CHECK(store.dates() == setup.dates);
+        BOOST_CHECK_EQUAL(store.keys().size(), 3);
+        BOOST_CHECK_EQUAL(store.firstSample(), 0);
+        BOOST_CHECK_EQUAL(store.samples(), 10);
+        BOOST_CHECK_EQUAL(store.singlePrecision(), singlePrecision);
+
+        TestScenarioGenerator src(setup.dates);
+        for (Size round = 0; round < 2; ++round) {
+            for (Size p = 0; p < 10; ++p) {
+                for (auto const& d : setup.dates) {
+                    boost::shared_ptr<Scenario> a = src.next(d), b = store.next(d);
+                    BOOST_CHECK_EQUAL(b->asof(), d);
+                    BOOST_CHECK_EQUAL(b->getNumeraire(), a->getNumeraire());
+                    BOOST_REQUIRE(b->keys() == a->keys());
+                    for (auto const& k : a->keys()) {
+                        if (singlePrecision)
+                            BOOST_CHECK_EQUAL(b->get(k), static_cast<float>(a->get(k)));
+                        else
+                            BOOST_CHECK_EQUAL(b->get(k), a->get(k));
+                    }
+                }
+            }
+            BOOST_CHECK_THROW(store.next(setup.dates.front()), QuantLib::Error);
+            src.reset();
+            store.reset();
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testSampleRange) {
+
+    BOOST_TEST_MESSAGE("Testing the replay of a scenario store for a sample range...");
+
+    StoreSetup setup;
+    setup.write(5, 8, false);
+
+    ScenarioStoreGenerator store(setup.fileName, boost::make_shared<SimpleScenarioFactory>());
+    BOOST_CHECK_EQUAL(store.firstSample(), 5);
+    BOOST_CHECK_EQUAL(store.samples(), 3);
+
+    // the paths keep their numbering, paths before the store are not available
+    BOOST_CHECK_THROW(store.next(setup.dates.front()), QuantLib::Error);
+    store.reset();
+    store.skip(6);
+    for (Size p = 6; p < 8; ++p)
+        for (Size j = 0; j < setup.dates.size(); ++j)
+            BOOST_CHECK_EQUAL(store.next(setup.dates[j])->getNumeraire(), 1.0 / value(p, j, 9));
+    BOOST_CHECK_THROW(store.next(setup.dates.front()), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_CASE(testConfigurationHash) {
+
+    BOOST_TEST_MESSAGE("Testing the configuration hash of a scenario store...");
+
+    // the hash must not change between runs and builds, 64 bit FNV-1a reference values
+    BOOST_CHECK_EQUAL(scenarioStoreHash(""), 14695981039346656037ULL);
+    BOOST_CHECK_EQUAL(scenarioStoreHash("a"), 12638187200555641996ULL);
+    BOOST_CHECK(scenarioStoreHash("<Seed>42</Seed>") != scenarioStoreHash("<Seed>43</Seed>"));
+
+    StoreSetup setup;
+    std::uint64_t hash = scenarioStoreHash("<Simulation/>");
+    setup.write(0, 2, false, hash);
+    ScenarioStoreGenerator store(setup.fileName, boost::make_shared<SimpleScenarioFactory>());
+    BOOST_CHECK_EQUAL(store.configurationHash(), hash);
+    BOOST_CHECK_EQUAL(store.samples(), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
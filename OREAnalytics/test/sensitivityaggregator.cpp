@@ -16,8 +16,10 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
 #include <orea/engine/sensitivityaggregator.hpp>
+#include <orea/engine/sensitivitybinaryfile.hpp>
 #include <orea/engine/sensitivityinmemorystream.hpp>
 #include <oret/toplevelfixture.hpp>
 #include <ql/math/comparison.hpp>
@@ -28,6 +30,8 @@ using namespace std;
 
 using ore::analytics::RiskFactorKey;
 using ore::analytics::SensitivityAggregator;
+using ore::analytics::SensitivityBinaryFileStream;
+using ore::analytics::SensitivityBinaryFileWriter;
 using ore::analytics::SensitivityInMemoryStream;
 using ore::analytics::SensitivityRecord;
 using std::function;
@@ -240,6 +244,48 @@ BOOST_AUTO_TEST_CASE(testGeneralAggregationFunctionCategories) {
     check(expAggregationAll, res, "all_except_002");
 }
 
+BOOST_AUTO_TEST_CASE(testBinaryFileStream) {
+
+    BOOST_TEST_MESSAGE("Testing round trip of sensitivity records through the binary file format");
+
+    boost::filesystem::path file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+
+    {
+        SensitivityBinaryFileWriter writer(file.string());
+        for (const auto& sr : records)
+            writer.add(sr);
+        writer.close();
+        BOOST_CHECK_EQUAL(writer.records(), records.size());
+    }
+    BOOST_CHECK(ore::analytics::isSensitivityBinaryFile(file.string()));
+
+    // Read the whole file, twice to check reset()
+    SensitivityBinaryFileStream ss(file.string());
+    BOOST_CHECK_EQUAL(ss.fileRecords(), records.size());
+    for (QuantLib::Size pass = 0; pass < 2; ++pass) {
+        set<SensitivityRecord> res;
+        while (SensitivityRecord sr = ss.next())
+            res.insert(sr);
+        check(records, res, "binary file");
+        ss.reset();
+    }
+
+    // Consecutive byte ranges return each record exactly once
+    QuantLib::Size fileSize = boost::filesystem::file_size(file);
+    QuantLib::Size parts = 4, total = 0;
+    set<SensitivityRecord> res;
+    for (QuantLib::Size k = 0; k < parts; ++k) {
+        SensitivityBinaryFileStream part(file.string(), k * fileSize / parts, (k + 1) * fileSize / parts);
+        total += part.records();
+        while (SensitivityRecord sr = part.next())
+            res.insert(sr);
+    }
+    BOOST_CHECK_EQUAL(total, records.size());
+    check(records, res, "binary file ranges");
+
+    boost::filesystem::remove(file);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -62,6 +62,7 @@ using namespace ore;
 using namespace ore::data;
 using namespace ore::analytics;
 
+using testsuite::TestConfigurationObjects;
 using testsuite::TestMarket;
 
 BOOST_FIXTURE_TEST_SUITE(OREAnalyticsPerformanceTestSuite, ore::test::OreaTopLevelFixture)
@@ -263,122 +264,17 @@ void test_performance(Size portfolioSize, ObservationMode::Mode om, double nonZe
     BOOST_TEST_MESSAGE("Samples   : " << samples);
     BOOST_TEST_MESSAGE("Swaps     : " << portfolioSize);
 
-    // build model
     string baseCcy = "EUR";
-    vector<string> ccys;
-    ccys.push_back(baseCcy);
-    ccys.push_back("GBP");
-    ccys.push_back("CHF");
-    ccys.push_back("USD");
-    ccys.push_back("JPY");
 
     // Init market
     boost::shared_ptr<Market> initMarket = boost::make_shared<TestMarket>(today);
 
     // build scenario sim market parameters
-    boost::shared_ptr<analytics::ScenarioSimMarketParameters> parameters(new analytics::ScenarioSimMarketParameters());
-    parameters->baseCcy() = "EUR";
-    parameters->setDiscountCurveNames({"EUR", "GBP", "USD", "CHF", "JPY"});
-    parameters->setYieldCurveTenors("",
-                                    {1 * Months, 6 * Months, 1 * Years, 2 * Years, 5 * Years, 10 * Years, 20 * Years});
-    parameters->setIndices({"EUR-EURIBOR-6M", "USD-LIBOR-3M", "GBP-LIBOR-6M", "CHF-LIBOR-6M", "JPY-LIBOR-6M"});
-    parameters->setYieldCurveDayCounters("", "ACT/ACT");
-
-    parameters->interpolation() = "LogLinear";
-    parameters->extrapolate() = true;
-
-    parameters->setSimulateSwapVols(false);
-    parameters->setSwapVolTerms("", {6 * Months, 1 * Years});
-    parameters->setSwapVolExpiries("", {1 * Years, 2 * Years});
-    parameters->swapVolCcys() = ccys;
-    parameters->swapVolDecayMode() = "ForwardVariance";
-    parameters->setSwapVolDayCounters("", "ACT/ACT");
-
-    parameters->setFxVolExpiries(
-        vector<Period>{1 * Months, 3 * Months, 6 * Months, 2 * Years, 3 * Years, 4 * Years, 5 * Years});
-    parameters->setFxVolDecayMode(string("ConstantVariance"));
-    parameters->setFxVolDayCounters("", "ACT/ACT");
-    parameters->setSimulateFXVols(false);
-
-    parameters->setFxVolCcyPairs({"USDEUR", "GBPEUR", "CHFEUR", "JPYEUR"});
-    parameters->setFxCcyPairs({"USDEUR", "GBPEUR", "CHFEUR", "JPYEUR"});
-
-    parameters->equityVolExpiries() = {1 * Months, 3 * Months, 6 * Months, 2 * Years, 3 * Years, 4 * Years, 5 * Years};
-    parameters->equityVolDecayMode() = "ConstantVariance";
-    parameters->setEquityVolDayCounters("", "ACT/ACT");
-    parameters->setSimulateEquityVols(false);
+    boost::shared_ptr<analytics::ScenarioSimMarketParameters> parameters =
+        TestConfigurationObjects::setupExposureSimMarketData5();
 
     // Config
-
-    // Build IR configurations
-    CalibrationType calibrationType = CalibrationType::Bootstrap;
-    LgmData::ReversionType revType = LgmData::ReversionType::HullWhite;
-    LgmData::VolatilityType volType = LgmData::VolatilityType::Hagan;
-    vector<string> swaptionExpiries = {"1Y", "2Y", "3Y", "5Y", "7Y", "10Y", "15Y", "20Y", "30Y"};
-    vector<string> swaptionTerms = {"5Y", "5Y", "5Y", "5Y", "5Y", "5Y", "5Y", "5Y", "5Y"};
-    vector<string> swaptionStrikes(swaptionExpiries.size(), "ATM");
-    vector<Time> hTimes = {};
-    vector<Time> aTimes = {};
-
-    std::vector<boost::shared_ptr<IrLgmData>> irConfigs;
-
-    vector<Real> hValues = {0.02};
-    vector<Real> aValues = {0.008};
-    irConfigs.push_back(boost::make_shared<IrLgmData>(
-        "EUR", calibrationType, revType, volType, false, ParamType::Constant, hTimes, hValues, true,
-        ParamType::Piecewise, aTimes, aValues, 0.0, 1.0, swaptionExpiries, swaptionTerms, swaptionStrikes));
-
-    hValues = {0.03};
-    aValues = {0.009};
-    irConfigs.push_back(boost::make_shared<IrLgmData>(
-        "USD", calibrationType, revType, volType, false, ParamType::Constant, hTimes, hValues, true,
-        ParamType::Piecewise, aTimes, aValues, 0.0, 1.0, swaptionExpiries, swaptionTerms, swaptionStrikes));
-
-    hValues = {0.04};
-    aValues = {0.01};
-    irConfigs.push_back(boost::make_shared<IrLgmData>(
-        "GBP", calibrationType, revType, volType, false, ParamType::Constant, hTimes, hValues, true,
-        ParamType::Piecewise, aTimes, aValues, 0.0, 1.0, swaptionExpiries, swaptionTerms, swaptionStrikes));
-
-    hValues = {0.04};
-    aValues = {0.01};
-    irConfigs.push_back(boost::make_shared<IrLgmData>(
-        "CHF", calibrationType, revType, volType, false, ParamType::Constant, hTimes, hValues, true,
-        ParamType::Piecewise, aTimes, aValues, 0.0, 1.0, swaptionExpiries, swaptionTerms, swaptionStrikes));
-
-    hValues = {0.04};
-    aValues = {0.01};
-    irConfigs.push_back(boost::make_shared<IrLgmData>(
-        "JPY", calibrationType, revType, volType, false, ParamType::Constant, hTimes, hValues, true,
-        ParamType::Piecewise, aTimes, aValues, 0.0, 1.0, swaptionExpiries, swaptionTerms, swaptionStrikes));
-
-    // Compile FX configurations
-    vector<string> optionExpiries = {"1Y", "2Y", "3Y", "5Y", "7Y", "10Y"};
-    vector<string> optionStrikes(optionExpiries.size(), "ATMF");
-    vector<Time> sigmaTimes = {};
-
-    std::vector<boost::shared_ptr<FxBsData>> fxConfigs;
-
-    vector<Real> sigmaValues = {0.15};
-    fxConfigs.push_back(boost::make_shared<FxBsData>("USD", "EUR", calibrationType, true, ParamType::Piecewise,
-                                                     sigmaTimes, sigmaValues, optionExpiries, optionStrikes));
-
-    sigmaValues = {0.20};
-    fxConfigs.push_back(boost::make_shared<FxBsData>("GBP", "EUR", calibrationType, true, ParamType::Piecewise,
-                                                     sigmaTimes, sigmaValues, optionExpiries, optionStrikes));
-
-    sigmaValues = {0.20};
-    fxConfigs.push_back(boost::make_shared<FxBsData>("CHF", "EUR", calibrationType, true, ParamType::Piecewise,
-                                                     sigmaTimes, sigmaValues, optionExpiries, optionStrikes));
-
-    sigmaValues = {0.20};
-    fxConfigs.push_back(boost::make_shared<FxBsData>("JPY", "EUR", calibrationType, true, ParamType::Piecewise,
-                                                     sigmaTimes, sigmaValues, optionExpiries, optionStrikes));
-
-    std::map<std::pair<std::string, std::string>, Handle<Quote>> corr;
-    corr[std::make_pair("IR:EUR", "IR:USD")] = Handle<Quote>(boost::make_shared<SimpleQuote>(0.6));
-
-    boost::shared_ptr<CrossAssetModelData> config(boost::make_shared<CrossAssetModelData>(irConfigs, fxConfigs, corr));
+    boost::shared_ptr<CrossAssetModelData> config = TestConfigurationObjects::setupCrossAssetModelData5();
 
     // Model Builder & Model
     // model builder
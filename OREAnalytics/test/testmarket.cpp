@@ -520,6 +520,81 @@ boost::shared_ptr<ore::analytics::ScenarioSimMarketParameters> TestConfiguration
     return simMarketData;
 }
 
+boost::shared_ptr<ore::analytics::ScenarioSimMarketParameters>
+TestConfigurationObjects::setupExposureSimMarketData5() {
+    boost::shared_ptr<ore::analytics::ScenarioSimMarketParameters> simMarketData(
+        new ore::analytics::ScenarioSimMarketParameters());
+
+    simMarketData->baseCcy() = "EUR";
+    simMarketData->setDiscountCurveNames({"EUR", "GBP", "USD", "CHF", "JPY"});
+    simMarketData->setYieldCurveTenors(
+        "", {1 * Months, 6 * Months, 1 * Years, 2 * Years, 5 * Years, 10 * Years, 20 * Years});
+    simMarketData->setIndices({"EUR-EURIBOR-6M", "USD-LIBOR-3M", "GBP-LIBOR-6M", "CHF-LIBOR-6M", "JPY-LIBOR-6M"});
+    simMarketData->setYieldCurveDayCounters("", "ACT/ACT");
+    simMarketData->interpolation() = "LogLinear";
+    simMarketData->extrapolate() = true;
+
+    simMarketData->setSimulateSwapVols(false);
+    simMarketData->setSwapVolTerms("", {6 * Months, 1 * Years});
+    simMarketData->setSwapVolExpiries("", {1 * Years, 2 * Years});
+    simMarketData->setSwapVolCcys({"EUR", "GBP", "CHF", "USD", "JPY"});
+    simMarketData->swapVolDecayMode() = "ForwardVariance";
+    simMarketData->setSwapVolDayCounters("", "ACT/ACT");
+
+    simMarketData->setFxVolExpiries(
+        vector<Period>{1 * Months, 3 * Months, 6 * Months, 2 * Years, 3 * Years, 4 * Years, 5 * Years});
+    simMarketData->setFxVolDecayMode(string("ConstantVariance"));
+    simMarketData->setFxVolDayCounters("", "ACT/ACT");
+    simMarketData->setSimulateFXVols(false);
+    simMarketData->setFxVolCcyPairs({"USDEUR", "GBPEUR", "CHFEUR", "JPYEUR"});
+    simMarketData->setFxCcyPairs({"USDEUR", "GBPEUR", "CHFEUR", "JPYEUR"});
+
+    simMarketData->equityVolExpiries() = {1 * Months, 3 * Months, 6 * Months, 2 * Years,
+                                          3 * Years,  4 * Years,  5 * Years};
+    simMarketData->equityVolDecayMode() = "ConstantVariance";
+    simMarketData->setEquityVolDayCounters("", "ACT/ACT");
+    simMarketData->setSimulateEquityVols(false);
+
+    return simMarketData;
+}
+
+boost::shared_ptr<ore::data::CrossAssetModelData> TestConfigurationObjects::setupCrossAssetModelData5() {
+    ore::data::CalibrationType calibrationType = ore::data::CalibrationType::Bootstrap;
+    vector<string> swaptionExpiries = {"1Y", "2Y", "3Y", "5Y", "7Y", "10Y", "15Y", "20Y", "30Y"};
+    vector<string> swaptionTerms(swaptionExpiries.size(), "5Y");
+    vector<string> swaptionStrikes(swaptionExpiries.size(), "ATM");
+
+    // reversion and volatility of the LGM components
+    vector<pair<string, pair<Real, Real>>> lgmParameters = {{"EUR", {0.02, 0.008}},
+                                                            {"USD", {0.03, 0.009}},
+                                                            {"GBP", {0.04, 0.01}},
+                                                            {"CHF", {0.04, 0.01}},
+                                                            {"JPY", {0.04, 0.01}}};
+    vector<boost::shared_ptr<ore::data::IrLgmData>> irConfigs;
+    for (const auto& p : lgmParameters) {
+        irConfigs.push_back(boost::make_shared<ore::data::IrLgmData>(
+            p.first, calibrationType, ore::data::LgmData::ReversionType::HullWhite,
+            ore::data::LgmData::VolatilityType::Hagan, false, ore::data::ParamType::Constant, vector<Time>(),
+            vector<Real>(1, p.second.first), true, ore::data::ParamType::Piecewise, vector<Time>(),
+            vector<Real>(1, p.second.second), 0.0, 1.0, swaptionExpiries, swaptionTerms, swaptionStrikes));
+    }
+
+    vector<string> optionExpiries = {"1Y", "2Y", "3Y", "5Y", "7Y", "10Y"};
+    vector<string> optionStrikes(optionExpiries.size(), "ATMF");
+    vector<pair<string, Real>> fxSigmas = {{"USD", 0.15}, {"GBP", 0.20}, {"CHF", 0.20}, {"JPY", 0.20}};
+    vector<boost::shared_ptr<ore::data::FxBsData>> fxConfigs;
+    for (const auto& p : fxSigmas) {
+        fxConfigs.push_back(boost::make_shared<ore::data::FxBsData>(
+            p.first, "EUR", calibrationType, true, ore::data::ParamType::Piecewise, vector<Time>(),
+            vector<Real>(1, p.second), optionExpiries, optionStrikes));
+    }
+
+    std::map<pair<string, string>, Handle<Quote>> correlations;
+    correlations[std::make_pair("IR:EUR", "IR:USD")] = Handle<Quote>(boost::make_shared<SimpleQuote>(0.6));
+
+    return boost::make_shared<ore::data::CrossAssetModelData>(irConfigs, fxConfigs, correlations);
+}
+
 boost::shared_ptr<ore::analytics::SensitivityScenarioData> TestConfigurationObjects::setupSensitivityScenarioData2() {
     boost::shared_ptr<ore::analytics::SensitivityScenarioData> sensiData =
         boost::make_shared<ore::analytics::SensitivityScenarioData>();
@@ -19,6 +19,7 @@
 #include <boost/make_shared.hpp>
 #include <orea/scenario/scenariosimmarketparameters.hpp>
 #include <orea/scenario/sensitivityscenariodata.hpp>
+#include <ored/model/crossassetmodeldata.hpp>
 #include <ored/marketdata/marketimpl.hpp>
 #include <ored/utilities/indexparser.hpp>
 #include <ql/math/interpolations/flatextrapolation2d.hpp>
@@ -126,6 +127,10 @@ public:
     static boost::shared_ptr<ore::analytics::ScenarioSimMarketParameters> setupSimMarketData2();
     //! ScenarioSimMarketParameters instance, 5 currencies
     static boost::shared_ptr<ore::analytics::ScenarioSimMarketParameters> setupSimMarketData5();
+    //! ScenarioSimMarketParameters instance of the exposure simulation, 5 currencies, no volatilities simulated
+    static boost::shared_ptr<ore::analytics::ScenarioSimMarketParameters> setupExposureSimMarketData5();
+    //! CrossAssetModelData instance, 5 currencies
+    static boost::shared_ptr<ore::data::CrossAssetModelData> setupCrossAssetModelData5();
     //! SensitivityScenarioData instance, 2 currencies
     static boost::shared_ptr<ore::analytics::SensitivityScenarioData> setupSensitivityScenarioData2();
     //! SensitivityScenarioData instance, 5 currencies
@@ -0,0 +1,42 @@
+/*
+ Copyright (C) 2019 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file test/testvalues.hpp
+    \brief Deterministic values to fill cubes and scenarios in tests
+    \ingroup tests
+*/
+
+#pragma once
+
+#include <ql/types.hpp>
+
+#include <cmath>
+
+namespace testsuite {
+
+//! Deterministic value for the given indices, e.g. trade, date, sample and depth of a cube
+/*! The values differ for neighbouring indices and are not representable in single precision, so that a value that
+    is written to the wrong place or stored with reduced precision is detected.
+
+    \ingroup tests
+*/
+inline QuantLib::Real testValue(QuantLib::Size i, QuantLib::Size j, QuantLib::Size k, QuantLib::Size d) {
+    return std::sqrt(1.0 + i + 3.0 * j + 7.0 * k + 11.0 * d);
+}
+
+} // namespace testsuite
@@ -0,0 +1,204 @@
+/*
+ Copyright (C) 2019 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "testmarket.hpp"
+#include "testportfolio.hpp"
+#include <boost/test/unit_test.hpp>
+#include <orea/aggregation/postprocess.hpp>
+#include <orea/cube/cubemerge.hpp>
+#include <orea/cube/inmemorycube.hpp>
+#include <orea/engine/valuationcalculator.hpp>
+#include <orea/engine/valuationengine.hpp>
+#include <orea/scenario/aggregationscenariodata.hpp>
+#include <orea/scenario/crossassetmodelscenariogenerator.hpp>
+#include <orea/scenario/scenariosimmarket.hpp>
+#include <orea/scenario/scenariosimmarketparameters.hpp>
+#include <orea/scenario/simplescenariofactory.hpp>
+#include <ored/model/crossassetmodelbuilder.hpp>
+#include <ored/model/crossassetmodeldata.hpp>
+#include <ored/model/lgmdata.hpp>
+#include <ored/portfolio/builders/swap.hpp>
+#include <ored/portfolio/nettingsetmanager.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/utilities/dategrid.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <qle/methods/multipathgeneratorbase.hpp>
+#include <ql/time/date.hpp>
+#include <test/oreatoplevelfixture.hpp>
+
+using namespace std;
+using namespace QuantLib;
+using namespace QuantExt;
+using namespace ore::analytics;
+using namespace ore::data;
+using namespace boost::unit_test_framework;
+
+using testsuite::buildSwap;
+using testsuite::TestMarket;
+
+namespace {
+
+// a single currency simulation with a cube over two netting sets, as generated by the xva analytic of OREApp
+struct WhatIfSetup {
+    WhatIfSetup() : today(14, April, 2016), samples(50) {
+        Settings::instance().evaluationDate() = today;
+        market = boost::make_shared<TestMarket>(today);
+
+        parameters = boost::make_shared<ScenarioSimMarketParameters>();
+        parameters->baseCcy() = "EUR";
+        parameters->setDiscountCurveNames({"EUR"});
+        parameters->setYieldCurveTenors("", {1 * Months, 6 * Months, 1 * Years, 2 * Years, 5 * Years, 10 * Years,
+                                             20 * Years});
+        parameters->setIndices({"EUR-EURIBOR-6M"});
+        parameters->interpolation() = "LogLinear";
+        parameters->extrapolate() = true;
+        parameters->setYieldCurveDayCounters("", "ACT/ACT");
+        parameters->additionalScenarioDataIndices() = {"EUR-EURIBOR-6M"};
+        parameters->additionalScenarioDataCcys() = {"EUR"};
+
+        vector<string> expiries = {"1Y", "2Y", "3Y", "5Y", "7Y", "10Y", "15Y", "20Y", "30Y"};
+        vector<string> terms(expiries.size(), "5Y");
+        vector<string> strikes(expiries.size(), "ATM");
+        vector<boost::shared_ptr<IrLgmData>> irConfigs;
+        irConfigs.push_back(boost::make_shared<IrLgmData>(
+            "EUR", CalibrationType::Bootstrap, LgmData::ReversionType::HullWhite, LgmData::VolatilityType::Hagan, false,
+            ParamType::Constant, vector<Time>(), vector<Real>(1, 0.02), true, ParamType::Piecewise, vector<Time>(),
+            vector<Real>(1, 0.008), 0.0, 1.0, expiries, terms, strikes));
+        boost::shared_ptr<CrossAssetModelData> config = boost::make_shared<CrossAssetModelData>(
+            irConfigs, vector<boost::shared_ptr<FxBsData>>(), map<pair<string, string>, Handle<Quote>>());
+        boost::shared_ptr<CrossAssetModel> model = *CrossAssetModelBuilder(market, config).model();
+
+        grid = boost::make_shared<DateGrid>("10,1Y");
+        simMarket = boost::make_shared<ScenarioSimMarket>(market, parameters, Conventions());
+        boost::shared_ptr<MultiPathGeneratorBase> pathGen =
+            boost::make_shared<MultiPathGeneratorMersenneTwister>(model->stateProcess(), grid->timeGrid(), 42);
+        simMarket->scenarioGenerator() = boost::make_shared<CrossAssetModelScenarioGenerator>(
+            model, pathGen, boost::make_shared<SimpleScenarioFactory>(), parameters, today, grid, market);
+
+        boost::shared_ptr<EngineData> data = boost::make_shared<EngineData>();
+        data->model("Swap") = "DiscountedCashflows";
+        data->engine("Swap") = "DiscountingSwapEngine";
+        factory = boost::make_shared<EngineFactory>(data, simMarket);
+        factory->registerBuilder(boost::make_shared<SwapEngineBuilder>());
+
+        netting = boost::make_shared<NettingSetManager>();
+        netting->add(boost::make_shared<NettingSetDefinition>("NS_1", "dc"));
+        netting->add(boost::make_shared<NettingSetDefinition>("NS_2", "dc2"));
+    }
+
+    boost::shared_ptr<Trade> swap(const string& id, const string& counterparty, const string& nettingSet,
+                                  bool isPayer, Real rate) const {
+        boost::shared_ptr<Trade> trade = buildSwap(id, "EUR", isPayer, 1000000.0, 0, 10, rate, 0.0, "1Y", "30/360",
+                                                   "6M", "A360", "EUR-EURIBOR-6M");
+        trade->envelope() = Envelope(counterparty, nettingSet);
+        return trade;
+    }
+
+    boost::shared_ptr<NPVCube> buildCube(const boost::shared_ptr<Portfolio>& portfolio) const {
+        boost::shared_ptr<NPVCube> cube =
+            boost::make_shared<DoublePrecisionInMemoryCube>(today, portfolio->ids(), grid->dates(), samples);
+        vector<boost::shared_ptr<ValuationCalculator>> calculators;
+        calculators.push_back(boost::make_shared<NPVCalculator>("EUR"));
+        ValuationEngine engine(today, grid, simMarket);
+        engine.buildCube(portfolio, cube, calculators);
+        return cube;
+    }
+
+    boost::shared_ptr<PostProcess> postProcess(const boost::shared_ptr<Portfolio>& portfolio,
+                                               const boost::shared_ptr<NPVCube>& cube) const {
+        map<string, bool> analytics = {{"exposureProfiles", true}, {"cva", true}, {"dva", false},
+                                       {"fva", false},             {"colva", false}, {"collateralFloor", false},
+                                       {"exerciseNextBreak", false}};
+        return boost::make_shared<PostProcess>(portfolio, netting, market, Market::defaultConfiguration, cube,
+                                               scenarioData, analytics, "EUR", "None", 1.0, 0.95);
+    }
+
+    SavedSettings backup;
+    Date today;
+    Size samples;
+    boost::shared_ptr<Market> market;
+    boost::shared_ptr<ScenarioSimMarketParameters> parameters;
+    boost::shared_ptr<DateGrid> grid;
+    boost::shared_ptr<ScenarioSimMarket> simMarket;
+    boost::shared_ptr<EngineFactory> factory;
+    boost::shared_ptr<NettingSetManager> netting;
+    boost::shared_ptr<AggregationScenarioData> scenarioData;
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(WhatIfXvaTest)
+
+BOOST_AUTO_TEST_CASE(testExistingTradeAsWhatIf) {
+
+    BOOST_TEST_MESSAGE("Testing that an existing trade valued as a what-if trade leaves the XVA unchanged...");
+
+    WhatIfSetup setup;
+
+    // the cached cube and scenario data of the full portfolio
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    portfolio->add(setup.swap("Swap_1", "dc", "NS_1", true, 0.02));
+    portfolio->add(setup.swap("Swap_2", "dc", "NS_1", false, 0.01));
+    portfolio->add(setup.swap("Swap_3", "dc2", "NS_2", true, 0.03));
+    portfolio->build(setup.factory);
+    setup.scenarioData = boost::make_shared<InMemoryAggregationScenarioData>(setup.grid->size(), setup.samples);
+    setup.simMarket->aggregationScenarioData() = setup.scenarioData;
+    boost::shared_ptr<NPVCube> cube = setup.buildCube(portfolio);
+    boost::shared_ptr<PostProcess> base = setup.postProcess(portfolio, cube);
+
+    // the what-if run resets the scenario generator and values the what-if trades only, as OREApp::runWhatIfXVA()
+    boost::shared_ptr<Portfolio> whatIf = boost::make_shared<Portfolio>();
+    whatIf->add(setup.swap("Swap_1", "dc", "NS_1", true, 0.02));
+    whatIf->build(setup.factory);
+    setup.simMarket->scenarioGenerator()->reset();
+    setup.simMarket->aggregationScenarioData() = boost::shared_ptr<AggregationScenarioData>();
+    boost::shared_ptr<NPVCube> whatIfCube = setup.buildCube(whatIf);
+
+    // the regenerated paths reproduce the cached values of the trade
+    for (Size j = 0; j < setup.grid->size(); ++j)
+        for (Size k = 0; k < setup.samples; ++k)
+            BOOST_CHECK_SMALL(whatIfCube->get(0, j, k) - cube->get(0, j, k), 1E-6);
+    BOOST_CHECK_SMALL(whatIfCube->getT0(0) - cube->getT0(0), 1E-6);
+
+    // the affected netting set with the cached values of its other trades and the what-if values
+    boost::shared_ptr<Portfolio> affected = boost::make_shared<Portfolio>();
+    affected->add(portfolio->trades()[1]);
+    affected->add(whatIf->trades()[0]);
+    boost::shared_ptr<NPVCube> combined = boost::make_shared<DoublePrecisionInMemoryCube>(
+        setup.today, affected->ids(), setup.grid->dates(), setup.samples);
+    combineCubes({whatIfCube, cube}, combined);
+    boost::shared_ptr<PostProcess> whatIfPostProcess = setup.postProcess(affected, combined);
+
+    BOOST_REQUIRE(whatIfPostProcess->nettingSetIds().size() == 1);
+    BOOST_CHECK_EQUAL(whatIfPostProcess->nettingSetIds()[0], "NS_1");
+    Real cva = base->nettingSetCVA("NS_1");
+    BOOST_TEST_MESSAGE("base cva " << cva << " what-if cva " << whatIfPostProcess->nettingSetCVA("NS_1"));
+    BOOST_CHECK(cva > 0.0);
+    BOOST_CHECK_SMALL(whatIfPostProcess->nettingSetCVA("NS_1") - cva, 1E-6);
+    const vector<Real>& epe = base->netEPE("NS_1");
+    const vector<Real>& whatIfEpe = whatIfPostProcess->netEPE("NS_1");
+    BOOST_REQUIRE_EQUAL(whatIfEpe.size(), epe.size());
+    for (Size j = 0; j < epe.size(); ++j)
+        BOOST_CHECK_SMALL(whatIfEpe[j] - epe[j], 1E-6);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
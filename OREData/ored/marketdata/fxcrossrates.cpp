@@ -0,0 +1,158 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/marketdata/fxcrossrates.hpp>
+#include <ql/errors.hpp>
+
+#include <set>
+
+using namespace QuantLib;
+using std::string;
+using std::vector;
+
+namespace ore {
+namespace data {
+
+FXCrossRates::FXCrossRates(const std::map<string, Handle<Quote>>& quotes) : dirty_(true) {
+    std::set<string> ccys;
+    for (const auto& kv : quotes) {
+        QL_REQUIRE(kv.first.size() == 6, "FXCrossRates: invalid ccypair " << kv.first);
+        ccys.insert(kv.first.substr(0, 3));
+        ccys.insert(kv.first.substr(3));
+    }
+    currencies_.assign(ccys.begin(), ccys.end());
+    n_ = currencies_.size();
+    for (Size i = 0; i < n_; ++i)
+        index_[currencies_[i]] = i;
+
+    // adjacency lists holding the neighbour and the step, the direct quotes of a currency come first so that they
+    // are preferred over reverse quotes between the same two currencies
+    vector<vector<std::pair<Size, Size>>> direct(n_), reverse(n_);
+    for (const auto& kv : quotes) {
+        Size i = index_[kv.first.substr(0, 3)], j = index_[kv.first.substr(3)];
+        if (i == j)
+            continue;
+        Size q = quotes_.size();
+        quotes_.push_back(kv.second);
+        registerWith(kv.second);
+        direct[i].push_back(std::make_pair(j, 2 * q));
+        reverse[j].push_back(std::make_pair(i, 2 * q + 1));
+    }
+    for (Size i = 0; i < n_; ++i)
+        direct[i].insert(direct[i].end(), reverse[i].begin(), reverse[i].end());
+
+    // breadth first search from each currency
+    distance_.resize(n_ * n_, Null<Size>());
+    previous_.resize(n_ * n_, Null<Size>());
+    step_.resize(n_ * n_, Null<Size>());
+    order_.resize(n_);
+    for (Size s = 0; s < n_; ++s) {
+        Size* distance = &distance_[s * n_];
+        distance[s] = 0;
+        vector<Size>& order = order_[s];
+        // order serves as the queue of the search
+        for (Size k = 0, current = s;; current = order[k++]) {
+            for (const auto& edge : direct[current]) {
+                if (distance[edge.first] != Null<Size>())
+                    continue;
+                distance[edge.first] = distance[current] + 1;
+                previous_[s * n_ + edge.first] = current;
+                step_[s * n_ + edge.first] = edge.second;
+                order.push_back(edge.first);
+            }
+            if (k == order.size())
+                break;
+        }
+    }
+
+    values_.resize(quotes_.size());
+    rates_.resize(n_ * n_, Null<Real>());
+}
+
+Size FXCrossRates::index(const string& ccy) const {
+    auto it = index_.find(ccy);
+    QL_REQUIRE(it != index_.end(), "FXCrossRates: currency " << ccy << " not found");
+    return it->second;
+}
+
+Size FXCrossRates::pathLength(Size i, Size j) const {
+    QL_REQUIRE(connected(i, j),
+               "FXCrossRates: no conversion path from " << currencies_[i] << " to " << currencies_[j]);
+    return distance_[i * n_ + j];
+}
+
+bool FXCrossRates::isValid(Size i, Size j) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    checkRates();
+    return rates_[i * n_ + j] != Null<Real>();
+}
+
+Real FXCrossRates::rate(Size i, Size j) const {
+    Real r;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        checkRates();
+        r = rates_[i * n_ + j];
+    }
+    QL_REQUIRE(r != Null<Real>(), "FXCrossRates: no valid rate for " << currencies_[i] << currencies_[j]);
+    return r;
+}
+
+Real FXCrossRates::rate(const string& pair) const {
+    QL_REQUIRE(pair.size() == 6, "FXCrossRates: invalid ccypair " << pair);
+    return rate(index(pair.substr(0, 3)), index(pair.substr(3)));
+}
+
+vector<Real> FXCrossRates::rates() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    checkRates();
+    return rates_;
+}
+
+void FXCrossRates::update() {
+    dirty_ = true;
+    notifyObservers();
+}
+
+void FXCrossRates::checkRates() const {
+    if (dirty_.load(std::memory_order_acquire))
+        calculateRates();
+}
+
+void FXCrossRates::calculateRates() const {
+    for (Size q = 0; q < quotes_.size(); ++q)
+        values_[q] = !quotes_[q].empty() && quotes_[q]->isValid() ? quotes_[q]->value() : Null<Real>();
+    for (Size s = 0; s < n_; ++s) {
+        Real* rates = &rates_[s * n_];
+        rates[s] = 1.0;
+        // the previous currency comes first in order_, so its rate is known already
+        for (Size t : order_[s]) {
+            Real r = rates[previous_[s * n_ + t]];
+            Size step = step_[s * n_ + t];
+            Real v = values_[step / 2];
+            if (r == Null<Real>() || v == Null<Real>())
+                rates[t] = Null<Real>();
+            else
+                rates[t] = step % 2 == 0 ? r * v : r / v;
+        }
+    }
+    dirty_.store(false, std::memory_order_release);
+}
+
+} // namespace data
+} // namespace ore
@@ -0,0 +1,106 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file marketdata/fxcrossrates.hpp
+    \brief Matrix of fx cross rates between all currencies of a set of fx spot quotes
+    \ingroup marketdata
+*/
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <ql/handle.hpp>
+#include <ql/patterns/observable.hpp>
+#include <ql/quote.hpp>
+#include <ql/types.hpp>
+#include <ql/utilities/null.hpp>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace data {
+using QuantLib::Handle;
+using QuantLib::Quote;
+using QuantLib::Real;
+using QuantLib::Size;
+
+//! FX cross rate matrix
+/*! The currencies of the given fx spot quotes are the nodes of a graph, each quote is an edge between its two
+    currencies. On construction the shortest conversion path, i.e. the path with the least number of quotes, is
+    determined for each pair of connected currencies, with direct quotes taking precedence over reverse quotes.
+    Paths may have any number of steps.
+
+    The cross rates of all pairs are kept in a flat matrix. The matrix observes the quotes and is recomputed in
+    a single pass over all pairs on the first access after a quote changed: along the shortest path tree of each
+    currency each rate is the rate of the previous currency times one quote. The rates are recomputed and read
+    under a lock, so that they can be read from several threads.
+
+    \ingroup marketdata
+*/
+class FXCrossRates : public QuantLib::Observer, public QuantLib::Observable {
+public:
+    //! Build the graph from quotes keyed by currency pair, e.g. EURUSD for the number of USD per EUR
+    explicit FXCrossRates(const std::map<std::string, Handle<Quote>>& quotes);
+
+    //! The currencies of the graph in alphabetical order
+    const std::vector<std::string>& currencies() const { return currencies_; }
+    //! True if the currency is part of the graph
+    bool hasCurrency(const std::string& ccy) const { return index_.find(ccy) != index_.end(); }
+    //! Index of the currency in currencies(), throws if the currency is not part of the graph
+    Size index(const std::string& ccy) const;
+
+    //! True if there is a conversion path from currency i to currency j
+    bool connected(Size i, Size j) const { return distance_[i * n_ + j] != QuantLib::Null<Size>(); }
+    //! Number of quotes on the conversion path from currency i to currency j
+    Size pathLength(Size i, Size j) const;
+
+    //! True if currencies i and j are connected and all quotes on the path are valid
+    bool isValid(Size i, Size j) const;
+    //! Number of units of currency j per unit of currency i
+    Real rate(Size i, Size j) const;
+    //! Rate for a currency pair, e.g. USDJPY for the number of JPY per USD
+    Real rate(const std::string& pair) const;
+    //! A copy of the row major matrix of all rates, entries for pairs that are not valid are Null<Real>()
+    std::vector<Real> rates() const;
+
+    //! Marks the matrix for recomputation and notifies the observers
+    void update() override;
+
+private:
+    // recompute the rates if a quote changed, the caller must hold the lock
+    void checkRates() const;
+    void calculateRates() const;
+
+    Size n_;
+    std::vector<std::string> currencies_;
+    std::map<std::string, Size> index_;
+    std::vector<Handle<Quote>> quotes_;
+    // for each source currency s the reachable currencies ordered by distance, excluding s
+    std::vector<std::vector<Size>> order_;
+    // the number of quotes on the path from s to t and the last step of the path, i.e. the previous currency
+    // and the quote index times 2, plus 1 if the quote has to be inverted, stored at s * n + t
+    std::vector<Size> distance_, previous_, step_;
+    mutable std::vector<Real> values_, rates_;
+    mutable std::atomic<bool> dirty_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace data
+} // namespace ore
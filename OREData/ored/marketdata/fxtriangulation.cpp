@@ -19,7 +19,6 @@
 #include <boost/make_shared.hpp>
 #include <ored/marketdata/fxtriangulation.hpp>
 #include <ql/errors.hpp>
-#include <ql/quotes/compositequote.hpp>
 #include <ql/quotes/derivedquote.hpp>
 #include <ql/quotes/simplequote.hpp>
 
@@ -27,38 +26,79 @@ using namespace QuantLib;
 using std::string;
 
 namespace {
-// helper classes to enable the building
-// of composite cross-currency fx quotes
-class Triangulation {
-public:
-    Triangulation() {}
-    Real operator()(Real a, Real b) const { return a / b; }
-};
-
-class Product {
-public:
-    Product() {}
-    Real operator()(Real a, Real b) const { return a * b; }
-};
-
-class InverseProduct {
-public:
-    InverseProduct() {}
-    Real operator()(Real a, Real b) const { return 1.0 / (a * b); }
-};
-
 // Inverse a single quote
 class Inverse {
 public:
     Inverse() {}
     Real operator()(Real a) const { return 1.0 / a; }
 };
+
+// Quote reading a cross rate from the matrix
+class CrossRateQuote : public Quote, public Observer {
+public:
+    CrossRateQuote(const boost::shared_ptr<ore::data::FXCrossRates>& crossRates, Size i, Size j)
+        : crossRates_(crossRates), i_(i), j_(j) {
+        registerWith(crossRates_);
+    }
+    Real value() const { return crossRates_->rate(i_, j_); }
+    bool isValid() const { return crossRates_->isValid(i_, j_); }
+    void update() { notifyObservers(); }
+
+private:
+    boost::shared_ptr<ore::data::FXCrossRates> crossRates_;
+    Size i_, j_;
+};
 } // namespace
 
 namespace ore {
 namespace data {
 
+FXTriangulation::FXTriangulation(const FXTriangulation& other) {
+    std::lock_guard<std::mutex> lock(other.mutex_);
+    spots_ = other.spots_;
+    map_ = other.map_;
+    crossRates_ = other.crossRates_;
+}
+
+FXTriangulation& FXTriangulation::operator=(const FXTriangulation& other) {
+    if (this != &other) {
+        FXTriangulation tmp(other);
+        std::lock_guard<std::mutex> lock(mutex_);
+        spots_.swap(tmp.spots_);
+        map_.swap(tmp.map_);
+        crossRates_.swap(tmp.crossRates_);
+    }
+    return *this;
+}
+
+void FXTriangulation::addQuote(const string& pair, const Handle<Quote>& spot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    spots_[pair] = spot;
+    // the graph and the constructed quotes are rebuilt on request, so that all quotes in the map refer to the
+    // same cross rate matrix
+    map_ = spots_;
+    crossRates_.reset();
+}
+
+std::map<string, Handle<Quote>> FXTriangulation::quotes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return map_;
+}
+
+boost::shared_ptr<FXCrossRates> FXTriangulation::crossRates() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return crossRatesImpl();
+}
+
+boost::shared_ptr<FXCrossRates> FXTriangulation::crossRatesImpl() const {
+    if (crossRates_ == nullptr)
+        crossRates_ = boost::make_shared<FXCrossRates>(spots_);
+    return crossRates_;
+}
+
 Handle<Quote> FXTriangulation::getQuote(const string& pair) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
     // First, look for the pair in the map
     auto it = map_.find(pair);
     if (it != map_.end())
@@ -84,60 +124,16 @@ Handle<Quote> FXTriangulation::getQuote(const string& pair) const {
         return unity;
     }
 
-    // Now we search for a pair of quotes that we can combine to construct the quote required.
-    // We only search for a pair of quotes a single step apart.
-    //
-    // Suppose we want a USDJPY quote and we have EUR based data, there are 4 combinations to
-    // consider:
-    // EURUSD, EURJPY  => we want EURJPY / EURUSD [Triangulation]
-    // EURUSD, JPYEUR  => we want 1 / (EURUSD * JPYEUR) [InverseProduct]
-    // USDEUR, EURJPY  => we want USDEUR * EURJPY [Product]
-    // USDEUR, JPYEUR  => we want USDEUR / JPYEUR [Triangulation (but in the reverse order)]
-    //
-    // Loop over the map, look for domestic then use the map to find the other side of the pair.
-    for (const auto& kv : map_) {
-        string keyDomestic = kv.first.substr(0, 3);
-        string keyForeign = kv.first.substr(3);
-        const Handle<Quote>& q1 = kv.second;
-
-        if (domestic == keyDomestic) {
-            // we have domestic, now look for foreign/keyForeign
-            // USDEUR, JPYEUR  => we want USDEUR / JPYEUR [Triangulation (but in the reverse order)]
-            it = map_.find(foreign + keyForeign);
-            if (it != map_.end()) {
-                // Here q1 is USDEUR and it->second is JPYEUR
-                map_[pair] =
-                    Handle<Quote>(boost::make_shared<CompositeQuote<Triangulation>>(q1, it->second, Triangulation()));
-                return map_[pair];
-            }
-            // USDEUR, EURJPY  => we want USDEUR * EURJPY [Product]
-            it = map_.find(keyForeign + foreign);
-            if (it != map_.end()) {
-                map_[pair] = Handle<Quote>(boost::make_shared<CompositeQuote<Product>>(q1, it->second, Product()));
-                return map_[pair];
-            }
-        }
-
-        if (domestic == keyForeign) {
-            // EURUSD, JPYEUR  => we want 1 / (EURUSD * JPYEUR) [InverseProduct]
-            it = map_.find(foreign + keyDomestic);
-            if (it != map_.end()) {
-                map_[pair] =
-                    Handle<Quote>(boost::make_shared<CompositeQuote<InverseProduct>>(q1, it->second, InverseProduct()));
-                return map_[pair];
-            }
-            // EURUSD, EURJPY  => we want EURJPY / EURUSD [Triangulation]
-            it = map_.find(keyDomestic + foreign);
-            if (it != map_.end()) {
-                // Here q1 is EURUSD and it->second is EURJPY
-                map_[pair] =
-                    Handle<Quote>(boost::make_shared<CompositeQuote<Triangulation>>(it->second, q1, Triangulation()));
-                return map_[pair];
-            }
-        }
-    }
-
-    QL_FAIL("Unable to build FXQuote for ccy pair " << pair);
+    // Now we look for a conversion path in the graph of all quotes, e.g. if we want a USDJPY quote and we
+    // have EURUSD and EURJPY the path is USD -> EUR -> JPY and the cross rate is EURJPY / EURUSD.
+    boost::shared_ptr<FXCrossRates> crossRates = crossRatesImpl();
+    QL_REQUIRE(crossRates->hasCurrency(domestic) && crossRates->hasCurrency(foreign) &&
+                   crossRates->connected(crossRates->index(domestic), crossRates->index(foreign)),
+               "Unable to build FXQuote for ccy pair " << pair);
+    Handle<Quote> crossQuote(
+        boost::make_shared<CrossRateQuote>(crossRates, crossRates->index(domestic), crossRates->index(foreign)));
+    map_[pair] = crossQuote;
+    return crossQuote;
 }
 } // namespace data
 } // namespace ore
@@ -23,7 +23,10 @@
 
 #pragma once
 
+#include <boost/shared_ptr.hpp>
 #include <map>
+#include <mutex>
+#include <ored/marketdata/fxcrossrates.hpp>
 #include <ql/handle.hpp>
 #include <ql/quote.hpp>
 #include <ql/types.hpp>
@@ -40,14 +43,18 @@ using QuantLib::Quote;
  *  If the repository is asked for the FX spot price for a given pair it will attempt the following:
  *  1) Look in the map for the pair
  *  2) Look for the reverse quote (EURUSD -> USDEUR), if found it will return an inverse quote.
- *  3) Look through the map and attempt to find a bridging pair (e.g EURUSD and EURJPY for USDJPY)
- *     and return the required composite quote.
+ *  3) Look up the pair in the FXCrossRates matrix built from all added quotes. This finds a conversion
+ *     path with the least number of quotes, possibly over several bridging currencies (e.g. EURUSD,
+ *     EURAUD and AUDNZD for USDNZD), and returns a quote reading the cross rate from the matrix.
  *
  *  In cases (2) and (3) the constructed quote is then stored in the map so subsequent calls will hit (1).
  *
  *  The constructed quotes all reference the original quotes which are added by the addQuote() method
  *  and so if these original quotes change in the future, the constructed quotes will reflect the new
- *  value
+ *  value. The cross rate matrix is recomputed once after the original quotes changed, the constructed
+ *  quotes do not form chains of derived quotes.
+ *
+ *  getQuote(), quotes() and crossRates() can be called from several threads.
  *
  *  \ingroup marketdata
  */
@@ -55,18 +62,30 @@ class FXTriangulation {
 public:
     //! Default ctor, once built the repo is empty
     FXTriangulation() {}
+    FXTriangulation(const FXTriangulation& other);
+    FXTriangulation& operator=(const FXTriangulation& other);
 
     //! Add a quote to the repo
-    void addQuote(const std::string& pair, const Handle<Quote>& spot) { map_[pair] = spot; }
+    void addQuote(const std::string& pair, const Handle<Quote>& spot);
 
     //! Get a quote from the repo, this will follow the algorithm described above
     Handle<Quote> getQuote(const std::string&) const;
 
-    //! Get all quotes currently stored in the triangulation
-    const std::map<std::string, Handle<Quote>>& quotes() const { return map_; }
+    //! Get a copy of all quotes currently stored in the triangulation
+    std::map<std::string, Handle<Quote>> quotes() const;
+
+    //! Get the cross rate matrix of all quotes added to the repo
+    boost::shared_ptr<FXCrossRates> crossRates() const;
 
 private:
+    boost::shared_ptr<FXCrossRates> crossRatesImpl() const;
+
+    // the added quotes
+    std::map<std::string, Handle<Quote>> spots_;
+    // the added and the constructed quotes
     mutable std::map<std::string, Handle<Quote>> map_;
+    mutable boost::shared_ptr<FXCrossRates> crossRates_;
+    mutable std::mutex mutex_;
 };
 } // namespace data
 } // namespace ore
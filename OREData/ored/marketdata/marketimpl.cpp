@@ -171,6 +171,14 @@ Handle<Quote> MarketImpl::fxSpot(const string& ccypair, const string& configurat
     return it->second.getQuote(ccypair); // will throw if not found
 }
 
+boost::shared_ptr<FXCrossRates> MarketImpl::fxCrossRates(const string& configuration) const {
+    auto it = fxSpots_.find(configuration);
+    if (it == fxSpots_.end())
+        it = fxSpots_.find(Market::defaultConfiguration);
+    QL_REQUIRE(it != fxSpots_.end(), "did not find fx spots under configuration " << configuration);
+    return it->second.crossRates();
+}
+
 Handle<BlackVolTermStructure> MarketImpl::fxVol(const string& ccypair, const string& configuration) const {
     auto it = fxVols_.find(make_pair(configuration, ccypair));
     if (it != fxVols_.end())
@@ -431,6 +439,8 @@ void MarketImpl::refresh(const string& configuration) {
     // update fx spot quotes
     auto fxSpots = fxSpots_.find(configuration);
     if (fxSpots != fxSpots_.end()) {
+        // the cross rates first, the constructed quotes read from them
+        fxSpots->second.crossRates()->update();
         for (auto& x : fxSpots->second.quotes()) {
             auto dq = boost::dynamic_pointer_cast<Observer>(*x.second);
             if (dq != nullptr)
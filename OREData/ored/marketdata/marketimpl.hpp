@@ -88,6 +88,8 @@ public:
 
     //! FX
     Handle<Quote> fxSpot(const string& ccypair, const string& configuration = Market::defaultConfiguration) const;
+    //! Cross rates between all currencies with fx spot quotes, not part of the Market interface
+    boost::shared_ptr<FXCrossRates> fxCrossRates(const string& configuration = Market::defaultConfiguration) const;
     Handle<BlackVolTermStructure> fxVol(const string& ccypair,
                                         const string& configuration = Market::defaultConfiguration) const;
 
@@ -45,6 +45,7 @@
 #include <ored/marketdata/yieldvolcurve.hpp>
 #include <ored/utilities/indexparser.hpp>
 #include <ored/utilities/log.hpp>
+#include <ored/utilities/profiler.hpp>
 #include <qle/indexes/equityindex.hpp>
 #include <qle/indexes/inflationindexwrapper.hpp>
 #include <qle/termstructures/blackvolsurfacewithatm.hpp>
@@ -142,6 +143,7 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
             LOG("Loading spec " << *spec);
 
             try {
+                ORE_PROFILE_SCOPE("TodaysMarket", spec->name());
                 switch (spec->baseType()) {
 
                 case CurveSpec::CurveType::Yield: {
@@ -44,6 +44,7 @@
 #include <ored/marketdata/expiry.hpp>
 #include <ored/marketdata/fittedbondcurvehelpermarket.hpp>
 #include <ored/marketdata/fixings.hpp>
+#include <ored/marketdata/fxcrossrates.hpp>
 #include <ored/marketdata/fxspot.hpp>
 #include <ored/marketdata/fxtriangulation.hpp>
 #include <ored/marketdata/fxvolcurve.hpp>
@@ -147,6 +148,7 @@
 #include <ored/report/inmemoryreport.hpp>
 #include <ored/report/report.hpp>
 #include <ored/utilities/calendaradjustmentconfig.hpp>
+#include <ored/utilities/calendarcache.hpp>
 #include <ored/utilities/conventionsbasedfutureexpiry.hpp>
 #include <ored/utilities/correlationmatrix.hpp>
 #include <ored/utilities/csvfilereader.hpp>
@@ -158,6 +160,7 @@
 #include <ored/utilities/marketdata.hpp>
 #include <ored/utilities/osutils.hpp>
 #include <ored/utilities/parsers.hpp>
+#include <ored/utilities/profiler.hpp>
 #include <ored/utilities/progressbar.hpp>
 #include <ored/utilities/serializationdate.hpp>
 #include <ored/utilities/serializationdaycounter.hpp>
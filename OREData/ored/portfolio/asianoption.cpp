@@ -16,6 +16,7 @@
 #include <ql/instruments/asianoption.hpp>
 #include <ql/instruments/averagetype.hpp>
 #include <ql/errors.hpp>
+#include <qle/calendars/cachedcalendar.hpp>
 
 namespace ore {
 namespace data {
@@ -72,7 +73,7 @@ void AsianOptionTrade::build(const boost::shared_ptr<EngineFactory>& engineFacto
             if (opd->rulesBased()) {
                 const Calendar& cal = opd->calendar();
                 QL_REQUIRE(cal != Calendar(), "Need non-empty calendar for rules based payment date.");
-                paymentDate = cal.advance(expiryDate_, opd->lag(), Days, opd->convention());
+                paymentDate = QuantExt::cachedAdvance(cal, expiryDate_, opd->lag(), Days, opd->convention());
             } else {
                 const vector<Date>& dates = opd->dates();
                 QL_REQUIRE(dates.size() == 1, "Need exactly one payment date for cash settled European option.");
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <ored/portfolio/enginefactory.hpp>
+#include <ored/utilities/profiler.hpp>
 
 #include <ql/cashflows/couponpricer.hpp>
 #include <ql/cashflows/inflationcouponpricer.hpp>
@@ -63,6 +64,7 @@ public:
         T key = keyImpl(params...);
         if (engines_.find(key) == engines_.end()) {
             // build first (in case it throws)
+            ORE_PROFILE_SCOPE("EngineBuilder", model_ + "/" + engine_);
             boost::shared_ptr<U> engine = engineImpl(params...);
             // then add to map
             engines_[key] = engine;
@@ -22,6 +22,7 @@
 #include <ored/portfolio/swap.hpp>
 #include <ored/portfolio/swaption.hpp>
 #include <ored/utilities/log.hpp>
+#include <ored/utilities/profiler.hpp>
 #include <ored/utilities/xmlutils.hpp>
 #include <ql/errors.hpp>
 #include <ql/time/date.hpp>
@@ -127,6 +128,7 @@ void Portfolio::build(const boost::shared_ptr<EngineFactory>& engineFactory) {
     auto trade = trades_.begin();
     while (trade != trades_.end()) {
         try {
+            ORE_PROFILE_SCOPE("TradeBuild", (*trade)->tradeType());
             (*trade)->build(engineFactory);
             TLOG("Required Fixings for trade " << (*trade)->id() << ":");
             TLOGGERSTREAM << (*trade)->requiredFixings();
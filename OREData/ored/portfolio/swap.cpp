@@ -27,6 +27,7 @@
 #include <ql/cashflows/simplecashflow.hpp>
 
 #include <ql/time/calendars/target.hpp>
+#include <qle/calendars/cachedcalendar.hpp>
 #include <qle/cashflows/floatingratefxlinkednotionalcoupon.hpp>
 #include <qle/indexes/fxindex.hpp>
 #include <qle/instruments/currencyswap.hpp>
@@ -108,8 +109,9 @@ void Swap::build(const boost::shared_ptr<EngineFactory>& engineFactory) {
                 boost::shared_ptr<FloatingRateCoupon> coupon =
                     boost::dynamic_pointer_cast<FloatingRateCoupon>(legs_[i][j]);
 
-                Date fixingDate = fxIndex->fixingCalendar().advance(coupon->accrualStartDate(),
-                                                                    -static_cast<Integer>(fxIndex->fixingDays()), Days);
+                Date fixingDate =
+                    QuantExt::cachedAdvance(fxIndex->fixingCalendar(), coupon->accrualStartDate(),
+                                            -static_cast<Integer>(fxIndex->fixingDays()), Days);
                 boost::shared_ptr<FloatingRateFXLinkedNotionalCoupon> fxLinkedCoupon =
                     boost::make_shared<FloatingRateFXLinkedNotionalCoupon>(fixingDate, legData_[i].foreignAmount(),
                                                                            fxIndex, coupon);
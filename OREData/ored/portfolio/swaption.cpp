@@ -24,6 +24,7 @@
 #include <ql/instruments/swaption.hpp>
 #include <ql/time/daycounters/actualactual.hpp>
 
+#include <qle/calendars/cachedcalendar.hpp>
 #include <qle/instruments/rebatedexercise.hpp>
 
 #include <ored/portfolio/builders/swap.hpp>
@@ -72,7 +73,8 @@ void Swaption::build(const boost::shared_ptr<EngineFactory>& engineFactory) {
         option_.noticeConvention().empty() ? Unadjusted : parseBusinessDayConvention(option_.noticeConvention());
     std::vector<Date> exerciseDates(option_.exerciseDates().size());
     for (Size i = 0; i < option_.exerciseDates().size(); ++i) {
-        exerciseDates.push_back(noticeCal.advance(parseDate(option_.exerciseDates()[i]), -noticePeriod, noticeBdc));
+        exerciseDates.push_back(
+            QuantExt::cachedAdvance(noticeCal, parseDate(option_.exerciseDates()[i]), -noticePeriod, noticeBdc));
     }
 
     Date latestExerciseDate = *std::max_element(exerciseDates.begin(), exerciseDates.end());
@@ -144,7 +146,8 @@ void Swaption::buildEuropean(const boost::shared_ptr<EngineFactory>& engineFacto
     Calendar noticeCal = option_.noticeCalendar().empty() ? NullCalendar() : parseCalendar(option_.noticeCalendar());
     BusinessDayConvention noticeBdc =
         option_.noticeConvention().empty() ? Unadjusted : parseBusinessDayConvention(option_.noticeConvention());
-    Date exDate = noticeCal.advance(parseDate(option_.exerciseDates().front()), -noticePeriod, noticeBdc);
+    Date exDate =
+        QuantExt::cachedAdvance(noticeCal, parseDate(option_.exerciseDates().front()), -noticePeriod, noticeBdc);
     QL_REQUIRE(exDate >= Settings::instance().evaluationDate(), "Exercise date expected in the future.");
 
     boost::shared_ptr<VanillaSwap> swap = buildVanillaSwap(engineFactory, exDate);
@@ -255,7 +258,7 @@ void Swaption::buildBermudan(const boost::shared_ptr<EngineFactory>& engineFacto
     std::vector<QuantLib::Date> noticeDates, exerciseDates;
     std::vector<bool> isExerciseDateAlive(sortedExerciseDates.size(), false);
     for (Size i = 0; i < sortedExerciseDates.size(); i++) {
-        Date noticeDate = noticeCal.advance(sortedExerciseDates[i], -noticePeriod, noticeBdc);
+        Date noticeDate = QuantExt::cachedAdvance(noticeCal, sortedExerciseDates[i], -noticePeriod, noticeBdc);
         if (noticeDate > Settings::instance().evaluationDate() && noticeDate <= lastAccrualStartDate) {
             isExerciseDateAlive[i] = true;
             noticeDates.push_back(noticeDate);
@@ -12,6 +12,7 @@
 #include <ored/portfolio/vanillaoption.hpp>
 #include <ored/utilities/log.hpp>
 #include <ql/instruments/vanillaoption.hpp>
+#include <qle/calendars/cachedcalendar.hpp>
 #include <qle/instruments/cashsettledeuropeanoption.hpp>
 
 using namespace QuantLib;
@@ -68,7 +69,7 @@ void VanillaOptionTrade::build(const boost::shared_ptr<ore::data::EngineFactory>
             if (opd->rulesBased()) {
                 const Calendar& cal = opd->calendar();
                 QL_REQUIRE(cal != Calendar(), "Need a non-empty calendar for rules based payment date.");
-                paymentDate = cal.advance(expiryDate_, opd->lag(), Days, opd->convention());
+                paymentDate = QuantExt::cachedAdvance(cal, expiryDate_, opd->lag(), Days, opd->convention());
             } else {
                 const vector<Date>& dates = opd->dates();
                 QL_REQUIRE(dates.size() == 1, "Need exactly one payment date for cash settled European option.");
@@ -25,6 +25,7 @@
 
 #include <ored/report/report.hpp>
 #include <stdio.h>
+#include <string>
 #include <vector>
 
 namespace ore {
@@ -33,6 +34,9 @@ namespace data {
 class ReportTypePrinter;
 /*! CSV Report class
 
+    The formatted lines are collected in a local buffer which is written to the file in large blocks, numbers are
+    formatted by a local integer based routine rather than by fprintf.
+
 \ingroup report
 */
 class CSVFileReport : public Report {
@@ -56,6 +60,8 @@ public:
     void flush() override;
 
 private:
+    void writeBuffer();
+
     std::vector<ReportType> columnTypes_;
     std::vector<ReportTypePrinter> printers_;
     std::string filename_;
@@ -65,6 +71,7 @@ private:
     std::string nullString_;
     Size i_;
     FILE* fp_;
+    std::string buffer_;
 };
 } // namespace data
 } // namespace ore
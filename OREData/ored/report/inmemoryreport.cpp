@@ -0,0 +1,245 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/variant/static_visitor.hpp>
+#include <algorithm>
+#include <ored/report/inmemoryreport.hpp>
+
+namespace ore {
+namespace data {
+
+namespace {
+// indices of the types in Report::ReportType
+const int sizeType = 0;
+const int realType = 1;
+const int stringType = 2;
+const int dateType = 3;
+const int periodType = 4;
+} // namespace
+
+// Local class appending a single value to the typed buffer of a column
+class InMemoryReport::ColumnAppender : public boost::static_visitor<> {
+public:
+    ColumnAppender(Column& c) : c_(c) {}
+    void operator()(const Size i) const { c_.sizes.push_back(i); }
+    void operator()(const Real d) const { c_.reals.push_back(d); }
+    void operator()(const string& s) const { c_.codes.push_back(c_.code(s)); }
+    void operator()(const Date& d) const { c_.dates.push_back(d); }
+    void operator()(const Period& p) const { c_.periods.push_back(p); }
+
+private:
+    Column& c_;
+};
+
+Size InMemoryReport::Column::code(const string& s) {
+    std::unordered_map<string, Size>::const_iterator it = lookup.find(s);
+    if (it != lookup.end())
+        return it->second;
+    Size c = dictionary.size();
+    dictionary.push_back(s);
+    lookup[s] = c;
+    return c;
+}
+
+Report& InMemoryReport::addColumn(const string& name, const ReportType& rt, Size precision) {
+    QL_REQUIRE(data_.empty() || data_.front().size == 0, "Cannot add column " << name << " after rows were added");
+    headers_.push_back(name);
+    columnTypes_.push_back(rt);
+    columnPrecision_.push_back(precision);
+    data_.push_back(Column(rt.which()));
+    i_++;
+    return *this;
+}
+
+Report& InMemoryReport::next() {
+    QL_REQUIRE(i_ == headers_.size(), "Cannot go to next line, only " << i_ << " entires filled");
+    checkRowsComplete();
+    i_ = 0;
+    return *this;
+}
+
+Report& InMemoryReport::add(const ReportType& rt) {
+    // check type is valid
+    QL_REQUIRE(i_ < headers_.size(), "No column to add [" << rt << "] to.");
+    Column& c = data_[i_];
+    QL_REQUIRE(rt.which() == c.type, "Cannot add value " << rt << " of type " << rt.which() << " to column "
+                                                         << headers_[i_] << " of type " << c.type);
+    boost::apply_visitor(ColumnAppender(c), rt);
+    ++c.size;
+    i_++;
+    return *this;
+}
+
+void InMemoryReport::end() {
+    // an incomplete last line is tolerated, rows() only counts the rows present in all columns
+}
+
+InMemoryReport::Column& InMemoryReport::column(Size i, int type) {
+    QL_REQUIRE(i < data_.size(), "Column index " << i << " out of range, report has " << data_.size() << " columns");
+    QL_REQUIRE(data_[i].type == type,
+               "Column " << headers_[i] << " has type " << data_[i].type << ", requested type " << type);
+    return data_[i];
+}
+
+const InMemoryReport::Column& InMemoryReport::column(Size i, int type) const {
+    QL_REQUIRE(i < data_.size(), "Column index " << i << " out of range, report has " << data_.size() << " columns");
+    QL_REQUIRE(data_[i].type == type,
+               "Column " << headers_[i] << " has type " << data_[i].type << ", requested type " << type);
+    return data_[i];
+}
+
+void InMemoryReport::checkRowsComplete() const {
+    for (Size i = 1; i < data_.size(); ++i) {
+        QL_REQUIRE(data_[i].size == data_[0].size, "Column " << headers_[i] << " has " << data_[i].size
+                                                              << " entries, expected " << data_[0].size);
+    }
+}
+
+InMemoryReport& InMemoryReport::append(Size i, const vector<Size>& values) {
+    QL_REQUIRE(i_ == headers_.size(), "Cannot append to column " << i << " while a line is being filled");
+    Column& c = column(i, sizeType);
+    c.sizes.insert(c.sizes.end(), values.begin(), values.end());
+    c.size += values.size();
+    return *this;
+}
+
+InMemoryReport& InMemoryReport::append(Size i, const vector<Real>& values) {
+    QL_REQUIRE(i_ == headers_.size(), "Cannot append to column " << i << " while a line is being filled");
+    Column& c = column(i, realType);
+    c.reals.insert(c.reals.end(), values.begin(), values.end());
+    c.size += values.size();
+    return *this;
+}
+
+InMemoryReport& InMemoryReport::append(Size i, const vector<string>& values) {
+    QL_REQUIRE(i_ == headers_.size(), "Cannot append to column " << i << " while a line is being filled");
+    Column& c = column(i, stringType);
+    c.codes.reserve(c.codes.size() + values.size());
+    for (Size k = 0; k < values.size(); ++k)
+        c.codes.push_back(c.code(values[k]));
+    c.size += values.size();
+    return *this;
+}
+
+InMemoryReport& InMemoryReport::append(Size i, const vector<Date>& values) {
+    QL_REQUIRE(i_ == headers_.size(), "Cannot append to column " << i << " while a line is being filled");
+    Column& c = column(i, dateType);
+    c.dates.insert(c.dates.end(), values.begin(), values.end());
+    c.size += values.size();
+    return *this;
+}
+
+InMemoryReport& InMemoryReport::append(Size i, const vector<Period>& values) {
+    QL_REQUIRE(i_ == headers_.size(), "Cannot append to column " << i << " while a line is being filled");
+    Column& c = column(i, periodType);
+    c.periods.insert(c.periods.end(), values.begin(), values.end());
+    c.size += values.size();
+    return *this;
+}
+
+void InMemoryReport::reserve(Size n) {
+    for (Size i = 0; i < data_.size(); ++i) {
+        Column& c = data_[i];
+        switch (c.type) {
+        case sizeType:
+            c.sizes.reserve(n);
+            break;
+        case realType:
+            c.reals.reserve(n);
+            break;
+        case stringType:
+            c.codes.reserve(n);
+            break;
+        case dateType:
+            c.dates.reserve(n);
+            break;
+        case periodType:
+            c.periods.reserve(n);
+            break;
+        default:
+            QL_FAIL("Unexpected column type " << c.type);
+        }
+    }
+}
+
+Size InMemoryReport::rows() const {
+    if (data_.empty())
+        return 0;
+    // the last line might still be filled, only count the rows present in all columns
+    Size n = data_[0].size;
+    for (Size i = 1; i < data_.size(); ++i)
+        n = std::min(n, data_[i].size);
+    return n;
+}
+
+Report::ReportType InMemoryReport::value(Size row, Size i) const {
+    QL_REQUIRE(i < data_.size(), "Column index " << i << " out of range, report has " << data_.size() << " columns");
+    const Column& c = data_[i];
+    QL_REQUIRE(row < c.size, "Row index " << row << " out of range, column " << headers_[i] << " has " << c.size
+                                          << " entries");
+    switch (c.type) {
+    case sizeType:
+        return c.sizes[row];
+    case realType:
+        return c.reals[row];
+    case stringType:
+        return c.dictionary[c.codes[row]];
+    case dateType:
+        return c.dates[row];
+    case periodType:
+        return c.periods[row];
+    default:
+        QL_FAIL("Unexpected column type " << c.type);
+    }
+}
+
+vector<Report::ReportType> InMemoryReport::data(Size i) const {
+    QL_REQUIRE(i < data_.size(), "Column index " << i << " out of range, report has " << data_.size() << " columns");
+    vector<ReportType> result;
+    result.reserve(data_[i].size);
+    for (Size row = 0; row < data_[i].size; ++row)
+        result.push_back(value(row, i));
+    return result;
+}
+
+const vector<Size>& InMemoryReport::sizeData(Size i) const { return column(i, sizeType).sizes; }
+
+const vector<Real>& InMemoryReport::realData(Size i) const { return column(i, realType).reals; }
+
+const vector<Size>& InMemoryReport::stringCodes(Size i) const { return column(i, stringType).codes; }
+
+const vector<string>& InMemoryReport::stringDictionary(Size i) const { return column(i, stringType).dictionary; }
+
+const vector<Date>& InMemoryReport::dateData(Size i) const { return column(i, dateType).dates; }
+
+const vector<Period>& InMemoryReport::periodData(Size i) const { return column(i, periodType).periods; }
+
+void InMemoryReport::write(Report& report) const {
+    for (Size i = 0; i < headers_.size(); ++i)
+        report.addColumn(headers_[i], columnTypes_[i], columnPrecision_[i]);
+    Size n = rows();
+    for (Size row = 0; row < n; ++row) {
+        report.next();
+        for (Size i = 0; i < data_.size(); ++i)
+            report.add(value(row, i));
+    }
+    report.end();
+}
+
+} // namespace data
+} // namespace ore
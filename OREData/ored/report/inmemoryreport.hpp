@@ -25,6 +25,7 @@
 
 #include <ored/report/report.hpp>
 #include <ql/errors.hpp>
+#include <unordered_map>
 #include <vector>
 
 namespace ore {
@@ -34,55 +35,89 @@ using std::vector;
 
 /*! InMemoryReport just stores report information in local vectors and provides an interface to access
  *  the values. It could be used as a backend to a GUI
+ *
+ *  The data is stored column by column in contiguous typed buffers, i.e. a Real column is a vector<Real>,
+ *  a Size column a vector<Size> and so on. String columns are dictionary encoded, each distinct string is
+ *  stored once and the column holds the index into the dictionary. Besides the row by row Report interface
+ *  there are bulk append methods that add a block of values to a single column. Once all columns have
+ *  received the same number of values, the rows are complete.
  \ingroup report
  */
 class InMemoryReport : public Report {
 public:
     InMemoryReport() : i_(0) {}
 
-    Report& addColumn(const string& name, const ReportType& rt, Size precision = 0) {
-        headers_.push_back(name);
-        columnTypes_.push_back(rt);
-        columnPrecision_.push_back(precision);
-        data_.push_back(vector<ReportType>()); // Initalise vector for
-        i_++;
-        return *this;
-    }
-
-    Report& next() {
-        QL_REQUIRE(i_ == headers_.size(), "Cannot go to next line, only " << i_ << " entires filled");
-        i_ = 0;
-        return *this;
-    }
-
-    Report& add(const ReportType& rt) {
-        // check type is valid
-        QL_REQUIRE(i_ < headers_.size(), "No column to add [" << rt << "] to.");
-        QL_REQUIRE(rt.which() == columnTypes_[i_].which(),
-                   "Cannot add value " << rt << " of type " << rt.which() << " to column " << headers_[i_]
-                                       << " of type " << columnTypes_[i_].which());
-
-        data_[i_].push_back(rt);
-        i_++;
-        return *this;
-    }
-
-    void end() {}
+    Report& addColumn(const string& name, const ReportType& rt, Size precision = 0) override;
+    Report& next() override;
+    Report& add(const ReportType& rt) override;
+    void end() override;
+
+    //! \name Bulk row append
+    //@{
+    /*! Append a block of values to column \p i. The column type must match the type of the values. The
+        rows are complete once all columns have received the same number of values, only then next() or
+        add() may be called again. end() accepts incomplete rows, they are not counted by rows(). */
+    InMemoryReport& append(Size i, const vector<Size>& values);
+    InMemoryReport& append(Size i, const vector<Real>& values);
+    InMemoryReport& append(Size i, const vector<string>& values);
+    InMemoryReport& append(Size i, const vector<Date>& values);
+    InMemoryReport& append(Size i, const vector<Period>& values);
+    //! Reserve capacity for \p n rows in each column
+    void reserve(Size n);
+    //@}
 
     // InMemoryInterface
     Size columns() const { return headers_.size(); }
+    //! Number of complete rows
+    Size rows() const;
     const string& header(Size i) const { return headers_[i]; }
     ReportType columnType(Size i) const { return columnTypes_[i]; }
     Size columnPrecision(Size i) const { return columnPrecision_[i]; }
-    //! Returns the data
-    const vector<ReportType>& data(Size i) const { return data_[i]; }
+    //! Returns the value in row \p row of column \p i
+    ReportType value(Size row, Size i) const;
+    //! Returns the data of column \p i, this copies the column into a vector of variants
+    vector<ReportType> data(Size i) const;
+
+    //! \name Typed column access
+    //@{
+    const vector<Size>& sizeData(Size i) const;
+    const vector<Real>& realData(Size i) const;
+    //! Indices into stringDictionary(i), one per row
+    const vector<Size>& stringCodes(Size i) const;
+    const vector<string>& stringDictionary(Size i) const;
+    const vector<Date>& dateData(Size i) const;
+    const vector<Period>& periodData(Size i) const;
+    //@}
+
+    //! Writes the stored headers and rows to another report, e.g. a CSVFileReport
+    void write(Report& report) const;
 
 private:
+    //! Typed storage for one column, only the buffer matching the column type is used
+    struct Column {
+        Column(int type) : type(type), size(0) {}
+        int type;
+        Size size;
+        vector<Size> sizes;
+        vector<Real> reals;
+        vector<Size> codes;
+        vector<string> dictionary;
+        std::unordered_map<string, Size> lookup;
+        vector<Date> dates;
+        vector<Period> periods;
+        Size code(const string& s);
+    };
+    class ColumnAppender;
+
+    Column& column(Size i, int type);
+    const Column& column(Size i, int type) const;
+    void checkRowsComplete() const;
+
     Size i_;
     vector<string> headers_;
     vector<ReportType> columnTypes_;
     vector<Size> columnPrecision_;
-    vector<vector<ReportType>> data_;
+    vector<Column> data_;
 };
 } // namespace data
 } // namespace ore
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <map>
+#include <ored/utilities/calendarcache.hpp>
 #include <ored/utilities/xmlutils.hpp>
 #include <ql/patterns/singleton.hpp>
 #include <ql/time/calendar.hpp>
@@ -80,8 +81,11 @@ public:
     //! get the global config
     const CalendarAdjustmentConfig& config() const { return config_; }
 
-    //! set the global config
-    void setConfig(const CalendarAdjustmentConfig& c) { config_ = c; }
+    //! set the global config, this clears the calendar cache
+    void setConfig(const CalendarAdjustmentConfig& c) {
+        config_ = c;
+        CalendarCache::instance().clear();
+    }
 
 private:
     CalendarAdjustmentConfig config_;
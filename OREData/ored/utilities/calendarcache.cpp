@@ -0,0 +1,88 @@
+/*
+ Copyright (C) 2019 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/utilities/calendarcache.hpp>
+#include <ql/errors.hpp>
+#include <qle/calendars/cachedcalendar.hpp>
+
+using namespace QuantLib;
+
+namespace ore {
+namespace data {
+
+bool CalendarCache::get(const std::string& name, bool adjusted, Calendar& calendar) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = calendars_.find(std::make_pair(name, adjusted));
+    if (it == calendars_.end())
+        return false;
+    calendar = it->second;
+    return true;
+}
+
+Calendar CalendarCache::add(const std::string& name, bool adjusted, const Calendar& calendar) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!enabled_)
+        return calendar;
+    auto key = std::make_pair(name, adjusted);
+    auto it = calendars_.find(key);
+    if (it != calendars_.end())
+        return it->second;
+    Calendar cached = QuantExt::CachedCalendar(calendar, firstYear_, lastYear_);
+    calendars_[key] = cached;
+    return cached;
+}
+
+void CalendarCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    calendars_.clear();
+}
+
+void CalendarCache::enable(bool b) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_ = b;
+    if (!enabled_)
+        calendars_.clear();
+}
+
+bool CalendarCache::enabled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return enabled_;
+}
+
+void CalendarCache::setYearRange(Year firstYear, Year lastYear) {
+    QL_REQUIRE(firstYear <= lastYear, "CalendarCache: first year (" << firstYear
+                                                                    << ") must not be after last year (" << lastYear
+                                                                    << ")");
+    std::lock_guard<std::mutex> lock(mutex_);
+    firstYear_ = firstYear;
+    lastYear_ = lastYear;
+    calendars_.clear();
+}
+
+Year CalendarCache::firstYear() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return firstYear_;
+}
+
+Year CalendarCache::lastYear() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastYear_;
+}
+
+} // namespace data
+} // namespace ore
@@ -0,0 +1,76 @@
+/*
+ Copyright (C) 2019 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file ored/utilities/calendarcache.hpp
+    \brief Cache of parsed calendars with precomputed business days
+    \ingroup utilities
+*/
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <ql/patterns/singleton.hpp>
+#include <ql/time/calendar.hpp>
+#include <string>
+
+namespace ore {
+namespace data {
+
+//! Global cache of parsed calendars
+/*! parseCalendar() wraps each calendar it builds, including joint calendars, into a QuantExt::CachedCalendar with
+    precomputed business days for the years firstYear() to lastYear() and stores it here, so that all lookups of
+    the same name share one business day table. The calendars are returned as QuantLib::Calendar, which does not
+    dispatch advance() to the cached calendar, QuantExt::cachedAdvance() does.
+
+    The cache is cleared when the global calendar adjustments are set. Holidays that are added to the QuantLib
+    calendars in another way after a calendar was cached are not seen within the cached years, clear() the cache
+    in this case.
+
+    \ingroup utilities
+*/
+class CalendarCache : public QuantLib::Singleton<CalendarCache> {
+    friend class QuantLib::Singleton<CalendarCache>;
+    CalendarCache() : enabled_(true), firstYear_(1950), lastYear_(2150) {}
+
+public:
+    //! look up the calendar for name and adjustment flag, returns false if it is not cached
+    bool get(const std::string& name, bool adjusted, QuantLib::Calendar& calendar) const;
+    //! add a calendar and return its cached version, if the name is cached already the cached calendar is returned
+    QuantLib::Calendar add(const std::string& name, bool adjusted, const QuantLib::Calendar& calendar);
+    //! remove all cached calendars
+    void clear();
+
+    //! switch the cache on or off, it is on by default
+    void enable(bool b);
+    bool enabled() const;
+
+    //! set the years covered by the business day tables, this clears the cache
+    void setYearRange(QuantLib::Year firstYear, QuantLib::Year lastYear);
+    QuantLib::Year firstYear() const;
+    QuantLib::Year lastYear() const;
+
+private:
+    mutable std::mutex mutex_;
+    bool enabled_;
+    QuantLib::Year firstYear_, lastYear_;
+    std::map<std::pair<std::string, bool>, QuantLib::Calendar> calendars_;
+};
+
+} // namespace data
+} // namespace ore
@@ -21,10 +21,17 @@
     \ingroup
 */
 
+#include <algorithm>
+#include <atomic>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/make_shared.hpp>
+#include <chrono>
+#include <condition_variable>
 #include <iomanip>
 #include <ored/utilities/log.hpp>
 #include <ql/errors.hpp>
+#include <thread>
+#include <vector>
 
 using namespace boost::posix_time;
 using namespace std;
@@ -71,70 +78,42 @@ void FileLogger::log(unsigned, const string& msg) {
         fout_ << msg << endl;
 }
 
-// The Log itself
-Log::Log() : loggers_(), enabled_(false), mask_(255), ls_() {
-
-    ls_.setf(ios::fixed, ios::floatfield);
-    ls_.setf(ios::showpoint);
-}
-
-void Log::registerLogger(const boost::shared_ptr<Logger>& logger) {
-    QL_REQUIRE(loggers_.find(logger->name()) == loggers_.end(),
-               "Logger with name " << logger->name() << " already registered");
-    loggers_[logger->name()] = logger;
-}
-
-boost::shared_ptr<Logger>& Log::logger(const string& name) {
-    QL_REQUIRE(loggers_.find(name) != loggers_.end(), "No logger found with name " << name);
-    return loggers_[name];
-}
-
-void Log::removeLogger(const string& name) {
-    map<string, boost::shared_ptr<Logger>>::iterator it = loggers_.find(name);
-    QL_REQUIRE(it != loggers_.end(), "No logger found with name " << name);
-    loggers_.erase(it);
-}
-
-void Log::removeAllLoggers() { loggers_.clear(); }
-
-void Log::header(unsigned m, const char* filename, int lineNo) {
-    // 1. Reset stringstream
-    ls_.str(string());
-    ls_.clear();
+namespace {
 
+// Write the message header to the stream
+void writeHeader(std::ostream& ls, unsigned m, const ptime& time, const char* filename, int lineNo, int pid) {
     // Write the header to the stream
     // TYPE [Time Stamp] (file:line)
     switch (m) {
     case ORE_ALERT:
-        ls_ << "ALERT    ";
+        ls << "ALERT    ";
         break;
     case ORE_CRITICAL:
-        ls_ << "CRITICAL ";
+        ls << "CRITICAL ";
         break;
     case ORE_ERROR:
-        ls_ << "ERROR    ";
+        ls << "ERROR    ";
         break;
     case ORE_WARNING:
-        ls_ << "WARNING  ";
+        ls << "WARNING  ";
         break;
     case ORE_NOTICE:
-        ls_ << "NOTICE   ";
+        ls << "NOTICE   ";
         break;
     case ORE_DEBUG:
-        ls_ << "DEBUG    ";
+        ls << "DEBUG    ";
         break;
     case ORE_DATA:
-        ls_ << "DATA     ";
+        ls << "DATA     ";
         break;
     case ORE_MEMORY:
-        ls_ << "MEMORY   ";
+        ls << "MEMORY   ";
         break;
     }
 
     // Timestamp
-    // Use boost::posix_time microsecond clock to get better precision (when available).
     // format is "2014-Apr-04 11:10:16.179347"
-    ls_ << '[' << to_simple_string(microsec_clock::local_time()) << ']';
+    ls << '[' << to_simple_string(time) << ']';
 
     // Filename & line no
     // format is " (file:line)"
@@ -143,29 +122,273 @@ void Log::header(unsigned m, const char* filename, int lineNo) {
 
     int maxLen = 30; // gives about 23 chars for the filename
     if (len <= maxLen) {
-        ls_ << " (" << filename << ':' << lineNo << ')';
+        ls << " (" << filename << ':' << lineNo << ')';
         // pad out spaces
-        ls_ << string(maxLen - len, ' ');
+        ls << string(maxLen - len, ' ');
     } else {
         // need to trim the filename to fit into maxLen chars
         // need to remove (len - maxLen) chars + 3 for the "..."
-        ls_ << " (..." << string(filename).substr(3 + len - maxLen) << ':' << lineNo << ')';
+        ls << " (..." << string(filename).substr(3 + len - maxLen) << ':' << lineNo << ')';
     }
 
-    ls_ << " : ";
+    ls << " : ";
 
     // log pid if given
-    if (pid_ > 0)
-        ls_ << " [" << pid_ << "] ";
+    if (pid > 0)
+        ls << " [" << pid << "] ";
+}
+
+// A log message captured by a logging thread, the header is written by the AsyncLogWriter
+struct LogRecord {
+    unsigned mask;
+    ptime time;
+    const char* filename;
+    int lineNo;
+    string text;
+};
+
+// Ring buffer with a single producer (the logging thread) and a single consumer (the writer thread)
+class LogRingBuffer {
+public:
+    explicit LogRingBuffer(std::size_t capacity) : records_(capacity), head_(0), tail_(0), closed_(false) {}
+
+    // returns false if the buffer is full, the record is left untouched in this case
+    bool push(LogRecord& record) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == records_.size())
+            return false;
+        LogRecord& slot = records_[head % records_.size()];
+        slot.mask = record.mask;
+        slot.time = record.time;
+        slot.filename = record.filename;
+        slot.lineNo = record.lineNo;
+        slot.text.swap(record.text);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // pass all available records to f, returns the number of records consumed
+    template <class F> std::size_t drain(F& f) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t head = head_.load(std::memory_order_acquire);
+        for (std::size_t i = tail; i != head; ++i)
+            f(records_[i % records_.size()]);
+        tail_.store(head, std::memory_order_release);
+        return head - tail;
+    }
+
+    // called by the logging thread when it exits, no records are pushed after this
+    void close() { closed_.store(true, std::memory_order_release); }
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+private:
+    std::vector<LogRecord> records_;
+    std::atomic<std::size_t> head_, tail_;
+    std::atomic<bool> closed_;
+};
+
+// Per thread state of the Log, the message stream and, in async mode, the captured header data and ring buffer
+struct LogThreadState {
+    LogThreadState() : writerId(0) {
+        stream.setf(ios::fixed, ios::floatfield);
+        stream.setf(ios::showpoint);
+    }
+    // the writer unregisters the buffer once it has drained the remaining records
+    ~LogThreadState() {
+        if (buffer)
+            buffer->close();
+    }
+    std::ostringstream stream;
+    LogRecord record;
+    // the writer the buffer is registered with
+    unsigned long writerId;
+    boost::shared_ptr<LogRingBuffer> buffer;
+};
+
+LogThreadState& threadState() {
+    static thread_local LogThreadState state;
+    return state;
+}
+
+} // namespace
+
+//! Background thread passing the messages from the threads' ring buffers to the loggers
+class AsyncLogWriter {
+public:
+    AsyncLogWriter(Log& log, std::size_t bufferSize)
+        : log_(log), id_(++instances_), bufferSize_(bufferSize), stop_(false) {
+        QL_REQUIRE(bufferSize_ > 0, "AsyncLogWriter: buffer size must be positive");
+        thread_ = std::thread(&AsyncLogWriter::run, this);
+    }
+
+    ~AsyncLogWriter() { stop(); }
+
+    void push(LogThreadState& state) {
+        if (state.writerId != id_) {
+            state.buffer = boost::make_shared<LogRingBuffer>(bufferSize_);
+            state.writerId = id_;
+            std::lock_guard<std::mutex> lock(buffersMutex_);
+            buffers_.push_back(state.buffer);
+        }
+        state.record.text = state.stream.str();
+        while (!state.buffer->push(state.record)) {
+            // the buffer is full, wake up the writer and wait until it has made room
+            wakeUp_.notify_one();
+            std::this_thread::yield();
+        }
+    }
+
+    void stop() {
+        if (thread_.joinable()) {
+            stop_.store(true);
+            wakeUp_.notify_one();
+            thread_.join();
+        }
+    }
+
+    // called by the writer thread for each record
+    void operator()(const LogRecord& record) {
+        stream_.str(string());
+        stream_.clear();
+        writeHeader(stream_, record.mask, record.time, record.filename, record.lineNo, log_.pid_);
+        stream_ << record.text;
+        log_.dispatch(record.mask, stream_.str());
+    }
+
+private:
+    void run() {
+        for (;;) {
+            // read the flag before draining, so that all messages logged before stop() are written
+            bool stopping = stop_.load();
+            std::vector<boost::shared_ptr<LogRingBuffer>> buffers;
+            {
+                std::lock_guard<std::mutex> lock(buffersMutex_);
+                buffers = buffers_;
+            }
+            std::size_t n = 0;
+            std::vector<boost::shared_ptr<LogRingBuffer>> drained;
+            for (std::size_t i = 0; i < buffers.size(); ++i) {
+                // read the flag before draining, a closed buffer is empty afterwards
+                bool closed = buffers[i]->closed();
+                n += buffers[i]->drain(*this);
+                if (closed)
+                    drained.push_back(buffers[i]);
+            }
+            if (!drained.empty()) {
+                // the threads of these buffers have exited
+                std::lock_guard<std::mutex> lock(buffersMutex_);
+                buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(),
+                                              [&drained](const boost::shared_ptr<LogRingBuffer>& b) {
+                                                  return std::find(drained.begin(), drained.end(), b) != drained.end();
+                                              }),
+                               buffers_.end());
+            }
+            if (n == 0) {
+                if (stopping)
+                    break;
+                std::unique_lock<std::mutex> lock(wakeUpMutex_);
+                wakeUp_.wait_for(lock, std::chrono::milliseconds(5));
+            }
+        }
+    }
+
+    // counts the writers created so far, gives each writer a unique id
+    static std::atomic<unsigned long> instances_;
+
+    Log& log_;
+    unsigned long id_;
+    std::size_t bufferSize_;
+    std::atomic<bool> stop_;
+    std::ostringstream stream_;
+    std::mutex buffersMutex_;
+    std::vector<boost::shared_ptr<LogRingBuffer>> buffers_;
+    std::mutex wakeUpMutex_;
+    std::condition_variable wakeUp_;
+    std::thread thread_;
+};
+
+std::atomic<unsigned long> AsyncLogWriter::instances_(0);
+
+// The Log itself
+Log::Log() : loggers_(), enabled_(false), mask_(255) {}
+
+Log::~Log() { stopAsyncLogging(); }
+
+void Log::registerLogger(const boost::shared_ptr<Logger>& logger) {
+    std::lock_guard<std::mutex> lock(loggersMutex_);
+    QL_REQUIRE(loggers_.find(logger->name()) == loggers_.end(),
+               "Logger with name " << logger->name() << " already registered");
+    loggers_[logger->name()] = logger;
+}
+
+boost::shared_ptr<Logger>& Log::logger(const string& name) {
+    std::lock_guard<std::mutex> lock(loggersMutex_);
+    QL_REQUIRE(loggers_.find(name) != loggers_.end(), "No logger found with name " << name);
+    return loggers_[name];
+}
+
+void Log::removeLogger(const string& name) {
+    std::lock_guard<std::mutex> lock(loggersMutex_);
+    map<string, boost::shared_ptr<Logger>>::iterator it = loggers_.find(name);
+    QL_REQUIRE(it != loggers_.end(), "No logger found with name " << name);
+    loggers_.erase(it);
+}
+
+void Log::removeAllLoggers() {
+    std::lock_guard<std::mutex> lock(loggersMutex_);
+    loggers_.clear();
+}
+
+std::ostream& Log::logStream() { return threadState().stream; }
+
+void Log::header(unsigned m, const char* filename, int lineNo) {
+    LogThreadState& state = threadState();
+
+    // 1. Reset stringstream
+    state.stream.str(string());
+    state.stream.clear();
+
+    // Use boost::posix_time microsecond clock to get better precision (when available).
+    ptime time = microsec_clock::local_time();
+
+    if (asyncWriter_) {
+        // the header is written by the AsyncLogWriter
+        state.record.mask = m;
+        state.record.time = time;
+        state.record.filename = filename;
+        state.record.lineNo = lineNo;
+    } else {
+        writeHeader(state.stream, m, time, filename, lineNo, pid_);
+    }
 }
 
 void Log::log(unsigned m) {
-    string msg = ls_.str();
+    LogThreadState& state = threadState();
+    if (asyncWriter_)
+        asyncWriter_->push(state);
+    else
+        dispatch(m, state.stream.str());
+}
+
+void Log::dispatch(unsigned m, const string& msg) {
+    std::lock_guard<std::mutex> lock(loggersMutex_);
     map<string, boost::shared_ptr<Logger>>::iterator it;
     for (it = loggers_.begin(); it != loggers_.end(); ++it)
         it->second->log(m, msg);
 }
 
+void Log::startAsyncLogging(std::size_t bufferSize) {
+    if (!asyncWriter_)
+        asyncWriter_ = boost::make_shared<AsyncLogWriter>(*this, bufferSize);
+}
+
+void Log::stopAsyncLogging() {
+    if (asyncWriter_) {
+        asyncWriter_->stop();
+        asyncWriter_.reset();
+    }
+}
+
 // --------
 
 LoggerStream::LoggerStream(unsigned mask, const char* filename, unsigned lineNo)
@@ -33,6 +33,13 @@
 #define ORE_DATA 64    // 01000000  127
 #define ORE_MEMORY 128 // 10000000  255
 
+/*! Compile time log mask. Log statements whose level is not contained in this mask are removed by the compiler, i.e.
+    they cost nothing at run time regardless of the mask set via Log::setMask(). For example, building with
+    -DORE_LOG_COMPILE_MASK=31 removes all DLOG, TLOG and MEM_LOG statements. The default keeps all levels. */
+#ifndef ORE_LOG_COMPILE_MASK
+#define ORE_LOG_COMPILE_MASK 255
+#endif
+
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -41,6 +48,7 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/shared_ptr.hpp>
 #include <map>
+#include <mutex>
 #include <ql/qldefines.hpp>
 #include <queue>
 
@@ -197,7 +205,16 @@ private:
   Once a message is recieved, it is imediatly dispatched to each of the registered loggers, the order in which
   the loggers are called is not guarenteed.
 
-  Logging is done by the calling thread and the LOG call blocks until all the loggers have returned.
+  By default logging is done by the calling thread and the LOG call blocks until all the loggers have returned.
+  Calls from several threads are serialised, each thread formats its messages into its own stream.
+
+  After startAsyncLogging() the LOG call only captures the message and its time stamp and puts it into a ring buffer
+  owned by the calling thread. A background writer thread drains the ring buffers, formats the message headers and
+  dispatches the messages to the loggers. Messages from one thread are passed on in the order they were logged. If a
+  ring buffer is full, the logging thread waits until the writer has made room, i.e. no messages are dropped. When a
+  thread exits, the writer releases its ring buffer after writing the remaining messages.
+  stopAsyncLogging() passes all pending messages to the loggers and returns to synchronous logging. Loggers must not
+  be probed (e.g. BufferLogger::next()) while asynchronous logging is running.
 
   At start up, the Log class has no loggers and so will ignore any LOG() messages until it is configured.
 
@@ -223,10 +240,16 @@ private:
           std::cout << bl.next() << std::endl;
       std::cout << "End Log Messages." << std::endl;
   </pre>
+  To switch on asynchronous logging after the loggers are set up
+  <pre>
+      Log::instance().startAsyncLogging();
+  </pre>
   \ingroup utilities
  */
+class AsyncLogWriter;
 class Log : public QuantLib::Singleton<Log> {
     friend class QuantLib::Singleton<Log>;
+    friend class AsyncLogWriter;
 
 public:
     //! Add a new Logger.
@@ -259,7 +282,7 @@ public:
     //! macro utility function - do not use directly
     void header(unsigned m, const char* filename, int lineNo);
     //! macro utility function - do not use directly
-    std::ostream& logStream() { return ls_; }
+    std::ostream& logStream();
     //! macro utility function - do not use directly
     void log(unsigned m);
 
@@ -275,13 +298,29 @@ public:
     //! if a PID is set for the logger, messages are tagged with [1234] if pid = 1234
     void setPid(const int pid) { pid_ = pid; }
 
+    //! \name Asynchronous logging
+    /*! Start and stop must not be called while other threads are logging. */
+    //@{
+    //! Start the background writer, each logging thread gets a ring buffer holding \p bufferSize messages
+    void startAsyncLogging(std::size_t bufferSize = 8192);
+    //! Pass all pending messages to the loggers, stop the background writer and return to synchronous logging
+    void stopAsyncLogging();
+    bool async() const { return asyncWriter_ != nullptr; }
+    //@}
+
+    ~Log();
+
 private:
     Log();
 
+    // pass a formatted message to all loggers
+    void dispatch(unsigned m, const string& msg);
+
     std::map<string, boost::shared_ptr<Logger>> loggers_;
+    std::mutex loggersMutex_;
     bool enabled_;
     unsigned mask_;
-    std::ostringstream ls_;
+    boost::shared_ptr<AsyncLogWriter> asyncWriter_;
 
     int pid_ = 0;
 };
@@ -290,7 +329,8 @@ private:
   Main Logging macro, do not use this directly, use on of the below 6 macros instead
  */
 #define MLOG(mask, text)                                                                                               \
-    if (ore::data::Log::instance().enabled() && ore::data::Log::instance().filter(mask)) {                             \
+    if (0 != ((mask)&ORE_LOG_COMPILE_MASK) && ore::data::Log::instance().enabled() &&                                 \
+        ore::data::Log::instance().filter(mask)) {                                                                     \
         ore::data::Log::instance().header(mask, __FILE__, __LINE__);                                                   \
         ore::data::Log::instance().logStream() << text;                                                                \
         ore::data::Log::instance().log(mask);                                                                          \
@@ -313,7 +353,8 @@ private:
 
 //! Logging macro specifically for logging memory usage
 #define MEM_LOG                                                                                                        \
-    if (ore::data::Log::instance().enabled() && ore::data::Log::instance().filter(ORE_MEMORY)) {                       \
+    if (0 != (ORE_MEMORY & ORE_LOG_COMPILE_MASK) && ore::data::Log::instance().enabled() &&                           \
+        ore::data::Log::instance().filter(ORE_MEMORY)) {                                                               \
         ore::data::Log::instance().header(ORE_MEMORY, __FILE__, __LINE__);                                             \
         ore::data::Log::instance().logStream() << std::to_string(ore::data::os::getPeakMemoryUsageBytes()) << "|";     \
         ore::data::Log::instance().logStream() << std::to_string(ore::data::os::getMemoryUsageBytes());                \
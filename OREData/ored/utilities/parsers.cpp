@@ -25,6 +25,7 @@
 #include <boost/algorithm/string.hpp>
 #include <map>
 #include <ored/utilities/calendaradjustmentconfig.hpp>
+#include <ored/utilities/calendarcache.hpp>
 #include <ored/utilities/parsers.hpp>
 #include <ql/currencies/all.hpp>
 #include <ql/errors.hpp>
@@ -170,6 +171,11 @@ bool parseBool(const string& s) {
 }
 
 Calendar parseCalendar(const string& s, bool adjustCalendar) {
+    // calendars that were parsed before come with precomputed business days
+    Calendar cached;
+    if (CalendarCache::instance().get(s, adjustCalendar, cached))
+        return cached;
+
     static map<string, Calendar> m = {
         {"TGT", TARGET()},
         {"TARGET", TARGET()},
@@ -458,7 +464,7 @@ Calendar parseCalendar(const string& s, bool adjustCalendar) {
                 cal.removeHoliday(b);
             }
         }
-        return cal;
+        return CalendarCache::instance().add(s, adjustCalendar, cal);
 
     } else {
         // Try to split them up
@@ -486,7 +492,7 @@ Calendar parseCalendar(const string& s, bool adjustCalendar) {
             }
         }
 
-        return LargeJointCalendar(calendars);
+        return CalendarCache::instance().add(s, adjustCalendar, LargeJointCalendar(calendars));
     }
 }
 
@@ -93,6 +93,9 @@ bool parseBool(const string& s);
 
   For a joint calendar, the separate calendar names should be
   comma-delimited.
+
+  The calendar is a copy of a QuantExt::CachedCalendar held in the CalendarCache. Use QuantExt::cachedAdvance()
+  to advance it by business days with table lookups.
   \ingroup utilities
 */
 QuantLib::Calendar parseCalendar(const string& s, bool adjustCalendar = true);
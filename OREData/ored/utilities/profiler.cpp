@@ -0,0 +1,115 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/utilities/profiler.hpp>
+
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+
+using QuantLib::Size;
+using std::string;
+using std::vector;
+
+namespace ore {
+namespace data {
+
+namespace {
+// plain thread local values, so that they can be used from within operator new
+thread_local void* threadEntries = nullptr;
+thread_local Size threadAllocations = 0;
+thread_local Size threadAllocatedBytes = 0;
+} // namespace
+
+std::atomic<bool> Profiler::enabled_(false);
+
+void ProfileEntry::add(double time, Size allocs, Size allocBytes) {
+    if (timed == 0) {
+        minTime = maxTime = time;
+    } else {
+        minTime = std::min(minTime, time);
+        maxTime = std::max(maxTime, time);
+    }
+    ++count;
+    ++timed;
+    totalTime += time;
+    allocations += allocs;
+    bytes += allocBytes;
+}
+
+Profiler::ThreadEntries* Profiler::registerThread() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    boost::shared_ptr<ThreadEntries> t = boost::make_shared<ThreadEntries>();
+    t->id = threads_.size();
+    threads_.push_back(t);
+    threadEntries = t.get();
+    return t.get();
+}
+
+ProfileEntry* Profiler::entry(const string& category, const string& name) {
+    ThreadEntries* t = static_cast<ThreadEntries*>(threadEntries);
+    if (t == nullptr)
+        t = registerThread();
+    // the entries of a thread are only changed by the thread itself, the references stay valid in the map
+    return &t->entries[category][name];
+}
+
+vector<ProfileRecord> Profiler::records() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    vector<ProfileRecord> result;
+    for (const auto& t : threads_) {
+        for (const auto& c : t->entries) {
+            for (const auto& n : c.second) {
+                if (n.second.count > 0) {
+                    ProfileRecord r;
+                    r.thread = t->id;
+                    r.category = c.first;
+                    r.name = n.first;
+                    r.entry = n.second;
+                    result.push_back(r);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+void Profiler::clear() {
+    // the entries are reset rather than erased, since the threads may hold pointers to them
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& t : threads_) {
+        for (auto& c : t->entries) {
+            for (auto& n : c.second)
+                n.second.clear();
+        }
+    }
+}
+
+void Profiler::allocation(std::size_t bytes) {
+    if (enabled()) {
+        ++threadAllocations;
+        threadAllocatedBytes += bytes;
+    }
+}
+
+Size Profiler::allocations() { return threadAllocations; }
+
+Size Profiler::allocatedBytes() { return threadAllocatedBytes; }
+
+} // namespace data
+} // namespace ore
@@ -0,0 +1,171 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file ored/utilities/profiler.hpp
+    \brief Scoped timers and counters for profiling hot paths
+    \ingroup utilities
+*/
+
+#pragma once
+
+#include <atomic>
+#include <boost/shared_ptr.hpp>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <ql/patterns/singleton.hpp>
+#include <ql/types.hpp>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace data {
+
+//! Timings and counts collected for one profiled scope or counter on one thread
+/*! \ingroup utilities
+ */
+struct ProfileEntry {
+    ProfileEntry() : count(0), timed(0), totalTime(0.0), minTime(0.0), maxTime(0.0), allocations(0), bytes(0) {}
+    //! add one timed call, the time in seconds
+    void add(double time, QuantLib::Size allocs, QuantLib::Size allocBytes);
+    //! reset all values to zero
+    void clear() { *this = ProfileEntry(); }
+
+    //! number of calls for scopes, sum of the increments for counters
+    QuantLib::Size count;
+    //! number of timed calls
+    QuantLib::Size timed;
+    //! total, minimum and maximum wall time of the timed calls in seconds
+    double totalTime, minTime, maxTime;
+    //! number and size in bytes of the allocations during the timed calls
+    QuantLib::Size allocations, bytes;
+};
+
+//! One line of the profile
+/*! \ingroup utilities
+ */
+struct ProfileRecord {
+    QuantLib::Size thread;
+    std::string category;
+    std::string name;
+    ProfileEntry entry;
+};
+
+//! Global profiler
+/*! The profiler collects wall times, call counts and allocation counts of scopes marked with ORE_PROFILE_SCOPE and
+    counts of events marked with ORE_PROFILE_COUNT, keyed by a category (e.g. "Pricing") and a name (e.g. the trade
+    type).
+
+    Each thread writes to its own set of entries, so that timers and counters do not need any locking. The
+    entries of a thread are kept when the thread ends, records() returns them per thread, numbered in the order
+    in which the threads first recorded anything.
+
+    The profiler is switched off by default. While it is off the macros reduce to a check of an atomic flag, the
+    name arguments are not evaluated.
+
+    Allocations are only counted if the application forwards its allocations to allocation(), e.g. from a
+    replacement of the global operator new as done by the ORE application. Otherwise the allocation counts are
+    zero.
+
+    records() and clear() must not be called while other threads are inside a profiled scope.
+
+    \ingroup utilities
+*/
+class Profiler : public QuantLib::Singleton<Profiler> {
+    friend class QuantLib::Singleton<Profiler>;
+    Profiler() {}
+
+public:
+    //! switch the profiler on or off, it is off by default
+    void switchOn() { enabled_.store(true, std::memory_order_relaxed); }
+    void switchOff() { enabled_.store(false, std::memory_order_relaxed); }
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    //! the entry for category and name of the calling thread, it is created if necessary
+    ProfileEntry* entry(const std::string& category, const std::string& name);
+
+    //! all entries with a non-zero count, ordered by thread, category and name
+    std::vector<ProfileRecord> records() const;
+    //! reset all entries to zero
+    void clear();
+
+    //! record an allocation of the given size on the calling thread, does nothing if the profiler is off
+    static void allocation(std::size_t bytes);
+    //! number and size of the allocations recorded on the calling thread so far
+    static QuantLib::Size allocations();
+    static QuantLib::Size allocatedBytes();
+
+private:
+    struct ThreadEntries {
+        QuantLib::Size id;
+        std::map<std::string, std::map<std::string, ProfileEntry>> entries;
+    };
+    ThreadEntries* registerThread();
+
+    static std::atomic<bool> enabled_;
+    mutable std::mutex mutex_;
+    std::vector<boost::shared_ptr<ThreadEntries>> threads_;
+};
+
+//! Adds the wall time and allocations between its construction and destruction to a profile entry
+/*! Nothing is measured if the entry is null.
+    \ingroup utilities
+ */
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileEntry* entry) : entry_(entry) {
+        if (entry_) {
+            allocations_ = Profiler::allocations();
+            bytes_ = Profiler::allocatedBytes();
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+    ~ProfileScope() {
+        if (entry_) {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_;
+            entry_->add(elapsed.count(), Profiler::allocations() - allocations_, Profiler::allocatedBytes() - bytes_);
+        }
+    }
+
+private:
+    ProfileScope(const ProfileScope&);
+    ProfileScope& operator=(const ProfileScope&);
+
+    ProfileEntry* entry_;
+    std::chrono::steady_clock::time_point start_;
+    QuantLib::Size allocations_, bytes_;
+};
+
+} // namespace data
+} // namespace ore
+
+#define ORE_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ORE_PROFILE_CONCAT(a, b) ORE_PROFILE_CONCAT_IMPL(a, b)
+
+//! Profile the rest of the enclosing block under category and name
+#define ORE_PROFILE_SCOPE(category, name)                                                                              \
+    ore::data::ProfileScope ORE_PROFILE_CONCAT(oreProfileScope, __LINE__)(                                             \
+        ore::data::Profiler::enabled() ? ore::data::Profiler::instance().entry(category, name) : nullptr)
+
+//! Add n to the counter for category and name
+#define ORE_PROFILE_COUNT(category, name, n)                                                                           \
+    do {                                                                                                               \
+        if (ore::data::Profiler::enabled())                                                                            \
+            ore::data::Profiler::instance().entry(category, name)->count += (n);                                       \
+    } while (false)
@@ -113,13 +113,82 @@ BOOST_AUTO_TEST_CASE(testMoreThanOneStep) {
     // Larger tolerance for multiple steps
     Real tol = 1e-8;
 
-    // Check that we don't handle more than one step
     // EURUSD + EURAUD + AUDNZD => USDNZD
-    BOOST_CHECK_THROW(fx.getQuote("USDNZD"), QuantLib::Error);
-    // but if we cache EURNZD first....
-    BOOST_CHECK_CLOSE(fx.getQuote("EURNZD")->value(), 1.6450, tol);
-    // then we should be able to get it with one step
     BOOST_CHECK_CLOSE(fx.getQuote("USDNZD")->value(), 1.6450 / 1.0861, tol);
+    BOOST_CHECK_CLOSE(fx.getQuote("NZDUSD")->value(), 1.0861 / 1.6450, tol);
+    // ZZZEUR + EURAUD + AUDNZD => ZZZNZD
+    BOOST_CHECK_CLOSE(fx.getQuote("ZZZNZD")->value(), 3.141 * 1.6450, tol);
+    BOOST_CHECK_CLOSE(fx.getQuote("EURNZD")->value(), 1.6450, tol);
+}
+
+BOOST_AUTO_TEST_CASE(testCrossRates) {
+
+    Real tol = 1e-12;
+
+    boost::shared_ptr<FXCrossRates> crossRates = fx.crossRates();
+    BOOST_CHECK_EQUAL(crossRates->currencies().size(), 14);
+    Size eur = crossRates->index("EUR"), usd = crossRates->index("USD"), jpy = crossRates->index("JPY"),
+         nzd = crossRates->index("NZD"), zzz = crossRates->index("ZZZ");
+    BOOST_CHECK_THROW(crossRates->index("MXN"), QuantLib::Error);
+
+    // shortest paths
+    BOOST_CHECK_EQUAL(crossRates->pathLength(eur, eur), 0);
+    BOOST_CHECK_EQUAL(crossRates->pathLength(eur, usd), 1);
+    BOOST_CHECK_EQUAL(crossRates->pathLength(zzz, eur), 1);
+    BOOST_CHECK_EQUAL(crossRates->pathLength(usd, jpy), 2);
+    BOOST_CHECK_EQUAL(crossRates->pathLength(usd, nzd), 3);
+    BOOST_CHECK_EQUAL(crossRates->pathLength(zzz, nzd), 3);
+
+    // the matrix agrees with the quotes
+    const vector<Real>& rates = crossRates->rates();
+    Size n = crossRates->currencies().size();
+    BOOST_REQUIRE_EQUAL(rates.size(), n * n);
+    for (Size i = 0; i < n; ++i) {
+        for (Size j = 0; j < n; ++j) {
+            string pair = crossRates->currencies()[i] + crossRates->currencies()[j];
+            BOOST_CHECK_CLOSE(rates[i * n + j], fx.getQuote(pair)->value(), tol);
+            BOOST_CHECK_CLOSE(rates[i * n + j] * rates[j * n + i], 1.0, tol);
+        }
+    }
+    BOOST_CHECK_CLOSE(crossRates->rate("USDJPY"), 128.51 / 1.0861, tol);
+}
+
+BOOST_AUTO_TEST_CASE(testCrossRatesUpdate) {
+
+    Real tol = 1e-12;
+
+    boost::shared_ptr<SimpleQuote> eurUsd = boost::make_shared<SimpleQuote>(1.10);
+    boost::shared_ptr<SimpleQuote> eurGbp = boost::make_shared<SimpleQuote>(0.85);
+    boost::shared_ptr<SimpleQuote> gbpChf = boost::make_shared<SimpleQuote>(1.20);
+    FXTriangulation fxt;
+    fxt.addQuote("EURUSD", Handle<Quote>(eurUsd));
+    fxt.addQuote("EURGBP", Handle<Quote>(eurGbp));
+    fxt.addQuote("GBPCHF", Handle<Quote>(gbpChf));
+
+    Handle<Quote> usdChf = fxt.getQuote("USDCHF");
+    BOOST_CHECK_CLOSE(usdChf->value(), 0.85 * 1.20 / 1.10, tol);
+
+    // the constructed quote follows the original quotes
+    eurUsd->setValue(1.25);
+    gbpChf->setValue(1.15);
+    BOOST_CHECK_CLOSE(usdChf->value(), 0.85 * 1.15 / 1.25, tol);
+    BOOST_CHECK_CLOSE(fxt.crossRates()->rate("CHFEUR"), 1.0 / (0.85 * 1.15), tol);
+
+    // an invalid quote invalidates the paths through it only
+    eurGbp->setValue(Null<Real>());
+    BOOST_CHECK(!usdChf->isValid());
+    BOOST_CHECK_THROW(usdChf->value(), QuantLib::Error);
+    BOOST_CHECK_CLOSE(fxt.crossRates()->rate("USDEUR"), 1.0 / 1.25, tol);
+
+    // the copy shares the quotes
+    FXTriangulation copy(fxt);
+    eurGbp->setValue(0.90);
+    BOOST_CHECK_CLOSE(copy.getQuote("USDCHF")->value(), 0.90 * 1.15 / 1.25, tol);
+
+    // a quote added later is part of the graph
+    fxt.addQuote("CHFJPY", Handle<Quote>(boost::make_shared<SimpleQuote>(120.0)));
+    BOOST_CHECK_CLOSE(fxt.getQuote("EURJPY")->value(), 0.90 * 1.15 * 120.0, tol);
+    BOOST_CHECK_THROW(copy.getQuote("EURJPY"), QuantLib::Error);
 }
 
 BOOST_AUTO_TEST_CASE(testBadInputsThrow) {
@@ -0,0 +1,166 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/make_shared.hpp>
+#include <boost/test/unit_test.hpp>
+#include <ored/utilities/log.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+using namespace ore::data;
+using namespace std;
+
+namespace {
+
+// Registers a BufferLogger with the Log for the duration of a test and restores the Log settings afterwards
+class BufferLoggerFixture {
+public:
+    BufferLoggerFixture()
+        : logger(boost::make_shared<BufferLogger>(ORE_DATA)), enabled_(Log::instance().enabled()),
+          mask_(Log::instance().mask()) {
+        Log::instance().registerLogger(logger);
+        Log::instance().switchOn();
+        Log::instance().setMask(255);
+    }
+    ~BufferLoggerFixture() {
+        Log::instance().stopAsyncLogging();
+        Log::instance().removeLogger(BufferLogger::name);
+        Log::instance().setMask(mask_);
+        if (!enabled_)
+            Log::instance().switchOff();
+    }
+    boost::shared_ptr<BufferLogger> logger;
+
+private:
+    bool enabled_;
+    unsigned mask_;
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREDataTestSuite, ore::test::TopLevelFixture)
+
+BOOST_FIXTURE_TEST_SUITE(LogTests, BufferLoggerFixture)
+
+BOOST_AUTO_TEST_CASE(testSynchronousLogging) {
+
+    BOOST_TEST_MESSAGE("Testing synchronous logging...");
+
+    LOG("message " << 1);
+    Log::instance().setMask(ORE_WARNING);
+    LOG("filtered message");
+    WLOG("message " << 2);
+
+    BOOST_REQUIRE(logger->hasNext());
+    string msg = logger->next();
+    BOOST_CHECK(msg.find("NOTICE") == 0);
+    BOOST_CHECK(msg.find("message 1") != string::npos);
+    BOOST_REQUIRE(logger->hasNext());
+    msg = logger->next();
+    BOOST_CHECK(msg.find("WARNING") == 0);
+    BOOST_CHECK(msg.find("message 2") != string::npos);
+    BOOST_CHECK(!logger->hasNext());
+}
+
+BOOST_AUTO_TEST_CASE(testAsynchronousLogging) {
+
+    BOOST_TEST_MESSAGE("Testing asynchronous logging from several threads...");
+
+    const int nThreads = 4;
+    const int nMessages = 5000;
+
+    // use a small ring buffer to exercise the waiting on a full buffer
+    Log::instance().startAsyncLogging(64);
+    BOOST_CHECK(Log::instance().async());
+
+    vector<std::thread> threads;
+    for (int t = 0; t < nThreads; ++t) {
+        threads.push_back(std::thread([t]() {
+            for (int i = 0; i < nMessages; ++i)
+                WLOG("thread " << t << " message " << i);
+        }));
+    }
+    for (std::size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    Log::instance().stopAsyncLogging();
+    BOOST_CHECK(!Log::instance().async());
+
+    // all messages arrive, the messages of each thread in order
+    vector<int> last(nThreads, -1);
+    int count = 0;
+    while (logger->hasNext()) {
+        string msg = logger->next();
+        BOOST_CHECK(msg.find("WARNING") == 0);
+        string::size_type pos = msg.find("thread ");
+        BOOST_REQUIRE(pos != string::npos);
+        int t, i;
+        BOOST_REQUIRE_EQUAL(sscanf(msg.c_str() + pos, "thread %d message %d", &t, &i), 2);
+        BOOST_REQUIRE(t >= 0 && t < nThreads);
+        BOOST_CHECK_EQUAL(i, last[t] + 1);
+        last[t] = i;
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(count, nThreads * nMessages);
+
+    // back to synchronous logging
+    LOG("synchronous message");
+    BOOST_REQUIRE(logger->hasNext());
+    BOOST_CHECK(logger->next().find("synchronous message") != string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(testAsynchronousLoggingShortLivedThreads) {
+
+    BOOST_TEST_MESSAGE("Testing asynchronous logging from short lived threads...");
+
+    const int nThreads = 200;
+    const int nMessages = 10;
+
+    // each thread registers a ring buffer, which is released after the thread has exited
+    Log::instance().startAsyncLogging(4);
+    for (int t = 0; t < nThreads; ++t) {
+        std::thread thread([t]() {
+            for (int i = 0; i < nMessages; ++i)
+                WLOG("thread " << t << " message " << i);
+        });
+        thread.join();
+    }
+    Log::instance().stopAsyncLogging();
+
+    // all messages arrive, the messages of each thread in order
+    vector<int> last(nThreads, -1);
+    int count = 0;
+    while (logger->hasNext()) {
+        string msg = logger->next();
+        string::size_type pos = msg.find("thread ");
+        BOOST_REQUIRE(pos != string::npos);
+        int t, i;
+        BOOST_REQUIRE_EQUAL(sscanf(msg.c_str() + pos, "thread %d message %d", &t, &i), 2);
+        BOOST_REQUIRE(t >= 0 && t < nThreads);
+        BOOST_CHECK_EQUAL(i, last[t] + 1);
+        last[t] = i;
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(count, nThreads * nMessages);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
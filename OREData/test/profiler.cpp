@@ -0,0 +1,189 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <ored/utilities/profiler.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace ore::data;
+using namespace std;
+using QuantLib::Size;
+
+namespace {
+
+// Switches the profiler off and clears it after each test
+class ProfilerFixture {
+public:
+    ProfilerFixture() { Profiler::instance().clear(); }
+    ~ProfilerFixture() {
+        Profiler::instance().switchOff();
+        Profiler::instance().clear();
+    }
+};
+
+// The records of the calling test with the given category
+vector<ProfileRecord> records(const string& category) {
+    vector<ProfileRecord> result;
+    for (const auto& r : Profiler::instance().records()) {
+        if (r.category == category)
+            result.push_back(r);
+    }
+    return result;
+}
+
+string evaluatedName(bool& evaluated) {
+    evaluated = true;
+    return "name";
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREDataTestSuite, ore::test::TopLevelFixture)
+
+BOOST_FIXTURE_TEST_SUITE(ProfilerTests, ProfilerFixture)
+
+BOOST_AUTO_TEST_CASE(testScopesAndCounters) {
+
+    BOOST_TEST_MESSAGE("Testing profiler scopes and counters...");
+
+    Profiler::instance().switchOn();
+    for (Size i = 0; i < 3; ++i) {
+        ORE_PROFILE_SCOPE("TestOuter", "outer");
+        for (Size j = 0; j < 4; ++j) {
+            ORE_PROFILE_SCOPE("TestInner", j % 2 == 0 ? "even" : "odd");
+            ORE_PROFILE_COUNT("TestCounter", "count", j);
+        }
+    }
+
+    vector<ProfileRecord> outer = records("TestOuter");
+    BOOST_REQUIRE_EQUAL(outer.size(), 1);
+    BOOST_CHECK_EQUAL(outer[0].name, "outer");
+    BOOST_CHECK_EQUAL(outer[0].entry.count, 3);
+    BOOST_CHECK_EQUAL(outer[0].entry.timed, 3);
+    BOOST_CHECK(outer[0].entry.minTime >= 0.0);
+    BOOST_CHECK(outer[0].entry.minTime <= outer[0].entry.maxTime);
+    BOOST_CHECK(outer[0].entry.maxTime <= outer[0].entry.totalTime);
+
+    // records are ordered by name within a category
+    vector<ProfileRecord> inner = records("TestInner");
+    BOOST_REQUIRE_EQUAL(inner.size(), 2);
+    BOOST_CHECK_EQUAL(inner[0].name, "even");
+    BOOST_CHECK_EQUAL(inner[1].name, "odd");
+    BOOST_CHECK_EQUAL(inner[0].entry.count, 6);
+    BOOST_CHECK_EQUAL(inner[1].entry.count, 6);
+    // the inner scopes are part of the outer scopes
+    BOOST_CHECK(inner[0].entry.totalTime + inner[1].entry.totalTime <= outer[0].entry.totalTime);
+
+    // counters add up the increments and are not timed
+    vector<ProfileRecord> counter = records("TestCounter");
+    BOOST_REQUIRE_EQUAL(counter.size(), 1);
+    BOOST_CHECK_EQUAL(counter[0].entry.count, 3 * (0 + 1 + 2 + 3));
+    BOOST_CHECK_EQUAL(counter[0].entry.timed, 0);
+
+    // clear resets all entries, records without counts are not reported
+    Profiler::instance().clear();
+    BOOST_CHECK(records("TestOuter").empty());
+    BOOST_CHECK(records("TestCounter").empty());
+}
+
+BOOST_AUTO_TEST_CASE(testSwitchedOff) {
+
+    BOOST_TEST_MESSAGE("Testing that the switched off profiler records nothing...");
+
+    BOOST_CHECK(!Profiler::enabled());
+    bool evaluated = false;
+    {
+        ORE_PROFILE_SCOPE("TestOff", evaluatedName(evaluated));
+        ORE_PROFILE_COUNT("TestOff", evaluatedName(evaluated), 1);
+    }
+    // the names are not even evaluated
+    BOOST_CHECK(!evaluated);
+    BOOST_CHECK(records("TestOff").empty());
+
+    Profiler::instance().switchOn();
+    {
+        ORE_PROFILE_SCOPE("TestOff", evaluatedName(evaluated));
+    }
+    BOOST_CHECK(evaluated);
+    BOOST_CHECK_EQUAL(records("TestOff").size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(testAllocations) {
+
+    BOOST_TEST_MESSAGE("Testing profiler allocation counts...");
+
+    // allocations are forwarded by the application, here we report them by hand
+    Profiler::allocation(100);
+    Profiler::instance().switchOn();
+    {
+        ORE_PROFILE_SCOPE("TestAllocations", "scope");
+        Profiler::allocation(16);
+        Profiler::allocation(32);
+    }
+    Profiler::allocation(64);
+
+    vector<ProfileRecord> r = records("TestAllocations");
+    BOOST_REQUIRE_EQUAL(r.size(), 1);
+    BOOST_CHECK_EQUAL(r[0].entry.allocations, 2);
+    BOOST_CHECK_EQUAL(r[0].entry.bytes, 48);
+}
+
+BOOST_AUTO_TEST_CASE(testThreads) {
+
+    BOOST_TEST_MESSAGE("Testing profiler entries per thread...");
+
+    const Size nThreads = 4;
+    const Size nScopes = 1000;
+
+    Profiler::instance().switchOn();
+    vector<std::thread> threads;
+    for (Size t = 0; t < nThreads; ++t) {
+        threads.push_back(std::thread([t]() {
+            for (Size i = 0; i < nScopes; ++i) {
+                ORE_PROFILE_SCOPE("TestThreads", "scope");
+                ORE_PROFILE_COUNT("TestThreads", "count", t);
+            }
+        }));
+    }
+    for (auto& t : threads)
+        t.join();
+
+    // the entries of the threads are kept after the threads ended, one scope and one counter per thread
+    vector<ProfileRecord> r = records("TestThreads");
+    std::set<Size> ids;
+    Size scopes = 0, counts = 0;
+    for (const auto& x : r) {
+        ids.insert(x.thread);
+        if (x.name == "scope") {
+            BOOST_CHECK_EQUAL(x.entry.count, nScopes);
+            scopes += x.entry.count;
+        } else {
+            counts += x.entry.count;
+        }
+    }
+    BOOST_CHECK_EQUAL(ids.size(), nThreads);
+    BOOST_CHECK_EQUAL(scopes, nThreads * nScopes);
+    BOOST_CHECK_EQUAL(counts, nScopes * (0 + 1 + 2 + 3));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
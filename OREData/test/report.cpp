@@ -0,0 +1,147 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <ored/report/csvreport.hpp>
+#include <ored/report/inmemoryreport.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <ql/math/comparison.hpp>
+#include <ql/math/rounding.hpp>
+#include <ql/time/date.hpp>
+#include <stdio.h>
+
+using namespace QuantLib;
+using namespace ore::data;
+using namespace std;
+
+BOOST_FIXTURE_TEST_SUITE(OREDataTestSuite, ore::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(ReportTests)
+
+BOOST_AUTO_TEST_CASE(testInMemoryReportColumnarStorage) {
+
+    BOOST_TEST_MESSAGE("Testing columnar storage of InMemoryReport...");
+
+    InMemoryReport report;
+    report.addColumn("TradeId", string())
+        .addColumn("No", Size())
+        .addColumn("Date", Date())
+        .addColumn("NPV", double(), 2);
+
+    // row by row
+    report.next().add(string("t1")).add(Size(1)).add(Date(1, Jan, 2020)).add(1.5);
+    report.next().add(string("t2")).add(Size(2)).add(Date(2, Jan, 2020)).add(2.5);
+
+    // bulk append
+    vector<string> ids = {"t1", "t3", "t2"};
+    vector<Size> nos = {3, 4, 5};
+    vector<Date> dates = {Date(3, Jan, 2020), Date(4, Jan, 2020), Date(5, Jan, 2020)};
+    vector<Real> npvs = {3.5, 4.5, 5.5};
+    report.append(0, ids).append(1, nos).append(2, dates).append(3, npvs);
+    report.end();
+
+    BOOST_CHECK_EQUAL(report.columns(), 4);
+    BOOST_CHECK_EQUAL(report.rows(), 5);
+    BOOST_CHECK_EQUAL(report.realData(3).size(), 5);
+    BOOST_CHECK_EQUAL(report.sizeData(1).back(), 5);
+    BOOST_CHECK_EQUAL(report.dateData(2)[1], Date(2, Jan, 2020));
+
+    // strings are stored once in the dictionary
+    BOOST_CHECK_EQUAL(report.stringDictionary(0).size(), 3);
+    BOOST_CHECK_EQUAL(report.stringCodes(0).size(), 5);
+    BOOST_CHECK_EQUAL(report.stringCodes(0)[0], report.stringCodes(0)[2]);
+    BOOST_CHECK_EQUAL(boost::get<string>(report.value(3, 0)), "t3");
+
+    vector<Report::ReportType> npvColumn = report.data(3);
+    BOOST_REQUIRE_EQUAL(npvColumn.size(), 5);
+    BOOST_CHECK_EQUAL(boost::get<Real>(npvColumn[4]), 5.5);
+
+    // wrong types and incomplete rows are rejected
+    BOOST_CHECK_THROW(report.append(0, npvs), QuantLib::Error);
+    BOOST_CHECK_THROW(report.next().add(1.0), QuantLib::Error);
+}
+
+BOOST_AUTO_TEST_CASE(testInMemoryReportIncompleteBulkRows) {
+
+    BOOST_TEST_MESSAGE("Testing InMemoryReport with incomplete bulk rows...");
+
+    InMemoryReport report;
+    report.addColumn("A", Size()).addColumn("B", double());
+    vector<Size> a = {1, 2};
+    vector<Real> b = {1.0};
+    report.append(0, a).append(1, b);
+    BOOST_CHECK_EQUAL(report.rows(), 1);
+    BOOST_CHECK_THROW(report.next(), QuantLib::Error);
+    // end() tolerates an incomplete last row as before, only the complete rows are reported
+    BOOST_CHECK_NO_THROW(report.end());
+    BOOST_CHECK_EQUAL(report.rows(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(testCsvReportNumberFormatting) {
+
+    BOOST_TEST_MESSAGE("Testing CSVFileReport number formatting against printf...");
+
+    boost::filesystem::path file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+
+    vector<Real> values = {0.0,   -0.0,       1.0,         -1.0,       0.5,        123456.789012, -98765.4321,
+                           1E-12, -0.000049, 0.0000501,   1E14,       -7.25E15,   3.1E20,        Null<Real>(),
+                           2.675, 1.005,      -1234.56785, 0.99999999, 9.87654321, 42.0};
+    vector<Size> precisions = {0, 2, 4, 6, 10};
+
+    string expected = "#";
+    for (Size p = 0; p < precisions.size(); ++p)
+        expected += (p > 0 ? "," : "") + std::to_string(p);
+    {
+        CSVFileReport report(file.string());
+        for (Size p = 0; p < precisions.size(); ++p)
+            report.addColumn(std::to_string(p), double(), precisions[p]);
+        for (Size i = 0; i < values.size(); ++i) {
+            report.next();
+            expected += "\n";
+            for (Size p = 0; p < precisions.size(); ++p) {
+                report.add(values[i]);
+                if (p > 0)
+                    expected += ",";
+                if (values[i] == Null<Real>()) {
+                    expected += "#N/A";
+                } else {
+                    Rounding rounding(precisions[p], Rounding::Closest);
+                    Real r = rounding(values[i]);
+                    char buf[64];
+                    snprintf(buf, sizeof(buf), "%.*f", rounding.precision(), close_enough(r, 0.0) ? 0.0 : r);
+                    expected += buf;
+                }
+            }
+        }
+        report.end();
+        expected += "\n";
+    }
+
+    std::ifstream in(file.string().c_str());
+    string written((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    boost::filesystem::remove(file);
+
+    BOOST_CHECK_EQUAL(written, expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
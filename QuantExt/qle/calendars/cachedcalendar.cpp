@@ -0,0 +1,164 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ql/errors.hpp>
+#include <qle/calendars/cachedcalendar.hpp>
+
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+
+using namespace QuantLib;
+
+namespace QuantExt {
+
+namespace {
+
+inline Size popcount(boost::uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<Size>(__builtin_popcountll(x));
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<Size>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// gives access to the implementation shared by the copies of a calendar
+class CalendarImplAccess : public Calendar {
+public:
+    explicit CalendarImplAccess(const Calendar& calendar) : Calendar(calendar) {}
+    const boost::shared_ptr<Calendar::Impl>& impl() const { return impl_; }
+};
+
+} // namespace
+
+CachedCalendar::Impl::Impl(const Calendar& calendar, Year firstYear, Year lastYear) : calendar_(calendar) {
+    QL_REQUIRE(!calendar_.empty(), "CachedCalendar: no calendar given");
+    QL_REQUIRE(firstYear <= lastYear,
+               "CachedCalendar: first year (" << firstYear << ") must not be after last year (" << lastYear << ")");
+    first_ = Date(1, January, firstYear).serialNumber();
+    size_ = static_cast<Size>(Date(31, December, lastYear).serialNumber() - first_ + 1);
+    bits_.resize((size_ + 63) / 64, 0);
+    for (Size i = 0; i < size_; ++i) {
+        if (calendar_.isBusinessDay(date(i)))
+            bits_[i / 64] |= boost::uint64_t(1) << (i % 64);
+    }
+    counts_.resize(bits_.size() + 1, 0);
+    for (Size w = 0; w < bits_.size(); ++w)
+        counts_[w + 1] = counts_[w] + popcount(bits_[w]);
+}
+
+bool CachedCalendar::Impl::isBusinessDay(const Date& d) const {
+    if (!inRange(d))
+        return calendar_.isBusinessDay(d);
+    Size i = index(d);
+    return (bits_[i / 64] >> (i % 64)) & 1;
+}
+
+Size CachedCalendar::Impl::rank(Size i) const {
+    Size w = i / 64, b = i % 64;
+    if (b == 0)
+        return counts_[w];
+    return counts_[w] + popcount(bits_[w] & ((boost::uint64_t(1) << b) - 1));
+}
+
+Size CachedCalendar::Impl::select(Size r) const {
+    if (r >= counts_.back())
+        return size_;
+    // the last word with less than r + 1 business days before it contains the business day
+    Size w = std::upper_bound(counts_.begin(), counts_.end(), r) - counts_.begin() - 1;
+    boost::uint64_t x = bits_[w];
+    for (Size k = counts_[w]; k < r; ++k)
+        x &= x - 1;
+    // position of the lowest set bit
+    return w * 64 + popcount((x & (~x + 1)) - 1);
+}
+
+CachedCalendar::CachedCalendar(const Calendar& calendar, Year firstYear, Year lastYear) {
+    cachedImpl_ = boost::make_shared<CachedCalendar::Impl>(calendar, firstYear, lastYear);
+    impl_ = cachedImpl_;
+}
+
+CachedCalendar::CachedCalendar(const boost::shared_ptr<Impl>& impl) : cachedImpl_(impl) { impl_ = cachedImpl_; }
+
+boost::shared_ptr<CachedCalendar::Impl> CachedCalendar::cachedImpl(const Calendar& calendar) {
+    return boost::dynamic_pointer_cast<CachedCalendar::Impl>(CalendarImplAccess(calendar).impl());
+}
+
+BigInteger CachedCalendar::businessDaysBetween(const Date& from, const Date& to, bool includeFirst,
+                                               bool includeLast) const {
+    if (cachedImpl_->adjusted() || !cachedImpl_->inRange(from) || !cachedImpl_->inRange(to))
+        return Calendar::businessDaysBetween(from, to, includeFirst, includeLast);
+    bool fromIsBusinessDay = cachedImpl_->isBusinessDay(from);
+    if (from == to)
+        return includeFirst && includeLast && fromIsBusinessDay ? 1 : 0;
+    Size lo = cachedImpl_->index(std::min(from, to)), hi = cachedImpl_->index(std::max(from, to));
+    BigInteger wd = static_cast<BigInteger>(cachedImpl_->rank(hi + 1) - cachedImpl_->rank(lo));
+    if (fromIsBusinessDay && !includeFirst)
+        --wd;
+    if (cachedImpl_->isBusinessDay(to) && !includeLast)
+        --wd;
+    return from > to ? -wd : wd;
+}
+
+Date CachedCalendar::advance(const Date& d, Integer n) const {
+    if (n == 0)
+        return adjust(d, Following);
+    if (cachedImpl_->adjusted() || !cachedImpl_->inRange(d))
+        return Calendar::advance(d, n, Days);
+    Size i;
+    if (n > 0) {
+        // the business days up to and including d are skipped
+        i = cachedImpl_->select(cachedImpl_->rank(cachedImpl_->index(d) + 1) + n - 1);
+    } else {
+        Size before = cachedImpl_->rank(cachedImpl_->index(d)), m = static_cast<Size>(-n);
+        i = before >= m ? cachedImpl_->select(before - m) : cachedImpl_->size();
+    }
+    // the result is outside the cached range
+    if (i == cachedImpl_->size())
+        return Calendar::advance(d, n, Days);
+    return cachedImpl_->date(i);
+}
+
+Date CachedCalendar::advance(const Date& d, Integer n, TimeUnit unit, BusinessDayConvention c,
+                             bool endOfMonth) const {
+    if (unit == Days && n != 0)
+        return advance(d, n);
+    return Calendar::advance(d, n, unit, c, endOfMonth);
+}
+
+Date CachedCalendar::advance(const Date& d, const Period& period, BusinessDayConvention c, bool endOfMonth) const {
+    return advance(d, period.length(), period.units(), c, endOfMonth);
+}
+
+Date cachedAdvance(const Calendar& calendar, const Date& d, Integer n, TimeUnit unit, BusinessDayConvention c,
+                   bool endOfMonth) {
+    boost::shared_ptr<CachedCalendar::Impl> impl = CachedCalendar::cachedImpl(calendar);
+    if (impl)
+        return CachedCalendar(impl).advance(d, n, unit, c, endOfMonth);
+    return calendar.advance(d, n, unit, c, endOfMonth);
+}
+
+Date cachedAdvance(const Calendar& calendar, const Date& d, const Period& period, BusinessDayConvention c,
+                   bool endOfMonth) {
+    return cachedAdvance(calendar, d, period.length(), period.units(), c, endOfMonth);
+}
+
+} // namespace QuantExt
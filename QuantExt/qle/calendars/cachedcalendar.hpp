@@ -0,0 +1,137 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file cachedcalendar.hpp
+    \brief Calendar with precomputed business days
+*/
+
+#ifndef quantext_cached_calendar_hpp
+#define quantext_cached_calendar_hpp
+
+#include <ql/time/calendar.hpp>
+
+#include <boost/cstdint.hpp>
+
+#include <vector>
+
+namespace QuantExt {
+
+//! Cached calendar
+/*! Wraps a calendar and precomputes its business days for the years \p firstYear to \p lastYear into a bitmap
+    with one bit per day. Within this range isBusinessDay() is a single table lookup, outside the range the
+    wrapped calendar is asked. Since the bitmap also stores the running number of business days, counting and
+    advancing by a number of business days do not need to step through the days, see businessDaysBetween() and
+    advance().
+
+    The holidays and business days added to the wrapped calendar before the construction of the cached calendar
+    are part of the bitmap, later modifications of the wrapped calendar are not seen inside the cached range.
+    Holidays added to or removed from the cached calendar itself are taken into account.
+
+    The name of the cached calendar is the name of the wrapped calendar, i.e. both calendars compare equal.
+
+    Copies of a cached calendar stored as a QuantLib::Calendar share the table for isBusinessDay(), use
+    cachedAdvance() to advance them by business days with table lookups.
+
+    \ingroup calendars
+*/
+class CachedCalendar : public QuantLib::Calendar {
+private:
+    class Impl : public Calendar::Impl {
+    public:
+        Impl(const QuantLib::Calendar& calendar, QuantLib::Year firstYear, QuantLib::Year lastYear);
+        std::string name() const { return calendar_.name(); }
+        bool isWeekend(QuantLib::Weekday w) const { return calendar_.isWeekend(w); }
+        bool isBusinessDay(const QuantLib::Date&) const;
+
+        //! true if the cached calendar itself has added or removed holidays
+        bool adjusted() const { return !addedHolidays.empty() || !removedHolidays.empty(); }
+        //! true if d is in the cached range
+        bool inRange(const QuantLib::Date& d) const {
+            return d.serialNumber() >= first_ && d.serialNumber() < first_ + static_cast<long>(size_);
+        }
+        //! number of business days in the cached range before the i-th day of the range
+        QuantLib::Size rank(QuantLib::Size i) const;
+        //! index of the business day with the given rank in the cached range, or size() if there is none
+        QuantLib::Size select(QuantLib::Size r) const;
+        //! index of d in the cached range
+        QuantLib::Size index(const QuantLib::Date& d) const { return d.serialNumber() - first_; }
+        QuantLib::Date date(QuantLib::Size i) const { return QuantLib::Date(first_ + static_cast<long>(i)); }
+        QuantLib::Size size() const { return size_; }
+
+    private:
+        QuantLib::Calendar calendar_;
+        QuantLib::BigInteger first_;
+        QuantLib::Size size_;
+        // one bit per day, set for business days
+        std::vector<boost::uint64_t> bits_;
+        // number of business days before each word of bits_
+        std::vector<QuantLib::Size> counts_;
+    };
+
+public:
+    explicit CachedCalendar(const QuantLib::Calendar& calendar, QuantLib::Year firstYear = 1950,
+                            QuantLib::Year lastYear = 2150);
+
+    using QuantLib::Calendar::advance;
+
+    //! same result as Calendar::businessDaysBetween(), counted with table lookups within the cached range
+    QuantLib::BigInteger businessDaysBetween(const QuantLib::Date& from, const QuantLib::Date& to,
+                                             bool includeFirst = true, bool includeLast = false) const;
+
+    /*! same result as Calendar::advance(d, n, Days, Following), i.e. the n-th business day after (n > 0)
+        or before (n < 0) d, found with table lookups within the cached range */
+    QuantLib::Date advance(const QuantLib::Date& d, QuantLib::Integer n) const;
+
+    //! see Calendar::advance(), uses the table lookups for unit Days
+    QuantLib::Date advance(const QuantLib::Date& d, QuantLib::Integer n, QuantLib::TimeUnit unit,
+                           QuantLib::BusinessDayConvention c = QuantLib::Following, bool endOfMonth = false) const;
+
+    //! see Calendar::advance(), uses the table lookups for a period in days
+    QuantLib::Date advance(const QuantLib::Date& d, const QuantLib::Period& period,
+                           QuantLib::BusinessDayConvention c = QuantLib::Following, bool endOfMonth = false) const;
+
+private:
+    // shares the table of another cached calendar
+    explicit CachedCalendar(const boost::shared_ptr<Impl>& impl);
+    // the table of calendar if it is a cached calendar or a copy of one, null otherwise
+    static boost::shared_ptr<Impl> cachedImpl(const QuantLib::Calendar& calendar);
+
+    friend QuantLib::Date cachedAdvance(const QuantLib::Calendar& calendar, const QuantLib::Date& d,
+                                        QuantLib::Integer n, QuantLib::TimeUnit unit,
+                                        QuantLib::BusinessDayConvention c, bool endOfMonth);
+
+    boost::shared_ptr<Impl> cachedImpl_;
+};
+
+/*! Same as calendar.advance(d, n, unit, c, endOfMonth). Calendar::advance() is not virtual, so a cached calendar
+    that was copied into a QuantLib::Calendar, e.g. a calendar returned by ore::data::parseCalendar(), steps
+    through the days again. This function recognises such copies and uses the table lookups of the cached
+    calendar. Other calendars are advanced as usual.
+*/
+QuantLib::Date cachedAdvance(const QuantLib::Calendar& calendar, const QuantLib::Date& d, QuantLib::Integer n,
+                             QuantLib::TimeUnit unit, QuantLib::BusinessDayConvention c = QuantLib::Following,
+                             bool endOfMonth = false);
+
+//! Same as calendar.advance(d, period, c, endOfMonth), see above
+QuantLib::Date cachedAdvance(const QuantLib::Calendar& calendar, const QuantLib::Date& d,
+                             const QuantLib::Period& period, QuantLib::BusinessDayConvention c = QuantLib::Following,
+                             bool endOfMonth = false);
+
+} // namespace QuantExt
+
+#endif
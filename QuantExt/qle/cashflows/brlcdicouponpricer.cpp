@@ -38,7 +38,7 @@ Rate BRLCdiCouponPricer::swapletRate() const {
 
     // Already fixed part of the coupon
     while (i < n && fixingDates[i] < today) {
-        Rate pastFixing = IndexManager::instance().getHistory(index_->name())[fixingDates[i]];
+        Rate pastFixing = historicalFixing(fixingDates[i]);
         QL_REQUIRE(pastFixing != Null<Real>(), "Missing " << index_->name() << " fixing for " << fixingDates[i]);
         compoundFactor *= pow(1.0 + pastFixing, dt[i]);
         ++i;
@@ -47,7 +47,7 @@ Rate BRLCdiCouponPricer::swapletRate() const {
     // Today is a border case. If there is a fixing use it. If not, it will be projected in the next block.
     if (i < n && fixingDates[i] == today) {
         try {
-            Rate pastFixing = IndexManager::instance().getHistory(index_->name())[fixingDates[i]];
+            Rate pastFixing = historicalFixing(fixingDates[i]);
             if (pastFixing != Null<Real>()) {
                 compoundFactor *= pow(1.0 + pastFixing, dt[i]);
                 ++i;
@@ -85,6 +85,11 @@ void BRLCdiCouponPricer::initialize(const FloatingRateCoupon& coupon) {
     QL_REQUIRE(index_, "BRLCdiCouponPricer epxects the coupon's index to be BRLCdi");
 }
 
+Real BRLCdiCouponPricer::historicalFixing(const Date& d) const {
+    // the QuantExt coupon reads through its fixing history, i.e. from the current fixing overlay if there is one
+    return couponQle_ ? couponQle_->fixingHistory().fixing(d) : IndexManager::instance().getHistory(index_->name())[d];
+}
+
 Real BRLCdiCouponPricer::swapletPrice() const { QL_FAIL("swapletPrice not implemented for BRLCdiCouponPricer"); }
 
 Real BRLCdiCouponPricer::capletPrice(Rate effectiveCap) const {
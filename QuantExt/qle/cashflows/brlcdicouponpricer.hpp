@@ -32,6 +32,8 @@
 namespace QuantExt {
 
 //! BRL CDI coupon pricer
+/*! The past fixings of a QuantExt::OvernightIndexedCoupon are read through the coupon's FixingHistory, i.e. from
+    the fixing overlay that is current on the thread if there is one. */
 
 class BRLCdiCouponPricer : public QuantLib::FloatingRateCouponPricer {
 public:
@@ -55,6 +57,9 @@ private:
 
     //! The index underlying the coupon to be priced
     boost::shared_ptr<BRLCdi> index_;
+
+    //! Past fixing of the index for the date
+    QuantLib::Real historicalFixing(const QuantLib::Date& d) const;
 };
 
 } // namespace QuantExt
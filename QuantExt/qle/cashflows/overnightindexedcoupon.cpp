@@ -37,6 +37,7 @@
  FOR A PARTICULAR PURPOSE.  See the license for more details.
 */
 
+#include <qle/cashflows/brlcdicouponpricer.hpp>
 #include <qle/cashflows/overnightindexedcoupon.hpp>
 
 #include <ql/cashflows/cashflowvectors.hpp>
@@ -78,7 +79,7 @@ public:
         Date today = Settings::instance().evaluationDate();
         while (i < n && fixingDates[std::min(i, nCutoff)] < today) {
             // rate must have been fixed
-            Rate pastFixing = IndexManager::instance().getHistory(index->name())[fixingDates[std::min(i, nCutoff)]];
+            Rate pastFixing = coupon_->fixingHistory().fixing(fixingDates[std::min(i, nCutoff)]);
             QL_REQUIRE(pastFixing != Null<Real>(),
                        "Missing " << index->name() << " fixing for " << fixingDates[std::min(i, nCutoff)]);
             if (coupon_->includeSpread()) {
@@ -93,7 +94,7 @@ public:
         if (i < n && fixingDates[std::min(i, nCutoff)] == today) {
             // might have been fixed
             try {
-                Rate pastFixing = IndexManager::instance().getHistory(index->name())[fixingDates[std::min(i, nCutoff)]];
+                Rate pastFixing = coupon_->fixingHistory().fixing(fixingDates[std::min(i, nCutoff)]);
                 if (pastFixing != Null<Real>()) {
                     if (coupon_->includeSpread()) {
                         compoundFactorWithoutSpread *= (1.0 + pastFixing * dt[i]);
@@ -201,7 +202,8 @@ OvernightIndexedCoupon::OvernightIndexedCoupon(const Date& paymentDate, Real nom
                                                const Natural fixingDays)
     : FloatingRateCoupon(paymentDate, nominal, startDate, endDate, fixingDays, overnightIndex, gearing, spread,
                          refPeriodStart, refPeriodEnd, dayCounter, false),
-      includeSpread_(includeSpread), lookback_(lookback), rateCutoff_(rateCutoff) {
+      includeSpread_(includeSpread), lookback_(lookback), rateCutoff_(rateCutoff),
+      fixingHistory_(overnightIndex->name()) {
 
     QL_REQUIRE(!includeSpread || close_enough(gearing, 1.0),
                "OvernightIndexedCoupon does not support includeSpread with non-unit gearing (got " << gearing << ")");
@@ -293,6 +295,11 @@ const vector<Rate>& OvernightIndexedCoupon::indexFixings() const {
     return fixings_;
 }
 
+bool OvernightIndexedCoupon::readsFixingHistory() const {
+    return ext::dynamic_pointer_cast<OvernightIndexedCouponPricer>(pricer()) != nullptr ||
+           ext::dynamic_pointer_cast<BRLCdiCouponPricer>(pricer()) != nullptr;
+}
+
 void OvernightIndexedCoupon::accept(AcyclicVisitor& v) {
     Visitor<OvernightIndexedCoupon>* v1 = dynamic_cast<Visitor<OvernightIndexedCoupon>*>(&v);
     if (v1 != 0) {
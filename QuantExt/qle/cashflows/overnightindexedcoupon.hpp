@@ -48,6 +48,7 @@
 #include <ql/cashflows/floatingratecoupon.hpp>
 #include <ql/indexes/iborindex.hpp>
 #include <ql/time/schedule.hpp>
+#include <qle/indexes/fixinghistory.hpp>
 
 namespace QuantLib {
 class OptionletVolatilityStructure;
@@ -100,6 +101,10 @@ public:
     const Period& lookback() const { return lookback_; }
     //! rate cutoff
     Natural rateCutoff() const { return rateCutoff_; }
+    //! past fixings of the overnight index
+    const FixingHistory& fixingHistory() const { return fixingHistory_; }
+    //! true if the attached pricer reads the past fixings through fixingHistory()
+    bool readsFixingHistory() const;
     //@}
     //! \name FloatingRateCoupon interface
     //@{
@@ -118,6 +123,7 @@ private:
     bool includeSpread_;
     Period lookback_;
     Natural rateCutoff_;
+    FixingHistory fixingHistory_;
 };
 
 //! capped floored overnight indexed coupon
@@ -0,0 +1,104 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/indexes/fixinghistory.hpp>
+
+#include <ql/errors.hpp>
+#include <ql/indexes/indexmanager.hpp>
+
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include <mutex>
+
+namespace QuantExt {
+
+namespace {
+
+// handles are only created when coupons and indices are built, the reads do not need the lock
+std::mutex& handleMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::map<std::string, Size>& handles() {
+    static std::map<std::string, Size> handles;
+    return handles;
+}
+
+thread_local const FixingOverlay* currentOverlay = nullptr;
+
+} // namespace
+
+Size FixingOverlay::handle(const std::string& indexName) {
+    std::string name = boost::algorithm::to_upper_copy(indexName);
+    std::lock_guard<std::mutex> lock(handleMutex());
+    auto it = handles().find(name);
+    if (it == handles().end())
+        it = handles().insert(std::make_pair(name, handles().size())).first;
+    return it->second;
+}
+
+void FixingOverlay::addFixing(Size handle, const Date& d, Real value) {
+    QL_REQUIRE(handle != Null<Size>(), "FixingOverlay: invalid handle");
+    if (handle >= fixings_.size())
+        fixings_.resize(handle + 1);
+    auto r = fixings_[handle].insert(std::make_pair(d, value));
+    if (r.second)
+        ++size_;
+    else
+        r.first->second = value;
+}
+
+Real FixingOverlay::fixing(Size handle, const Date& d) const {
+    if (handle >= fixings_.size())
+        return Null<Real>();
+    auto it = fixings_[handle].find(d);
+    return it == fixings_[handle].end() ? Null<Real>() : it->second;
+}
+
+void FixingOverlay::clear() {
+    // the containers are kept, they are usually refilled with the fixings of the next path
+    for (auto& f : fixings_)
+        f.clear();
+    size_ = 0;
+}
+
+const FixingOverlay* FixingOverlay::current() { return currentOverlay; }
+
+FixingOverlayScope::FixingOverlayScope(const FixingOverlay* overlay) : previous_(currentOverlay) {
+    currentOverlay = overlay;
+}
+
+FixingOverlayScope::~FixingOverlayScope() { currentOverlay = previous_; }
+
+FixingHistory::FixingHistory(const std::string& indexName)
+    : name_(boost::algorithm::to_upper_copy(indexName)), handle_(FixingOverlay::handle(name_)),
+      history_(&IndexManager::instance().getHistory(name_)) {}
+
+Real FixingHistory::fixing(const Date& d) const {
+    if (currentOverlay != nullptr && currentOverlay->size() > 0) {
+        Real f = currentOverlay->fixing(handle_, d);
+        if (f != Null<Real>())
+            return f;
+    }
+    if (history_ != nullptr)
+        return (*history_)[d];
+    return IndexManager::instance().getHistory(name_)[d];
+}
+
+} // namespace QuantExt
@@ -0,0 +1,115 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/indexes/fixinghistory.hpp
+    \brief fixing overlays on top of the historical fixings of the IndexManager
+    \ingroup indexes
+*/
+
+#ifndef quantext_fixinghistory_hpp
+#define quantext_fixinghistory_hpp
+
+#include <ql/time/date.hpp>
+#include <ql/timeseries.hpp>
+#include <ql/utilities/null.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace QuantExt {
+using namespace QuantLib;
+
+//! Fixings of a valuation context on top of the historical fixings
+/*! An overlay holds e.g. the simulated fixings of one valuation worker, so that concurrent workers do not write to
+    the global IndexManager. The historical fixings are not copied, readers look into the overlay that is current on
+    their thread (see FixingOverlayScope) first and into the IndexManager otherwise.
+
+    The indices are identified by integer handles, which are shared by all overlays.
+
+    \ingroup indexes
+*/
+class FixingOverlay {
+public:
+    FixingOverlay() : size_(0) {}
+
+    //! Handle of the index with the given name, the name is not case sensitive as in the IndexManager
+    static Size handle(const std::string& indexName);
+
+    //! Add a fixing, an existing fixing for the date is overwritten
+    void addFixing(Size handle, const Date& d, Real value);
+    //! Fixing for the date, Null<Real>() if the overlay has none
+    Real fixing(Size handle, const Date& d) const;
+    //! Remove all fixings
+    void clear();
+    //! Number of fixings
+    Size size() const { return size_; }
+
+    //! Overlay that is current on this thread, null if none
+    static const FixingOverlay* current();
+
+private:
+    friend class FixingOverlayScope;
+    std::vector<std::map<Date, Real>> fixings_;
+    Size size_;
+};
+
+//! Makes an overlay the current one of this thread for the lifetime of the scope
+/*! The previously current overlay is restored at the end of the scope, a null overlay can be given to read the
+    IndexManager only.
+
+    \ingroup indexes
+*/
+class FixingOverlayScope : boost::noncopyable {
+public:
+    explicit FixingOverlayScope(const FixingOverlay* overlay);
+    ~FixingOverlayScope();
+
+private:
+    const FixingOverlay* previous_;
+};
+
+//! Past fixings of an index, resolved once to an overlay handle and to the history in the IndexManager
+/*! The IndexManager keeps the address of a history when fixings are added or the history is overwritten, so the
+    history is looked up by name only once. Objects holding a FixingHistory must not be used after the history was
+    removed with IndexManager::clearHistory() or clearHistories().
+
+    \ingroup indexes
+*/
+class FixingHistory {
+public:
+    FixingHistory() : handle_(Null<Size>()), history_(nullptr) {}
+    explicit FixingHistory(const std::string& indexName);
+
+    //! Fixing for the date from the current overlay if it has one, otherwise from the IndexManager
+    Real fixing(const Date& d) const;
+
+    const std::string& name() const { return name_; }
+    Size handle() const { return handle_; }
+
+private:
+    std::string name_;
+    Size handle_;
+    const TimeSeries<Real>* history_;
+};
+
+} // namespace QuantExt
+
+#endif
@@ -44,6 +44,7 @@ FxIndex::FxIndex(const std::string& familyName, Natural fixingDays, const Curren
     std::ostringstream tmp;
     tmp << familyName_ << " " << sourceCurrency_.code() << "/" << targetCurrency_.code();
     name_ = tmp.str();
+    fixingHistory_ = FixingHistory(name_);
     registerWith(Settings::instance().evaluationDate());
     registerWith(IndexManager::instance().notifier(name()));
     registerWith(sourceYts_);
@@ -65,6 +66,7 @@ FxIndex::FxIndex(const std::string& familyName, Natural fixingDays, const Curren
     std::ostringstream tmp;
     tmp << familyName_ << " " << sourceCurrency_.code() << "/" << targetCurrency_.code();
     name_ = tmp.str();
+    fixingHistory_ = FixingHistory(name_);
     registerWith(Settings::instance().evaluationDate());
     registerWith(IndexManager::instance().notifier(name()));
     registerWith(fxQuote_);
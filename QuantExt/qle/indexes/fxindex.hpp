@@ -44,6 +44,7 @@
 #include <ql/index.hpp>
 #include <ql/termstructures/yieldtermstructure.hpp>
 #include <ql/time/calendar.hpp>
+#include <qle/indexes/fixinghistory.hpp>
 namespace QuantExt {
 using namespace QuantLib;
 
@@ -107,6 +108,7 @@ protected:
 private:
     Calendar fixingCalendar_;
     bool inverseIndex_;
+    FixingHistory fixingHistory_;
 };
 
 // inline definitions
@@ -131,7 +133,7 @@ inline Date FxIndex::valueDate(const Date& fixingDate) const {
 
 inline Real FxIndex::pastFixing(const Date& fixingDate) const {
     QL_REQUIRE(isValidFixingDate(fixingDate), fixingDate << " is not a valid fixing date");
-    return timeSeries()[fixingDate];
+    return fixingHistory_.fixing(fixingDate);
 }
 } // namespace QuantExt
 
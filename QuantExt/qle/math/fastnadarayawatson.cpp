@@ -0,0 +1,144 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/fastnadarayawatson.hpp>
+
+#include <ql/math/comparison.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace QuantExt {
+
+void FastNadarayaWatson::initialise(const std::vector<Real>& x, const std::vector<Real>& y,
+                                    Size gridPointsPerSupport) {
+    QL_REQUIRE(support_ > 0.0, "FastNadarayaWatson: support (" << support_ << ") must be positive");
+    QL_REQUIRE(gridPointsPerSupport > 0, "FastNadarayaWatson: grid points per support must be positive");
+
+    Size n = x.size();
+    std::vector<Size> order(n);
+    for (Size i = 0; i < n; ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&x](Size i, Size j) { return x[i] < x[j]; });
+    x_.resize(n);
+    y_.resize(n);
+    for (Size i = 0; i < n; ++i) {
+        x_[i] = x[order[i]];
+        y_[i] = y[order[i]];
+    }
+
+    binned_ = false;
+    if (n == 0)
+        return;
+
+    // number of kernel evaluations with truncated windows when evaluating at all samples
+    Real windowCost = 0.0;
+    for (Size i = 0, lo = 0, hi = 0; i < n; ++i) {
+        while (x_[lo] < x_[i] - support_)
+            ++lo;
+        while (hi < n && x_[hi] <= x_[i] + support_)
+            ++hi;
+        windowCost += static_cast<Real>(hi - lo);
+    }
+
+    // grid covering the samples plus the support on both sides and the resulting convolution effort
+    Size l = gridPointsPerSupport;
+    Real step = support_ / static_cast<Real>(l);
+    Real nodes = std::floor((x_.back() - x_.front()) / step) + static_cast<Real>(2 * l + 2);
+    if (nodes * static_cast<Real>(2 * l + 1) >= windowCost)
+        return;
+
+    binned_ = true;
+    gridStep_ = step;
+    gridStart_ = x_.front() - static_cast<Real>(l) * step;
+    Size m = static_cast<Size>(nodes);
+
+    // linear binning
+    std::vector<Real> c0(m, 0.0), c1(m, 0.0), c2(m, 0.0);
+    for (Size i = 0; i < n; ++i) {
+        Real p = (x_[i] - gridStart_) / gridStep_;
+        Size k = std::min(static_cast<Size>(p), m - 2);
+        Real w = p - static_cast<Real>(k);
+        c0[k] += 1.0 - w;
+        c0[k + 1] += w;
+        c1[k] += (1.0 - w) * y_[i];
+        c1[k + 1] += w * y_[i];
+        c2[k] += (1.0 - w) * y_[i] * y_[i];
+        c2[k + 1] += w * y_[i] * y_[i];
+    }
+
+    // kernel weights for the node offsets -l, ..., l
+    std::vector<Real> weights(2 * l + 1);
+    for (Size o = 0; o < weights.size(); ++o)
+        weights[o] = kernel_((static_cast<Real>(o) - static_cast<Real>(l)) * gridStep_);
+
+    // discrete convolution, node k collects the binned samples at nodes k - l, ..., k + l
+    s0_.assign(m, 0.0);
+    s1_.assign(m, 0.0);
+    s2_.assign(m, 0.0);
+    for (Size j = 0; j < m; ++j) {
+        if (c0[j] == 0.0)
+            continue;
+        Size kBegin = j < l ? 0 : j - l, kEnd = std::min(j + l + 1, m);
+        for (Size k = kBegin; k < kEnd; ++k) {
+            // kernel argument is node k minus node j
+            Real w = weights[k + l - j];
+            s0_[k] += w * c0[j];
+            s1_[k] += w * c1[j];
+            s2_[k] += w * c2[j];
+        }
+    }
+}
+
+void FastNadarayaWatson::sums(Real x, Real& s0, Real& s1, Real& s2) const {
+    s0 = s1 = s2 = 0.0;
+    if (binned_) {
+        Real p = (x - gridStart_) / gridStep_;
+        if (!(p >= 0.0 && p < static_cast<Real>(s0_.size() - 1)))
+            return;
+        Size k = static_cast<Size>(p);
+        Real w = p - static_cast<Real>(k);
+        s0 = (1.0 - w) * s0_[k] + w * s0_[k + 1];
+        s1 = (1.0 - w) * s1_[k] + w * s1_[k + 1];
+        s2 = (1.0 - w) * s2_[k] + w * s2_[k + 1];
+    } else {
+        std::vector<Real>::const_iterator lo = std::lower_bound(x_.begin(), x_.end(), x - support_);
+        std::vector<Real>::const_iterator hi = std::upper_bound(lo, x_.end(), x + support_);
+        for (Size i = lo - x_.begin(); i < static_cast<Size>(hi - x_.begin()); ++i) {
+            Real tmp = kernel_(x - x_[i]);
+            s0 += tmp;
+            s1 += y_[i] * tmp;
+            s2 += y_[i] * y_[i] * tmp;
+        }
+    }
+}
+
+Real FastNadarayaWatson::operator()(Real x) const {
+    Real s0, s1, s2;
+    sums(x, s0, s1, s2);
+    return QuantLib::close_enough(s0, 0.0) ? 0.0 : s1 / s0;
+}
+
+Real FastNadarayaWatson::standardDeviation(Real x) const {
+    Real s0, s1, s2;
+    sums(x, s0, s1, s2);
+    // the binning might produce a slightly negative variance
+    return QuantLib::close_enough(s0, 0.0) ? 0.0 : std::sqrt(std::max(s2 / s0 - (s1 * s1) / (s0 * s0), 0.0));
+}
+
+} // namespace QuantExt
@@ -0,0 +1,95 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/fastnadarayawatson.hpp
+    \brief Nadaraya-Watson regression with truncated kernel support
+    \ingroup math
+*/
+
+#ifndef quantext_fast_nadaraya_watson_regression_hpp
+#define quantext_fast_nadaraya_watson_regression_hpp
+
+#include <ql/errors.hpp>
+#include <ql/types.hpp>
+
+#include <boost/function.hpp>
+
+#include <vector>
+
+namespace QuantExt {
+using QuantLib::Real;
+using QuantLib::Size;
+
+//! Fast Nadaraya Watson regression
+/*! This implements the same estimator as NadarayaWatson, for a kernel that is treated as zero outside
+    \f$ [-s, s] \f$ where \f$ s \f$ is the given support, e.g. a few bandwidths for a gaussian kernel.
+
+    The samples are sorted once on construction. Then one of two evaluation schemes is chosen, whichever is
+    cheaper for an evaluation at all sample points:
+
+    - truncated windows: the kernel sums run over the samples within \f$ [x-s, x+s] \f$ only, which are
+      found by binary search; the result coincides with NadarayaWatson up to the kernel truncation
+    - linear binning: the samples are distributed to an equidistant grid with \p gridPointsPerSupport
+      points per support length, the kernel sums are convolved on the grid once and linearly interpolated
+      on evaluation; the error is of second order in the grid step
+
+    For a bandwidth that is small compared to the spread of the samples the windows are small, for a large
+    bandwidth the grid is small, so that both the construction and the evaluation at all samples are
+    cheap in either case, as opposed to the quadratic effort of NadarayaWatson.
+
+    \ingroup math
+*/
+class FastNadarayaWatson {
+public:
+    /*! \pre kernel needs a Real operator()(Real x) implementation
+        \pre the \f$ x \f$ values need not be sorted
+    */
+    template <class I1, class I2, class Kernel>
+    FastNadarayaWatson(const I1& xBegin, const I1& xEnd, const I2& yBegin, const Kernel& kernel, Real support,
+                       Size gridPointsPerSupport = 64)
+        : kernel_(kernel), support_(support) {
+        std::vector<Real> x(xBegin, xEnd);
+        std::vector<Real> y(yBegin, yBegin + x.size());
+        initialise(x, y, gridPointsPerSupport);
+    }
+
+    Real operator()(Real x) const;
+
+    Real standardDeviation(Real x) const;
+
+    //! true if the linear binning scheme is used, false if the truncated windows are used
+    bool binned() const { return binned_; }
+
+private:
+    void initialise(const std::vector<Real>& x, const std::vector<Real>& y, Size gridPointsPerSupport);
+    // sums of the kernel weights, the weighted y and the weighted y^2 at x
+    void sums(Real x, Real& s0, Real& s1, Real& s2) const;
+
+    boost::function<Real(Real)> kernel_;
+    Real support_;
+    bool binned_;
+    // samples sorted by x, used for the truncated windows
+    std::vector<Real> x_, y_;
+    // kernel sums on the grid, used for the linear binning
+    Real gridStart_, gridStep_;
+    std::vector<Real> s0_, s1_, s2_;
+};
+
+} // namespace QuantExt
+
+#endif
@@ -26,27 +26,72 @@ namespace QuantExt {
 
 MultiPathGeneratorMersenneTwister::MultiPathGeneratorMersenneTwister(
     const boost::shared_ptr<StochasticProcess>& process, const TimeGrid& grid, BigNatural seed, bool antitheticSampling)
-    : process_(process), grid_(grid), seed_(seed), antitheticSampling_(antitheticSampling), antitheticVariate_(true) {
+    : process_(process), grid_(grid), seed_(seed), antitheticSampling_(antitheticSampling), antitheticVariate_(true),
+      next_(MultiPath(process->size(), grid), 1.0) {
     reset();
 }
 
 void MultiPathGeneratorMersenneTwister::reset() {
-    PseudoRandom::rsg_type rsg = PseudoRandom::make_sequence_generator(process_->size() * (grid_.size() - 1), seed_);
-    pg_ = boost::make_shared<MultiPathGenerator<PseudoRandom::rsg_type> >(process_, grid_, rsg, false);
+    rsg_ = boost::make_shared<PseudoRandom::rsg_type>(
+        PseudoRandom::make_sequence_generator(process_->size() * (grid_.size() - 1), seed_));
+    antitheticVariate_ = true;
+}
+
+void MultiPathGeneratorMersenneTwister::skip(Size n) {
+    // number of new sequences among the next n paths, every second path is antithetic if antithetic sampling is on
+    Size draws = n;
+    if (antitheticSampling_) {
+        draws = antitheticVariate_ ? (n + 1) / 2 : n / 2;
+        if (n % 2 == 1)
+            antitheticVariate_ = !antitheticVariate_;
+    }
+    // a subsequent antithetic path is built from the last sequence drawn here
+    for (Size i = 0; i < draws; ++i)
+        rsg_->nextSequence();
+}
+
+void MultiPathGeneratorMersenneTwister::evolve(const PseudoRandom::rsg_type::sample_type& sequence,
+                                               bool antithetic) const {
+    MultiPath& path = next_.value;
+    Array asset = process_->initialValues();
+    for (Size j = 0; j < asset.size(); ++j)
+        path[j].front() = asset[j];
+    next_.weight = sequence.weight;
+    Size factors = process_->factors();
+    Array dw(factors);
+    for (Size i = 1; i < grid_.size(); ++i) {
+        Size offset = (i - 1) * factors;
+        for (Size k = 0; k < factors; ++k)
+            dw[k] = antithetic ? -sequence.value[offset + k] : sequence.value[offset + k];
+        asset = process_->evolve(grid_[i - 1], asset, grid_.dt(i - 1), dw);
+        for (Size j = 0; j < asset.size(); ++j)
+            path[j][i] = asset[j];
+    }
 }
 
 MultiPathGeneratorSobol::MultiPathGeneratorSobol(const boost::shared_ptr<StochasticProcess>& process,
                                                  const TimeGrid& grid, BigNatural seed,
                                                  SobolRsg::DirectionIntegers directionIntegers)
-    : process_(process), grid_(grid), seed_(seed), directionIntegers_(directionIntegers) {
+    : process_(process), grid_(grid), seed_(seed), directionIntegers_(directionIntegers), draws_(0) {
     reset();
 }
 
 void MultiPathGeneratorSobol::reset() {
+    rsg_ = boost::make_shared<SobolRsg>(process_->size() * (grid_.size() - 1), seed_, directionIntegers_);
+    pg_ = boost::make_shared<MultiPathGenerator<InverseCumulativeRsg<SobolRsg, InverseCumulativeNormal> > >(
+        process_, grid_, InverseCumulativeRsg<SobolRsg, InverseCumulativeNormal>(*rsg_));
+    draws_ = 0;
+}
+
+void MultiPathGeneratorSobol::skip(Size n) {
+    if (n == 0)
+        return;
+    // a fresh generator skipped to point m returns point m + 1 on its first draw
+    SobolRsg rsg(*rsg_);
+    rsg.skipTo(draws_ + n);
     pg_ = boost::make_shared<MultiPathGenerator<InverseCumulativeRsg<SobolRsg, InverseCumulativeNormal> > >(
-        process_, grid_,
-        InverseCumulativeRsg<SobolRsg, InverseCumulativeNormal>(
-            SobolRsg(process_->size() * (grid_.size() - 1), seed_, directionIntegers_)));
+        process_, grid_, InverseCumulativeRsg<SobolRsg, InverseCumulativeNormal>(rsg));
+    draws_ += n;
 }
 
 MultiPathGeneratorSobolBrownianBridge::MultiPathGeneratorSobolBrownianBridge(
@@ -62,6 +107,11 @@ void MultiPathGeneratorSobolBrownianBridge::reset() {
                                                       directionIntegers_);
 }
 
+void MultiPathGeneratorSobolBrownianBridge::skip(Size n) {
+    for (Size i = 0; i < n; ++i)
+        gen_->nextPath();
+}
+
 const Sample<MultiPath>& MultiPathGeneratorSobolBrownianBridge::next() const {
     Array asset = process_->initialValues();
     MultiPath& path = next_.value;
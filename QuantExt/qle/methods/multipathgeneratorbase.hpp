@@ -45,6 +45,12 @@ public:
     virtual ~MultiPathGeneratorBase() {}
     virtual const Sample<MultiPath>& next() const = 0;
     virtual void reset() = 0;
+    /*! Skip the next n paths, e.g. to resume an interrupted simulation. The default implementation generates and
+        discards the paths, so that the following paths are identical to the ones of an uninterrupted run. */
+    virtual void skip(Size n) {
+        for (Size i = 0; i < n; ++i)
+            next();
+    }
 };
 
 //! Instantiation of MultiPathGenerator with standard PseudoRandom traits
@@ -56,15 +62,23 @@ public:
                                       bool antitheticSampling = false);
     const Sample<MultiPath>& next() const;
     void reset();
+    /*! Skips the paths by drawing their random sequences without evolving the process. The sequence generator is
+        advanced from its current state, i.e. skipping n paths costs n draws, or n / 2 with antithetic sampling,
+        independent of the number of paths generated before. */
+    void skip(Size n);
 
 private:
+    // builds the path from a sequence as QuantLib's MultiPathGenerator does
+    void evolve(const PseudoRandom::rsg_type::sample_type& sequence, bool antithetic) const;
+
     const boost::shared_ptr<StochasticProcess> process_;
     TimeGrid grid_;
     BigNatural seed_;
 
-    boost::shared_ptr<MultiPathGenerator<PseudoRandom::rsg_type> > pg_;
+    boost::shared_ptr<PseudoRandom::rsg_type> rsg_;
     bool antitheticSampling_;
     mutable bool antitheticVariate_;
+    mutable Sample<MultiPath> next_;
 };
 
 //! Instantiation of MultiPathGenerator with standard LowDiscrepancy traits
@@ -79,6 +93,8 @@ public:
                             SobolRsg::DirectionIntegers directionIntegers = SobolRsg::JoeKuoD7);
     const Sample<MultiPath>& next() const;
     void reset();
+    //! Skips the paths using the skip ahead of the Sobol sequence
+    void skip(Size n);
 
 private:
     const boost::shared_ptr<StochasticProcess> process_;
@@ -86,7 +102,10 @@ private:
     BigNatural seed_;
     SobolRsg::DirectionIntegers directionIntegers_;
 
+    // the Sobol generator in its initial state, the path generators are built from copies of it
+    boost::shared_ptr<SobolRsg> rsg_;
     boost::shared_ptr<MultiPathGenerator<LowDiscrepancy::rsg_type> > pg_;
+    mutable Size draws_;
 };
 
 //! Instantiation using SobolBrownianGenerator from  models/marketmodels/browniangenerators
@@ -100,6 +119,8 @@ public:
                                           SobolRsg::DirectionIntegers directionIntegers = SobolRsg::JoeKuoD7);
     const Sample<MultiPath>& next() const;
     void reset();
+    //! Skips the paths by drawing their variates without evolving the process
+    void skip(Size n);
 
 private:
     const boost::shared_ptr<StochasticProcess> process_;
@@ -126,13 +147,19 @@ std::ostream& operator<<(std::ostream& out, const SequenceType s);
 inline const Sample<MultiPath>& MultiPathGeneratorMersenneTwister::next() const {
     if (antitheticSampling_) {
         antitheticVariate_ = !antitheticVariate_;
-        return antitheticVariate_ ? pg_->antithetic() : pg_->next();
-    } else {
-        return pg_->next();
+        if (antitheticVariate_) {
+            evolve(rsg_->lastSequence(), true);
+            return next_;
+        }
     }
+    evolve(rsg_->nextSequence(), false);
+    return next_;
 }
 
-inline const Sample<MultiPath>& MultiPathGeneratorSobol::next() const { return pg_->next(); }
+inline const Sample<MultiPath>& MultiPathGeneratorSobol::next() const {
+    ++draws_;
+    return pg_->next();
+}
 
 } // namespace QuantExt
 
@@ -3,13 +3,17 @@
  All rights reserved.
 */
 
-#include <ql/math/matrixutilities/pseudosqrt.hpp>
+#include <ql/math/matrixutilities/choleskydecomposition.hpp>
 #include <ql/pricingengines/blackformula.hpp>
 #include <ql/processes/ornsteinuhlenbeckprocess.hpp>
 #include <qle/cashflows/commodityindexedcashflow.hpp>
 #include <qle/methods/multipathgeneratorbase.hpp>
 #include <qle/pricingengines/commodityapoengine.hpp>
 
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+
 using std::adjacent_difference;
 using std::exp;
 using std::make_pair;
@@ -19,6 +23,12 @@ using std::pair;
 using std::set;
 using std::vector;
 
+namespace {
+// the cached random number blocks are dropped when they would exceed this size in bytes, the size of a block is
+// the number of samples times its dimension, so that a count of blocks does not bound the memory
+const QuantLib::Size maxCachedBytes = 256 * 1024 * 1024;
+} // namespace
+
 namespace QuantExt {
 
 CommodityAveragePriceOptionBaseEngine::CommodityAveragePriceOptionBaseEngine(
@@ -217,16 +227,11 @@ void CommodityAveragePriceOptionMonteCarloEngine::calculateSpot(const pair<Real,
     // Put call indicator
     Real omega = arguments_.type == Option::Call ? 1.0 : -1.0;
 
-    // Variable to hold the payoff
-    Real payoff = 0.0;
-
     // Vector of timesteps from today = t_0 out to last pricing date t_n
     // i.e. {t_1 - t_0, t_2 - t_1,..., t_n - t_{n-1}}
     vector<Date> dates;
     vector<Real> dt = timegrid(dates);
-
-    // On each Monte Carlo sample, we must generate the spot price process path over n time steps.
-    LowDiscrepancy::rsg_type rsg = LowDiscrepancy::make_sequence_generator(dt.size(), seed_);
+    Size n = dt.size();
 
     // We will read the volatility off the surface at the effective strike
     // We will only call this method when the effectiveStrike > 0 but will check anyway
@@ -234,60 +239,37 @@ void CommodityAveragePriceOptionMonteCarloEngine::calculateSpot(const pair<Real,
     QL_REQUIRE(effectiveStrike > 0.0, "calculateSpot: expected effectiveStrike to be positive");
 
     // Precalculate:
-    // exp(-1/2 forward variance over dt): \exp \left(-\frac{1}{2} \int_{t_{i-1}}^{t_i} \sigma^2(u) du \right)
-    // forward std dev over dt: \exp \left(\sqrt{\int_{t_{i-1}}^{t_i} \sigma^2(u) du} \right)
-    // forward ratio: \exp \left(\int_{t_{i-1}}^{t_i} r(u) - r_f(u) \, du \right) = \frac{F(0, t_i)}{F(0, t_{i-1})}
-    //                first period is multiplied by S(0)
-    // factors array is exp(-1/2 forward variance over dt) x forward ratio
-    Array expHalfFwdVar(dt.size(), 0.0);
-    Array fwdStdDev(dt.size(), 0.0);
-    Array fwdRatio(dt.size(), 0.0);
+    // -1/2 forward variance over dt: -\frac{1}{2} \int_{t_{i-1}}^{t_i} \sigma^2(u) du
+    // forward std dev over dt: \sqrt{\int_{t_{i-1}}^{t_i} \sigma^2(u) du}
+    // forward prices F(0, t_i)
+    vector<Real> halfFwdVar(n), fwdStdDev(n), forwards(n);
     Time t = 0.0;
-    for (Size i = 0; i < dt.size(); i++) {
+    for (Size i = 0; i < n; i++) {
         t += dt[i];
-        expHalfFwdVar[i] = volStructure_->blackForwardVariance(t - dt[i], t, effectiveStrike);
-        fwdStdDev[i] = sqrt(expHalfFwdVar[i]);
-        expHalfFwdVar[i] = exp(-expHalfFwdVar[i] / 2.0);
-        fwdRatio[i] = arguments_.flow->index()->fixing(dates[i + 1]);
-        if (i > 0) {
-            fwdRatio[i] /= arguments_.flow->index()->fixing(dates[i]);
-        }
+        Real fwdVar = volStructure_->blackForwardVariance(t - dt[i], t, effectiveStrike);
+        fwdStdDev[i] = sqrt(fwdVar);
+        halfFwdVar[i] = -fwdVar / 2.0;
+        forwards[i] = arguments_.flow->index()->fixing(dates[i + 1]);
     }
-    Array factors = expHalfFwdVar * fwdRatio;
 
-    // Loop over each sample
-    for (Size k = 0; k < samples_; k++) {
-
-        // Sequence is n independent standard normal random variables
-        vector<Real> sequence = rsg.nextSequence().value;
-
-        // Calculate payoff on this sample - price holds the evolved price
-        Real price = 0.0;
-        Real samplePayoff = 0.0;
-        Array path(sequence.begin(), sequence.end());
-        path = Exp(path * fwdStdDev) * factors;
-        for (Size i = 0; i < dt.size(); i++) {
-
-            // Update price
-            price = i == 0 ? path[i] : price * path[i];
-
-            // Update sum of the spot prices on the pricing dates after today
-            samplePayoff += price;
+    // The spot price on pricing date i is S(t_i) = F(0, t_i) \exp(x_i) with the exponent x_i accumulating
+    // -1/2 forward variance + forward std dev * z over the timesteps, z being n independent standard normal
+    // random variables on each sample.
+    boost::shared_ptr<const vector<Real>> normals = normalBlock(n);
+    const Real* z = &(*normals)[0];
+    buffer_.resize(samples_ * n);
+    Real* x = &buffer_[0];
+    for (Size k = 0; k < samples_; k++, z += n, x += n) {
+        Real sum = 0.0;
+        for (Size i = 0; i < n; i++) {
+            sum += halfFwdVar[i] + fwdStdDev[i] * z[i];
+            x[i] = sum;
         }
-
-        // Average price on this sample
-        samplePayoff /= dt.size();
-
-        // Finally, the payoff on this sample
-        samplePayoff = max(omega * (samplePayoff - effectiveStrike), 0.0);
-
-        // Update the final average
-        // Note: payoff * k / (k + 1) - left to right precedence => double division.
-        payoff = k == 0 ? samplePayoff : payoff * k / (k + 1) + samplePayoff / (k + 1);
     }
 
     // Populate the result value
-    results_.value = arguments_.quantity * arguments_.flow->gearing() * payoff * discount;
+    results_.value = arguments_.quantity * arguments_.flow->gearing() *
+                     averagePayoff(forwards, omega, effectiveStrike) * discount;
     results_.underlyingForwardValue = Null<Real>();
     results_.sigma = Null<Real>();
 }
@@ -300,9 +282,6 @@ void CommodityAveragePriceOptionMonteCarloEngine::calculateFuture(const pair<Rea
     // Put call indicator
     Real omega = arguments_.type == Option::Call ? 1.0 : -1.0;
 
-    // Variable to hold the payoff
-    Real payoff = 0.0;
-
     // We will read the volatility off the surface the effective strike
     // We will only call this method when the effectiveStrike > 0 but will check anyway
     Real effectiveStrike = arguments_.effectiveStrike - accrued.first;
@@ -319,74 +298,143 @@ void CommodityAveragePriceOptionMonteCarloEngine::calculateFuture(const pair<Rea
     // i.e. {t_1 - t_0, t_2 - t_1,..., t_n - t_{n-1}}. Don't need the dates here.
     vector<Date> dates;
     vector<Real> dt = timegrid(dates);
+    Size n = dt.size();
+
+    // The price of the future i_j = futureIndex[j] on pricing date j is
+    // F_{i_j}(t_j) = F_{i_j}(0) \exp(-\sigma_{i_j}^2 t_j / 2 + \sigma_{i_j} W_{i_j}(t_j))
+    // where the Brownian motions W_i of the N (size of vols) future contracts are correlated. They only depend on
+    // the pricing times and the futures, not on the volatilities, and are shared with other APOs on the same
+    // futures and pricing dates.
+    boost::shared_ptr<const vector<Real>> brownians = brownianBlock(dt, futureIndex, sqrtCorr);
+    vector<Real> drift(n), sigma(n), forwards(n);
+    Time t = 0.0;
+    for (Size j = 0; j < n; j++) {
+        t += dt[j];
+        Size i = futureIndex[j];
+        sigma[j] = vols[i];
+        drift[j] = -vols[i] * vols[i] * t / 2.0;
+        forwards[j] = prices[i];
+    }
 
-    // On each Monte Carlo sample, we must generate the paths for N (size of vols) future contracts where
-    // each path has n time steps. We will represent the paths with an N x n matrix. First step is to fill the
-    // matrix with N x n _independent_ standard normal variables. Then correlate the N variables in each column
-    // using the sqrtCorr matrix and then fill each entry F_{i, j} in the matrix with the value of the i-th
-    // future price process at timestep j. Note, we will possibly simulate contracts past their expiries but not
-    // use the price in the APO rate averaging.
-    LowDiscrepancy::rsg_type rsg = LowDiscrepancy::make_sequence_generator(vols.size() * dt.size(), seed_);
-
-    // Precalculate exp(-0.5 \sigma_i^2 \delta t_j) and std dev = sqrt(\delta t_j) \sigma_i
-    Matrix factors(vols.size(), dt.size(), 0.0);
-    Matrix stdDev(vols.size(), dt.size(), 0.0);
-    for (Size j = 0; j < factors.columns(); j++) {
-        for (Size i = 0; i < factors.rows(); i++) {
-            factors[i][j] = exp(-vols[i] * vols[i] * dt[j] / 2.0);
-            stdDev[i][j] = vols[i] * sqrt(dt[j]);
-        }
+    const Real* w = &(*brownians)[0];
+    buffer_.resize(samples_ * n);
+    Real* x = &buffer_[0];
+    for (Size k = 0; k < samples_; k++, w += n, x += n) {
+        for (Size j = 0; j < n; j++)
+            x[j] = drift[j] + sigma[j] * w[j];
     }
 
-    // Loop over each sample
+    // Populate the result value
+    results_.value = arguments_.quantity * arguments_.flow->gearing() *
+                     averagePayoff(forwards, omega, effectiveStrike) * discount;
+    results_.underlyingForwardValue = Null<Real>();
+    results_.sigma = Null<Real>();
+}
+
+boost::shared_ptr<const vector<Real>> CommodityAveragePriceOptionMonteCarloEngine::normalBlock(Size dimension) const {
+
+    auto it = normals_.find(dimension);
+    if (it != normals_.end())
+        return it->second;
+
+    // On each Monte Carlo sample, the sequence is dimension independent standard normal random variables
+    LowDiscrepancy::rsg_type rsg = LowDiscrepancy::make_sequence_generator(dimension, seed_);
+    boost::shared_ptr<vector<Real>> block = boost::make_shared<vector<Real>>(samples_ * dimension);
     for (Size k = 0; k < samples_; k++) {
+        const vector<Real>& sequence = rsg.nextSequence().value;
+        std::copy(sequence.begin(), sequence.end(), block->begin() + k * dimension);
+    }
 
-        // Sequence is N x n independent standard normal random variables
-        vector<Real> sequence = rsg.nextSequence().value;
-
-        // paths initially holds independent standard normal random variables
-        Matrix paths(vols.size(), dt.size(), sequence.begin(), sequence.end());
-
-        // Correlate the random variables in each column
-        paths = sqrtCorr * paths;
-
-        // Fill the paths
-        for (Size i = 0; i < paths.rows(); i++) {
-            for (Size j = 0; j < paths.columns(); j++) {
-                // This is \exp(-\sigma_i^2 \delta t_j / 2) * \exp(\sigma_i \sqrt(\delta t_j) \delta W_{i,j})
-                paths[i][j] = factors[i][j] * exp(stdDev[i][j] * paths[i][j]);
-                if (j == 0) {
-                    // If on first timestep, multiply by F_i(0)
-                    paths[i][j] *= prices[i];
-                } else {
-                    // If on timestep greater than t_0, multiply by F_i(t_{j-1}) i.e. value of contract at
-                    // previous time
-                    paths[i][j] *= paths[i][j - 1];
-                }
+    if (reserveCache(block->size()))
+        normals_[dimension] = block;
+    return block;
+}
+
+boost::shared_ptr<const vector<Real>>
+CommodityAveragePriceOptionMonteCarloEngine::brownianBlock(const vector<Real>& dt, const vector<Size>& futureIndex,
+                                                           const Matrix& sqrtCorr) const {
+
+    Size n = dt.size();
+    Size nf = sqrtCorr.rows();
+
+    // The lower triangular Cholesky factor identifies the correlation
+    BrownianKey key;
+    std::get<0>(key) = dt;
+    std::get<1>(key) = futureIndex;
+    for (Size i = 0; i < nf; i++)
+        std::get<2>(key).insert(std::get<2>(key).end(), sqrtCorr.row_begin(i), sqrtCorr.row_begin(i) + i + 1);
+    auto it = brownians_.find(key);
+    if (it != brownians_.end())
+        return it->second;
+
+    // On each sample the N x n independent standard normal random variables are read as an N x n matrix, i.e.
+    // the variable for future i and timestep j is at i * n + j. The variables in each column are correlated
+    // using the lower triangular sqrtCorr matrix and the Brownian motions of all futures are evolved, even if
+    // only the future on the pricing date is stored.
+    boost::shared_ptr<const vector<Real>> normals = normalBlock(nf * n);
+    boost::shared_ptr<vector<Real>> block = boost::make_shared<vector<Real>>(samples_ * n);
+    vector<Real> sqrtDt(n), w(nf);
+    for (Size j = 0; j < n; j++)
+        sqrtDt[j] = sqrt(dt[j]);
+    const Real* z = &(*normals)[0];
+    Real* out = &(*block)[0];
+    for (Size k = 0; k < samples_; k++, z += nf * n, out += n) {
+        std::fill(w.begin(), w.end(), 0.0);
+        for (Size j = 0; j < n; j++) {
+            for (Size i = 0; i < nf; i++) {
+                Real dw = 0.0;
+                for (Size m = 0; m <= i; m++)
+                    dw += sqrtCorr[i][m] * z[m * n + j];
+                w[i] += sqrtDt[j] * dw;
             }
+            out[j] = w[futureIndex[j]];
         }
+    }
 
-        // Calculate the sum of the commodity future prices on the pricing dates after today
-        Real samplePayoff = 0.0;
-        for (Size j = 0; j < dt.size(); j++) {
-            samplePayoff += paths[futureIndex[j]][j];
-        }
+    if (reserveCache(block->size()))
+        brownians_[key] = block;
+    return block;
+}
+
+bool CommodityAveragePriceOptionMonteCarloEngine::reserveCache(Size size) const {
+
+    Size bytes = size * sizeof(Real);
+    if (bytes > maxCachedBytes)
+        return false;
+
+    if (cachedBytes_ + bytes > maxCachedBytes) {
+        normals_.clear();
+        brownians_.clear();
+        cachedBytes_ = 0;
+    }
+    cachedBytes_ += bytes;
+    return true;
+}
+
+Real CommodityAveragePriceOptionMonteCarloEngine::averagePayoff(const vector<Real>& forwards, Real omega,
+                                                                Real strike) const {
+
+    // One pass of exp over the whole buffer. This is a flat loop without dependencies that the compiler can
+    // vectorise where a vector math library is available.
+    Size n = forwards.size();
+    Real* x = &buffer_[0];
+    for (Size l = 0; l < samples_ * n; l++)
+        x[l] = exp(x[l]);
+
+    Real payoff = 0.0;
+    for (Size k = 0; k < samples_; k++, x += n) {
 
         // Average price on this sample
-        samplePayoff /= dt.size();
+        Real samplePayoff = 0.0;
+        for (Size j = 0; j < n; j++)
+            samplePayoff += forwards[j] * x[j];
+        samplePayoff /= n;
 
         // Finally, the payoff on this sample
-        samplePayoff = max(omega * (samplePayoff - effectiveStrike), 0.0);
-
-        // Update the final average
-        // Note: payoff * k / (k + 1) - left to right precedence => double division.
-        payoff = k == 0 ? samplePayoff : payoff * k / (k + 1) + samplePayoff / (k + 1);
+        payoff += max(omega * (samplePayoff - strike), 0.0);
     }
 
-    // Populate the result value
-    results_.value = arguments_.quantity * arguments_.flow->gearing() * payoff * discount;
-    results_.underlyingForwardValue = Null<Real>();
-    results_.sigma = Null<Real>();
+    return payoff / samples_;
 }
 
 void CommodityAveragePriceOptionMonteCarloEngine::setupFuture(vector<Real>& outVolatilities, Matrix& outSqrtCorr,
@@ -430,7 +478,7 @@ void CommodityAveragePriceOptionMonteCarloEngine::setupFuture(vector<Real>& outV
             outSqrtCorr[i][j] = outSqrtCorr[j][i] = rho(vExpiryDates[i], vExpiryDates[j]);
         }
     }
-    outSqrtCorr = pseudoSqrt(outSqrtCorr, SalvagingAlgorithm::None);
+    outSqrtCorr = CholeskyDecomposition(outSqrtCorr, true);
 }
 
 vector<Real> CommodityAveragePriceOptionMonteCarloEngine::timegrid(vector<Date>& outDates) const {
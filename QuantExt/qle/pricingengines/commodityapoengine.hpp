@@ -16,6 +16,12 @@
 #include <qle/instruments/commodityapo.hpp>
 #include <qle/methods/multipathgeneratorbase.hpp>
 
+#include <boost/shared_ptr.hpp>
+
+#include <map>
+#include <tuple>
+#include <vector>
+
 namespace QuantExt {
 
 /*! Commodity APO Engine base class
@@ -69,6 +75,13 @@ public:
 /*! Commodity APO Monte Carlo Engine
     Monte Carlo implementation of the APO payoff
     Reference: Iain Clark, Commodity Option Pricing, Wiley, section 2.7.4, equations (2.118) and (2.126)
+
+    All samples are generated as one block. The quasi random numbers and, for APOs on futures, the correlated
+    Brownian motions on the pricing dates are cached in the engine and reused for all APOs priced with it that
+    have the same number of pricing dates resp. the same pricing times and future contracts. The cache is bounded
+    by the memory of the blocks. The correlation is applied with the lower triangular Cholesky factor of the
+    correlation matrix. The prices on all samples and pricing dates are then obtained with one pass of exp over a
+    contiguous buffer, which is kept between calculations.
 */
 class CommodityAveragePriceOptionMonteCarloEngine : public CommodityAveragePriceOptionBaseEngine {
 public:
@@ -76,7 +89,10 @@ public:
                                                 const QuantLib::Handle<QuantLib::BlackVolTermStructure>& vol,
                                                 QuantLib::Size samples, QuantLib::Real beta = 0.0,
                                                 const QuantLib::Size seed = 42)
-        : CommodityAveragePriceOptionBaseEngine(discountCurve, vol, beta), samples_(samples), seed_(seed) {}
+        : CommodityAveragePriceOptionBaseEngine(discountCurve, vol, beta), samples_(samples), seed_(seed),
+          cachedBytes_(0) {
+        QL_REQUIRE(samples_ > 0, "CommodityAveragePriceOptionMonteCarloEngine: samples must be positive");
+    }
 
     void calculate() const;
 
@@ -90,9 +106,9 @@ private:
     /*! Prepare data for APO calculation. The \p outVolatilities parameter will be populated with separate future
         contract volatilities taking into account the \p strike level. The number of elements of \p outVolatilities
         gives the number, N, of future contracts involved in the non-accrued portion of the APO. The matrix
-        \p outSqrtCorr is populated with the square root of the correlation matrix between the future contracts.
-        The \p outPrices vector will be populated with the current future price values. The \p futureIndex is
-        populated with the index of the future to be used on each timestep in the simulation.
+        \p outSqrtCorr is populated with the lower triangular Cholesky factor of the correlation matrix between the
+        future contracts. The \p outPrices vector will be populated with the current future price values. The
+        \p futureIndex is populated with the index of the future to be used on each timestep in the simulation.
     */
     void setupFuture(std::vector<QuantLib::Real>& outVolatilities, QuantLib::Matrix& outSqrtCorr,
                      std::vector<QuantLib::Real>& outPrices, std::vector<QuantLib::Size>& futureIndex,
@@ -105,8 +121,40 @@ private:
     */
     std::vector<QuantLib::Real> timegrid(std::vector<QuantLib::Date>& outDates) const;
 
+    /*! Return the block of independent standard normal variables with the given \p dimension for all samples.
+        The variables of sample \f$k\f$ are stored at \f$k \cdot dimension, \ldots, (k+1) \cdot dimension - 1\f$.
+    */
+    boost::shared_ptr<const std::vector<QuantLib::Real>> normalBlock(QuantLib::Size dimension) const;
+
+    /*! Return the block of the correlated Brownian motions \f$W_{i_j}(t_j)\f$ of the future \f$i_j\f$ =
+        \p futureIndex[j] at the pricing times \f$t_j\f$ for all samples, stored sample by sample.
+    */
+    boost::shared_ptr<const std::vector<QuantLib::Real>> brownianBlock(const std::vector<QuantLib::Real>& dt,
+                                                                       const std::vector<QuantLib::Size>& futureIndex,
+                                                                       const QuantLib::Matrix& sqrtCorr) const;
+
+    /*! Return the Monte Carlo estimate of the payoff on the average of the prices \f$F_j \exp(x_{k,j})\f$ on the
+        pricing dates. On entry buffer_ holds the exponents \f$x_{k,j}\f$ for all samples \f$k\f$.
+    */
+    QuantLib::Real averagePayoff(const std::vector<QuantLib::Real>& forwards, QuantLib::Real omega,
+                                 QuantLib::Real strike) const;
+
+    /*! Make room in the cache for a block of \p size values, dropping all cached blocks if the cache would exceed
+        its memory limit. Returns \c false if the block alone exceeds the limit and should not be cached.
+    */
+    bool reserveCache(QuantLib::Size size) const;
+
     QuantLib::Size samples_;
     QuantLib::Size seed_;
+
+    // cached random number blocks, keyed by dimension resp. by the time steps, the future indices and the
+    // entries of the Cholesky factor
+    typedef std::tuple<std::vector<QuantLib::Real>, std::vector<QuantLib::Size>, std::vector<QuantLib::Real>>
+        BrownianKey;
+    mutable std::map<QuantLib::Size, boost::shared_ptr<const std::vector<QuantLib::Real>>> normals_;
+    mutable std::map<BrownianKey, boost::shared_ptr<const std::vector<QuantLib::Real>>> brownians_;
+    mutable QuantLib::Size cachedBytes_;
+    mutable std::vector<QuantLib::Real> buffer_;
 };
 
 } // namespace QuantExt
@@ -25,61 +25,40 @@
 #include <ql/utilities/dataformatters.hpp>
 
 #include <qle/pricingengines/discountingswapenginemulticurve.hpp>
+#include <qle/termstructures/cachedinterpolateddiscountcurve.hpp>
+
+#include <boost/weak_ptr.hpp>
+
+#include <list>
+#include <map>
 
 namespace QuantExt {
 
 namespace {
 
-class AmountGetter : public AcyclicVisitor,
-                     public Visitor<CashFlow>,
-                     public Visitor<Coupon>,
-                     public Visitor<IborCoupon> {
+// maximum number of compiled legs cached by an engine, the least recently priced legs are dropped beyond this
+const Size maxCompiledLegs = 4096;
+
+class AmountGetter : public AcyclicVisitor, public Visitor<CashFlow>, public Visitor<Coupon> {
 
 public:
-    AmountGetter() : amount_(0), callAmount_(true) {}
+    AmountGetter() : amount_(0) {}
     virtual ~AmountGetter() {}
 
     Real amount() const { return amount_; }
     virtual Real bpsFactor() const { return 0.0; }
-    void setCallAmount(bool flag) { callAmount_ = flag; }
 
     void visit(CashFlow& c);
     void visit(Coupon& c);
-    void visit(IborCoupon& c);
 
 private:
     Real amount_;
-    bool callAmount_;
 };
 
 void AmountGetter::visit(CashFlow& c) { amount_ = c.amount(); }
 
 void AmountGetter::visit(Coupon& c) { amount_ = c.amount(); }
 
-void AmountGetter::visit(IborCoupon& c) {
-    if (callAmount_) {
-        amount_ = c.amount();
-    } else {
-        Handle<YieldTermStructure> forwardingCurve = c.iborIndex()->forwardingTermStructure();
-        QL_REQUIRE(!forwardingCurve.empty(), "Forwarding curve is empty.");
-
-        /* Assuming here that Libor value/maturity date = coupon accrual start/end date */
-        DiscountFactor discAccStart = forwardingCurve->discount(c.accrualStartDate());
-        DiscountFactor discAccEnd = forwardingCurve->discount(c.accrualEndDate());
-
-        Real fixingTimesDcf;
-        DayCounter indexBasis = c.iborIndex()->dayCounter();
-        DayCounter couponBasis = c.dayCounter();
-        if (indexBasis == couponBasis) {
-            fixingTimesDcf = (discAccStart / discAccEnd - 1);
-        } else {
-            Time indexDcf = indexBasis.yearFraction(c.accrualStartDate(), c.accrualEndDate());
-            fixingTimesDcf = (discAccStart / discAccEnd - 1) / indexDcf * c.accrualPeriod();
-        }
-        amount_ = (c.gearing() * fixingTimesDcf + c.spread() * c.accrualPeriod()) * c.nominal();
-    }
-}
-
 class AdditionalAmountGetter : public AmountGetter {
 
 public:
@@ -88,7 +67,6 @@ public:
 
     void visit(CashFlow& c);
     void visit(Coupon& c);
-    void visit(IborCoupon& c);
 
 private:
     Real bpsFactor_;
@@ -104,17 +82,162 @@ void AdditionalAmountGetter::visit(Coupon& c) {
     bpsFactor_ = c.accrualPeriod() * c.nominal();
 }
 
-void AdditionalAmountGetter::visit(IborCoupon& c) {
-    AmountGetter::visit(c);
-    bpsFactor_ = c.accrualPeriod() * c.nominal();
-}
+// type of a cashflow in a compiled leg
+enum class FlowType {
+    // amount and bps factor do not change, e.g. fixed rate coupons
+    Constant,
+    // ibor coupon, amount estimated from the forwarding curve discounts
+    Ibor,
+    // any other cashflow, amount and bps factor are retrieved by an AmountGetter on each calculation
+    Other
+};
+
+// Classifies a cashflow for the compiled leg
+class FlowClassifier : public AcyclicVisitor,
+                       public Visitor<CashFlow>,
+                       public Visitor<SimpleCashFlow>,
+                       public Visitor<FixedRateCoupon>,
+                       public Visitor<IborCoupon> {
+public:
+    FlowClassifier() : type_(FlowType::Other), ibor_(nullptr) {}
+    FlowType type() const { return type_; }
+    // the coupon if type() is FlowType::Ibor
+    const IborCoupon* iborCoupon() const { return ibor_; }
+
+    void visit(CashFlow&) { type_ = FlowType::Other; }
+    void visit(SimpleCashFlow&) { type_ = FlowType::Constant; }
+    void visit(FixedRateCoupon&) { type_ = FlowType::Constant; }
+    void visit(IborCoupon& c) {
+        type_ = FlowType::Ibor;
+        ibor_ = &c;
+    }
+
+private:
+    FlowType type_;
+    const IborCoupon* ibor_;
+};
+
 } // namespace
 
 class DiscountingSwapEngineMultiCurve::AmountImpl {
 public:
+    /* Leg compiled into a structure of arrays, each array has one entry per cashflow of the leg. The leg is
+       identified by its first cashflow, which is only referenced weakly so that the leg is compiled again if
+       the cashflow was destroyed and its address reused. */
+    struct CompiledLeg {
+        const CashFlow* key;
+        boost::weak_ptr<CashFlow> first;
+        std::vector<FlowType> types;
+        std::vector<Date> payDates;
+        // amounts of FlowType::Constant cashflows
+        std::vector<Real> amounts;
+        // bps factors of FlowType::Constant and FlowType::Ibor cashflows
+        std::vector<Real> bpsFactors;
+        // FlowType::Ibor coupon data, assuming index value / maturity date = accrual start / end date
+        std::vector<Date> accrualStarts, accrualEnds;
+        std::vector<Real> gearings, nominals, spreadAccruals;
+        // ratio of coupon and index day count fractions, 1 if the day counters coincide
+        std::vector<Real> dcfFactors;
+        std::vector<Handle<YieldTermStructure> > forwardingCurves;
+        // payment times w.r.t. the discount curve and reference date below
+        boost::shared_ptr<YieldTermStructure> payTimesCurve;
+        Date payTimesReferenceDate;
+        std::vector<Time> payTimes;
+    };
+
+    CompiledLeg& compiledLeg(const Leg& leg, bool minimalResults);
+    void updatePayTimes(CompiledLeg& cl, const boost::shared_ptr<YieldTermStructure>& curve, const Date& refDate);
+
     boost::shared_ptr<AmountGetter> amountGetter_;
+    // compiled legs, the most recently priced first, and their position by first cashflow
+    std::list<CompiledLeg> legs_;
+    std::map<const CashFlow*, std::list<CompiledLeg>::iterator> legIndex_;
+    // buffers for the cashflows of one leg, reused across legs and calculations
+    std::vector<Real> amounts_, bpsFactors_;
+    std::vector<Time> payTimes_, fwdTimes_;
+    std::vector<DiscountFactor> discounts_, fwdDiscounts_;
+    // ibor coupons with deferred amount estimation, position in amounts_ and index in the compiled leg
+    std::vector<std::pair<Size, Size> > deferred_;
 };
 
+DiscountingSwapEngineMultiCurve::AmountImpl::CompiledLeg&
+DiscountingSwapEngineMultiCurve::AmountImpl::compiledLeg(const Leg& leg, bool minimalResults) {
+    const CashFlow* key = leg.front().get();
+    std::map<const CashFlow*, std::list<CompiledLeg>::iterator>::iterator it = legIndex_.find(key);
+    if (it != legIndex_.end()) {
+        legs_.splice(legs_.begin(), legs_, it->second);
+        if (legs_.front().types.size() == leg.size() && legs_.front().first.lock() == leg.front())
+            return legs_.front();
+    } else {
+        // drop the least recently priced leg, which includes the legs of destroyed swaps
+        if (legs_.size() >= maxCompiledLegs) {
+            legIndex_.erase(legs_.back().key);
+            legs_.pop_back();
+        }
+        legs_.push_front(CompiledLeg());
+        legIndex_[key] = legs_.begin();
+    }
+
+    CompiledLeg& cl = legs_.front();
+    cl = CompiledLeg();
+    cl.key = key;
+    cl.first = leg.front();
+    Size n = leg.size();
+    cl.types.resize(n);
+    cl.payDates.resize(n);
+    cl.amounts.resize(n, 0.0);
+    cl.bpsFactors.resize(n, 0.0);
+    cl.accrualStarts.resize(n);
+    cl.accrualEnds.resize(n);
+    cl.gearings.resize(n, 0.0);
+    cl.nominals.resize(n, 0.0);
+    cl.spreadAccruals.resize(n, 0.0);
+    cl.dcfFactors.resize(n, 0.0);
+    cl.forwardingCurves.resize(n);
+
+    FlowClassifier classifier;
+    for (Size j = 0; j < n; ++j) {
+        leg[j]->accept(classifier);
+        cl.types[j] = classifier.type();
+        cl.payDates[j] = leg[j]->date();
+        if (classifier.type() == FlowType::Constant) {
+            cl.amounts[j] = leg[j]->amount();
+            boost::shared_ptr<Coupon> c = boost::dynamic_pointer_cast<Coupon>(leg[j]);
+            if (c && !minimalResults)
+                cl.bpsFactors[j] = c->accrualPeriod() * c->nominal();
+        } else if (classifier.type() == FlowType::Ibor) {
+            const IborCoupon& c = *classifier.iborCoupon();
+            if (!minimalResults)
+                cl.bpsFactors[j] = c.accrualPeriod() * c.nominal();
+            cl.accrualStarts[j] = c.accrualStartDate();
+            cl.accrualEnds[j] = c.accrualEndDate();
+            cl.gearings[j] = c.gearing();
+            cl.nominals[j] = c.nominal();
+            cl.spreadAccruals[j] = c.spread() * c.accrualPeriod();
+            DayCounter indexBasis = c.iborIndex()->dayCounter();
+            if (indexBasis == c.dayCounter())
+                cl.dcfFactors[j] = 1.0;
+            else
+                cl.dcfFactors[j] =
+                    c.accrualPeriod() / indexBasis.yearFraction(c.accrualStartDate(), c.accrualEndDate());
+            cl.forwardingCurves[j] = c.iborIndex()->forwardingTermStructure();
+        }
+    }
+    return cl;
+}
+
+void DiscountingSwapEngineMultiCurve::AmountImpl::updatePayTimes(CompiledLeg& cl,
+                                                                 const boost::shared_ptr<YieldTermStructure>& curve,
+                                                                 const Date& refDate) {
+    if (cl.payTimesCurve == curve && cl.payTimesReferenceDate == refDate)
+        return;
+    cl.payTimes.resize(cl.payDates.size());
+    for (Size j = 0; j < cl.payDates.size(); ++j)
+        cl.payTimes[j] = curve->timeFromReference(cl.payDates[j]);
+    cl.payTimesCurve = curve;
+    cl.payTimesReferenceDate = refDate;
+}
+
 DiscountingSwapEngineMultiCurve::DiscountingSwapEngineMultiCurve(const Handle<YieldTermStructure>& discountCurve,
                                                                  bool minimalResults,
                                                                  boost::optional<bool> includeSettlementDateFlows,
@@ -174,32 +297,95 @@ void DiscountingSwapEngineMultiCurve::calculate() const {
 
     const Spread bp = 1.0e-4;
 
+    AmountImpl& impl = *impl_;
+
     for (Size i = 0; i < numLegs; i++) {
 
-        Leg leg = arguments_.legs[i];
+        const Leg& leg = arguments_.legs[i];
         results_.legNPV[i] = 0.0;
         results_.legBPS[i] = 0.0;
 
-        // Call amount() method of underlying coupon for first coupon.
-        impl_->amountGetter_->setCallAmount(true);
-
-        for (Size j = 0; j < leg.size(); j++) {
-
-            /* Exclude cashflows that have occured taking into account the
-            settlement date and includeSettlementDateFlows flag */
-            if (leg[j]->hasOccurred(settlementDate, includeRefDateFlows)) {
-                continue;
+        impl.amounts_.clear();
+        impl.bpsFactors_.clear();
+        impl.payTimes_.clear();
+        impl.deferred_.clear();
+
+        if (!leg.empty()) {
+            AmountImpl::CompiledLeg& cl = impl.compiledLeg(leg, minimalResults_);
+            impl.updatePayTimes(cl, discountCurve_.currentLink(), referenceDate);
+
+            // Call amount() method of underlying coupon for first coupon.
+            bool callAmount = true;
+
+            for (Size j = 0; j < leg.size(); j++) {
+
+                /* Exclude cashflows that have occured taking into account the
+                settlement date and includeSettlementDateFlows flag, only cashflows
+                paying on the settlement date need to be asked */
+                const Date& payDate = cl.payDates[j];
+                if (payDate < settlementDate ||
+                    (payDate == settlementDate && leg[j]->hasOccurred(settlementDate, includeRefDateFlows))) {
+                    continue;
+                }
+
+                switch (cl.types[j]) {
+                case FlowType::Constant:
+                    impl.amounts_.push_back(cl.amounts[j]);
+                    impl.bpsFactors_.push_back(cl.bpsFactors[j]);
+                    break;
+                case FlowType::Ibor:
+                    if (callAmount) {
+                        impl.amounts_.push_back(leg[j]->amount());
+                    } else {
+                        impl.amounts_.push_back(0.0);
+                        impl.deferred_.push_back(std::make_pair(impl.amounts_.size() - 1, j));
+                    }
+                    impl.bpsFactors_.push_back(cl.bpsFactors[j]);
+                    break;
+                default:
+                    leg[j]->accept(*(impl.amountGetter_));
+                    impl.amounts_.push_back(impl.amountGetter_->amount());
+                    impl.bpsFactors_.push_back(impl.amountGetter_->bpsFactor());
+                }
+                impl.payTimes_.push_back(cl.payTimes[j]);
+
+                // For all coupons after second do not call amount(), since for those
+                // we can be sure that they are not fixed yet
+                if (j == 1)
+                    callAmount = false;
             }
 
-            DiscountFactor discount = discountCurve_->discount(leg[j]->date());
-            leg[j]->accept(*(impl_->amountGetter_));
-            results_.legNPV[i] += impl_->amountGetter_->amount() * discount;
-            results_.legBPS[i] += impl_->amountGetter_->bpsFactor() * discount;
+            // estimate the deferred ibor coupon amounts, querying the forwarding curve discounts for all coupons
+            // sharing the same forwarding curve at once
+            for (Size k = 0; k < impl.deferred_.size();) {
+                const Handle<YieldTermStructure>& forwardingCurve = cl.forwardingCurves[impl.deferred_[k].second];
+                QL_REQUIRE(!forwardingCurve.empty(), "Forwarding curve is empty.");
+                const boost::shared_ptr<YieldTermStructure>& link = forwardingCurve.currentLink();
+                impl.fwdTimes_.clear();
+                Size end = k;
+                for (; end < impl.deferred_.size(); ++end) {
+                    Size j = impl.deferred_[end].second;
+                    if (cl.forwardingCurves[j].currentLink() != link)
+                        break;
+                    impl.fwdTimes_.push_back(link->timeFromReference(cl.accrualStarts[j]));
+                    impl.fwdTimes_.push_back(link->timeFromReference(cl.accrualEnds[j]));
+                }
+                discountFactors(*link, impl.fwdTimes_, impl.fwdDiscounts_);
+                for (Size m = k; m < end; ++m) {
+                    Size j = impl.deferred_[m].second;
+                    Real fixingTimesDcf =
+                        (impl.fwdDiscounts_[2 * (m - k)] / impl.fwdDiscounts_[2 * (m - k) + 1] - 1) * cl.dcfFactors[j];
+                    impl.amounts_[impl.deferred_[m].first] =
+                        (cl.gearings[j] * fixingTimesDcf + cl.spreadAccruals[j]) * cl.nominals[j];
+                }
+                k = end;
+            }
 
-            // For all coupons after second do not call amount(), since for those
-            // we can be sure that they are not fixed yet
-            if (j == 1)
-                impl_->amountGetter_->setCallAmount(false);
+            discountFactors(**discountCurve_, impl.payTimes_, impl.discounts_);
+            for (Size k = 0; k < impl.amounts_.size(); ++k) {
+                results_.legNPV[i] += impl.amounts_[k] * impl.discounts_[k];
+                results_.legBPS[i] += impl.bpsFactors_[k] * impl.discounts_[k];
+            }
         }
 
         results_.legNPV[i] *= arguments_.payer[i];
@@ -39,6 +39,18 @@ using namespace QuantLib;
       date.
     - start and end discounts of Swap::results not populated.
 
+    Each leg is compiled once into arrays holding the payment dates, the
+    amounts of fixed rate coupons and simple cashflows, and the accrual
+    dates, gearings, spreads, nominals and day count factors of the ibor
+    coupons. The most recently priced legs, up to a fixed number, are
+    cached by the engine, a leg being identified by its first cashflow,
+    so that pricing the same swap again (e.g. on each scenario of a
+    simulation) only loops over these arrays and queries the forwarding
+    and discount curves in batches. The payment
+    times are cached as well as long as the discount curve and its
+    reference date do not change. Cashflows of other types are asked for
+    their amount on each calculation.
+
     \warning if an IborCoupon with non-natural fixing and/or accrual
              period is present, the NPV will be false
 
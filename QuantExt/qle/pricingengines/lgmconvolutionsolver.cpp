@@ -20,6 +20,8 @@
 
 #include <ql/math/distributions/normaldistribution.hpp>
 
+#include <algorithm>
+
 namespace QuantExt {
 
 //! Numerical convolution solver for the LGM model
@@ -28,8 +30,8 @@ namespace QuantExt {
 */
 
 LgmConvolutionSolver::LgmConvolutionSolver(const boost::shared_ptr<LinearGaussMarkovModel>& model, const Real sy,
-                                           const Size ny, const Real sx, const Size nx)
-    : model_(model), nx_(nx) {
+                                           const Size ny, const Real sx, const Size nx, const Size maxCachedBytes)
+    : model_(model), nx_(nx), maxCachedBytes_(maxCachedBytes), cachedBytes_(0) {
 
     // precompute weights
 
@@ -37,6 +39,9 @@ LgmConvolutionSolver::LgmConvolutionSolver(const boost::shared_ptr<LinearGaussMa
     mx_ = static_cast<Size>(floor(sx * static_cast<Real>(nx)) + 0.5);
     my_ = static_cast<Size>(floor(sy * static_cast<Real>(ny)) + 0.5);
 
+    QL_REQUIRE(mx_ > 0 && my_ > 0,
+               "LgmConvolutionSolver: number of grid points mx (" << mx_ << ") and my (" << my_ << ") must be positive");
+
     // y-grid spacing
     h_ = 1.0 / static_cast<Real>(ny);
 
@@ -63,14 +68,110 @@ LgmConvolutionSolver::LgmConvolutionSolver(const boost::shared_ptr<LinearGaussMa
 }
 
 std::vector<Real> LgmConvolutionSolver::stateGrid(const Real t) const {
-    if (close_enough(t, 0.0))
-        return std::vector<Real>(2 * mx_ + 1, 0.0);
-    std::vector<Real> x(2 * mx_ + 1);
+    std::vector<Real> x;
+    stateGrid(t, x);
+    return x;
+}
+
+void LgmConvolutionSolver::stateGrid(const Real t, std::vector<Real>& x) const {
+    x.resize(2 * mx_ + 1);
+    if (close_enough(t, 0.0)) {
+        std::fill(x.begin(), x.end(), 0.0);
+        return;
+    }
     Real dx = std::sqrt(model_->parametrization()->zeta(t)) / static_cast<Real>(nx_);
     for (int k = 0; k <= 2 * mx_; ++k) {
         x[k] = dx * (k - mx_);
     }
-    return x;
+}
+
+void LgmConvolutionSolver::buildRollbackOperator(const Real zeta1, const Real zeta0, RollbackOperator& op) const {
+    // same discretisation as in rollbackDirect(), accumulating the interpolation weights per grid point
+    Real sigma = std::sqrt(zeta1);
+    Real dx = sigma / static_cast<Real>(nx_);
+    Real std = std::sqrt(zeta1 - zeta0);
+    Real dx2 = std::sqrt(zeta0) / static_cast<Real>(nx_);
+    Size rows = zeta0 == 0.0 ? 1 : 2 * mx_ + 1;
+    op.first.resize(rows);
+    op.size.resize(rows);
+    op.offset.resize(rows);
+    op.weights.clear();
+    std::vector<Real> row(2 * mx_ + 1);
+    int kk;
+    Real alpha;
+    for (Size k = 0; k < rows; ++k) {
+        std::fill(row.begin(), row.end(), 0.0);
+        int first = 2 * mx_, last = 0;
+        for (int i = 0; i <= 2 * my_; i++) {
+            // for zeta0 = 0 we have dx2 = 0 and std = sigma, i.e. a single row
+            Real kp = (dx2 * (static_cast<int>(k) - mx_) + y_[i] * std) / dx + mx_;
+            interpolationIndex(kp, kk, alpha);
+            row[kk] += w_[i] * (1.0 - alpha);
+            row[kk + 1] += w_[i] * alpha;
+            first = std::min(first, kk);
+            last = std::max(last, kk + 1);
+        }
+        op.first[k] = first;
+        op.size[k] = last - first + 1;
+        op.offset[k] = op.weights.size();
+        op.weights.insert(op.weights.end(), row.begin() + first, row.begin() + last + 1);
+    }
+}
+
+const LgmConvolutionSolver::RollbackOperator* LgmConvolutionSolver::rollbackOperator(const Real t1,
+                                                                                    const Real t0) const {
+    Real zeta0 = close_enough(t0, 0.0) ? 0.0 : model_->parametrization()->zeta(t0);
+    std::pair<Real, Real> key(zeta0, model_->parametrization()->zeta(t1));
+    auto it = operators_.find(key);
+    if (it != operators_.end())
+        return &it->second;
+    // an operator has at most gridSize() x gridSize() weights
+    Size maxBytes = 3 * gridSize() * sizeof(Size) + gridSize() * gridSize() * sizeof(Real);
+    if (cachedBytes_ + maxBytes > maxCachedBytes_)
+        return nullptr;
+    RollbackOperator& op = operators_[key];
+    buildRollbackOperator(key.second, key.first, op);
+    cachedBytes_ += op.bytes();
+    return &op;
+}
+
+void LgmConvolutionSolver::rollback(const Matrix& v, const Real t1, const Real t0, Matrix& result) const {
+    QL_REQUIRE(&v != &result, "LgmConvolutionSolver::rollback(): result matrix must be different from input matrix");
+    QL_REQUIRE(v.rows() == gridSize(),
+               "LgmConvolutionSolver::rollback(): rows (" << v.rows() << ") do not match grid size (" << gridSize()
+                                                          << ")");
+    if (close_enough(t0, t1)) {
+        result = v;
+        return;
+    }
+    QL_REQUIRE(t0 < t1, "LgmConvolutionSolver::rollback(): t0 (" << t0 << ") < t1 (" << t1 << ") required.");
+    const RollbackOperator* op = rollbackOperator(t1, t0);
+    // a batch is worth building the operator even if it does not fit into the cache
+    RollbackOperator uncached;
+    if (op == nullptr) {
+        buildRollbackOperator(model_->parametrization()->zeta(t1),
+                              close_enough(t0, 0.0) ? 0.0 : model_->parametrization()->zeta(t0), uncached);
+        op = &uncached;
+    }
+    Size batchSize = v.columns();
+    if (result.rows() != v.rows() || result.columns() != batchSize)
+        result = Matrix(v.rows(), batchSize);
+    for (Size k = 0; k < op->first.size(); ++k) {
+        Real* r = result.row_begin(k);
+        std::fill(r, r + batchSize, 0.0);
+        const Real* w = &op->weights[op->offset[k]];
+        for (Size j = 0; j < op->size[k]; ++j) {
+            // contiguous inner loop over the batch without branches, vectorised by the compiler
+            const Real* vj = v.row_begin(op->first[k] + j);
+            Real wj = w[j];
+            for (Size b = 0; b < batchSize; ++b)
+                r[b] += wj * vj[b];
+        }
+    }
+    if (op->first.size() == 1) {
+        for (Size k = 1; k < result.rows(); ++k)
+            std::copy(result.row_begin(0), result.row_end(0), result.row_begin(k));
+    }
 }
 
 } // namespace QuantExt
@@ -26,17 +26,27 @@
 
 #include <qle/models/lgm.hpp>
 
+#include <ql/math/matrix.hpp>
+
+#include <algorithm>
+#include <map>
+
 namespace QuantExt {
 
 //! Numerical convolution solver for the LGM model
 /*! Reference: Hagan, Methodology for callable swaps and Bermudan
                exercise into swaptions
+
+    The interpolation indices and weights of a rollback step only depend on zeta(t0) and zeta(t1). They are
+    assembled into a banded rollback operator, which is kept for later rollbacks over the same step, e.g. when the
+    same Bermudan is priced again on the next sample of an exposure simulation. The cached operators are bounded by
+    maxCachedBytes, steps that do not fit into the cache are rolled back without an operator.
 */
 
 class LgmConvolutionSolver {
 public:
     LgmConvolutionSolver(const boost::shared_ptr<LinearGaussMarkovModel>& model, const Real sy, const Size ny,
-                         const Real sx, const Size nx);
+                         const Real sx, const Size nx, const Size maxCachedBytes = 8 * 1024 * 1024);
 
     /* get grid size */
     Size gridSize() const { return 2 * mx_ + 1; }
@@ -44,19 +54,69 @@ public:
     /* get discretised states grid at time t */
     std::vector<Real> stateGrid(const Real t) const;
 
+    /* get discretised states grid at time t, the result array is resized if necessary */
+    void stateGrid(const Real t, std::vector<Real>& x) const;
+
     /* roll back an deflated NPV array from t1 to t0 */
     template <typename ValueType = Real>
     std::vector<ValueType> rollback(const std::vector<ValueType>& v, const Real t1, const Real t0,
                                     const ValueType zero = ValueType(0.0)) const;
 
+    /* roll back an deflated NPV array from t1 to t0 into the given result array, which must not be v itself, the
+       result array is resized if necessary, i.e. it can be reused over several rollback steps */
+    template <typename ValueType = Real>
+    void rollback(const std::vector<ValueType>& v, const Real t1, const Real t0, std::vector<ValueType>& result,
+                  const ValueType zero = ValueType(0.0)) const;
+
+    /* roll back a batch of deflated NPV arrays from t1 to t0, column j of v holds the j-th array on the state grid,
+       the result matrix must not be v itself and is resized if necessary */
+    void rollback(const Matrix& v, const Real t1, const Real t0, Matrix& result) const;
+
     /* the underlying model */
     const boost::shared_ptr<LinearGaussMarkovModel>& model() const { return model_; }
 
+    /* number of cached rollback operators and their size in bytes */
+    Size cachedOperators() const { return operators_.size(); }
+    Size cachedBytes() const { return cachedBytes_; }
+
 private:
+    /* rollback from t1 to t0 as a banded matrix, the rolled back value at grid point k is
+       sum_j weights[offset[k] + j] v[first[k] + j], j = 0, ..., size[k] - 1; a rollback to t0 = 0 has a single row,
+       which gives the value at all grid points */
+    struct RollbackOperator {
+        std::vector<Size> first, size, offset;
+        std::vector<Real> weights;
+        Size bytes() const { return 3 * first.size() * sizeof(Size) + weights.size() * sizeof(Real); }
+    };
+
+    /* grid index kk and weight alpha such that the value at the fractional grid index kp is given by
+       (1 - alpha) v[kk] + alpha v[kk + 1], with flat extrapolation outside the grid */
+    void interpolationIndex(Real kp, int& kk, Real& alpha) const {
+        kp = std::min(std::max(kp, 0.0), static_cast<Real>(2 * mx_));
+        kk = std::min(static_cast<int>(kp), 2 * mx_ - 1);
+        alpha = kp - kk;
+    }
+
+    /* the operator for the step from zeta(t1) = zeta1 to zeta(t0) = zeta0 */
+    void buildRollbackOperator(const Real zeta1, const Real zeta0, RollbackOperator& op) const;
+
+    /* the cached operator for the step from t1 to t0, built if it fits into the cache, null otherwise */
+    const RollbackOperator* rollbackOperator(const Real t1, const Real t0) const;
+
+    /* roll back without an operator */
+    template <typename ValueType>
+    void rollbackDirect(const std::vector<ValueType>& v, const Real t1, const Real t0, std::vector<ValueType>& result,
+                        const ValueType zero) const;
+
     boost::shared_ptr<LinearGaussMarkovModel> model_;
     int mx_, my_, nx_;
     Real h_;
     std::vector<Real> y_, w_;
+
+    // cached operators keyed by (zeta(t0), zeta(t1))
+    Size maxCachedBytes_;
+    mutable std::map<std::pair<Real, Real>, RollbackOperator> operators_;
+    mutable Size cachedBytes_;
 };
 
 // rollback implementation
@@ -64,28 +124,59 @@ private:
 template <typename ValueType>
 std::vector<ValueType> LgmConvolutionSolver::rollback(const std::vector<ValueType>& v, const Real t1, const Real t0,
                                                       const ValueType zero) const {
-    if (close_enough(t0, t1))
-        return v;
+    std::vector<ValueType> result;
+    rollback(v, t1, t0, result, zero);
+    return result;
+}
+
+template <typename ValueType>
+void LgmConvolutionSolver::rollback(const std::vector<ValueType>& v, const Real t1, const Real t0,
+                                    std::vector<ValueType>& result, const ValueType zero) const {
+    QL_REQUIRE(&v != &result, "LgmConvolutionSolver::rollback(): result array must be different from input array");
+    if (close_enough(t0, t1)) {
+        result = v;
+        return;
+    }
     QL_REQUIRE(t0 < t1, "LgmConvolutionSolver::rollback(): t0 (" << t0 << ") < t1 (" << t1 << ") required.");
+    const RollbackOperator* op = rollbackOperator(t1, t0);
+    if (op == nullptr) {
+        rollbackDirect(v, t1, t0, result, zero);
+        return;
+    }
+    result.resize(2 * mx_ + 1, zero);
+    for (Size k = 0; k < op->first.size(); ++k) {
+        const Real* w = &op->weights[op->offset[k]];
+        const ValueType* vk = &v[op->first[k]];
+        ValueType value(zero);
+        for (Size j = 0; j < op->size[k]; ++j)
+            value += w[j] * vk[j];
+        result[k] = value;
+    }
+    if (op->first.size() == 1)
+        std::fill(result.begin() + 1, result.end(), result[0]);
+}
+
+template <typename ValueType>
+void LgmConvolutionSolver::rollbackDirect(const std::vector<ValueType>& v, const Real t1, const Real t0,
+                                          std::vector<ValueType>& result, const ValueType zero) const {
     Real sigma = std::sqrt(model_->parametrization()->zeta(t1));
     Real dx = sigma / static_cast<Real>(nx_);
+    int kk;
+    Real alpha;
     if (close_enough(t0, 0.0)) {
         // rollback from t1 to t0 = 0
         ValueType value(zero);
         for (int i = 0; i <= 2 * my_; i++) {
             // Map y index to x index, not integer in general
             Real kp = y_[i] * sigma / dx + mx_;
-            // Adjacent integer x index <= k
-            int kk = int(floor(kp));
             // Get value at kp by linear interpolation on
             // kk <= kp <= kk + 1 with flat extrapolation
-            value +=
-                w_[i] *
-                (kk < 0 ? v[0] : (kk + 1 > 2 * mx_ ? v[2 * mx_] : (kp - kk) * v[kk + 1] + (1.0 + kk - kp) * v[kk]));
+            interpolationIndex(kp, kk, alpha);
+            value += w_[i] * (alpha * v[kk + 1] + (1.0 - alpha) * v[kk]);
         }
-        return std::vector<ValueType>(2 * mx_ + 1, value);
+        result.assign(2 * mx_ + 1, value);
     } else {
-        std::vector<ValueType> value(2 * mx_ + 1, zero);
+        result.assign(2 * mx_ + 1, zero);
         // rollback from t1 to t0 > 0
         Real std = std::sqrt(model_->parametrization()->zeta(t1) - model_->parametrization()->zeta(t0));
         Real dx2 = std::sqrt(model_->parametrization()->zeta(t0)) / static_cast<Real>(nx_);
@@ -93,16 +184,12 @@ std::vector<ValueType> LgmConvolutionSolver::rollback(const std::vector<ValueTyp
             for (int i = 0; i <= 2 * my_; i++) {
                 // Map y index to x index, not integer in generalTo
                 Real kp = (dx2 * (k - mx_) + y_[i] * std) / dx + mx_;
-                // Adjacent integer x index <= k
-                int kk = int(floor(kp));
                 // Get value at kp by linear interpolation on
                 // kk <= kp <= kk + 1 with flat extrapolation
-                value[k] +=
-                    w_[i] *
-                    (kk < 0 ? v[0] : (kk + 1 > 2 * mx_ ? v[2 * mx_] : (kp - kk) * v[kk + 1] + (1.0 + kk - kp) * v[kk]));
+                interpolationIndex(kp, kk, alpha);
+                result[k] += w_[i] * (alpha * v[kk + 1] + (1.0 - alpha) * v[kk]);
             }
         }
-        return value;
     }
 }
 
@@ -70,8 +70,10 @@ Real NumericLgmSwaptionEngineBase::calculate() const {
 
     Real t =
         model()->parametrization()->termStructure()->timeFromReference(exercise_->dates()[minIdxAlive + options - 1]);
-    std::vector<Real> x = stateGrid(t);
-    std::vector<Real> v(x.size());
+    // the state grid and value arrays are reused over the exercise dates
+    std::vector<Real> x, v, vRolled;
+    stateGrid(t, x);
+    v.resize(x.size());
     for (Size k = 0; k < x.size(); ++k) {
         v[k] = std::max(conditionalSwapValue(x[k], t, exercise_->dates()[minIdxAlive + options - 1]) +
                             rebatePv(x[k], t, minIdxAlive + options - 1),
@@ -83,8 +85,9 @@ Real NumericLgmSwaptionEngineBase::calculate() const {
     for (int j = options - 1; j > 0; --j) {
         Real t_to =
             model()->parametrization()->termStructure()->timeFromReference(exercise_->dates()[minIdxAlive + j - 1]);
-        v = rollback(v, t, t_to);
-        x = stateGrid(t_to);
+        rollback(v, t, t_to, vRolled);
+        v.swap(vRolled);
+        stateGrid(t_to, x);
         for (Size k = 0; k < x.size(); ++k) {
             QL_REQUIRE(v[k] > 0 || close_enough(v[k], 0.0), "negative value in rollback: " << v[k]);
             // choose: continue or exercise
@@ -93,8 +96,8 @@ Real NumericLgmSwaptionEngineBase::calculate() const {
         }
         t = t_to;
     }
-    v = rollback(v, t, 0.0);
-    return v[0];
+    rollback(v, t, 0.0, vRolled);
+    return vRolled[0];
 
 } // NumericLgmSwaptionEngineBase::calculate
 
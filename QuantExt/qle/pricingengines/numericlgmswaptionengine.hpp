@@ -52,6 +52,10 @@ namespace QuantExt {
 /*! Base class from which we derive the engines for both the Swaption
   and NonstandardSwaption instrument
 
+  The rollback operators between the exercise times are cached by the LgmConvolutionSolver, so pricing the
+  swaption again on the same model, e.g. on the next sample of an exposure simulation, reuses the interpolation
+  tables of the steps already seen.
+
   \ingroup engines
 */
 class NumericLgmSwaptionEngineBase : protected LgmConvolutionSolver {
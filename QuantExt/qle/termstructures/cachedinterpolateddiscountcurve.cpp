@@ -0,0 +1,119 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/termstructures/cachedinterpolateddiscountcurve.hpp>
+
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace QuantExt {
+
+CachedInterpolatedDiscountCurve::CachedInterpolatedDiscountCurve(const std::vector<Time>& times,
+                                                                 const std::vector<Handle<Quote> >& quotes,
+                                                                 const Natural settlementDays, const Calendar& cal,
+                                                                 const DayCounter& dc)
+    : YieldTermStructure(settlementDays, cal, dc), times_(times), quotes_(quotes) {
+    initialise();
+}
+
+CachedInterpolatedDiscountCurve::CachedInterpolatedDiscountCurve(const std::vector<Date>& dates,
+                                                                 const std::vector<Handle<Quote> >& quotes,
+                                                                 const Natural settlementDays, const Calendar& cal,
+                                                                 const DayCounter& dc)
+    : YieldTermStructure(settlementDays, cal, dc), times_(dates.size()), quotes_(quotes) {
+    for (Size i = 0; i < dates.size(); ++i)
+        times_[i] = timeFromReference(dates[i]);
+    initialise();
+}
+
+void CachedInterpolatedDiscountCurve::initialise() {
+    QL_REQUIRE(times_.size() > 1, "at least two times required");
+    QL_REQUIRE(times_[0] == 0.0, "First time must be 0, got " << times_[0]); // or date=asof
+    QL_REQUIRE(times_.size() == quotes_.size(), "size of time and quote vectors do not match");
+    for (Size i = 0; i < times_.size() - 1; ++i)
+        timeDiffs_.push_back(times_[i + 1] - times_[i]);
+    logDiscounts_.resize(times_.size());
+    stale_ = true;
+    quoteObserver_ = boost::make_shared<QuoteObserver>(stale_);
+    for (Size i = 0; i < quotes_.size(); ++i)
+        quoteObserver_->registerWith(quotes_[i]);
+}
+
+void CachedInterpolatedDiscountCurve::updateLogDiscounts() const {
+    for (Size i = 0; i < quotes_.size(); ++i)
+        logDiscounts_[i] = std::log(quotes_[i]->value());
+    stale_ = false;
+}
+
+Size CachedInterpolatedDiscountCurve::interval(Time t, Size hint) const {
+    Size n = times_.size() - 1;
+    if (hint < 1 || hint > n || t < times_[hint - 1])
+        return std::min<Size>(std::upper_bound(times_.begin(), times_.end(), t) - times_.begin(), n);
+    // all times before the hint are <= t, step forward to the first time > t
+    while (hint < n && times_[hint] <= t)
+        ++hint;
+    return hint;
+}
+
+DiscountFactor CachedInterpolatedDiscountCurve::interpolate(Time t, Size i) const {
+    Real weight = (times_[i] - t) / timeDiffs_[i - 1];
+    // this handles extrapolation (t > times.back()) as well
+    Real value = (1.0 - weight) * logDiscounts_[i] + weight * logDiscounts_[i - 1];
+    return std::exp(value);
+}
+
+DiscountFactor CachedInterpolatedDiscountCurve::discountImpl(Time t) const {
+    if (stale_)
+        updateLogDiscounts();
+    return interpolate(t, interval(t, 0));
+}
+
+void CachedInterpolatedDiscountCurve::discount(const std::vector<Time>& times, std::vector<DiscountFactor>& discounts,
+                                               bool extrapolate) const {
+    if (stale_)
+        updateLogDiscounts();
+    discounts.resize(times.size());
+    Size hint = 0;
+    for (Size k = 0; k < times.size(); ++k) {
+        checkRange(times[k], extrapolate);
+        hint = interval(times[k], hint);
+        discounts[k] = interpolate(times[k], hint);
+    }
+}
+
+std::vector<DiscountFactor> CachedInterpolatedDiscountCurve::discount(const std::vector<Time>& times,
+                                                                      bool extrapolate) const {
+    std::vector<DiscountFactor> discounts;
+    discount(times, discounts, extrapolate);
+    return discounts;
+}
+
+void discountFactors(const YieldTermStructure& curve, const std::vector<Time>& times,
+                     std::vector<DiscountFactor>& discounts) {
+    if (const CachedInterpolatedDiscountCurve* c = dynamic_cast<const CachedInterpolatedDiscountCurve*>(&curve)) {
+        c->discount(times, discounts);
+        return;
+    }
+    discounts.resize(times.size());
+    for (Size k = 0; k < times.size(); ++k)
+        discounts[k] = curve.discount(times[k]);
+}
+
+} // namespace QuantExt
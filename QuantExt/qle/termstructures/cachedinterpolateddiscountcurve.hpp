@@ -0,0 +1,113 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file cachedinterpolateddiscountcurve.hpp
+    \brief interpolated discount term structure with cached log discounts
+    \ingroup termstructures
+*/
+
+#ifndef quantext_cached_interpolated_discount_curve_hpp
+#define quantext_cached_interpolated_discount_curve_hpp
+
+#include <ql/patterns/observable.hpp>
+#include <ql/quote.hpp>
+#include <ql/termstructures/yieldtermstructure.hpp>
+
+namespace QuantExt {
+using namespace QuantLib;
+
+//! InterpolatedDiscountCurve with cached log discount factors
+/*! Same curve as InterpolatedDiscountCurve, i.e. loglinear interpolation of discount factors, flat fwd
+    extrapolation and a floating reference date, but the logarithms of the discount quotes are computed once
+    after each quote update instead of on every call of discount().
+
+    The curve is notified of quote updates by an internal observer, its own observers are notified in the
+    same way as those of InterpolatedDiscountCurve, i.e. quote updates are not forwarded. The cache relies on
+    the quote notifications, so it must not be used while notifications are disabled.
+
+    Several discount factors can be retrieved at once with discount(const std::vector<Time>&, ...), which
+    avoids the virtual call and the interval search per discount factor for ascending times.
+
+        \ingroup termstructures
+*/
+class CachedInterpolatedDiscountCurve : public YieldTermStructure {
+public:
+    //! \name Constructors
+    //@{
+    //! default constructor
+    CachedInterpolatedDiscountCurve(const std::vector<Time>& times, const std::vector<Handle<Quote> >& quotes,
+                                    const Natural settlementDays, const Calendar& cal, const DayCounter& dc);
+
+    //! constructor that takes a vector of dates
+    CachedInterpolatedDiscountCurve(const std::vector<Date>& dates, const std::vector<Handle<Quote> >& quotes,
+                                    const Natural settlementDays, const Calendar& cal, const DayCounter& dc);
+    //@}
+
+    //! \name TermStructure interface
+    //@{
+    Date maxDate() const { return Date::maxDate(); } // flat fwd extrapolation
+    //@}
+
+    using YieldTermStructure::discount;
+
+    //! discount factors for the given times, the result is written to \p discounts
+    void discount(const std::vector<Time>& times, std::vector<DiscountFactor>& discounts,
+                  bool extrapolate = false) const;
+
+    //! discount factors for the given times
+    std::vector<DiscountFactor> discount(const std::vector<Time>& times, bool extrapolate = false) const;
+
+protected:
+    DiscountFactor discountImpl(Time t) const;
+
+private:
+    class QuoteObserver : public Observer {
+    public:
+        QuoteObserver(bool& stale) : stale_(stale) {}
+        void update() { stale_ = true; }
+
+    private:
+        bool& stale_;
+    };
+
+    void initialise();
+    void updateLogDiscounts() const;
+    //! index i >= 1 of the interval [times_[i-1], times_[i]] used for t, starting the search at \p hint
+    Size interval(Time t, Size hint) const;
+    DiscountFactor interpolate(Time t, Size i) const;
+
+    std::vector<Time> times_;
+    std::vector<Time> timeDiffs_;
+    std::vector<Handle<Quote> > quotes_;
+    mutable std::vector<Real> logDiscounts_;
+    mutable bool stale_;
+    boost::shared_ptr<QuoteObserver> quoteObserver_;
+};
+
+//! discount factors of \p curve for the given times
+/*! Uses the batch interface of CachedInterpolatedDiscountCurve if \p curve is such a curve and calls
+    YieldTermStructure::discount() for each time otherwise.
+
+        \ingroup termstructures
+*/
+void discountFactors(const YieldTermStructure& curve, const std::vector<Time>& times,
+                     std::vector<DiscountFactor>& discounts);
+
+} // namespace QuantExt
+
+#endif
@@ -0,0 +1,207 @@
+/*
+ Copyright (C) 2018 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+#include <boost/make_shared.hpp>
+#include <boost/test/unit_test.hpp>
+#include <ql/currencies/america.hpp>
+#include <ql/exercise.hpp>
+#include <ql/settings.hpp>
+#include <ql/termstructures/volatility/equityfx/blackconstantvol.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/calendars/target.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+
+#include <qle/cashflows/commodityindexedaveragecashflow.hpp>
+#include <qle/indexes/commodityindex.hpp>
+#include <qle/instruments/commodityapo.hpp>
+#include <qle/pricingengines/commodityapoengine.hpp>
+#include <qle/termstructures/pricecurve.hpp>
+#include <qle/time/futureexpirycalculator.hpp>
+
+using namespace std;
+using namespace boost::unit_test_framework;
+using namespace QuantLib;
+using namespace QuantExt;
+
+namespace {
+
+// APO on the average spot price over the pricing dates between start and end
+boost::shared_ptr<CommodityAveragePriceOption> makeApo(const boost::shared_ptr<CommoditySpotIndex>& index,
+                                                       const Date& start, const Date& end, Real strike,
+                                                       Option::Type type) {
+    boost::shared_ptr<CommodityIndexedAverageCashFlow> flow =
+        boost::make_shared<CommodityIndexedAverageCashFlow>(1.0, start, end, end, index, TARGET());
+    return boost::make_shared<CommodityAveragePriceOption>(flow, boost::make_shared<EuropeanExercise>(end), 1.0,
+                                                           strike, type);
+}
+
+// Monthly futures expiring on the 20th of the month
+class MonthlyExpiryCalculator : public FutureExpiryCalculator {
+public:
+    Date nextExpiry(bool includeExpiry, const Date& referenceDate, Natural offset, bool) override {
+        Date d = referenceDate == Date() ? Settings::instance().evaluationDate() : referenceDate;
+        Date expiry(20, d.month(), d.year());
+        if (expiry < d || (expiry == d && !includeExpiry))
+            expiry += 1 * Months;
+        return expiry + offset * Months;
+    }
+    Date priorExpiry(bool includeExpiry, const Date& referenceDate, bool) override {
+        Date d = referenceDate == Date() ? Settings::instance().evaluationDate() : referenceDate;
+        Date expiry(20, d.month(), d.year());
+        if (expiry > d || (expiry == d && !includeExpiry))
+            expiry -= 1 * Months;
+        return expiry;
+    }
+    Date expiryDate(Month contractMonth, Year contractYear, Natural monthOffset, bool) override {
+        return Date(20, contractMonth, contractYear) + monthOffset * Months;
+    }
+};
+
+// APO on the average of the prices of the next future contract over the pricing dates between start and end
+boost::shared_ptr<CommodityAveragePriceOption>
+makeFutureApo(const boost::shared_ptr<CommoditySpotIndex>& index, const boost::shared_ptr<FutureExpiryCalculator>& calc,
+              const Date& start, const Date& end, Real strike, Option::Type type) {
+    boost::shared_ptr<CommodityIndexedAverageCashFlow> flow = boost::make_shared<CommodityIndexedAverageCashFlow>(
+        1.0, start, end, end, index, TARGET(), 0.0, 1.0, true, 0, 0, calc);
+    return boost::make_shared<CommodityAveragePriceOption>(flow, boost::make_shared<EuropeanExercise>(end), 1.0,
+                                                           strike, type);
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(CommodityApoEngineTest)
+
+BOOST_AUTO_TEST_CASE(testMonteCarloSpotApo) {
+
+    BOOST_TEST_MESSAGE("Testing commodity APO Monte Carlo engine against the analytical engine");
+
+    SavedSettings backup;
+
+    Date asof(19, Feb, 2018);
+    Settings::instance().evaluationDate() = asof;
+    Actual365Fixed dayCounter;
+
+    Handle<YieldTermStructure> discountCurve(boost::make_shared<FlatForward>(asof, 0.02, dayCounter));
+    Handle<BlackVolTermStructure> vol(boost::make_shared<BlackConstantVol>(asof, TARGET(), 0.3, dayCounter));
+    vector<Date> dates = {asof, Date(19, Feb, 2019)};
+    vector<Real> prices = {100.0, 104.0};
+    Handle<PriceTermStructure> priceCurve(
+        boost::make_shared<InterpolatedPriceCurve<Linear>>(asof, dates, prices, dayCounter, USDCurrency()));
+    boost::shared_ptr<CommoditySpotIndex> index =
+        boost::make_shared<CommoditySpotIndex>("COMM-TEST", TARGET(), priceCurve);
+
+    boost::shared_ptr<PricingEngine> analyticalEngine =
+        boost::make_shared<CommodityAveragePriceOptionAnalyticalEngine>(discountCurve, vol);
+    boost::shared_ptr<PricingEngine> mcEngine =
+        boost::make_shared<CommodityAveragePriceOptionMonteCarloEngine>(discountCurve, vol, 10000);
+
+    // APOs with the same pricing dates
+    Date start(1, Jun, 2018), end(31, Aug, 2018);
+    vector<Real> strikes = {101.0, 95.0, 106.0};
+    vector<Option::Type> types = {Option::Call, Option::Put, Option::Call};
+    vector<boost::shared_ptr<CommodityAveragePriceOption>> apos;
+    for (Size i = 0; i < strikes.size(); ++i)
+        apos.push_back(makeApo(index, start, end, strikes[i], types[i]));
+
+    vector<Real> mcValues;
+    for (Size i = 0; i < apos.size(); ++i) {
+        apos[i]->setPricingEngine(analyticalEngine);
+        Real analytical = apos[i]->NPV();
+        apos[i]->setPricingEngine(mcEngine);
+        Real mc = apos[i]->NPV();
+        mcValues.push_back(mc);
+        BOOST_TEST_MESSAGE("APO strike " << strikes[i] << ": analytical " << analytical << ", mc " << mc);
+        BOOST_CHECK_SMALL(mc - analytical, 0.03 * analytical + 0.02);
+    }
+
+    // The APOs share the quasi random block of the engine, a separate engine gives the same values
+    for (Size i = 0; i < apos.size(); ++i) {
+        apos[i]->setPricingEngine(
+            boost::make_shared<CommodityAveragePriceOptionMonteCarloEngine>(discountCurve, vol, 10000));
+        BOOST_CHECK_CLOSE(apos[i]->NPV(), mcValues[i], 1e-10);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testMonteCarloFutureApo) {
+
+    BOOST_TEST_MESSAGE("Testing commodity APO Monte Carlo engine on futures against reference values");
+
+    SavedSettings backup;
+
+    Date asof(19, Feb, 2018);
+    Settings::instance().evaluationDate() = asof;
+    Actual365Fixed dayCounter;
+
+    // A steep price curve, so that the prices of subsequent future contracts differ significantly
+    Handle<YieldTermStructure> discountCurve(boost::make_shared<FlatForward>(asof, 0.02, dayCounter));
+    Handle<BlackVolTermStructure> vol(boost::make_shared<BlackConstantVol>(asof, TARGET(), 0.3, dayCounter));
+    vector<Date> dates = {asof, Date(19, Feb, 2019)};
+    vector<Real> prices = {100.0, 130.0};
+    Handle<PriceTermStructure> priceCurve(
+        boost::make_shared<InterpolatedPriceCurve<Linear>>(asof, dates, prices, dayCounter, USDCurrency()));
+    boost::shared_ptr<CommoditySpotIndex> index =
+        boost::make_shared<CommoditySpotIndex>("COMM-TEST", TARGET(), priceCurve);
+    boost::shared_ptr<FutureExpiryCalculator> calc = boost::make_shared<MonthlyExpiryCalculator>();
+
+    // The averaging period rolls from the July to the August contract on 20 July 2018
+    Date start(1, Jul, 2018), end(31, Jul, 2018);
+    Real strike = 110.0;
+    boost::shared_ptr<CommodityAveragePriceOption> call = makeFutureApo(index, calc, start, end, strike, Option::Call);
+    boost::shared_ptr<CommodityAveragePriceOption> put = makeFutureApo(index, calc, start, end, strike, Option::Put);
+
+    // Reference forward of the average price, each pricing date referencing the next contract's price
+    Real expected = 0.0;
+    Size n = 0;
+    for (const auto& kv : call->underlyingFlow()->indices()) {
+        expected += priceCurve->price(calc->nextExpiry(true, kv.first));
+        ++n;
+    }
+    expected /= n;
+    Real discount = discountCurve->discount(end);
+    BOOST_REQUIRE(priceCurve->price(Date(20, Aug, 2018)) - priceCurve->price(Date(20, Jul, 2018)) > 2.0);
+
+    // beta = 0 gives perfectly correlated futures, i.e. a singular correlation matrix
+    vector<Real> betas = {0.0, 2.0};
+    for (Real beta : betas) {
+        boost::shared_ptr<PricingEngine> analyticalEngine =
+            boost::make_shared<CommodityAveragePriceOptionAnalyticalEngine>(discountCurve, vol, beta);
+        boost::shared_ptr<PricingEngine> mcEngine =
+            boost::make_shared<CommodityAveragePriceOptionMonteCarloEngine>(discountCurve, vol, 10000, beta);
+
+        call->setPricingEngine(analyticalEngine);
+        Real analytical = call->NPV();
+        call->setPricingEngine(mcEngine);
+        put->setPricingEngine(mcEngine);
+        Real mcCall = call->NPV();
+        Real mcPut = put->NPV();
+        BOOST_TEST_MESSAGE("beta " << beta << ": analytical " << analytical << ", mc call " << mcCall << ", mc put "
+                                   << mcPut << ", forward " << (expected - strike) * discount);
+
+        // The call minus the put is the forward of the average price, i.e. the Brownian motions on the pricing
+        // dates have the right variance and each pricing date references the right contract
+        BOOST_CHECK_SMALL(mcCall - mcPut - (expected - strike) * discount, 0.25);
+        BOOST_CHECK_SMALL(mcCall - analytical, 0.03 * analytical + 0.02);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -65,6 +65,7 @@
 #include <qle/pricingengines/discountingfxforwardengine.hpp>
 #include <qle/pricingengines/discountingriskybondengine.hpp>
 #include <qle/pricingengines/discountingswapenginemulticurve.hpp>
+#include <qle/pricingengines/lgmconvolutionsolver.hpp>
 #include <qle/pricingengines/midpointcdsengine.hpp>
 #include <qle/pricingengines/numericlgmswaptionengine.hpp>
 #include <qle/pricingengines/oiccbasisswapengine.hpp>
@@ -287,6 +288,64 @@ BOOST_AUTO_TEST_CASE(testNonstandardBermudanSwaption) {
                     << (npv - ns_npv) << ", tolerance is " << tol);
 } // testNonstandardBermudanSwaption
 
+BOOST_AUTO_TEST_CASE(testLgmConvolutionBatchRollback) {
+
+    BOOST_TEST_MESSAGE("Testing cached and batched rollback in LGM convolution solver...");
+
+    BermudanTestData d;
+
+    boost::shared_ptr<IrLgm1fParametrization> lgm_p = boost::make_shared<IrLgm1fPiecewiseConstantHullWhiteAdaptor>(
+        EURCurrency(), d.yts, d.stepTimes_a, d.sigmas_a, d.stepTimes_a, d.kappas_a);
+
+    boost::shared_ptr<LinearGaussMarkovModel> lgm = boost::make_shared<LinearGaussMarkovModel>(lgm_p);
+
+    // the second solver has no cache and rolls back without operators
+    LgmConvolutionSolver solver(lgm, 7.0, 16, 7.0, 32);
+    LgmConvolutionSolver direct(lgm, 7.0, 16, 7.0, 32, 0);
+
+    // a batch of call like payoffs on the state grid at t1
+    Real t1 = 5.0;
+    std::vector<Real> x = solver.stateGrid(t1);
+    Size n = solver.gridSize(), batchSize = 5;
+    Matrix v(n, batchSize);
+    std::vector<std::vector<Real>> vs(batchSize, std::vector<Real>(n));
+    for (Size b = 0; b < batchSize; ++b) {
+        for (Size k = 0; k < n; ++k) {
+            vs[b][k] = std::max(x[k] - 0.002 * b, 0.0) + 0.01 * b;
+            v[k][b] = vs[b][k];
+        }
+    }
+
+    Real tol = 1.0E-12;
+    Real t0s[] = {5.0, 3.0, 0.0};
+    std::vector<Real> rolled, rolledDirect;
+    Matrix batchRolled;
+    for (Size i = 0; i < LENGTH(t0s); ++i) {
+        solver.rollback(v, t1, t0s[i], batchRolled);
+        BOOST_REQUIRE_EQUAL(batchRolled.rows(), n);
+        BOOST_REQUIRE_EQUAL(batchRolled.columns(), batchSize);
+        for (Size b = 0; b < batchSize; ++b) {
+            solver.rollback(vs[b], t1, t0s[i], rolled);
+            direct.rollback(vs[b], t1, t0s[i], rolledDirect);
+            BOOST_REQUIRE_EQUAL(rolled.size(), n);
+            BOOST_REQUIRE_EQUAL(rolledDirect.size(), n);
+            for (Size k = 0; k < n; ++k) {
+                BOOST_CHECK_SMALL(rolled[k] - batchRolled[k][b], tol);
+                BOOST_CHECK_SMALL(rolled[k] - rolledDirect[k], tol);
+            }
+        }
+    }
+
+    // one operator per step, t0 = t1 needs none, the step is not rebuilt on later rollbacks
+    BOOST_CHECK_EQUAL(solver.cachedOperators(), 2);
+    Size bytes = solver.cachedBytes();
+    BOOST_CHECK(bytes > 0);
+    solver.rollback(vs[0], t1, 3.0, rolled);
+    BOOST_CHECK_EQUAL(solver.cachedOperators(), 2);
+    BOOST_CHECK_EQUAL(solver.cachedBytes(), bytes);
+    BOOST_CHECK_EQUAL(direct.cachedOperators(), 0);
+} // testLgmConvolutionBatchRollback
+
 BOOST_AUTO_TEST_CASE(testLgm1fCalibration) {
 
     BOOST_TEST_MESSAGE("Testing calibration of LGM 1F model (analytic engine) "
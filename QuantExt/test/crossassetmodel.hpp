@@ -42,6 +42,9 @@ public:
     /*! Test the non-standard Bermudan swaption engine against the standard engine */
     static void testNonstandardBermudanSwaption();
 
+    /*! Test the cached and batched rollback of the LGM convolution solver against the rollback without operators */
+    static void testLgmConvolutionBatchRollback();
+
     /*! Calibrate the LGM and the GSR model to a coterminal swaption basket and compare the calibrated model parameters.
      * Perform the same calibration in the LGM model as a component of the CrossAssetModel and check whether the results
      * are the same and if other components are not affected by this calibration. */
@@ -22,6 +22,8 @@
 #include <ql/termstructures/yield/discountcurve.hpp>
 #include <ql/time/calendars/nullcalendar.hpp>
 #include <ql/time/daycounters/actualactual.hpp>
+#include <qle/termstructures/cachedinterpolateddiscountcurve.hpp>
+#include <qle/termstructures/interpolateddiscountcurve.hpp>
 #include <qle/termstructures/interpolateddiscountcurve2.hpp>
 
 using namespace boost::unit_test_framework;
@@ -81,6 +83,54 @@ BOOST_AUTO_TEST_CASE(testDiscountCurve) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testCachedInterpolatedDiscountCurve) {
+
+    BOOST_TEST_MESSAGE("Testing QuantExt::CachedInterpolatedDiscountCurve...");
+
+    SavedSettings backup;
+    Settings::instance().evaluationDate() = Date(1, Dec, 2015);
+
+    vector<Time> times;
+    vector<boost::shared_ptr<SimpleQuote> > simpleQuotes;
+    vector<Handle<Quote> > quotes;
+    for (Size i = 0; i <= 20; i++) {
+        times.push_back(i * 0.5);
+        simpleQuotes.push_back(boost::make_shared<SimpleQuote>(::exp(-(0.01 + i * 0.001) * times.back())));
+        quotes.push_back(Handle<Quote>(simpleQuotes.back()));
+    }
+
+    DayCounter dc = ActualActual();
+    QuantExt::InterpolatedDiscountCurve ytsBase(times, quotes, 0, NullCalendar(), dc);
+    QuantExt::CachedInterpolatedDiscountCurve ytsTest(times, quotes, 0, NullCalendar(), dc);
+
+    // ascending times including pillars and extrapolation, and a descending sequence
+    vector<Time> ascending, descending;
+    for (Time t = 0.0; t < 15.0; t += 0.05)
+        ascending.push_back(t);
+    descending.assign(ascending.rbegin(), ascending.rend());
+
+    for (Size run = 0; run < 2; ++run) {
+        for (Size i = 0; i < ascending.size(); ++i)
+            BOOST_CHECK_CLOSE(ytsBase.discount(ascending[i]), ytsTest.discount(ascending[i]), 1e-12);
+        vector<DiscountFactor> dfs = ytsTest.discount(ascending);
+        BOOST_REQUIRE_EQUAL(dfs.size(), ascending.size());
+        for (Size i = 0; i < ascending.size(); ++i)
+            BOOST_CHECK_CLOSE(ytsBase.discount(ascending[i]), dfs[i], 1e-12);
+        QuantExt::discountFactors(ytsTest, descending, dfs);
+        for (Size i = 0; i < descending.size(); ++i)
+            BOOST_CHECK_CLOSE(ytsBase.discount(descending[i]), dfs[i], 1e-12);
+        QuantExt::discountFactors(ytsBase, descending, dfs);
+        for (Size i = 0; i < descending.size(); ++i)
+            BOOST_CHECK_CLOSE(ytsTest.discount(descending[i]), dfs[i], 1e-12);
+
+        // the cached log discounts are updated when the quotes change
+        for (Size i = 1; i < simpleQuotes.size(); ++i)
+            simpleQuotes[i]->setValue(simpleQuotes[i]->value() * 0.99);
+    }
+
+    BOOST_CHECK_THROW(ytsTest.discount(vector<Time>(1, -1.0)), QuantLib::Error);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -32,6 +32,8 @@ class DiscountCurveTest {
 public:
     /*! Test the discount curve against a corresponding QuantLib discount curve. */
     static void testDiscountCurve();
+    /*! Test the cached curve and its batch interface against InterpolatedDiscountCurve. */
+    static void testCachedInterpolatedDiscountCurve();
 
     static boost::unit_test_framework::test_suite* suite();
 };
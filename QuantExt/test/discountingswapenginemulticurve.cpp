@@ -0,0 +1,162 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+#include <boost/make_shared.hpp>
+#include <boost/test/unit_test.hpp>
+#include <ql/currencies/europe.hpp>
+#include <ql/indexes/iborindex.hpp>
+#include <ql/instruments/vanillaswap.hpp>
+#include <ql/pricingengines/swap/discountingswapengine.hpp>
+#include <ql/quotes/simplequote.hpp>
+#include <ql/time/calendars/nullcalendar.hpp>
+#include <ql/time/daycounters/actual360.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+
+#include <qle/pricingengines/discountingswapenginemulticurve.hpp>
+#include <qle/termstructures/cachedinterpolateddiscountcurve.hpp>
+
+using namespace std;
+using namespace boost::unit_test_framework;
+using namespace QuantLib;
+using namespace QuantExt;
+
+namespace {
+
+// flat zero rate curve with cached log discounts, the quotes are returned to allow for shifts
+Handle<YieldTermStructure> curve(Rate rate, vector<boost::shared_ptr<SimpleQuote> >& quotes) {
+    vector<Time> times;
+    vector<Handle<Quote> > handles;
+    for (Size i = 0; i <= 40; ++i) {
+        times.push_back(i * 0.5);
+        quotes.push_back(boost::make_shared<SimpleQuote>(std::exp(-(rate + 0.0002 * i) * times.back())));
+        handles.push_back(Handle<Quote>(quotes.back()));
+    }
+    Handle<YieldTermStructure> h(
+        boost::make_shared<CachedInterpolatedDiscountCurve>(times, handles, 0, NullCalendar(), Actual365Fixed()));
+    h->enableExtrapolation();
+    return h;
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(DiscountingSwapEngineMultiCurveTest)
+
+BOOST_AUTO_TEST_CASE(testAgainstDiscountingSwapEngine) {
+
+    BOOST_TEST_MESSAGE("Testing DiscountingSwapEngineMultiCurve against DiscountingSwapEngine...");
+
+    SavedSettings backup;
+
+    Date asof(15, Jan, 2016);
+    Settings::instance().evaluationDate() = asof;
+
+    vector<boost::shared_ptr<SimpleQuote> > discountQuotes, forwardQuotes;
+    Handle<YieldTermStructure> discountCurve = curve(0.01, discountQuotes);
+    Handle<YieldTermStructure> forwardCurve = curve(0.015, forwardQuotes);
+
+    // index periods coincide with the accrual periods, as assumed by the multi curve engine
+    boost::shared_ptr<IborIndex> index = boost::make_shared<IborIndex>(
+        "Test", 6 * Months, 0, EURCurrency(), NullCalendar(), Unadjusted, false, Actual360(), forwardCurve);
+    Schedule fixedSchedule(asof, asof + 10 * Years, 1 * Years, NullCalendar(), Unadjusted, Unadjusted,
+                           DateGeneration::Forward, false);
+    Schedule floatSchedule(asof, asof + 10 * Years, 6 * Months, NullCalendar(), Unadjusted, Unadjusted,
+                           DateGeneration::Forward, false);
+
+    boost::shared_ptr<PricingEngine> referenceEngine = boost::make_shared<DiscountingSwapEngine>(discountCurve);
+    boost::shared_ptr<PricingEngine> engine = boost::make_shared<DiscountingSwapEngineMultiCurve>(discountCurve, false);
+
+    for (Size run = 0; run < 2; ++run) {
+        VanillaSwap swap(VanillaSwap::Payer, 1000000.0, fixedSchedule, 0.02, Actual365Fixed(), floatSchedule, index,
+                         0.001, Actual360());
+
+        swap.setPricingEngine(referenceEngine);
+        Real npv = swap.NPV();
+        vector<Real> legNpv = {swap.legNPV(0), swap.legNPV(1)};
+        vector<Real> legBps = {swap.legBPS(0), swap.legBPS(1)};
+
+        swap.setPricingEngine(engine);
+        BOOST_CHECK_CLOSE(swap.NPV(), npv, 1e-8);
+        for (Size i = 0; i < 2; ++i) {
+            BOOST_CHECK_CLOSE(swap.legNPV(i), legNpv[i], 1e-8);
+            BOOST_CHECK_CLOSE(swap.legBPS(i), legBps[i], 1e-8);
+        }
+
+        // the curves do not forward quote updates, so the swap is priced again from scratch
+        for (Size i = 1; i < discountQuotes.size(); ++i) {
+            discountQuotes[i]->setValue(discountQuotes[i]->value() * 0.995);
+            forwardQuotes[i]->setValue(forwardQuotes[i]->value() * 0.99);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testCompiledLegsAcrossDates) {
+
+    BOOST_TEST_MESSAGE("Testing DiscountingSwapEngineMultiCurve on swaps sharing an engine across dates...");
+
+    SavedSettings backup;
+
+    Date asof(15, Jan, 2016);
+    Settings::instance().evaluationDate() = asof;
+
+    vector<boost::shared_ptr<SimpleQuote> > discountQuotes, forwardQuotes;
+    Handle<YieldTermStructure> discountCurve = curve(0.01, discountQuotes);
+    Handle<YieldTermStructure> forwardCurve = curve(0.015, forwardQuotes);
+
+    boost::shared_ptr<IborIndex> index = boost::make_shared<IborIndex>(
+        "Test", 6 * Months, 0, EURCurrency(), NullCalendar(), Unadjusted, false, Actual360(), forwardCurve);
+    index->addFixing(asof, 0.0125);
+
+    boost::shared_ptr<PricingEngine> referenceEngine = boost::make_shared<DiscountingSwapEngine>(discountCurve);
+    boost::shared_ptr<PricingEngine> engine = boost::make_shared<DiscountingSwapEngineMultiCurve>(discountCurve, false);
+
+    // the swaps are priced repeatedly by the same engine, so that the compiled legs are reused
+    vector<boost::shared_ptr<VanillaSwap> > swaps;
+    for (Size k = 0; k < 2; ++k) {
+        Schedule fixedSchedule(asof, asof + Integer(5 * (k + 1)) * Years, 1 * Years, NullCalendar(), Unadjusted,
+                               Unadjusted, DateGeneration::Forward, false);
+        Schedule floatSchedule(asof, asof + Integer(5 * (k + 1)) * Years, 6 * Months, NullCalendar(), Unadjusted,
+                               Unadjusted, DateGeneration::Forward, false);
+        swaps.push_back(boost::make_shared<VanillaSwap>(k == 0 ? VanillaSwap::Payer : VanillaSwap::Receiver,
+                                                        1000000.0 * (k + 1), fixedSchedule, 0.02, Actual365Fixed(),
+                                                        floatSchedule, index, 0.001 * k, Actual360()));
+    }
+
+    // moving the evaluation date moves the curve reference dates, the first coupons are fixed then
+    for (Size d = 0; d < 3; ++d) {
+        Settings::instance().evaluationDate() = asof + Integer(d) * Months;
+        for (Size run = 0; run < 2; ++run) {
+            for (Size k = 0; k < swaps.size(); ++k) {
+                swaps[k]->setPricingEngine(referenceEngine);
+                Real npv = swaps[k]->NPV();
+                vector<Real> legBps = {swaps[k]->legBPS(0), swaps[k]->legBPS(1)};
+
+                swaps[k]->setPricingEngine(engine);
+                BOOST_CHECK_CLOSE(swaps[k]->NPV(), npv, 1e-8);
+                for (Size i = 0; i < 2; ++i)
+                    BOOST_CHECK_CLOSE(swaps[k]->legBPS(i), legBps[i], 1e-8);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,95 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ Copyright (C) 2016 Skandinaviska Enskilda Banken AB (publ)
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+*/
+
+#include "toplevelfixture.hpp"
+#include <boost/test/unit_test.hpp>
+#include <ql/indexes/indexmanager.hpp>
+#include <qle/indexes/fixinghistory.hpp>
+
+#include <thread>
+
+using namespace QuantLib;
+using namespace QuantExt;
+using namespace boost::unit_test_framework;
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(FixingHistoryTest)
+
+BOOST_AUTO_TEST_CASE(testFixingOverlay) {
+
+    BOOST_TEST_MESSAGE("Testing fixing overlays on top of the IndexManager...");
+
+    BOOST_CHECK_EQUAL(FixingOverlay::handle("FixingHistoryTest-EUR"), FixingOverlay::handle("FIXINGHISTORYTEST-EUR"));
+    BOOST_CHECK(FixingOverlay::handle("FixingHistoryTest-EUR") != FixingOverlay::handle("FixingHistoryTest-USD"));
+
+    Date d1(4, March, 2019), d2(5, March, 2019);
+    TimeSeries<Real> history;
+    history[d1] = 0.01;
+    IndexManager::instance().setHistory("FixingHistoryTest-EUR", history);
+
+    FixingHistory eur("FixingHistoryTest-EUR");
+    BOOST_CHECK_EQUAL(eur.handle(), FixingOverlay::handle("FixingHistoryTest-EUR"));
+    BOOST_CHECK_EQUAL(eur.fixing(d1), 0.01);
+    BOOST_CHECK(eur.fixing(d2) == Null<Real>());
+
+    FixingOverlay overlay;
+    overlay.addFixing(eur.handle(), d2, 0.02);
+    overlay.addFixing(eur.handle(), d2, 0.03);
+    BOOST_CHECK_EQUAL(overlay.size(), 1);
+    {
+        FixingOverlayScope scope(&overlay);
+        BOOST_CHECK(FixingOverlay::current() == &overlay);
+        // the overlay fixings come first, the historical fixings are still visible
+        BOOST_CHECK_EQUAL(eur.fixing(d1), 0.01);
+        BOOST_CHECK_EQUAL(eur.fixing(d2), 0.03);
+
+        // the overlay is not visible on other threads
+        Real otherThread = 0.0;
+        std::thread t([&eur, &otherThread, &d2]() { otherThread = eur.fixing(d2); });
+        t.join();
+        BOOST_CHECK(otherThread == Null<Real>());
+
+        // a nested scope can hide the overlay
+        {
+            FixingOverlayScope inner(nullptr);
+            BOOST_CHECK(eur.fixing(d2) == Null<Real>());
+        }
+        BOOST_CHECK_EQUAL(eur.fixing(d2), 0.03);
+    }
+    BOOST_CHECK(FixingOverlay::current() == nullptr);
+    BOOST_CHECK(eur.fixing(d2) == Null<Real>());
+
+    // the IndexManager is not modified
+    BOOST_CHECK(IndexManager::instance().getHistory("FixingHistoryTest-EUR")[d2] == Null<Real>());
+
+    // the history is resolved once, fixings added to the IndexManager later are still visible
+    IndexManager::instance().setHistory("FixingHistoryTest-EUR", TimeSeries<Real>());
+    BOOST_CHECK(eur.fixing(d1) == Null<Real>());
+    history[d2] = 0.04;
+    IndexManager::instance().setHistory("FixingHistoryTest-EUR", history);
+    BOOST_CHECK_EQUAL(eur.fixing(d2), 0.04);
+
+    overlay.clear();
+    BOOST_CHECK_EQUAL(overlay.size(), 0);
+    BOOST_CHECK(overlay.fixing(eur.handle(), d2) == Null<Real>());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
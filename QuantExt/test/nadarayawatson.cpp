@@ -0,0 +1,73 @@
+/*
+ Copyright (C) 2016 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+#include <boost/test/unit_test.hpp>
+#include <ql/math/distributions/normaldistribution.hpp>
+#include <ql/math/kernelfunctions.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+
+#include <qle/math/fastnadarayawatson.hpp>
+#include <qle/math/nadarayawatson.hpp>
+
+using namespace std;
+using namespace boost::unit_test_framework;
+using namespace QuantLib;
+using namespace QuantExt;
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(NadarayaWatsonTest)
+
+BOOST_AUTO_TEST_CASE(testFastNadarayaWatson) {
+
+    BOOST_TEST_MESSAGE("Testing FastNadarayaWatson against NadarayaWatson...");
+
+    // heteroscedastic samples with unsorted regressors
+    MersenneTwisterUniformRng rng(42);
+    InverseCumulativeNormal icn;
+    Size n = 5000;
+    vector<Real> x(n), y(n);
+    for (Size i = 0; i < n; ++i) {
+        x[i] = icn(rng.nextReal());
+        y[i] = x[i] * x[i] + (1.0 + std::fabs(x[i])) * icn(rng.nextReal());
+    }
+
+    // a small bandwidth leads to truncated windows, a large one to linear binning
+    vector<Real> bandwidths = {0.001, 0.25};
+    vector<bool> binned = {false, true};
+    vector<Real> tolerances = {1.0E-5, 1.0E-2};
+
+    for (Size b = 0; b < bandwidths.size(); ++b) {
+        GaussianKernel kernel(0.0, bandwidths[b]);
+        NadarayaWatson exact(x.begin(), x.end(), y.begin(), kernel);
+        FastNadarayaWatson fast(x.begin(), x.end(), y.begin(), kernel, 6.0 * bandwidths[b]);
+        BOOST_CHECK_EQUAL(fast.binned(), binned[b]);
+        for (Size i = 0; i < n; i += 50) {
+            BOOST_CHECK_SMALL(fast(x[i]) - exact(x[i]), tolerances[b]);
+            BOOST_CHECK_SMALL(fast.standardDeviation(x[i]) - exact.standardDeviation(x[i]), tolerances[b]);
+        }
+        // no samples within the kernel support
+        BOOST_CHECK_EQUAL(fast(100.0), 0.0);
+        BOOST_CHECK_EQUAL(fast.standardDeviation(-100.0), 0.0);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
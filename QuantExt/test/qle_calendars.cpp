@@ -20,11 +20,15 @@
 #include <boost/test/unit_test.hpp>
 #include <ql/time/calendar.hpp>
 #include <ql/time/calendars/austria.hpp>
+#include <ql/time/calendars/target.hpp>
+#include <ql/time/calendars/unitedkingdom.hpp>
 #include <qle/calendars/belgium.hpp>
+#include <qle/calendars/cachedcalendar.hpp>
 #include <qle/calendars/chile.hpp>
 #include <qle/calendars/colombia.hpp>
 #include <qle/calendars/france.hpp>
 #include <qle/calendars/israel.hpp>
+#include <qle/calendars/largejointcalendar.hpp>
 #include <qle/calendars/luxembourg.hpp>
 #include <qle/calendars/malaysia.hpp>
 #include <qle/calendars/netherlands.hpp>
@@ -400,6 +404,66 @@ BOOST_AUTO_TEST_CASE(testBelgianCalendar) {
     check::checkCalendars(expectedHolidays, hol);
 }
 
+BOOST_AUTO_TEST_CASE(testCachedCalendar) {
+
+    BOOST_TEST_MESSAGE("Testing cached calendar against the underlying calendar");
+
+    std::vector<Calendar> cals;
+    cals.push_back(TARGET());
+    cals.push_back(UnitedKingdom());
+    cals.push_back(Peru());
+    std::vector<Calendar> calendars;
+    calendars.push_back(TARGET());
+    calendars.push_back(LargeJointCalendar(cals));
+    calendars.push_back(LargeJointCalendar(cals, JoinBusinessDays));
+
+    // the dates before 2010 and after 2020 are outside the cached range
+    Date start(1, January, 2009), end(31, December, 2021);
+    std::vector<Integer> steps = {-300, -25, -2, -1, 0, 1, 2, 7, 25, 300};
+
+    for (Size i = 0; i < calendars.size(); ++i) {
+        Calendar c = calendars[i];
+        CachedCalendar cached(c, 2010, 2020);
+        BOOST_CHECK_EQUAL(cached.name(), c.name());
+        for (Date d = start; d <= end; ++d) {
+            BOOST_REQUIRE_MESSAGE(cached.isBusinessDay(d) == c.isBusinessDay(d),
+                                  "isBusinessDay differs for " << c.name() << " on " << d);
+            if (d.dayOfMonth() % 3 != 0)
+                continue;
+            for (Size j = 0; j < steps.size(); ++j) {
+                BOOST_CHECK_EQUAL(cached.advance(d, steps[j]), c.advance(d, steps[j], Days));
+                BOOST_CHECK_EQUAL(cached.advance(d, steps[j], Days), c.advance(d, steps[j], Days));
+                Date e = d + steps[j] * 3;
+                if (e < start || e > end)
+                    continue;
+                BOOST_CHECK_EQUAL(cached.businessDaysBetween(d, e), c.businessDaysBetween(d, e));
+                BOOST_CHECK_EQUAL(cached.businessDaysBetween(d, e, false, true),
+                                  c.businessDaysBetween(d, e, false, true));
+            }
+        }
+    }
+
+    // holidays added to the cached calendar are taken into account
+    CachedCalendar cached(TARGET(), 2010, 2020);
+    BOOST_CHECK_EQUAL(cached.advance(Date(14, June, 2016), 1), Date(15, June, 2016));
+    cached.addHoliday(Date(15, June, 2016));
+    BOOST_CHECK(cached.isHoliday(Date(15, June, 2016)));
+    BOOST_CHECK_EQUAL(cached.advance(Date(14, June, 2016), 1), Date(16, June, 2016));
+    BOOST_CHECK_EQUAL(cached.businessDaysBetween(Date(13, June, 2016), Date(20, June, 2016)), 4);
+
+    // copies stored as a plain calendar are advanced with the table lookups by cachedAdvance()
+    Calendar copy = CachedCalendar(UnitedKingdom(), 2010, 2020);
+    for (Size j = 0; j < steps.size(); ++j) {
+        Date d(14, June, 2016);
+        BOOST_CHECK_EQUAL(cachedAdvance(copy, d, steps[j], Days), UnitedKingdom().advance(d, steps[j], Days));
+        BOOST_CHECK_EQUAL(cachedAdvance(copy, d, steps[j] * Days, Preceding),
+                          UnitedKingdom().advance(d, steps[j] * Days, Preceding));
+        BOOST_CHECK_EQUAL(cachedAdvance(copy, d, steps[j], Months, ModifiedFollowing),
+                          UnitedKingdom().advance(d, steps[j], Months, ModifiedFollowing));
+        BOOST_CHECK_EQUAL(cachedAdvance(TARGET(), d, steps[j], Days), TARGET().advance(d, steps[j], Days));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
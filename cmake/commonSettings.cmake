@@ -12,6 +12,10 @@ endmacro()
 set(CMAKE_CXX_STANDARD 11)
 add_compiler_flag("-D QL_USE_STD_UNIQUE_PTR" supports_D_QL_USE_STD_UNIQUE_PTR)
 
+# log levels not contained in this mask are removed from the code at compile time, see ored/utilities/log.hpp
+set(ORE_LOG_COMPILE_MASK "255" CACHE STRING "Log levels compiled into ORE (bitmask, 255 = all levels)")
+add_definitions(-DORE_LOG_COMPILE_MASK=${ORE_LOG_COMPILE_MASK})
+
 # On single-configuration builds, select a default build type that gives the same compilation flags as a default autotools build.
 if(NOT CMAKE_BUILD_TYPE AND NOT CMAKE_CONFIGURATION_TYPES)
     set(CMAKE_BUILD_TYPE "RelWithDebInfo")